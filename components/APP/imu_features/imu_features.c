@@ -0,0 +1,232 @@
+#include "imu_features.h"
+#include "esp_dsp.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "imu_features";
+
+struct imu_features {
+    imu_features_config_t cfg;
+    imu_features_cb_t cb;
+    void *user_ctx;
+
+    float *samples[IMU_FEATURES_AXES];  // 当前窗口
+    float *window;                      // Hann 窗系数
+    float *fft_buf;                     // 复数 FFT 缓冲区（2N）
+    float spec_norm;                    // 单边功率谱归一化系数 2 / (N² · mean(w²))
+    size_t fill;
+    uint64_t start_ts_us;
+    uint32_t period_us;
+
+    // 每个 FFT 频点所属频带（-1 表示不属于任何频带），创建时预计算
+    int8_t *bin_band;
+};
+
+static bool _is_pow2(uint32_t n)
+{
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+static void _compute_axis(imu_features_handle_t h, const float *x, imu_features_axis_t *out)
+{
+    const size_t n = h->cfg.window_size;
+
+    // 时域：去均值后的 RMS 与峰值
+    float mean = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        mean += x[i];
+    }
+    mean /= n;
+
+    float sum_sq = 0.0f;
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        float v = x[i] - mean;
+        sum_sq += v * v;
+        float a = fabsf(v);
+        if (a > peak) {
+            peak = a;
+        }
+    }
+    out->rms = sqrtf(sum_sq / n);
+    out->peak = peak;
+    out->crest = out->rms > 0.0f ? peak / out->rms : 0.0f;
+
+    // 频域：加窗实数信号按复数 FFT 计算（虚部为 0）
+    float *buf = h->fft_buf;
+    for (size_t i = 0; i < n; i++) {
+        buf[i * 2] = (x[i] - mean) * h->window[i];
+        buf[i * 2 + 1] = 0.0f;
+    }
+    dsps_fft2r_fc32(buf, n);
+    dsps_bit_rev_fc32(buf, n);
+
+    memset(out->band_energy, 0, sizeof(out->band_energy));
+    float best = 0.0f;
+    size_t best_bin = 0;
+    // 单边谱：除直流与奈奎斯特外乘 2，再按窗函数功率增益还原。确定性信号各频带能量之和 ≈ RMS²；
+    // 宽带噪声单窗口受窗函数加权有几个百分点的估计波动，多窗口平均后 ≈ RMS²
+    const float norm = h->spec_norm;
+    for (size_t k = 1; k < n / 2; k++) {
+        float re = buf[k * 2];
+        float im = buf[k * 2 + 1];
+        float p = (re * re + im * im) * norm;
+        if (p > best) {
+            best = p;
+            best_bin = k;
+        }
+        int band = h->bin_band[k];
+        if (band >= 0) {
+            out->band_energy[band] += p;
+        }
+    }
+    out->dominant_hz = best_bin * h->cfg.sample_rate_hz / n;
+}
+
+static void _process_window(imu_features_handle_t h)
+{
+    imu_features_result_t result = {
+        .start_ts_us = h->start_ts_us,
+        .window_size = h->cfg.window_size,
+        .num_bands = h->cfg.num_bands,
+    };
+
+    for (int a = 0; a < IMU_FEATURES_AXES; a++) {
+        _compute_axis(h, h->samples[a], &result.axis[a]);
+    }
+
+    if (h->cb) {
+        h->cb(&result, h->user_ctx);
+    }
+}
+
+esp_err_t imu_features_create(const imu_features_config_t *config, imu_features_cb_t cb, void *user_ctx,
+                              imu_features_handle_t *ret_handle)
+{
+    if (config == NULL || ret_handle == NULL || !_is_pow2(config->window_size) ||
+        config->window_size < 64 || config->window_size > CONFIG_DSP_MAX_FFT_SIZE ||
+        config->sample_rate_hz <= 0.0f || config->num_bands > IMU_FEATURES_MAX_BANDS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < config->num_bands; i++) {
+        if (config->band_edges_hz[i + 1] <= config->band_edges_hz[i]) {
+            ESP_LOGE(TAG, "频带边界必须递增");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    // FFT 旋转因子表为全局共享，重复初始化直接返回
+    esp_err_t err = dsps_fft2r_init_fc32(NULL, CONFIG_DSP_MAX_FFT_SIZE);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "FFT 初始化失败: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    imu_features_handle_t h = calloc(1, sizeof(struct imu_features));
+    if (h == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    h->cfg = *config;
+    h->cb = cb;
+    h->user_ctx = user_ctx;
+    h->period_us = (uint32_t)(1000000.0f / config->sample_rate_hz);
+
+    const size_t n = config->window_size;
+    bool ok = true;
+    // 运算缓冲区放在内部 RAM，FFT 访问频繁
+    for (int a = 0; a < IMU_FEATURES_AXES; a++) {
+        h->samples[a] = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_INTERNAL);
+        ok &= h->samples[a] != NULL;
+    }
+    h->window = heap_caps_malloc(n * sizeof(float), MALLOC_CAP_INTERNAL);
+    h->fft_buf = heap_caps_aligned_alloc(16, n * 2 * sizeof(float), MALLOC_CAP_INTERNAL);
+    h->bin_band = malloc(n / 2);
+    ok &= h->window != NULL && h->fft_buf != NULL && h->bin_band != NULL;
+    if (!ok) {
+        imu_features_delete(h);
+        return ESP_ERR_NO_MEM;
+    }
+
+    dsps_wind_hann_f32(h->window, n);
+
+    // dsps_wind_hann_f32 为对称窗，mean(w²) = 3/8 · (N-1)/N，按实际系数计算，小窗口时不低估能量
+    double w_sq = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        w_sq += (double)h->window[i] * h->window[i];
+    }
+    h->spec_norm = (float)(2.0 / ((double)n * w_sq));
+
+    for (size_t k = 0; k < n / 2; k++) {
+        float f = k * config->sample_rate_hz / n;
+        h->bin_band[k] = -1;
+        for (int b = 0; b < config->num_bands; b++) {
+            if (f >= config->band_edges_hz[b] && f < config->band_edges_hz[b + 1]) {
+                h->bin_band[k] = (int8_t)b;
+                break;
+            }
+        }
+    }
+
+    ESP_LOGI(TAG, "特征提取器已创建: 窗口 %u 点 @ %.0f Hz, %u 个频带", (unsigned)n, config->sample_rate_hz,
+             config->num_bands);
+    *ret_handle = h;
+    return ESP_OK;
+}
+
+void imu_features_delete(imu_features_handle_t handle)
+{
+    if (handle == NULL) {
+        return;
+    }
+    for (int a = 0; a < IMU_FEATURES_AXES; a++) {
+        free(handle->samples[a]);
+    }
+    free(handle->window);
+    free(handle->fft_buf);
+    free(handle->bin_band);
+    free(handle);
+}
+
+esp_err_t imu_features_push(imu_features_handle_t handle, const float *x, const float *y, const float *z,
+                            size_t count, uint64_t ts_us)
+{
+    if (handle == NULL || x == NULL || y == NULL || z == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const float *in[IMU_FEATURES_AXES] = {x, y, z};
+    const size_t n = handle->cfg.window_size;
+    size_t done = 0;
+
+    while (done < count) {
+        if (handle->fill == 0) {
+            handle->start_ts_us = ts_us + (uint64_t)done * handle->period_us;
+        }
+
+        size_t chunk = n - handle->fill;
+        if (chunk > count - done) {
+            chunk = count - done;
+        }
+        for (int a = 0; a < IMU_FEATURES_AXES; a++) {
+            memcpy(&handle->samples[a][handle->fill], &in[a][done], chunk * sizeof(float));
+        }
+        handle->fill += chunk;
+        done += chunk;
+
+        if (handle->fill == n) {
+            _process_window(handle);
+            handle->fill = 0;
+        }
+    }
+    return ESP_OK;
+}
+
+void imu_features_reset(imu_features_handle_t handle)
+{
+    if (handle != NULL) {
+        handle->fill = 0;
+    }
+}
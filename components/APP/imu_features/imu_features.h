@@ -0,0 +1,76 @@
+#ifndef IMU_FEATURES_H
+#define IMU_FEATURES_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define IMU_FEATURES_AXES           3       // X / Y / Z
+#define IMU_FEATURES_MAX_BANDS      8       // 最多频带数
+
+/**
+ * @brief 特征提取配置
+ */
+typedef struct {
+    uint16_t window_size;                       // 窗口长度（2 的幂，64 ~ 4096）
+    float sample_rate_hz;                       // 采样率
+    uint8_t num_bands;                          // 频带数（0 表示不计算频带能量）
+    float band_edges_hz[IMU_FEATURES_MAX_BANDS + 1];    // 频带边界（递增，num_bands + 1 个）
+} imu_features_config_t;
+
+/**
+ * @brief 单轴特征（已去除窗口均值，即重力/静态分量）
+ */
+typedef struct {
+    float rms;                                  // 均方根
+    float peak;                                 // 绝对值峰值
+    float crest;                                // 峰值因子 peak / rms
+    float dominant_hz;                          // 能量最大的频率
+    float band_energy[IMU_FEATURES_MAX_BANDS];  // 各频带能量（与 RMS² 同量纲，频带覆盖 0 ~ fs/2 时之和 ≈ RMS²）
+} imu_features_axis_t;
+
+/**
+ * @brief 一个窗口的特征
+ */
+typedef struct {
+    uint64_t start_ts_us;                       // 窗口第一个样本的时间戳
+    uint16_t window_size;
+    uint8_t num_bands;
+    imu_features_axis_t axis[IMU_FEATURES_AXES];
+} imu_features_result_t;
+
+/**
+ * @brief 窗口完成回调（在调用 imu_features_push 的任务中执行）
+ */
+typedef void (*imu_features_cb_t)(const imu_features_result_t *result, void *user_ctx);
+
+typedef struct imu_features *imu_features_handle_t;
+
+/**
+ * @brief 创建特征提取器
+ */
+esp_err_t imu_features_create(const imu_features_config_t *config, imu_features_cb_t cb, void *user_ctx,
+                              imu_features_handle_t *ret_handle);
+
+/**
+ * @brief 释放特征提取器
+ */
+void imu_features_delete(imu_features_handle_t handle);
+
+/**
+ * @brief 输入一批三轴数据（SoA，可直接使用 mpu6050_convert_batch 的输出）
+ *
+ * 每满一个窗口计算一次特征并调用回调，窗口之间不重叠。
+ *
+ * @param ts_us 第一个样本的时间戳
+ */
+esp_err_t imu_features_push(imu_features_handle_t handle, const float *x, const float *y, const float *z,
+                            size_t count, uint64_t ts_us);
+
+/**
+ * @brief 丢弃未满的窗口
+ */
+void imu_features_reset(imu_features_handle_t handle);
+
+#endif /* IMU_FEATURES_H */
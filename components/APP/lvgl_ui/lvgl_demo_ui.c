@@ -1,4 +1,13 @@
 #include "lvgl_demo_ui.h"
+#include "font_cache.h"
+
+#define DEMO_FONT_CACHE_GLYPHS      128             // 常用字形数
+#define DEMO_FONT_CACHE_BYTES       (32 * 1024)     // 位图区大小
+
+static font_cache_handle_t s_font_cache = NULL;
+#if LV_FONT_SIMSUN_16_CJK
+static font_cache_handle_t s_cjk_cache = NULL;
+#endif
 
 static void _set_angle(void *obj, int32_t v)
 {
@@ -10,12 +19,34 @@ void lvgl_demo_ui(lv_disp_t *disp)
     lv_obj_t *scr = lv_disp_get_scr_act(disp);
     lv_obj_set_style_bg_color(scr, lv_color_hex(0xFFB6C1), LV_PART_MAIN);
 
+    /* Font cache */
+    const lv_font_t *font = &lv_font_montserrat_14;
+    if (s_font_cache == NULL &&
+        font_cache_create(&lv_font_montserrat_14, DEMO_FONT_CACHE_GLYPHS, DEMO_FONT_CACHE_BYTES, &s_font_cache) == ESP_OK) {
+        font_cache_preload(s_font_cache, "ST7789 + LVGL 8.3");
+    }
+    if (s_font_cache != NULL) {
+        font = font_cache_get_font(s_font_cache);
+    }
+
     /* Create a label */
     lv_obj_t *label = lv_label_create(scr);
     lv_label_set_text(label, "ST7789 + LVGL 8.3");
-    lv_obj_set_style_text_font(label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_font(label, font, 0);
     lv_obj_align(label, LV_ALIGN_TOP_MID, 0, 35);
 
+#if LV_FONT_SIMSUN_16_CJK
+    /* CJK label */
+    if (s_cjk_cache == NULL &&
+        font_cache_create(&lv_font_simsun_16_cjk, DEMO_FONT_CACHE_GLYPHS, DEMO_FONT_CACHE_BYTES, &s_cjk_cache) == ESP_OK) {
+        font_cache_preload(s_cjk_cache, "你好世界");
+    }
+    lv_obj_t *cjk_label = lv_label_create(scr);
+    lv_label_set_text(cjk_label, "你好世界");
+    lv_obj_set_style_text_font(cjk_label, s_cjk_cache ? font_cache_get_font(s_cjk_cache) : &lv_font_simsun_16_cjk, 0);
+    lv_obj_align(cjk_label, LV_ALIGN_BOTTOM_MID, 0, -25);
+#endif
+
     /* Create an Arc */
     lv_obj_t *arc = lv_arc_create(scr);
     lv_arc_set_rotation(arc, 270);
@@ -0,0 +1,304 @@
+#include "i2c_bus.h"
+#include "i2c_bus_config.h"
+#include "driver/i2c_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "i2c_bus";
+
+struct i2c_bus {
+    int port;
+    i2c_master_bus_handle_t handle;
+    SemaphoreHandle_t lock;             // 串行化传输、总线清除与统计更新
+    QueueHandle_t queue;                // 异步传输队列（首次提交时创建）
+    TaskHandle_t task;
+    uint8_t fail_streak;                // 连续失败次数
+    i2c_bus_stats_t stats;
+    int64_t stats_since_us;
+};
+
+struct i2c_bus_dev {
+    struct i2c_bus *bus;
+    i2c_master_dev_handle_t handle;
+    uint16_t addr;
+};
+
+typedef struct {
+    struct i2c_bus_dev *dev;
+    i2c_bus_trans_t trans;
+} i2c_bus_job_t;
+
+static struct i2c_bus *s_buses[I2C_NUM_MAX] = {0};
+static portMUX_TYPE s_buses_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_err_t _transfer(struct i2c_bus_dev *dev, const uint8_t *write_buf, size_t write_len,
+                           uint8_t *read_buf, size_t read_len)
+{
+    struct i2c_bus *bus = dev->bus;
+    esp_err_t err = ESP_FAIL;
+
+    xSemaphoreTake(bus->lock, portMAX_DELAY);
+    for (int attempt = 0; attempt <= I2C_BUS_MAX_RETRIES; attempt++) {
+        if (attempt > 0) {
+            bus->stats.retries++;
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        if (read_buf != NULL) {
+            err = i2c_master_transmit_receive(dev->handle, write_buf, write_len, read_buf, read_len,
+                                              I2C_BUS_DEFAULT_TIMEOUT_MS);
+        } else {
+            err = i2c_master_transmit(dev->handle, write_buf, write_len, I2C_BUS_DEFAULT_TIMEOUT_MS);
+        }
+        bus->stats.busy_us += esp_timer_get_time() - t0;
+
+        if (err == ESP_OK) {
+            bus->fail_streak = 0;
+            bus->stats.transactions++;
+            bus->stats.bytes += write_len + (read_buf != NULL ? read_len : 0);
+            break;
+        }
+
+        // 从机拉住 SDA 或卡在半个字节时，只有发送时钟脉冲才能恢复
+        if (++bus->fail_streak >= I2C_BUS_RECOVER_AFTER) {
+            ESP_LOGW(TAG, "端口 %d 设备 0x%02X 连续失败，执行总线清除", bus->port, dev->addr);
+            i2c_master_bus_reset(bus->handle);
+            bus->stats.recoveries++;
+            bus->fail_streak = 0;
+        }
+    }
+    if (err != ESP_OK) {
+        bus->stats.errors++;
+    }
+    xSemaphoreGive(bus->lock);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "设备 0x%02X 传输失败: %s", dev->addr, esp_err_to_name(err));
+    }
+    return err;
+}
+
+static void _bus_task(void *arg)
+{
+    struct i2c_bus *bus = (struct i2c_bus *)arg;
+    i2c_bus_job_t job;
+
+    while (1) {
+        if (xQueueReceive(bus->queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        esp_err_t err = _transfer(job.dev, job.trans.write_buf, job.trans.write_len, job.trans.read_buf,
+                                  job.trans.read_len);
+        if (job.trans.cb) {
+            job.trans.cb(err, job.trans.user_ctx);
+        }
+    }
+}
+
+esp_err_t i2c_bus_get(const i2c_bus_config_t *config, i2c_bus_handle_t *ret_bus)
+{
+    if (config == NULL || ret_bus == NULL || config->port < 0 || config->port >= I2C_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&s_buses_lock);
+    struct i2c_bus *existing = s_buses[config->port];
+    taskEXIT_CRITICAL(&s_buses_lock);
+    if (existing != NULL) {
+        *ret_bus = existing;
+        return ESP_OK;
+    }
+
+    struct i2c_bus *bus = calloc(1, sizeof(struct i2c_bus));
+    if (bus == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    bus->port = config->port;
+    bus->lock = xSemaphoreCreateMutex();
+    if (bus->lock == NULL) {
+        free(bus);
+        return ESP_ERR_NO_MEM;
+    }
+
+    i2c_master_bus_config_t bus_cfg = {
+        .i2c_port = config->port,
+        .sda_io_num = config->sda_pin,
+        .scl_io_num = config->scl_pin,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = config->glitch_ignore_cnt,
+        .flags.enable_internal_pullup = config->internal_pullup,
+    };
+    esp_err_t err = i2c_new_master_bus(&bus_cfg, &bus->handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "端口 %d 总线创建失败: %s", config->port, esp_err_to_name(err));
+        vSemaphoreDelete(bus->lock);
+        free(bus);
+        return err;
+    }
+    bus->stats_since_us = esp_timer_get_time();
+
+    // 两个任务同时创建同一端口时，后到者释放自己的实例并使用先到者的
+    taskENTER_CRITICAL(&s_buses_lock);
+    existing = s_buses[config->port];
+    if (existing == NULL) {
+        s_buses[config->port] = bus;
+    }
+    taskEXIT_CRITICAL(&s_buses_lock);
+    if (existing != NULL) {
+        i2c_del_master_bus(bus->handle);
+        vSemaphoreDelete(bus->lock);
+        free(bus);
+        *ret_bus = existing;
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "I2C 总线 %d 已创建 (SDA: %d, SCL: %d)", config->port, config->sda_pin, config->scl_pin);
+    *ret_bus = bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_add_device(i2c_bus_handle_t bus, uint16_t addr, uint32_t scl_speed_hz,
+                             i2c_bus_dev_handle_t *ret_dev)
+{
+    if (bus == NULL || ret_dev == NULL || scl_speed_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct i2c_bus_dev *dev = calloc(1, sizeof(struct i2c_bus_dev));
+    if (dev == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = addr,
+        .scl_speed_hz = scl_speed_hz,
+    };
+    esp_err_t err = i2c_master_bus_add_device(bus->handle, &dev_cfg, &dev->handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "添加设备 0x%02X 失败: %s", addr, esp_err_to_name(err));
+        free(dev);
+        return err;
+    }
+    dev->bus = bus;
+    dev->addr = addr;
+
+    ESP_LOGI(TAG, "总线 %d 添加设备 0x%02X @ %lu Hz", bus->port, addr, (unsigned long)scl_speed_hz);
+    *ret_dev = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_remove_device(i2c_bus_dev_handle_t dev)
+{
+    if (dev == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 等待正在执行的传输结束；调用者需保证队列中没有该设备的异步传输
+    xSemaphoreTake(dev->bus->lock, portMAX_DELAY);
+    esp_err_t err = i2c_master_bus_rm_device(dev->handle);
+    xSemaphoreGive(dev->bus->lock);
+    if (err == ESP_OK) {
+        free(dev);
+    }
+    return err;
+}
+
+esp_err_t i2c_bus_write(i2c_bus_dev_handle_t dev, const uint8_t *data, size_t len)
+{
+    if (dev == NULL || data == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return _transfer(dev, data, len, NULL, 0);
+}
+
+esp_err_t i2c_bus_write_read(i2c_bus_dev_handle_t dev, const uint8_t *write_buf, size_t write_len,
+                             uint8_t *read_buf, size_t read_len)
+{
+    if (dev == NULL || write_buf == NULL || write_len == 0 || read_buf == NULL || read_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return _transfer(dev, write_buf, write_len, read_buf, read_len);
+}
+
+esp_err_t i2c_bus_write_reg(i2c_bus_dev_handle_t dev, uint8_t reg, uint8_t value)
+{
+    uint8_t buf[] = {reg, value};
+    return i2c_bus_write(dev, buf, sizeof(buf));
+}
+
+esp_err_t i2c_bus_read_regs(i2c_bus_dev_handle_t dev, uint8_t reg, uint8_t *data, size_t len)
+{
+    return i2c_bus_write_read(dev, &reg, 1, data, len);
+}
+
+esp_err_t i2c_bus_submit(i2c_bus_dev_handle_t dev, const i2c_bus_trans_t *trans, TickType_t wait)
+{
+    if (dev == NULL || trans == NULL || trans->write_buf == NULL || trans->write_len == 0 ||
+        (trans->read_buf != NULL && trans->read_len == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct i2c_bus *bus = dev->bus;
+
+    // 工作任务按需创建，只使用同步接口的总线不占用额外资源
+    xSemaphoreTake(bus->lock, portMAX_DELAY);
+    if (bus->queue == NULL) {
+        bus->queue = xQueueCreate(I2C_BUS_QUEUE_LEN, sizeof(i2c_bus_job_t));
+        if (bus->queue != NULL &&
+            xTaskCreate(_bus_task, "i2c_bus", I2C_BUS_TASK_STACK, bus, I2C_BUS_TASK_PRIORITY, &bus->task) != pdPASS) {
+            vQueueDelete(bus->queue);
+            bus->queue = NULL;
+        }
+    }
+    QueueHandle_t queue = bus->queue;
+    xSemaphoreGive(bus->lock);
+
+    if (queue == NULL) {
+        ESP_LOGE(TAG, "总线 %d 异步队列创建失败", bus->port);
+        return ESP_ERR_NO_MEM;
+    }
+
+    i2c_bus_job_t job = {
+        .dev = dev,
+        .trans = *trans,
+    };
+    if (xQueueSend(queue, &job, wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_get_stats(i2c_bus_handle_t bus, i2c_bus_stats_t *stats)
+{
+    if (bus == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(bus->lock, portMAX_DELAY);
+    *stats = bus->stats;
+    int64_t elapsed = esp_timer_get_time() - bus->stats_since_us;
+    xSemaphoreGive(bus->lock);
+
+    stats->queued = bus->queue != NULL ? uxQueueMessagesWaiting(bus->queue) : 0;
+    stats->utilization = elapsed > 0 ? (float)stats->busy_us / (float)elapsed : 0.0f;
+    return ESP_OK;
+}
+
+void i2c_bus_reset_stats(i2c_bus_handle_t bus)
+{
+    if (bus == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(bus->lock, portMAX_DELAY);
+    memset(&bus->stats, 0, sizeof(bus->stats));
+    bus->stats_since_us = esp_timer_get_time();
+    xSemaphoreGive(bus->lock);
+}
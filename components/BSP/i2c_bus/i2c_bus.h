@@ -0,0 +1,110 @@
+#ifndef __I2C_BUS_H__
+#define __I2C_BUS_H__
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct i2c_bus *i2c_bus_handle_t;
+typedef struct i2c_bus_dev *i2c_bus_dev_handle_t;
+
+/**
+ * @brief 总线配置（同一端口只会创建一次，之后的调用返回已有总线）
+ */
+typedef struct {
+    int port;                       // I2C 端口号
+    int sda_pin;
+    int scl_pin;
+    bool internal_pullup;
+    int glitch_ignore_cnt;
+} i2c_bus_config_t;
+
+/**
+ * @brief 异步传输完成回调（在总线工作任务中执行）
+ */
+typedef void (*i2c_bus_done_cb_t)(esp_err_t err, void *user_ctx);
+
+/**
+ * @brief 异步传输描述（缓冲区在回调前必须保持有效）
+ */
+typedef struct {
+    const uint8_t *write_buf;
+    size_t write_len;
+    uint8_t *read_buf;              // NULL 表示只写
+    size_t read_len;
+    i2c_bus_done_cb_t cb;
+    void *user_ctx;
+} i2c_bus_trans_t;
+
+/**
+ * @brief 总线统计
+ */
+typedef struct {
+    uint32_t transactions;          // 成功的传输数
+    uint32_t errors;                // 重试后仍失败的传输数
+    uint32_t retries;               // 重试次数
+    uint32_t recoveries;            // 总线清除次数
+    uint32_t queued;                // 异步队列中待执行的传输数
+    uint64_t bytes;                 // 传输字节数（读 + 写）
+    uint64_t busy_us;               // 总线占用时间
+    float utilization;              // 自上次重置以来的占用率（0 ~ 1）
+} i2c_bus_stats_t;
+
+/**
+ * @brief 获取（必要时创建）总线
+ */
+esp_err_t i2c_bus_get(const i2c_bus_config_t *config, i2c_bus_handle_t *ret_bus);
+
+/**
+ * @brief 在总线上添加设备（每个设备可使用不同的时钟频率）
+ */
+esp_err_t i2c_bus_add_device(i2c_bus_handle_t bus, uint16_t addr, uint32_t scl_speed_hz,
+                             i2c_bus_dev_handle_t *ret_dev);
+
+/**
+ * @brief 移除设备
+ */
+esp_err_t i2c_bus_remove_device(i2c_bus_dev_handle_t dev);
+
+/**
+ * @brief 同步写（失败自动重试，必要时清除总线，不会中止程序）
+ */
+esp_err_t i2c_bus_write(i2c_bus_dev_handle_t dev, const uint8_t *data, size_t len);
+
+/**
+ * @brief 同步写后读（重复起始条件）
+ */
+esp_err_t i2c_bus_write_read(i2c_bus_dev_handle_t dev, const uint8_t *write_buf, size_t write_len,
+                             uint8_t *read_buf, size_t read_len);
+
+/**
+ * @brief 写单个寄存器
+ */
+esp_err_t i2c_bus_write_reg(i2c_bus_dev_handle_t dev, uint8_t reg, uint8_t value);
+
+/**
+ * @brief 从 reg 开始连续读取
+ */
+esp_err_t i2c_bus_read_regs(i2c_bus_dev_handle_t dev, uint8_t reg, uint8_t *data, size_t len);
+
+/**
+ * @brief 提交异步传输（由总线工作任务按提交顺序执行）
+ *
+ * @param wait 队列满时的等待时间
+ * @return ESP_OK 已入队，ESP_ERR_TIMEOUT 队列已满
+ */
+esp_err_t i2c_bus_submit(i2c_bus_dev_handle_t dev, const i2c_bus_trans_t *trans, TickType_t wait);
+
+/**
+ * @brief 获取总线统计
+ */
+esp_err_t i2c_bus_get_stats(i2c_bus_handle_t bus, i2c_bus_stats_t *stats);
+
+/**
+ * @brief 重置总线统计
+ */
+void i2c_bus_reset_stats(i2c_bus_handle_t bus);
+
+#endif // __I2C_BUS_H__
@@ -0,0 +1,14 @@
+#ifndef __I2C_BUS_CONFIG_H__
+#define __I2C_BUS_CONFIG_H__
+
+/* ================= Transaction Config ================= */
+#define I2C_BUS_DEFAULT_TIMEOUT_MS      100             // 单次传输超时
+#define I2C_BUS_MAX_RETRIES             2               // 失败后的重试次数
+#define I2C_BUS_RECOVER_AFTER           2               // 连续失败多少次后执行总线清除
+
+/* ================= Async Queue Config ================= */
+#define I2C_BUS_QUEUE_LEN               16              // 异步传输队列深度
+#define I2C_BUS_TASK_STACK              (3 * 1024)      // 总线工作任务栈大小
+#define I2C_BUS_TASK_PRIORITY           9               // 总线工作任务优先级
+
+#endif // __I2C_BUS_CONFIG_H__
@@ -1,85 +1,72 @@
 #include "mpu6050.h"
 #include "mpu6050_config.h"
-#include "driver/i2c_master.h"
+#include "mpu6050_calib.h"
+#include "mpu6050_backend.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_log.h"
+#include <math.h>
 
 static const char *TAG = "mpu6050";
 
 #define NUM_SENSOR_DATA 7  // 加速度计3轴 + 温度 + 陀螺仪3轴
 
-static i2c_master_bus_handle_t s_bus_handle = NULL;
-static i2c_master_dev_handle_t s_dev_handle = NULL;
+static const mpu6050_backend_t *s_backend = NULL;    // NULL 表示使用 I2C 后端
+static bool s_attached = false;
 static bool s_inited = false;
 
 // 灵敏度表
 static float s_gyro_sensitivity = MPU6050_GYRO_SENS_250;       // 默认 ±250°/s
 static float s_accel_sensitivity = MPU6050_ACCEL_SENS_2G;      // 默认 ±2g
 
-// 陀螺仪零偏
-static mpu6050_gyro_bias_t s_gyro_bias = {0, 0, 0};
-static bool s_gyro_calibrated = false;
-
-static esp_err_t _i2c_bus_init(void)
+// 校准参数（物理单位，与量程无关；默认无偏移、比例为 1）
+static mpu6050_calib_t s_calib = {
+    .accel_scale = {1.0f, 1.0f, 1.0f},
+};
+
+// 换算系数：物理量 = 原始值 × k + b（量程或校准参数变化时重新计算，转换时无除法）
+// 顺序与 mpu6050_raw_data_t 一致：accel x/y/z，gyro x/y/z
+static float s_conv_k[6] = {
+    MPU6050_GRAVITY_MS2 / MPU6050_ACCEL_SENS_2G, MPU6050_GRAVITY_MS2 / MPU6050_ACCEL_SENS_2G,
+    MPU6050_GRAVITY_MS2 / MPU6050_ACCEL_SENS_2G, 1.0f / MPU6050_GYRO_SENS_250,
+    1.0f / MPU6050_GYRO_SENS_250, 1.0f / MPU6050_GYRO_SENS_250,
+};
+static float s_conv_b[6] = {0};
+
+static void _update_conv_coeffs(void)
 {
-    if (s_bus_handle != NULL) {
-        ESP_LOGW(TAG, "I2C 总线已初始化");
-        return ESP_OK;
+    for (int i = 0; i < 3; i++) {
+        float accel_k = s_calib.accel_scale[i] * MPU6050_GRAVITY_MS2;
+        s_conv_k[i] = accel_k / s_accel_sensitivity;
+        s_conv_b[i] = -s_calib.accel_offset_g[i] * accel_k;
+        s_conv_k[i + 3] = 1.0f / s_gyro_sensitivity;
+        s_conv_b[i + 3] = -s_calib.gyro_bias_dps[i];
     }
-
-    i2c_master_bus_config_t bus_cfg = {
-        .i2c_port = MPU6050_I2C_PORT,
-        .sda_io_num = MPU6050_SDA_PIN,
-        .scl_io_num = MPU6050_SCL_PIN,
-        .clk_source = I2C_CLK_SRC_DEFAULT,
-        .glitch_ignore_cnt = MPU6050_I2C_GLITCH_IGNORE_CNT,
-        .flags.enable_internal_pullup = true
-    };
-
-    ESP_ERROR_CHECK(i2c_new_master_bus(&bus_cfg, &s_bus_handle));
-
-    return ESP_OK;
 }
 
-static esp_err_t _mpu6050_device_init(void)
+// out[i] = in[i] × k + b，4 路展开便于编译器生成 FPU madd.s（主机上可自动向量化）
+static void _affine_i16_f32(const int16_t *__restrict in, float *__restrict out, size_t n, float k, float b)
 {
-    if (s_dev_handle != NULL) {
-        ESP_LOGW(TAG, "MPU6050 设备已初始化");
-        return ESP_OK;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        out[i + 0] = in[i + 0] * k + b;
+        out[i + 1] = in[i + 1] * k + b;
+        out[i + 2] = in[i + 2] * k + b;
+        out[i + 3] = in[i + 3] * k + b;
     }
-
-    if (s_bus_handle == NULL) {
-        ESP_LOGE(TAG, "I2C 总线未初始化");
-        return ESP_ERR_INVALID_STATE;
+    for (; i < n; i++) {
+        out[i] = in[i] * k + b;
     }
-
-    i2c_device_config_t dev_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = MPU6050_I2C_ADDR,
-        .scl_speed_hz = MPU6050_I2C_CLK_SPEED,
-    };
-
-    ESP_ERROR_CHECK(i2c_master_bus_add_device(s_bus_handle, &dev_cfg, &s_dev_handle));
-
-    return ESP_OK;
 }
 
 static esp_err_t _mpu6050_verify_device(void)
 {
-    if (s_dev_handle == NULL) {
-        ESP_LOGE(TAG, "MPU6050 设备未初始化");
-        return ESP_ERR_INVALID_STATE;
-    }
-
     uint8_t who_am_i = 0;
-    uint8_t reg_addr = MPU6050_REG_WHO_AM_I;
-
-    ESP_ERROR_CHECK(i2c_master_transmit_receive(
-        s_dev_handle,
-        &reg_addr, 1,
-        &who_am_i, 1,
-        100  // 100ms 超时
-    ));
+    esp_err_t err = mpu6050_read_regs(MPU6050_REG_WHO_AM_I, &who_am_i, 1);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "读取设备 ID 失败: %s", esp_err_to_name(err));
+        return err;
+    }
 
     if (who_am_i != MPU6050_WHO_AM_I_VALUE) {
         ESP_LOGE(TAG, "设备 ID 不匹配，期望: 0x%02X，实际: 0x%02X",
@@ -93,15 +80,7 @@ static esp_err_t _mpu6050_verify_device(void)
 
 static esp_err_t _mpu6050_wakeup(void)
 {
-    if (s_dev_handle == NULL) {
-        ESP_LOGE(TAG, "MPU6050 设备未初始化");
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    uint8_t wakeup_cmd[] = {MPU6050_REG_PWR_MGMT_1, MPU6050_PWR_MGMT_1_WAKEUP};
-    ESP_ERROR_CHECK(i2c_master_transmit(s_dev_handle, wakeup_cmd, sizeof(wakeup_cmd), -1));
-
-    return ESP_OK;
+    return mpu6050_write_reg(MPU6050_REG_PWR_MGMT_1, MPU6050_PWR_MGMT_1_WAKEUP);
 }
 
 esp_err_t mpu6050_init(void)
@@ -111,20 +90,51 @@ esp_err_t mpu6050_init(void)
         return ESP_OK;
     }
 
-    // 初始化 I2C 总线
-    ESP_ERROR_CHECK(_i2c_bus_init());
-
-    // 初始化 MPU6050 设备
-    ESP_ERROR_CHECK(_mpu6050_device_init());
+    // 连接设备（默认挂载到共享 I2C 总线）
+    if (s_backend == NULL) {
+        s_backend = mpu6050_backend_i2c();
+    }
+    esp_err_t err = s_backend->attach(s_backend->ctx);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "后端 %s 连接失败: %s", s_backend->name, esp_err_to_name(err));
+        return err;
+    }
+    s_attached = true;
 
     // 验证设备是否正确连接
-    ESP_ERROR_CHECK(_mpu6050_verify_device());
+    err = _mpu6050_verify_device();
+    if (err != ESP_OK) {
+        return err;
+    }
 
     // 唤醒 MPU6050
-    ESP_ERROR_CHECK(_mpu6050_wakeup());
+    err = _mpu6050_wakeup();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // 加载 NVS 中保存的校准参数（无记录时使用默认值，可稍后在后台校准）
+    if (mpu6050_calib_load() != ESP_OK) {
+        ESP_LOGW(TAG, "未找到校准数据，建议执行 mpu6050_calib_start_gyro / mpu6050_calib_start_accel");
+    }
 
+    _update_conv_coeffs();
     s_inited = true;
-    ESP_LOGI(TAG, "MPU6050 初始化成功");
+    ESP_LOGI(TAG, "MPU6050 初始化成功 (后端: %s)", s_backend->name);
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_set_backend(const mpu6050_backend_t *backend)
+{
+    if (s_attached) {
+        ESP_LOGE(TAG, "驱动已初始化，无法切换后端");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (backend != NULL && (backend->attach == NULL || backend->read_regs == NULL || backend->write_reg == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_backend = backend;
     return ESP_OK;
 }
 
@@ -145,20 +155,12 @@ esp_err_t mpu6050_read_raw_data(mpu6050_raw_data_t *data)
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (s_dev_handle == NULL) {
-        ESP_LOGE(TAG, "设备句柄无效");
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    uint8_t reg_addr = MPU6050_REG_ACCEL_XOUT_H;
     uint8_t raw_data[MPU6050_DATA_BYTES(NUM_SENSOR_DATA)];
 
-    ESP_ERROR_CHECK(i2c_master_transmit_receive(
-        s_dev_handle,
-        &reg_addr, 1,
-        raw_data, sizeof(raw_data),
-        100  // 100ms 超时
-    ));
+    esp_err_t err = mpu6050_read_regs(MPU6050_REG_ACCEL_XOUT_H, raw_data, sizeof(raw_data));
+    if (err != ESP_OK) {
+        return err;
+    }
 
     // 解析原始数据（注意：加速度和陀螺仪之间有2字节温度数据）
     data->accel_x = (int16_t)((raw_data[0] << 8) | raw_data[1]);
@@ -179,29 +181,13 @@ esp_err_t mpu6050_convert_data(const mpu6050_raw_data_t *raw_data, mpu6050_data_
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 转换加速度计数据（原始值 → m/s²）
-    float accel_x_g = raw_data->accel_x / s_accel_sensitivity;
-    float accel_y_g = raw_data->accel_y / s_accel_sensitivity;
-    float accel_z_g = raw_data->accel_z / s_accel_sensitivity;
-
-    data->accel_x = accel_x_g * MPU6050_GRAVITY_MS2;
-    data->accel_y = accel_y_g * MPU6050_GRAVITY_MS2;
-    data->accel_z = accel_z_g * MPU6050_GRAVITY_MS2;
-
-    // 转换陀螺仪数据（原始值 - 零偏 → °/s）
-    int16_t gyro_x_corrected = raw_data->gyro_x;
-    int16_t gyro_y_corrected = raw_data->gyro_y;
-    int16_t gyro_z_corrected = raw_data->gyro_z;
-
-    if (s_gyro_calibrated) {
-        gyro_x_corrected -= s_gyro_bias.gyro_x_bias;
-        gyro_y_corrected -= s_gyro_bias.gyro_y_bias;
-        gyro_z_corrected -= s_gyro_bias.gyro_z_bias;
-    }
-
-    data->gyro_x = gyro_x_corrected / s_gyro_sensitivity;
-    data->gyro_y = gyro_y_corrected / s_gyro_sensitivity;
-    data->gyro_z = gyro_z_corrected / s_gyro_sensitivity;
+    // 加速度（m/s²）与角速度（°/s），校准参数已合并进系数
+    data->accel_x = raw_data->accel_x * s_conv_k[0] + s_conv_b[0];
+    data->accel_y = raw_data->accel_y * s_conv_k[1] + s_conv_b[1];
+    data->accel_z = raw_data->accel_z * s_conv_k[2] + s_conv_b[2];
+    data->gyro_x = raw_data->gyro_x * s_conv_k[3] + s_conv_b[3];
+    data->gyro_y = raw_data->gyro_y * s_conv_k[4] + s_conv_b[4];
+    data->gyro_z = raw_data->gyro_z * s_conv_k[5] + s_conv_b[5];
 
     return ESP_OK;
 }
@@ -216,7 +202,10 @@ esp_err_t mpu6050_read_data(mpu6050_data_t *data)
     mpu6050_raw_data_t raw_data;
 
     // 读取原始数据
-    ESP_ERROR_CHECK(mpu6050_read_raw_data(&raw_data));
+    esp_err_t err = mpu6050_read_raw_data(&raw_data);
+    if (err != ESP_OK) {
+        return err;
+    }
 
     // 转换为物理单位
     return mpu6050_convert_data(&raw_data, data);
@@ -242,7 +231,11 @@ esp_err_t mpu6050_calibrate_gyro(mpu6050_gyro_bias_t *bias, uint16_t samples)
     ESP_LOGI(TAG, "开始校准陀螺仪，采样次数: %u", samples);
 
     for (uint16_t i = 0; i < samples; i++) {
-        ESP_ERROR_CHECK(mpu6050_read_raw_data(&temp));
+        esp_err_t err = mpu6050_read_raw_data(&temp);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "陀螺仪校准中读取失败: %s", esp_err_to_name(err));
+            return err;
+        }
 
         sum_x += temp.gyro_x;
         sum_y += temp.gyro_y;
@@ -251,18 +244,22 @@ esp_err_t mpu6050_calibrate_gyro(mpu6050_gyro_bias_t *bias, uint16_t samples)
         vTaskDelay(pdMS_TO_TICKS(10));
     }
 
-    s_gyro_bias.gyro_x_bias = sum_x / samples;
-    s_gyro_bias.gyro_y_bias = sum_y / samples;
-    s_gyro_bias.gyro_z_bias = sum_z / samples;
-    s_gyro_calibrated = true;
+    mpu6050_gyro_bias_t result = {
+        .gyro_x_bias = sum_x / samples,
+        .gyro_y_bias = sum_y / samples,
+        .gyro_z_bias = sum_z / samples,
+    };
+    s_calib.gyro_bias_dps[0] = result.gyro_x_bias / s_gyro_sensitivity;
+    s_calib.gyro_bias_dps[1] = result.gyro_y_bias / s_gyro_sensitivity;
+    s_calib.gyro_bias_dps[2] = result.gyro_z_bias / s_gyro_sensitivity;
+    s_calib.flags |= MPU6050_CALIB_GYRO_VALID;
+    _update_conv_coeffs();
 
     ESP_LOGI(TAG, "陀螺仪校准完成 - X: %d, Y: %d, Z: %d",
-             s_gyro_bias.gyro_x_bias, s_gyro_bias.gyro_y_bias, s_gyro_bias.gyro_z_bias);
+             result.gyro_x_bias, result.gyro_y_bias, result.gyro_z_bias);
 
     if (bias != NULL) {
-        bias->gyro_x_bias = s_gyro_bias.gyro_x_bias;
-        bias->gyro_y_bias = s_gyro_bias.gyro_y_bias;
-        bias->gyro_z_bias = s_gyro_bias.gyro_z_bias;
+        *bias = result;
     }
 
     return ESP_OK;
@@ -275,14 +272,11 @@ esp_err_t mpu6050_set_gyro_range(uint8_t range)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (s_dev_handle == NULL) {
-        ESP_LOGE(TAG, "设备句柄无效");
-        return ESP_ERR_INVALID_STATE;
+    esp_err_t err = mpu6050_write_reg(MPU6050_REG_GYRO_CONFIG, range);
+    if (err != ESP_OK) {
+        return err;
     }
 
-    uint8_t config[] = {MPU6050_REG_GYRO_CONFIG, range};
-    ESP_ERROR_CHECK(i2c_master_transmit(s_dev_handle, config, sizeof(config), -1));
-
     // 更新灵敏度
     switch (range) {
         case MPU6050_GYRO_RANGE_250:
@@ -305,6 +299,7 @@ esp_err_t mpu6050_set_gyro_range(uint8_t range)
             ESP_LOGW(TAG, "陀螺仪量程设置值错误");
             return ESP_ERR_INVALID_ARG;
     }
+    _update_conv_coeffs();
 
     return ESP_OK;
 }
@@ -316,14 +311,11 @@ esp_err_t mpu6050_set_accel_range(uint8_t range)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (s_dev_handle == NULL) {
-        ESP_LOGE(TAG, "设备句柄无效");
-        return ESP_ERR_INVALID_STATE;
+    esp_err_t err = mpu6050_write_reg(MPU6050_REG_ACCEL_CONFIG, range);
+    if (err != ESP_OK) {
+        return err;
     }
 
-    uint8_t config[] = {MPU6050_REG_ACCEL_CONFIG, range};
-    ESP_ERROR_CHECK(i2c_master_transmit(s_dev_handle, config, sizeof(config), -1));
-
     // 更新灵敏度
     switch (range) {
         case MPU6050_ACCEL_RANGE_2G:
@@ -346,6 +338,7 @@ esp_err_t mpu6050_set_accel_range(uint8_t range)
             ESP_LOGW(TAG, "加速度设计值错误");
             return ESP_ERR_INVALID_ARG;
     }
+    _update_conv_coeffs();
 
     return ESP_OK;
 }
@@ -358,4 +351,88 @@ float mpu6050_get_gyro_sensitivity(void)
 float mpu6050_get_accel_sensitivity(void)
 {
     return s_accel_sensitivity;
-}
\ No newline at end of file
+}
+
+esp_err_t mpu6050_write_reg(uint8_t reg, uint8_t value)
+{
+    if (!s_attached) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return s_backend->write_reg(s_backend->ctx, reg, value);
+}
+
+esp_err_t mpu6050_read_regs(uint8_t reg, uint8_t *data, size_t len)
+{
+    if (!s_attached) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (data == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return s_backend->read_regs(s_backend->ctx, reg, data, len);
+}
+
+esp_err_t mpu6050_convert_batch(const mpu6050_raw_soa_t *raw, mpu6050_data_soa_t *data, size_t count)
+{
+    if (raw == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const int16_t *in[6] = {raw->accel_x, raw->accel_y, raw->accel_z, raw->gyro_x, raw->gyro_y, raw->gyro_z};
+    float *out[6] = {data->accel_x, data->accel_y, data->accel_z, data->gyro_x, data->gyro_y, data->gyro_z};
+
+    for (int ch = 0; ch < 6; ch++) {
+        if (in[ch] == NULL || out[ch] == NULL) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    // 逐通道处理：每个通道只有一组系数，内层循环连续访存
+    for (int ch = 0; ch < 6; ch++) {
+        _affine_i16_f32(in[ch], out[ch], count, s_conv_k[ch], s_conv_b[ch]);
+    }
+    return ESP_OK;
+}
+
+void mpu6050_raw_to_soa(const mpu6050_raw_data_t *samples, size_t stride, size_t count, mpu6050_raw_soa_t *soa)
+{
+    const uint8_t *p = (const uint8_t *)samples;
+    for (size_t i = 0; i < count; i++, p += stride) {
+        const mpu6050_raw_data_t *r = (const mpu6050_raw_data_t *)p;
+        soa->accel_x[i] = r->accel_x;
+        soa->accel_y[i] = r->accel_y;
+        soa->accel_z[i] = r->accel_z;
+        soa->gyro_x[i] = r->gyro_x;
+        soa->gyro_y[i] = r->gyro_y;
+        soa->gyro_z[i] = r->gyro_z;
+    }
+}
+
+void mpu6050_set_calibration(const mpu6050_calib_t *calib)
+{
+    if (calib == NULL) {
+        return;
+    }
+    // 拷贝非原子，与转换并发时最多有一个样本混用新旧参数
+    s_calib = *calib;
+    _update_conv_coeffs();
+}
+
+void mpu6050_get_calibration(mpu6050_calib_t *calib)
+{
+    if (calib != NULL) {
+        *calib = s_calib;
+    }
+}
+
+void mpu6050_get_gyro_bias(mpu6050_gyro_bias_t *bias)
+{
+    if (bias == NULL) {
+        return;
+    }
+    bias->gyro_x_bias = (int16_t)lroundf(s_calib.gyro_bias_dps[0] * s_gyro_sensitivity);
+    bias->gyro_y_bias = (int16_t)lroundf(s_calib.gyro_bias_dps[1] * s_gyro_sensitivity);
+    bias->gyro_z_bias = (int16_t)lroundf(s_calib.gyro_bias_dps[2] * s_gyro_sensitivity);
+}
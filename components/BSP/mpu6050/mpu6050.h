@@ -4,6 +4,7 @@
 #include "esp_err.h"
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 
 /**
  * @brief MPU6050 原始传感器数据结构
@@ -38,6 +39,43 @@ typedef struct {
     int16_t gyro_z_bias;   // Z 轴零偏
 } mpu6050_gyro_bias_t;
 
+/**
+ * @brief 原始数据（SoA 布局，每个通道一个连续数组）
+ */
+typedef struct {
+    int16_t *accel_x;
+    int16_t *accel_y;
+    int16_t *accel_z;
+    int16_t *gyro_x;
+    int16_t *gyro_y;
+    int16_t *gyro_z;
+} mpu6050_raw_soa_t;
+
+/**
+ * @brief 转换后的数据（SoA 布局，单位同 mpu6050_data_t）
+ */
+typedef struct {
+    float *accel_x;
+    float *accel_y;
+    float *accel_z;
+    float *gyro_x;
+    float *gyro_y;
+    float *gyro_z;
+} mpu6050_data_soa_t;
+
+#define MPU6050_CALIB_GYRO_VALID    (1 << 0)    // 陀螺仪零偏有效
+#define MPU6050_CALIB_ACCEL_VALID   (1 << 1)    // 加速度计偏移/比例有效
+
+/**
+ * @brief 校准参数（物理单位，切换量程后仍然有效）
+ */
+typedef struct {
+    uint32_t flags;                 // MPU6050_CALIB_xxx_VALID
+    float gyro_bias_dps[3];         // 陀螺仪零偏（°/s）
+    float accel_offset_g[3];        // 加速度计偏移（g）
+    float accel_scale[3];           // 加速度计比例（校正后 = (读数 - 偏移) × 比例）
+} mpu6050_calib_t;
+
 /**
  * @brief 初始化 MPU6050 驱动
  * 
@@ -78,7 +116,27 @@ esp_err_t mpu6050_convert_data(const mpu6050_raw_data_t *raw_data, mpu6050_data_
 esp_err_t mpu6050_read_data(mpu6050_data_t *data);
 
 /**
- * @brief 校准陀螺仪零偏
+ * @brief 批量转换原始数据（SoA 布局，结果与 mpu6050_convert_data 一致）
+ * 
+ * 使用预先计算的换算系数（无除法），逐通道连续处理，适合高采样率下的整批数据。
+ * 
+ * @param raw   原始数据数组（每个通道至少 count 个元素）
+ * @param data  输出数组（每个通道至少 count 个元素）
+ * @param count 样本数
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t mpu6050_convert_batch(const mpu6050_raw_soa_t *raw, mpu6050_data_soa_t *data, size_t count);
+
+/**
+ * @brief 将 AoS 样本（如 mpu6050_sample_t 数组中的 raw 字段）拆分为 SoA 布局
+ * 
+ * @param samples 第一个样本的原始数据
+ * @param stride  相邻样本的字节间隔（sizeof 所在结构体）
+ */
+void mpu6050_raw_to_soa(const mpu6050_raw_data_t *samples, size_t stride, size_t count, mpu6050_raw_soa_t *soa);
+
+/**
+ * @brief 校准陀螺仪零偏（阻塞 samples × 10ms，推荐使用 mpu6050_calib_start_gyro 后台校准）
  * 
  * @param bias 存储校准结果的结构体指针
  * @param samples 采样次数（建议 100-200）
@@ -116,4 +174,33 @@ float mpu6050_get_gyro_sensitivity(void);
  */
 float mpu6050_get_accel_sensitivity(void);
 
+/**
+ * @brief 设置校准参数（mpu6050_convert_data 使用）
+ */
+void mpu6050_set_calibration(const mpu6050_calib_t *calib);
+
+/**
+ * @brief 获取当前校准参数
+ */
+void mpu6050_get_calibration(mpu6050_calib_t *calib);
+
+/**
+ * @brief 获取按当前量程换算的陀螺仪零偏原始值（供 mpu6050_fusion_set_gyro_bias 使用）
+ */
+void mpu6050_get_gyro_bias(mpu6050_gyro_bias_t *bias);
+
+/**
+ * @brief 写单个寄存器（不会因 I2C 错误中止，供 FIFO 采集等运行时路径使用）
+ * 
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 设备未初始化，其他值为 I2C 错误
+ */
+esp_err_t mpu6050_write_reg(uint8_t reg, uint8_t value);
+
+/**
+ * @brief 从 reg 开始连续读取 len 字节（FIFO_R_W 不自增，可用于突发读取 FIFO）
+ * 
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 设备未初始化，其他值为 I2C 错误
+ */
+esp_err_t mpu6050_read_regs(uint8_t reg, uint8_t *data, size_t len);
+
 #endif // __MPU6050_DRIVER_H__
@@ -0,0 +1,87 @@
+#ifndef __MPU6050_BACKEND_H__
+#define __MPU6050_BACKEND_H__
+
+#include "esp_err.h"
+#include "mpu6050_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 寄存器级后端接口
+ *
+ * 驱动、FIFO 采集与校准只通过寄存器读写访问传感器，替换后端即可在无硬件时运行
+ * 完整的数据链路。模拟设备的核心（mpu6050_sim.h）不依赖 IDF 驱动，可在主机上单独编译。
+ */
+typedef struct {
+    const char *name;
+    esp_err_t (*attach)(void *ctx);                                         // 连接设备（mpu6050_init 中调用）
+    esp_err_t (*read_regs)(void *ctx, uint8_t reg, uint8_t *data, size_t len);
+    esp_err_t (*write_reg)(void *ctx, uint8_t reg, uint8_t value);
+    void *ctx;
+} mpu6050_backend_t;
+
+/**
+ * @brief 合成数据配置（正弦 + 高斯噪声，单位为物理量，按当前量程换算为原始值）
+ */
+typedef struct {
+    float gravity_g[3];             // 静态重力分量（g）
+    float vib_hz;                   // 加速度振动频率
+    float vib_amp_g[3];             // 加速度振动幅值（g）
+    float rot_hz;                   // 角速度摆动频率
+    float rot_amp_dps[3];           // 角速度摆动幅值（°/s）
+    float gyro_bias_dps[3];         // 陀螺仪零偏（°/s）
+    float accel_noise_g;            // 加速度噪声标准差（g）
+    float gyro_noise_dps;           // 角速度噪声标准差（°/s）
+    uint32_t seed;                  // 随机种子（相同种子输出相同序列）
+} mpu6050_synth_config_t;
+
+#define MPU6050_SYNTH_DEFAULT_CONFIG() {                                \
+    .gravity_g = {0.0f, 0.0f, 1.0f},                                    \
+    .vib_hz = MPU6050_SYNTH_VIB_HZ,                                     \
+    .vib_amp_g = {0.0f, 0.0f, MPU6050_SYNTH_VIB_AMP_G},                 \
+    .rot_hz = MPU6050_SYNTH_ROT_HZ,                                     \
+    .rot_amp_dps = {MPU6050_SYNTH_ROT_AMP_DPS, 0.0f, 0.0f},             \
+    .gyro_bias_dps = {0.5f, -0.3f, 0.2f},                               \
+    .accel_noise_g = MPU6050_SYNTH_ACCEL_NOISE_G,                       \
+    .gyro_noise_dps = MPU6050_SYNTH_GYRO_NOISE_DPS,                     \
+    .seed = 1,                                                          \
+}
+
+/**
+ * @brief 选择后端（须在 mpu6050_init 之前调用）
+ *
+ * @param backend 后端，NULL 恢复默认的 I2C 后端
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 驱动已初始化
+ */
+esp_err_t mpu6050_set_backend(const mpu6050_backend_t *backend);
+
+/**
+ * @brief 默认后端：共享 I2C 总线上的真实传感器
+ */
+const mpu6050_backend_t *mpu6050_backend_i2c(void);
+
+/**
+ * @brief 创建合成数据后端
+ *
+ * 模拟寄存器、采样率分频与 1024 字节硬件 FIFO（设备模型见 mpu6050_sim.h，
+ * 按 esp_timer 时间生成样本，含溢出），FIFO 采集、校准、融合与特征提取无需修改即可运行。
+ *
+ * @param config 配置，NULL 使用 MPU6050_SYNTH_DEFAULT_CONFIG
+ */
+esp_err_t mpu6050_backend_synthetic_create(const mpu6050_synth_config_t *config, mpu6050_backend_t **ret_backend);
+
+/**
+ * @brief 创建文件回放后端
+ *
+ * 文件为文本格式，每行 "t_us,ax,ay,az,gx,gy,gz"（原始值，'#' 开头为注释），
+ * 按记录的时间戳回放（与设定的 ODR 无关，采样保持），可选循环播放。
+ */
+esp_err_t mpu6050_backend_replay_create(const char *path, bool loop, mpu6050_backend_t **ret_backend);
+
+/**
+ * @brief 释放合成/回放后端（须先停止 FIFO 采集并不再使用驱动）
+ */
+void mpu6050_backend_delete(mpu6050_backend_t *backend);
+
+#endif // __MPU6050_BACKEND_H__
@@ -0,0 +1,62 @@
+#include "mpu6050_backend.h"
+#include "mpu6050_config.h"
+#include "i2c_bus.h"
+#include "driver/i2c_master.h"
+#include "esp_log.h"
+
+static const char *TAG = "mpu6050_i2c";
+
+static i2c_bus_dev_handle_t s_dev_handle = NULL;
+
+static esp_err_t _i2c_attach(void *ctx)
+{
+    if (s_dev_handle != NULL) {
+        ESP_LOGW(TAG, "MPU6050 设备已初始化");
+        return ESP_OK;
+    }
+
+    // 总线由 i2c_bus 统一管理，同一端口上的其他传感器共享同一实例
+    i2c_bus_config_t bus_cfg = {
+        .port = MPU6050_I2C_PORT,
+        .sda_pin = MPU6050_SDA_PIN,
+        .scl_pin = MPU6050_SCL_PIN,
+        .internal_pullup = true,
+        .glitch_ignore_cnt = MPU6050_I2C_GLITCH_IGNORE_CNT,
+    };
+    i2c_bus_handle_t bus = NULL;
+    esp_err_t err = i2c_bus_get(&bus_cfg, &bus);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return i2c_bus_add_device(bus, MPU6050_I2C_ADDR, MPU6050_I2C_CLK_SPEED, &s_dev_handle);
+}
+
+static esp_err_t _i2c_read_regs(void *ctx, uint8_t reg, uint8_t *data, size_t len)
+{
+    if (s_dev_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return i2c_bus_read_regs(s_dev_handle, reg, data, len);
+}
+
+static esp_err_t _i2c_write_reg(void *ctx, uint8_t reg, uint8_t value)
+{
+    if (s_dev_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return i2c_bus_write_reg(s_dev_handle, reg, value);
+}
+
+static const mpu6050_backend_t s_i2c_backend = {
+    .name = "i2c",
+    .attach = _i2c_attach,
+    .read_regs = _i2c_read_regs,
+    .write_reg = _i2c_write_reg,
+    .ctx = NULL,
+};
+
+const mpu6050_backend_t *mpu6050_backend_i2c(void)
+{
+    return &s_i2c_backend;
+}
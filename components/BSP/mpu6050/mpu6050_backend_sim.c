@@ -0,0 +1,114 @@
+#include "mpu6050_backend.h"
+#include "mpu6050_sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdlib.h>
+
+static const char *TAG = "mpu6050_sim";
+
+// 模拟设备后端：加锁串行访问，设备时间取 esp_timer
+typedef struct {
+    mpu6050_backend_t backend;          // 必须为第一个成员，mpu6050_backend_delete 据此还原
+    SemaphoreHandle_t lock;
+    mpu6050_sim_t *sim;
+} sim_backend_t;
+
+static esp_err_t _sim_attach(void *ctx)
+{
+    sim_backend_t *sb = (sim_backend_t *)ctx;
+
+    xSemaphoreTake(sb->lock, portMAX_DELAY);
+    mpu6050_sim_power_on(sb->sim, esp_timer_get_time());
+    xSemaphoreGive(sb->lock);
+
+    ESP_LOGI(TAG, "模拟设备已连接 (%s)", sb->backend.name);
+    return ESP_OK;
+}
+
+static esp_err_t _sim_read_regs(void *ctx, uint8_t reg, uint8_t *data, size_t len)
+{
+    sim_backend_t *sb = (sim_backend_t *)ctx;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(sb->lock, portMAX_DELAY);
+    mpu6050_sim_read_regs(sb->sim, now, reg, data, len);
+    xSemaphoreGive(sb->lock);
+    return ESP_OK;
+}
+
+static esp_err_t _sim_write_reg(void *ctx, uint8_t reg, uint8_t value)
+{
+    sim_backend_t *sb = (sim_backend_t *)ctx;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(sb->lock, portMAX_DELAY);
+    esp_err_t err = mpu6050_sim_write_reg(sb->sim, now, reg, value);
+    xSemaphoreGive(sb->lock);
+    return err;
+}
+
+static esp_err_t _sim_backend_wrap(mpu6050_sim_t *sim, mpu6050_backend_t **ret_backend)
+{
+    sim_backend_t *sb = calloc(1, sizeof(sim_backend_t));
+    if (sb == NULL) {
+        mpu6050_sim_delete(sim);
+        return ESP_ERR_NO_MEM;
+    }
+    sb->lock = xSemaphoreCreateMutex();
+    if (sb->lock == NULL) {
+        mpu6050_sim_delete(sim);
+        free(sb);
+        return ESP_ERR_NO_MEM;
+    }
+
+    sb->sim = sim;
+    sb->backend.name = mpu6050_sim_name(sim);
+    sb->backend.attach = _sim_attach;
+    sb->backend.read_regs = _sim_read_regs;
+    sb->backend.write_reg = _sim_write_reg;
+    sb->backend.ctx = sb;
+    *ret_backend = &sb->backend;
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_backend_synthetic_create(const mpu6050_synth_config_t *config, mpu6050_backend_t **ret_backend)
+{
+    if (ret_backend == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mpu6050_sim_t *sim = NULL;
+    esp_err_t err = mpu6050_sim_create_synthetic(config, &sim);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return _sim_backend_wrap(sim, ret_backend);
+}
+
+esp_err_t mpu6050_backend_replay_create(const char *path, bool loop, mpu6050_backend_t **ret_backend)
+{
+    if (path == NULL || ret_backend == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mpu6050_sim_t *sim = NULL;
+    esp_err_t err = mpu6050_sim_create_replay(path, loop, &sim);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return _sim_backend_wrap(sim, ret_backend);
+}
+
+void mpu6050_backend_delete(mpu6050_backend_t *backend)
+{
+    if (backend == NULL || backend == mpu6050_backend_i2c()) {
+        return;
+    }
+
+    sim_backend_t *sb = (sim_backend_t *)backend;
+    vSemaphoreDelete(sb->lock);
+    mpu6050_sim_delete(sb->sim);
+    free(sb);
+}
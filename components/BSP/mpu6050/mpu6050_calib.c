@@ -0,0 +1,363 @@
+#include "mpu6050_calib.h"
+#include "mpu6050_config.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG = "mpu6050_calib";
+
+// NVS 中的存储格式
+typedef struct {
+    uint32_t version;
+    mpu6050_calib_t calib;
+} mpu6050_calib_blob_t;
+
+// 静止检测分块统计（仅在喂数据的任务中访问）
+typedef struct {
+    uint32_t n;
+    float sum[6];                   // 0-2 陀螺仪 °/s，3-5 加速度 g
+    float sum_sq[6];
+} calib_block_t;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile mpu6050_calib_state_t s_state = MPU6050_CALIB_STATE_IDLE;
+static volatile bool s_reset_pending = false;
+static volatile bool s_saving = false;
+static mpu6050_calib_status_t s_status;
+
+static calib_block_t s_block;
+static float s_gyro_acc[3];
+static uint32_t s_gyro_blocks = 0;
+static float s_face_acc[6];
+static uint32_t s_face_blocks = 0;
+static int s_cur_face = -1;
+
+esp_err_t mpu6050_calib_load(void)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(MPU6050_CALIB_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return err == ESP_ERR_NVS_NOT_FOUND ? ESP_ERR_NOT_FOUND : err;
+    }
+
+    mpu6050_calib_blob_t blob;
+    size_t len = sizeof(blob);
+    err = nvs_get_blob(handle, MPU6050_CALIB_NVS_KEY, &blob, &len);
+    nvs_close(handle);
+
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (len != sizeof(blob) || blob.version != MPU6050_CALIB_VERSION) {
+        ESP_LOGW(TAG, "校准数据版本不符，忽略");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    mpu6050_set_calibration(&blob.calib);
+    ESP_LOGI(TAG, "已加载校准参数 (陀螺仪: %s, 加速度计: %s)",
+             (blob.calib.flags & MPU6050_CALIB_GYRO_VALID) ? "有效" : "无",
+             (blob.calib.flags & MPU6050_CALIB_ACCEL_VALID) ? "有效" : "无");
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_calib_save(void)
+{
+    mpu6050_calib_blob_t blob = {
+        .version = MPU6050_CALIB_VERSION,
+    };
+    mpu6050_get_calibration(&blob.calib);
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(MPU6050_CALIB_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "打开 NVS 失败: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    err = nvs_set_blob(handle, MPU6050_CALIB_NVS_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "保存校准参数失败: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t mpu6050_calib_erase(void)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(MPU6050_CALIB_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = nvs_erase_key(handle, MPU6050_CALIB_NVS_KEY);
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+}
+
+static esp_err_t _start(mpu6050_calib_state_t state)
+{
+    if (!mpu6050_is_inited()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_saving) {
+        portEXIT_CRITICAL(&s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.state = state;
+    s_state = state;
+    s_reset_pending = true;
+    portEXIT_CRITICAL(&s_lock);
+
+    ESP_LOGI(TAG, "开始%s校准", state == MPU6050_CALIB_STATE_GYRO ? "陀螺仪零偏" : "加速度计六面");
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_calib_start_gyro(void)
+{
+    return _start(MPU6050_CALIB_STATE_GYRO);
+}
+
+esp_err_t mpu6050_calib_start_accel(void)
+{
+    return _start(MPU6050_CALIB_STATE_ACCEL);
+}
+
+void mpu6050_calib_cancel(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    if (!s_saving) {
+        s_state = MPU6050_CALIB_STATE_IDLE;
+        s_status.state = MPU6050_CALIB_STATE_IDLE;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+bool mpu6050_calib_is_active(void)
+{
+    mpu6050_calib_state_t state = s_state;
+    return state == MPU6050_CALIB_STATE_GYRO || state == MPU6050_CALIB_STATE_ACCEL;
+}
+
+esp_err_t mpu6050_calib_get_status(mpu6050_calib_status_t *status)
+{
+    if (status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    *status = s_status;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+// NVS 写入可能耗时数十毫秒，放到独立任务中，避免阻塞采集
+static void _save_task(void *arg)
+{
+    esp_err_t err = mpu6050_calib_save();
+
+    portENTER_CRITICAL(&s_lock);
+    s_status.state = (err == ESP_OK) ? MPU6050_CALIB_STATE_DONE : MPU6050_CALIB_STATE_FAILED;
+    s_state = s_status.state;
+    s_saving = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    ESP_LOGI(TAG, "校准%s", err == ESP_OK ? "完成，已保存" : "参数已生效，但保存失败");
+    vTaskDelete(NULL);
+}
+
+static void _finish(const mpu6050_calib_t *calib)
+{
+    mpu6050_set_calibration(calib);
+
+    portENTER_CRITICAL(&s_lock);
+    s_saving = true;
+    s_status.progress = 100;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (xTaskCreate(_save_task, "mpu_calib", 3072, NULL, 3, NULL) != pdPASS) {
+        portENTER_CRITICAL(&s_lock);
+        s_status.state = MPU6050_CALIB_STATE_FAILED;
+        s_state = s_status.state;
+        s_saving = false;
+        portEXIT_CRITICAL(&s_lock);
+    }
+}
+
+static void _set_progress(uint8_t progress)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_status.progress = progress;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static void _count_motion(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_status.motion_resets++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static void _on_gyro_block(const float *mean, bool still)
+{
+    if (!still) {
+        if (s_gyro_blocks > 0) {
+            _count_motion();
+            _set_progress(0);
+        }
+        memset(s_gyro_acc, 0, sizeof(s_gyro_acc));
+        s_gyro_blocks = 0;
+        return;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        s_gyro_acc[i] += mean[i];
+    }
+    s_gyro_blocks++;
+    _set_progress(s_gyro_blocks * 100 / MPU6050_CALIB_GYRO_BLOCKS);
+
+    if (s_gyro_blocks >= MPU6050_CALIB_GYRO_BLOCKS) {
+        mpu6050_calib_t calib;
+        mpu6050_get_calibration(&calib);
+        for (int i = 0; i < 3; i++) {
+            calib.gyro_bias_dps[i] = s_gyro_acc[i] / s_gyro_blocks;
+        }
+        calib.flags |= MPU6050_CALIB_GYRO_VALID;
+        ESP_LOGI(TAG, "陀螺仪零偏: %.3f %.3f %.3f °/s",
+                 calib.gyro_bias_dps[0], calib.gyro_bias_dps[1], calib.gyro_bias_dps[2]);
+        _finish(&calib);
+    }
+}
+
+static void _on_accel_block(const float *mean, bool still)
+{
+    // 重力所在的主轴决定当前朝上的面
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (fabsf(mean[i]) > fabsf(mean[axis])) {
+            axis = i;
+        }
+    }
+    int face = axis * 2 + (mean[axis] < 0.0f ? 1 : 0);
+
+    if (!still || fabsf(mean[axis]) < MPU6050_CALIB_FACE_MIN_G) {
+        if (s_face_blocks > 0) {
+            _count_motion();
+        }
+        s_cur_face = -1;
+        s_face_blocks = 0;
+        return;
+    }
+    if (s_status.faces_done & (1 << face)) {
+        return;
+    }
+
+    if (face != s_cur_face) {
+        s_cur_face = face;
+        s_face_blocks = 0;
+        s_face_acc[face] = 0.0f;
+    }
+    s_face_acc[face] += mean[axis];
+    s_face_blocks++;
+    if (s_face_blocks < MPU6050_CALIB_FACE_BLOCKS) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_status.faces_done |= (1 << face);
+    uint8_t faces_done = s_status.faces_done;
+    s_status.progress = (uint8_t)(__builtin_popcount(faces_done) * 100 / 6);
+    portEXIT_CRITICAL(&s_lock);
+
+    s_face_acc[face] /= s_face_blocks;
+    s_cur_face = -1;
+    s_face_blocks = 0;
+    ESP_LOGI(TAG, "已采集 %c%c 面: %.4f g", face & 1 ? '-' : '+', 'X' + axis, s_face_acc[face]);
+
+    if (faces_done != MPU6050_CALIB_FACE_ALL) {
+        return;
+    }
+
+    mpu6050_calib_t calib;
+    mpu6050_get_calibration(&calib);
+    for (int i = 0; i < 3; i++) {
+        float pos = s_face_acc[i * 2];
+        float neg = s_face_acc[i * 2 + 1];
+        calib.accel_offset_g[i] = (pos + neg) * 0.5f;
+        calib.accel_scale[i] = 2.0f / (pos - neg);
+    }
+    calib.flags |= MPU6050_CALIB_ACCEL_VALID;
+    ESP_LOGI(TAG, "加速度计偏移: %.4f %.4f %.4f g, 比例: %.4f %.4f %.4f",
+             calib.accel_offset_g[0], calib.accel_offset_g[1], calib.accel_offset_g[2],
+             calib.accel_scale[0], calib.accel_scale[1], calib.accel_scale[2]);
+    _finish(&calib);
+}
+
+void mpu6050_calib_feed(const mpu6050_raw_data_t *raw)
+{
+    mpu6050_calib_state_t state = s_state;
+    if (raw == NULL || s_saving ||
+        (state != MPU6050_CALIB_STATE_GYRO && state != MPU6050_CALIB_STATE_ACCEL)) {
+        return;
+    }
+
+    if (s_reset_pending) {
+        s_reset_pending = false;
+        memset(&s_block, 0, sizeof(s_block));
+        memset(s_gyro_acc, 0, sizeof(s_gyro_acc));
+        memset(s_face_acc, 0, sizeof(s_face_acc));
+        s_gyro_blocks = 0;
+        s_face_blocks = 0;
+        s_cur_face = -1;
+    }
+
+    // 使用未校正的物理量，避免旧参数影响新结果
+    float gyro_scale = 1.0f / mpu6050_get_gyro_sensitivity();
+    float accel_scale = 1.0f / mpu6050_get_accel_sensitivity();
+    float v[6] = {
+        raw->gyro_x * gyro_scale, raw->gyro_y * gyro_scale, raw->gyro_z * gyro_scale,
+        raw->accel_x * accel_scale, raw->accel_y * accel_scale, raw->accel_z * accel_scale,
+    };
+    for (int i = 0; i < 6; i++) {
+        s_block.sum[i] += v[i];
+        s_block.sum_sq[i] += v[i] * v[i];
+    }
+    if (++s_block.n < MPU6050_CALIB_BLOCK_SAMPLES) {
+        return;
+    }
+
+    // 分块结束：计算均值与标准差，判断是否静止
+    float mean[6];
+    bool still = true;
+    for (int i = 0; i < 6; i++) {
+        mean[i] = s_block.sum[i] / s_block.n;
+        float var = s_block.sum_sq[i] / s_block.n - mean[i] * mean[i];
+        float limit = (i < 3) ? MPU6050_CALIB_STILL_GYRO_DPS : MPU6050_CALIB_STILL_ACCEL_G;
+        if (var > limit * limit) {
+            still = false;
+        }
+    }
+    memset(&s_block, 0, sizeof(s_block));
+
+    if (state == MPU6050_CALIB_STATE_GYRO) {
+        _on_gyro_block(mean, still);
+    } else {
+        _on_accel_block(&mean[3], still);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef __MPU6050_CALIB_H__
+#define __MPU6050_CALIB_H__
+
+#include "esp_err.h"
+#include "mpu6050.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 后台校准状态
+ */
+typedef enum {
+    MPU6050_CALIB_STATE_IDLE = 0,
+    MPU6050_CALIB_STATE_GYRO,       // 陀螺仪零偏：保持静止
+    MPU6050_CALIB_STATE_ACCEL,      // 加速度六面：依次将 ±X/±Y/±Z 朝上静置
+    MPU6050_CALIB_STATE_DONE,       // 完成并已写入 NVS
+    MPU6050_CALIB_STATE_FAILED,     // 写入 NVS 失败（参数已生效）
+} mpu6050_calib_state_t;
+
+// 六面校准的面编号（faces_done 位掩码）
+#define MPU6050_CALIB_FACE_POS_X    (1 << 0)
+#define MPU6050_CALIB_FACE_NEG_X    (1 << 1)
+#define MPU6050_CALIB_FACE_POS_Y    (1 << 2)
+#define MPU6050_CALIB_FACE_NEG_Y    (1 << 3)
+#define MPU6050_CALIB_FACE_POS_Z    (1 << 4)
+#define MPU6050_CALIB_FACE_NEG_Z    (1 << 5)
+#define MPU6050_CALIB_FACE_ALL      0x3F
+
+typedef struct {
+    mpu6050_calib_state_t state;
+    uint8_t faces_done;             // 已采集的面（MPU6050_CALIB_FACE_xxx）
+    uint8_t progress;               // 当前阶段进度（0 ~ 100）
+    uint32_t motion_resets;         // 因检测到运动而重新计数的次数
+} mpu6050_calib_status_t;
+
+/**
+ * @brief 从 NVS 加载校准参数并应用（mpu6050_init 自动调用）
+ *
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 无记录或版本不符，其他值为 NVS 错误
+ */
+esp_err_t mpu6050_calib_load(void);
+
+/**
+ * @brief 将当前校准参数写入 NVS
+ */
+esp_err_t mpu6050_calib_save(void);
+
+/**
+ * @brief 删除 NVS 中的校准参数（当前参数不变）
+ */
+esp_err_t mpu6050_calib_erase(void);
+
+/**
+ * @brief 开始后台陀螺仪零偏校准（设备需保持静止，期间的运动会自动重新计数）
+ */
+esp_err_t mpu6050_calib_start_gyro(void);
+
+/**
+ * @brief 开始后台加速度计六面校准（自动识别朝上的面，顺序任意）
+ */
+esp_err_t mpu6050_calib_start_accel(void);
+
+/**
+ * @brief 取消正在进行的校准
+ */
+void mpu6050_calib_cancel(void);
+
+/**
+ * @brief 校准是否正在进行
+ */
+bool mpu6050_calib_is_active(void);
+
+/**
+ * @brief 输入一个样本（FIFO 采集任务自动调用；轮询模式下由调用者喂入）
+ */
+void mpu6050_calib_feed(const mpu6050_raw_data_t *raw);
+
+/**
+ * @brief 获取校准状态
+ */
+esp_err_t mpu6050_calib_get_status(mpu6050_calib_status_t *status);
+
+#endif // __MPU6050_CALIB_H__
@@ -8,6 +8,7 @@
 #define MPU6050_I2C_ADDR                0x68            // I2C 从地址
 #define MPU6050_I2C_CLK_SPEED           400000U         // I2C 时钟频率 (400kHz)
 #define MPU6050_I2C_GLITCH_IGNORE_CNT   7               // 毛刺忽略计数
+#define MPU6050_INT_PIN                 9               // INT 引脚（数据就绪中断，-1 表示不接，改为轮询）
 
 /* ================= Sensor Sensitivity ================= */
 #define MPU6050_GYRO_LSB_PER_DPS        131.0f          // 陀螺仪灵敏度 (±250°/s)
@@ -53,7 +54,59 @@
 #define MPU6050_DEFAULT_GYRO_RANGE      MPU6050_GYRO_RANGE_250
 #define MPU6050_DEFAULT_ACCEL_RANGE     MPU6050_ACCEL_RANGE_2G
 
+/* ================= FIFO Acquisition Config ================= */
+#define MPU6050_FIFO_DEFAULT_ODR_HZ     1000            // 默认输出数据率（最高 1kHz）
+#define MPU6050_FIFO_DEFAULT_DLPF       MPU6050_DLPF_42HZ   // 默认数字低通滤波
+#define MPU6050_FIFO_RING_SAMPLES       1024            // 时间戳环形缓冲区样本数（约 1 秒 @1kHz）
+#define MPU6050_FIFO_POLL_MS            20              // 未接 INT 或丢失中断时的轮询周期
+#define MPU6050_FIFO_TASK_STACK         (4 * 1024)      // 采集任务栈大小
+#define MPU6050_FIFO_TASK_PRIORITY      10              // 采集任务优先级（需高于消费者）
+#define MPU6050_FIFO_HW_SIZE            1024            // 硬件 FIFO 容量（字节）
+#define MPU6050_FIFO_SAMPLE_BYTES       12              // FIFO 中每个样本字节数（加速度6 + 陀螺仪6）
+#define MPU6050_FIFO_BURST_BYTES        (MPU6050_FIFO_SAMPLE_BYTES * 16)    // 单次 I2C 突发读取上限
+
+/* ================= Sensor Fusion Config ================= */
+#define MPU6050_FUSION_MAHONY_KP        1.0f            // Mahony 比例增益
+#define MPU6050_FUSION_MAHONY_KI        0.0f            // Mahony 积分增益
+#define MPU6050_FUSION_MADGWICK_BETA    0.1f            // Madgwick 增益
+
+/* ================= Calibration Config ================= */
+#define MPU6050_CALIB_NVS_NAMESPACE     "mpu6050"       // NVS 命名空间
+#define MPU6050_CALIB_NVS_KEY           "calib"         // NVS 键名
+#define MPU6050_CALIB_VERSION           1               // 存储格式版本
+#define MPU6050_CALIB_BLOCK_SAMPLES     50              // 静止检测的分块大小
+#define MPU6050_CALIB_GYRO_BLOCKS       10              // 陀螺仪校准需要的连续静止块数
+#define MPU6050_CALIB_FACE_BLOCKS       4               // 六面校准每个面需要的静止块数
+#define MPU6050_CALIB_STILL_GYRO_DPS    1.0f            // 静止判定：陀螺仪标准差上限（°/s）
+#define MPU6050_CALIB_STILL_ACCEL_G     0.02f           // 静止判定：加速度标准差上限（g）
+#define MPU6050_CALIB_FACE_MIN_G        0.8f            // 六面校准：主轴分量下限（g）
+
+/* ================= Simulated Backend Config ================= */
+#define MPU6050_SYNTH_VIB_HZ            50.0f           // 合成数据默认振动频率
+#define MPU6050_SYNTH_VIB_AMP_G         0.05f           // 合成数据默认振动幅值（Z 轴）
+#define MPU6050_SYNTH_ROT_HZ            0.5f            // 合成数据默认摆动频率
+#define MPU6050_SYNTH_ROT_AMP_DPS       20.0f           // 合成数据默认摆动幅值（X 轴）
+#define MPU6050_SYNTH_ACCEL_NOISE_G     0.004f          // 加速度噪声（接近实测 ±2g 量程噪声）
+#define MPU6050_SYNTH_GYRO_NOISE_DPS    0.05f           // 角速度噪声
+#define MPU6050_SIM_MAX_CATCHUP         4096            // 单次最多补生成的样本数（超出视为溢出）
+
+/* ================= DLPF Options (CONFIG.DLPF_CFG) ================= */
+#define MPU6050_DLPF_260HZ              0               // 关闭 DLPF，陀螺仪内部采样率 8kHz
+#define MPU6050_DLPF_184HZ              1
+#define MPU6050_DLPF_94HZ               2
+#define MPU6050_DLPF_42HZ               3
+#define MPU6050_DLPF_20HZ               4
+#define MPU6050_DLPF_10HZ               5
+#define MPU6050_DLPF_5HZ                6
+
 /* ================= Register Addresses ================= */
+#define MPU6050_REG_SMPLRT_DIV          0x19            // 采样率分频寄存器
+#define MPU6050_REG_FIFO_EN             0x23            // FIFO 使能寄存器
+#define MPU6050_REG_INT_PIN_CFG         0x37            // 中断引脚配置寄存器
+#define MPU6050_REG_INT_ENABLE          0x38            // 中断使能寄存器
+#define MPU6050_REG_INT_STATUS          0x3A            // 中断状态寄存器
+#define MPU6050_REG_FIFO_COUNT_H        0x72            // FIFO 计数高字节
+#define MPU6050_REG_FIFO_R_W            0x74            // FIFO 读写寄存器
 #define MPU6050_REG_PWR_MGMT_1          0x6B            // 电源管理寄存器
 #define MPU6050_REG_PWR_MGMT_2          0x6C            // 电源管理寄存器 2
 #define MPU6050_REG_CONFIG              0x1A            // 配置寄存器
@@ -82,6 +135,12 @@
 #define MPU6050_PWR_MGMT_1_WAKEUP       0x00            // 唤醒值
 #define MPU6050_PWR_MGMT_1_SLEEP        (1 << 6)        // 睡眠值
 #define MPU6050_WHO_AM_I_VALUE          0x68            // 设备 ID 预期值
+#define MPU6050_FIFO_EN_ACCEL_GYRO      0x78            // XG/YG/ZG/ACCEL 写入 FIFO（不含温度）
+#define MPU6050_USER_CTRL_FIFO_EN       (1 << 6)        // FIFO 使能位
+#define MPU6050_USER_CTRL_FIFO_RESET    (1 << 2)        // FIFO 复位位
+#define MPU6050_INT_PIN_CFG_RD_CLEAR    (1 << 4)        // 任意读操作清除中断状态
+#define MPU6050_INT_DATA_RDY            (1 << 0)        // 数据就绪中断
+#define MPU6050_INT_FIFO_OFLOW          (1 << 4)        // FIFO 溢出中断
 
 /* ================= Data Format ================= */
 #define MPU6050_DATA_BYTES(x)           ((x) * 2)       // 数据字节数计算
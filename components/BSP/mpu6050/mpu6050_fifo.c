@@ -0,0 +1,413 @@
+#include "mpu6050_fifo.h"
+#include "mpu6050_config.h"
+#include "mpu6050_calib.h"
+#include "driver/gpio.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "mpu6050_fifo";
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_task = NULL;
+static bool s_isr_attached = false;
+static SemaphoreHandle_t s_data_sem = NULL;     // 有新样本写入环形缓冲区
+static SemaphoreHandle_t s_exit_sem = NULL;     // 采集任务已退出
+static volatile bool s_running = false;
+
+static mpu6050_fifo_config_t s_cfg;
+static uint32_t s_period_us = 0;
+
+// 环形缓冲区（s_lock 保护）
+static mpu6050_sample_t *s_ring = NULL;
+static size_t s_ring_head = 0;
+static size_t s_ring_count = 0;
+
+// 最近一次 INT 触发时间（中断中写入）
+static int64_t s_isr_us = 0;
+static uint64_t s_last_ts_us = 0;
+
+static mpu6050_fifo_stats_t s_stats;
+static uint32_t s_rate_samples = 0;
+static int64_t s_rate_start_us = 0;
+
+static void IRAM_ATTR _int_isr_handler(void *arg)
+{
+    BaseType_t need_yield = pdFALSE;
+
+    portENTER_CRITICAL_ISR(&s_lock);
+    s_isr_us = esp_timer_get_time();
+    portEXIT_CRITICAL_ISR(&s_lock);
+
+    vTaskNotifyGiveFromISR(s_task, &need_yield);
+    portYIELD_FROM_ISR(need_yield);
+}
+
+static esp_err_t _fifo_reset(void)
+{
+    esp_err_t err = mpu6050_write_reg(MPU6050_REG_USER_CTRL, MPU6050_USER_CTRL_FIFO_RESET);
+    if (err == ESP_OK) {
+        err = mpu6050_write_reg(MPU6050_REG_USER_CTRL, MPU6050_USER_CTRL_FIFO_EN);
+    }
+    return err;
+}
+
+static esp_err_t _configure_sensor(uint8_t div)
+{
+    esp_err_t err;
+    const uint8_t seq[][2] = {
+        {MPU6050_REG_USER_CTRL, 0},                             // 先关闭 FIFO
+        {MPU6050_REG_CONFIG, s_cfg.dlpf},
+        {MPU6050_REG_SMPLRT_DIV, div},
+        {MPU6050_REG_INT_PIN_CFG, MPU6050_INT_PIN_CFG_RD_CLEAR},  // 高电平脉冲，读取即清除
+        {MPU6050_REG_FIFO_EN, MPU6050_FIFO_EN_ACCEL_GYRO},
+        {MPU6050_REG_INT_ENABLE, MPU6050_INT_DATA_RDY | MPU6050_INT_FIFO_OFLOW},
+    };
+
+    for (size_t i = 0; i < sizeof(seq) / sizeof(seq[0]); i++) {
+        err = mpu6050_write_reg(seq[i][0], seq[i][1]);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "寄存器 0x%02X 写入失败: %s", seq[i][0], esp_err_to_name(err));
+            return err;
+        }
+    }
+    return _fifo_reset();
+}
+
+static void _ring_push(const mpu6050_sample_t *samples, size_t n)
+{
+    size_t cap = s_cfg.ring_samples;
+
+    portENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < n; i++) {
+        s_ring[s_ring_head] = samples[i];
+        s_ring_head = (s_ring_head + 1) % cap;
+        if (s_ring_count < cap) {
+            s_ring_count++;
+        } else {
+            // 消费者跟不上，覆盖最旧的样本
+            s_stats.ring_overruns++;
+        }
+    }
+    s_stats.samples += n;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+// 读出 FIFO 中全部完整样本
+static void _drain_fifo(void)
+{
+    uint8_t status = 0;
+    uint8_t cnt_buf[2];
+    esp_err_t err;
+
+    int64_t ref_us;
+    portENTER_CRITICAL(&s_lock);
+    ref_us = s_isr_us;
+    portEXIT_CRITICAL(&s_lock);
+    if (s_cfg.int_gpio < 0 || ref_us == 0) {
+        ref_us = esp_timer_get_time();
+    }
+
+    err = mpu6050_read_regs(MPU6050_REG_INT_STATUS, &status, 1);
+    if (err == ESP_OK) {
+        err = mpu6050_read_regs(MPU6050_REG_FIFO_COUNT_H, cnt_buf, sizeof(cnt_buf));
+    }
+    if (err != ESP_OK) {
+        s_stats.i2c_errors++;
+        return;
+    }
+
+    uint16_t count = (uint16_t)((cnt_buf[0] << 8) | cnt_buf[1]);
+    if ((status & MPU6050_INT_FIFO_OFLOW) || count >= MPU6050_FIFO_HW_SIZE) {
+        // 溢出后 FIFO 中的样本边界已不可信，直接复位
+        s_stats.hw_overflows++;
+        ESP_LOGW(TAG, "硬件 FIFO 溢出，复位 FIFO");
+        if (_fifo_reset() != ESP_OK) {
+            s_stats.i2c_errors++;
+        }
+        return;
+    }
+
+    size_t total = count / MPU6050_FIFO_SAMPLE_BYTES;
+    if (total == 0) {
+        return;
+    }
+
+    // 最新样本对应最近一次 INT，其余按 ODR 回推（误差不超过一个采样周期）
+    uint64_t ts = (uint64_t)ref_us - (uint64_t)(total - 1) * s_period_us;
+    if (s_last_ts_us != 0 && ts <= s_last_ts_us) {
+        ts = s_last_ts_us + s_period_us;
+    }
+
+    uint8_t raw[MPU6050_FIFO_BURST_BYTES];
+    mpu6050_sample_t samples[MPU6050_FIFO_BURST_BYTES / MPU6050_FIFO_SAMPLE_BYTES];
+    size_t done = 0;
+
+    while (done < total) {
+        size_t n = total - done;
+        if (n > sizeof(samples) / sizeof(samples[0])) {
+            n = sizeof(samples) / sizeof(samples[0]);
+        }
+
+        err = mpu6050_read_regs(MPU6050_REG_FIFO_R_W, raw, n * MPU6050_FIFO_SAMPLE_BYTES);
+        if (err != ESP_OK) {
+            // 读取中断会导致样本错位，复位 FIFO 重新对齐
+            s_stats.i2c_errors++;
+            _fifo_reset();
+            break;
+        }
+        s_stats.bursts++;
+
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t *p = &raw[i * MPU6050_FIFO_SAMPLE_BYTES];
+            samples[i].ts_us = ts;
+            samples[i].raw.accel_x = (int16_t)((p[0] << 8) | p[1]);
+            samples[i].raw.accel_y = (int16_t)((p[2] << 8) | p[3]);
+            samples[i].raw.accel_z = (int16_t)((p[4] << 8) | p[5]);
+            samples[i].raw.gyro_x = (int16_t)((p[6] << 8) | p[7]);
+            samples[i].raw.gyro_y = (int16_t)((p[8] << 8) | p[9]);
+            samples[i].raw.gyro_z = (int16_t)((p[10] << 8) | p[11]);
+            s_last_ts_us = ts;
+            ts += s_period_us;
+        }
+
+        _ring_push(samples, n);
+        if (mpu6050_calib_is_active()) {
+            for (size_t i = 0; i < n; i++) {
+                mpu6050_calib_feed(&samples[i].raw);
+            }
+        }
+        done += n;
+    }
+
+    if (done > 0) {
+        xSemaphoreGive(s_data_sem);
+    }
+}
+
+static void _update_rate(void)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now - s_rate_start_us;
+    if (elapsed < 1000000) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t samples = s_stats.samples;
+    s_stats.effective_hz = (samples - s_rate_samples) * 1000000.0f / (float)elapsed;
+    portEXIT_CRITICAL(&s_lock);
+
+    s_rate_samples = samples;
+    s_rate_start_us = now;
+}
+
+static void _fifo_task(void *arg)
+{
+    ESP_LOGI(TAG, "FIFO 采集任务已启动 (%u Hz, %s)", s_stats.odr_hz,
+             s_cfg.int_gpio >= 0 ? "INT" : "轮询");
+
+    s_rate_start_us = esp_timer_get_time();
+    while (s_running) {
+        // INT 触发时立即唤醒；未接 INT 或中断丢失时按周期轮询
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MPU6050_FIFO_POLL_MS));
+        if (!s_running) {
+            break;
+        }
+        _drain_fifo();
+        _update_rate();
+    }
+
+    xSemaphoreGive(s_exit_sem);
+    vTaskDelete(NULL);
+}
+
+// 移除 INT 中断处理（之后 ISR 不会再访问采集任务句柄）
+static void _detach_isr(void)
+{
+    if (s_isr_attached) {
+        gpio_isr_handler_remove(s_cfg.int_gpio);
+        s_isr_attached = false;
+    }
+}
+
+static void _release(void)
+{
+    _detach_isr();
+    if (s_data_sem != NULL) {
+        vSemaphoreDelete(s_data_sem);
+        s_data_sem = NULL;
+    }
+    if (s_exit_sem != NULL) {
+        vSemaphoreDelete(s_exit_sem);
+        s_exit_sem = NULL;
+    }
+    if (s_ring != NULL) {
+        free(s_ring);
+        s_ring = NULL;
+    }
+}
+
+esp_err_t mpu6050_fifo_start(const mpu6050_fifo_config_t *config)
+{
+    if (!mpu6050_is_inited()) {
+        ESP_LOGE(TAG, "MPU6050 未初始化");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_running) {
+        ESP_LOGW(TAG, "FIFO 采集已启动");
+        return ESP_OK;
+    }
+
+    mpu6050_fifo_config_t def = MPU6050_FIFO_DEFAULT_CONFIG();
+    s_cfg = config ? *config : def;
+    if (s_cfg.odr_hz == 0 || s_cfg.odr_hz > 1000 || s_cfg.dlpf > MPU6050_DLPF_5HZ || s_cfg.ring_samples == 0) {
+        ESP_LOGE(TAG, "无效的采集配置");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // DLPF 关闭时陀螺仪内部采样率为 8kHz，否则为 1kHz
+    uint32_t base_hz = (s_cfg.dlpf == MPU6050_DLPF_260HZ) ? 8000 : 1000;
+    uint32_t div = base_hz / s_cfg.odr_hz - 1;
+    if (div > 255) {
+        div = 255;
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.odr_hz = (uint16_t)(base_hz / (div + 1));
+    s_period_us = 1000000 / s_stats.odr_hz;
+    s_ring_head = 0;
+    s_ring_count = 0;
+    s_isr_us = 0;
+    s_last_ts_us = 0;
+    s_rate_samples = 0;
+
+#if CONFIG_SPIRAM
+    s_ring = heap_caps_malloc(s_cfg.ring_samples * sizeof(mpu6050_sample_t), MALLOC_CAP_SPIRAM);
+#else
+    s_ring = heap_caps_malloc(s_cfg.ring_samples * sizeof(mpu6050_sample_t), MALLOC_CAP_INTERNAL);
+#endif
+    s_data_sem = xSemaphoreCreateBinary();
+    s_exit_sem = xSemaphoreCreateBinary();
+    if (s_ring == NULL || s_data_sem == NULL || s_exit_sem == NULL) {
+        _release();
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = _configure_sensor((uint8_t)div);
+    if (err != ESP_OK) {
+        _release();
+        return err;
+    }
+
+    s_running = true;
+    if (xTaskCreate(_fifo_task, "mpu_fifo", MPU6050_FIFO_TASK_STACK, NULL,
+                    MPU6050_FIFO_TASK_PRIORITY, &s_task) != pdPASS) {
+        s_running = false;
+        _release();
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (s_cfg.int_gpio >= 0) {
+        gpio_config_t io_cfg = {
+            .pin_bit_mask = 1ULL << s_cfg.int_gpio,
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = GPIO_PULLUP_DISABLE,
+            .pull_down_en = GPIO_PULLDOWN_ENABLE,
+            .intr_type = GPIO_INTR_POSEDGE,
+        };
+        err = gpio_config(&io_cfg);
+        if (err == ESP_OK) {
+            // 其他模块可能已安装 ISR 服务
+            err = gpio_install_isr_service(0);
+            if (err == ESP_ERR_INVALID_STATE) {
+                err = ESP_OK;
+            }
+        }
+        if (err == ESP_OK) {
+            err = gpio_isr_handler_add(s_cfg.int_gpio, _int_isr_handler, NULL);
+            s_isr_attached = (err == ESP_OK);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "INT 引脚配置失败 (%s)，改为轮询", esp_err_to_name(err));
+            s_cfg.int_gpio = -1;
+        }
+    }
+
+    ESP_LOGI(TAG, "FIFO 采集已启动: ODR %u Hz, DLPF %u, 分频 %lu",
+             s_stats.odr_hz, s_cfg.dlpf, (unsigned long)div);
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_fifo_stop(void)
+{
+    if (!s_running) {
+        return ESP_OK;
+    }
+
+    // 先关闭传感器中断并移除 ISR，再停止任务：否则停止期间到达的数据就绪边沿
+    // 会对已删除的任务句柄调用 vTaskNotifyGiveFromISR
+    mpu6050_write_reg(MPU6050_REG_INT_ENABLE, 0);
+    _detach_isr();
+
+    s_running = false;
+    xTaskNotifyGive(s_task);
+    xSemaphoreTake(s_exit_sem, portMAX_DELAY);
+    s_task = NULL;
+
+    mpu6050_write_reg(MPU6050_REG_FIFO_EN, 0);
+    mpu6050_write_reg(MPU6050_REG_USER_CTRL, 0);
+
+    _release();
+    ESP_LOGI(TAG, "FIFO 采集已停止");
+    return ESP_OK;
+}
+
+size_t mpu6050_fifo_read(mpu6050_sample_t *out, size_t max, TickType_t timeout)
+{
+    if (out == NULL || max == 0 || !s_running) {
+        return 0;
+    }
+
+    size_t n = 0;
+    for (int attempt = 0; attempt < 2 && n == 0; attempt++) {
+        if (attempt > 0 && xSemaphoreTake(s_data_sem, timeout) != pdTRUE) {
+            break;
+        }
+
+        portENTER_CRITICAL(&s_lock);
+        size_t cap = s_cfg.ring_samples;
+        size_t tail = (s_ring_head + cap - s_ring_count) % cap;
+        n = s_ring_count < max ? s_ring_count : max;
+        for (size_t i = 0; i < n; i++) {
+            out[i] = s_ring[(tail + i) % cap];
+        }
+        s_ring_count -= n;
+        portEXIT_CRITICAL(&s_lock);
+    }
+    return n;
+}
+
+size_t mpu6050_fifo_available(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    size_t n = s_ring_count;
+    portEXIT_CRITICAL(&s_lock);
+    return n;
+}
+
+esp_err_t mpu6050_fifo_get_stats(mpu6050_fifo_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
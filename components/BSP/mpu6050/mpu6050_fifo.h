@@ -0,0 +1,84 @@
+#ifndef __MPU6050_FIFO_H__
+#define __MPU6050_FIFO_H__
+
+#include "esp_err.h"
+#include "mpu6050.h"
+#include "mpu6050_config.h"
+#include "freertos/FreeRTOS.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 带时间戳的样本
+ */
+typedef struct {
+    uint64_t ts_us;                 // 采样时间（esp_timer 时基，按 ODR 由中断时间回推）
+    mpu6050_raw_data_t raw;
+} mpu6050_sample_t;
+
+/**
+ * @brief FIFO 采集配置
+ */
+typedef struct {
+    uint16_t odr_hz;                // 输出数据率（4 ~ 1000Hz），据此计算 SMPLRT_DIV
+    uint8_t dlpf;                   // 数字低通滤波（MPU6050_DLPF_xxx）
+    int int_gpio;                   // INT 引脚，-1 表示轮询
+    size_t ring_samples;            // 环形缓冲区容量（样本数）
+} mpu6050_fifo_config_t;
+
+#define MPU6050_FIFO_DEFAULT_CONFIG() {                 \
+    .odr_hz = MPU6050_FIFO_DEFAULT_ODR_HZ,              \
+    .dlpf = MPU6050_FIFO_DEFAULT_DLPF,                  \
+    .int_gpio = MPU6050_INT_PIN,                        \
+    .ring_samples = MPU6050_FIFO_RING_SAMPLES,          \
+}
+
+/**
+ * @brief 采集统计
+ */
+typedef struct {
+    uint32_t samples;               // 已采集样本总数
+    uint32_t bursts;                // FIFO 突发读取次数
+    uint32_t hw_overflows;          // 硬件 FIFO 溢出次数（每次溢出会复位 FIFO）
+    uint32_t ring_overruns;         // 环形缓冲区满导致覆盖的样本数
+    uint32_t i2c_errors;            // I2C 读取失败次数
+    uint16_t odr_hz;                // 实际配置的输出数据率
+    float effective_hz;             // 最近 1 秒实测采样率
+} mpu6050_fifo_stats_t;
+
+/**
+ * @brief 启动 FIFO 采集（需先调用 mpu6050_init）
+ *
+ * 配置 DLPF / 分频 / FIFO / 数据就绪中断，并创建采集任务。
+ * INT 触发后采集任务一次性突发读出 FIFO 中的全部完整样本。
+ *
+ * @param config 配置，NULL 使用 MPU6050_FIFO_DEFAULT_CONFIG()
+ */
+esp_err_t mpu6050_fifo_start(const mpu6050_fifo_config_t *config);
+
+/**
+ * @brief 停止 FIFO 采集并释放资源
+ */
+esp_err_t mpu6050_fifo_stop(void);
+
+/**
+ * @brief 从环形缓冲区取出样本
+ *
+ * @param out     输出数组
+ * @param max     最多取出的样本数
+ * @param timeout 缓冲区为空时的最长等待时间
+ * @return 实际取出的样本数
+ */
+size_t mpu6050_fifo_read(mpu6050_sample_t *out, size_t max, TickType_t timeout);
+
+/**
+ * @brief 环形缓冲区中待读取的样本数
+ */
+size_t mpu6050_fifo_available(void);
+
+/**
+ * @brief 获取采集统计
+ */
+esp_err_t mpu6050_fifo_get_stats(mpu6050_fifo_stats_t *stats);
+
+#endif // __MPU6050_FIFO_H__
@@ -0,0 +1,237 @@
+#include "mpu6050_fusion.h"
+#include "mpu6050_config.h"
+#include <math.h>
+#include <string.h>
+
+#define FUSION_DEG2RAD      0.017453293f
+#define FUSION_RAD2DEG      57.29577951f
+
+// 单精度平方根倒数（sqrtf 由 FPU 完成，避免 double 提升）
+static inline float _inv_sqrt(float x)
+{
+    return 1.0f / sqrtf(x);
+}
+
+static void _normalize_quat(mpu6050_quat_t *q)
+{
+    float n = _inv_sqrt(q->w * q->w + q->x * q->x + q->y * q->y + q->z * q->z);
+    q->w *= n;
+    q->x *= n;
+    q->y *= n;
+    q->z *= n;
+}
+
+// 用加速度计直接得到 roll/pitch 作为初始姿态，避免从单位四元数缓慢收敛
+static void _align_to_accel(mpu6050_fusion_t *f, float ax, float ay, float az)
+{
+    float roll = atan2f(ay, az);
+    float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+
+    f->q.w = cr * cp;
+    f->q.x = sr * cp;
+    f->q.y = cr * sp;
+    f->q.z = -sr * sp;
+    f->initialized = true;
+}
+
+static void _mahony_update(mpu6050_fusion_t *f, float gx, float gy, float gz,
+                           float ax, float ay, float az, float dt)
+{
+    mpu6050_quat_t *q = &f->q;
+
+    if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+        float n = _inv_sqrt(ax * ax + ay * ay + az * az);
+        ax *= n;
+        ay *= n;
+        az *= n;
+
+        // 由当前姿态估计的重力方向（的一半）
+        float hvx = q->x * q->z - q->w * q->y;
+        float hvy = q->w * q->x + q->y * q->z;
+        float hvz = q->w * q->w - 0.5f + q->z * q->z;
+
+        // 测量值与估计值的叉积即为误差
+        float hex = ay * hvz - az * hvy;
+        float hey = az * hvx - ax * hvz;
+        float hez = ax * hvy - ay * hvx;
+
+        if (f->ki > 0.0f) {
+            f->integral[0] += 2.0f * f->ki * hex * dt;
+            f->integral[1] += 2.0f * f->ki * hey * dt;
+            f->integral[2] += 2.0f * f->ki * hez * dt;
+            gx += f->integral[0];
+            gy += f->integral[1];
+            gz += f->integral[2];
+        }
+
+        gx += 2.0f * f->kp * hex;
+        gy += 2.0f * f->kp * hey;
+        gz += 2.0f * f->kp * hez;
+    }
+
+    // 四元数微分积分
+    gx *= 0.5f * dt;
+    gy *= 0.5f * dt;
+    gz *= 0.5f * dt;
+    float qw = q->w, qx = q->x, qy = q->y;
+    q->w += -qx * gx - qy * gy - q->z * gz;
+    q->x += qw * gx + qy * gz - q->z * gy;
+    q->y += qw * gy - qx * gz + q->z * gx;
+    q->z += qw * gz + qx * gy - qy * gx;
+
+    _normalize_quat(q);
+}
+
+static void _madgwick_update(mpu6050_fusion_t *f, float gx, float gy, float gz,
+                             float ax, float ay, float az, float dt)
+{
+    mpu6050_quat_t *q = &f->q;
+    float q0 = q->w, q1 = q->x, q2 = q->y, q3 = q->z;
+
+    // 陀螺仪给出的四元数变化率
+    float dq0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float dq1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float dq2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float dq3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+        float n = _inv_sqrt(ax * ax + ay * ay + az * az);
+        ax *= n;
+        ay *= n;
+        az *= n;
+
+        float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+        float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+        float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+        // 目标函数梯度
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 +
+                   _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 +
+                   _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+
+        float sn = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (sn > 0.0f) {
+            sn = _inv_sqrt(sn);
+            dq0 -= f->beta * s0 * sn;
+            dq1 -= f->beta * s1 * sn;
+            dq2 -= f->beta * s2 * sn;
+            dq3 -= f->beta * s3 * sn;
+        }
+    }
+
+    q->w = q0 + dq0 * dt;
+    q->x = q1 + dq1 * dt;
+    q->y = q2 + dq2 * dt;
+    q->z = q3 + dq3 * dt;
+
+    _normalize_quat(q);
+}
+
+esp_err_t mpu6050_fusion_init(mpu6050_fusion_t *f, mpu6050_fusion_algo_t algo, float sample_hz)
+{
+    if (f == NULL || sample_hz <= 0.0f ||
+        (algo != MPU6050_FUSION_MAHONY && algo != MPU6050_FUSION_MADGWICK)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(f, 0, sizeof(*f));
+    f->algo = algo;
+    f->kp = MPU6050_FUSION_MAHONY_KP;
+    f->ki = MPU6050_FUSION_MAHONY_KI;
+    f->beta = MPU6050_FUSION_MADGWICK_BETA;
+    f->default_dt = 1.0f / sample_hz;
+    mpu6050_fusion_set_sensitivity(f, MPU6050_ACCEL_LSB_PER_G, MPU6050_GYRO_LSB_PER_DPS);
+    mpu6050_fusion_reset(f);
+    return ESP_OK;
+}
+
+void mpu6050_fusion_reset(mpu6050_fusion_t *f)
+{
+    f->q.w = 1.0f;
+    f->q.x = 0.0f;
+    f->q.y = 0.0f;
+    f->q.z = 0.0f;
+    f->integral[0] = f->integral[1] = f->integral[2] = 0.0f;
+    f->initialized = false;
+}
+
+void mpu6050_fusion_set_sensitivity(mpu6050_fusion_t *f, float accel_lsb_per_g, float gyro_lsb_per_dps)
+{
+    f->accel_scale = 1.0f / accel_lsb_per_g;
+    f->gyro_scale = FUSION_DEG2RAD / gyro_lsb_per_dps;
+}
+
+void mpu6050_fusion_set_gyro_bias(mpu6050_fusion_t *f, const mpu6050_gyro_bias_t *bias)
+{
+    if (bias != NULL) {
+        f->bias = *bias;
+    } else {
+        memset(&f->bias, 0, sizeof(f->bias));
+    }
+}
+
+void mpu6050_fusion_update(mpu6050_fusion_t *f, float gx, float gy, float gz,
+                           float ax, float ay, float az, float dt)
+{
+    if (dt <= 0.0f) {
+        dt = f->default_dt;
+    }
+
+    if (!f->initialized) {
+        if (ax == 0.0f && ay == 0.0f && az == 0.0f) {
+            return;
+        }
+        _align_to_accel(f, ax, ay, az);
+        return;
+    }
+
+    if (f->algo == MPU6050_FUSION_MADGWICK) {
+        _madgwick_update(f, gx, gy, gz, ax, ay, az, dt);
+    } else {
+        _mahony_update(f, gx, gy, gz, ax, ay, az, dt);
+    }
+}
+
+void mpu6050_fusion_update_raw(mpu6050_fusion_t *f, const mpu6050_raw_data_t *raw, float dt)
+{
+    float gx = (float)(raw->gyro_x - f->bias.gyro_x_bias) * f->gyro_scale;
+    float gy = (float)(raw->gyro_y - f->bias.gyro_y_bias) * f->gyro_scale;
+    float gz = (float)(raw->gyro_z - f->bias.gyro_z_bias) * f->gyro_scale;
+
+    // 加速度只参与方向计算，换算系数不影响结果，保留以便调试时读数一致
+    float ax = (float)raw->accel_x * f->accel_scale;
+    float ay = (float)raw->accel_y * f->accel_scale;
+    float az = (float)raw->accel_z * f->accel_scale;
+
+    mpu6050_fusion_update(f, gx, gy, gz, ax, ay, az, dt);
+}
+
+mpu6050_quat_t mpu6050_fusion_get_quat(const mpu6050_fusion_t *f)
+{
+    return f->q;
+}
+
+void mpu6050_fusion_get_euler(const mpu6050_fusion_t *f, mpu6050_euler_t *euler)
+{
+    const mpu6050_quat_t *q = &f->q;
+
+    float sinp = 2.0f * (q->w * q->y - q->z * q->x);
+    if (sinp > 1.0f) {
+        sinp = 1.0f;
+    } else if (sinp < -1.0f) {
+        sinp = -1.0f;
+    }
+
+    euler->roll = atan2f(2.0f * (q->w * q->x + q->y * q->z),
+                         1.0f - 2.0f * (q->x * q->x + q->y * q->y)) * FUSION_RAD2DEG;
+    euler->pitch = asinf(sinp) * FUSION_RAD2DEG;
+    euler->yaw = atan2f(2.0f * (q->w * q->z + q->x * q->y),
+                        1.0f - 2.0f * (q->y * q->y + q->z * q->z)) * FUSION_RAD2DEG;
+}
@@ -0,0 +1,103 @@
+#ifndef __MPU6050_FUSION_H__
+#define __MPU6050_FUSION_H__
+
+#include "esp_err.h"
+#include "mpu6050.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 姿态融合算法
+ */
+typedef enum {
+    MPU6050_FUSION_MAHONY = 0,      // 互补滤波 + PI 校正（运算量小）
+    MPU6050_FUSION_MADGWICK,        // 梯度下降（动态响应更好）
+} mpu6050_fusion_algo_t;
+
+/**
+ * @brief 四元数（w 为实部）
+ */
+typedef struct {
+    float w;
+    float x;
+    float y;
+    float z;
+} mpu6050_quat_t;
+
+/**
+ * @brief 欧拉角（°，ZYX 顺序）
+ */
+typedef struct {
+    float roll;
+    float pitch;
+    float yaw;                      // 无磁力计，yaw 会随时间漂移
+} mpu6050_euler_t;
+
+/**
+ * @brief 融合器状态（全部单精度运算，适配 ESP32-S3 FPU）
+ */
+typedef struct {
+    mpu6050_fusion_algo_t algo;
+    float kp;                       // Mahony 比例增益
+    float ki;                       // Mahony 积分增益（0 表示不做在线零偏估计）
+    float beta;                     // Madgwick 增益
+    float default_dt;               // dt <= 0 时使用的采样周期（s）
+
+    // 原始值换算（预先取倒数，避免每次更新做除法）
+    float accel_scale;              // 1 / (LSB/g)
+    float gyro_scale;               // (π/180) / (LSB/°/s)
+    mpu6050_gyro_bias_t bias;
+
+    mpu6050_quat_t q;
+    float integral[3];
+    bool initialized;               // 首个样本用加速度计直接对齐 roll/pitch
+} mpu6050_fusion_t;
+
+/**
+ * @brief 初始化融合器
+ *
+ * @param sample_hz 采样率（用于默认 dt）
+ */
+esp_err_t mpu6050_fusion_init(mpu6050_fusion_t *f, mpu6050_fusion_algo_t algo, float sample_hz);
+
+/**
+ * @brief 重置姿态为单位四元数（下一次更新重新对齐）
+ */
+void mpu6050_fusion_reset(mpu6050_fusion_t *f);
+
+/**
+ * @brief 设置原始值换算参数（供 mpu6050_fusion_update_raw 使用）
+ */
+void mpu6050_fusion_set_sensitivity(mpu6050_fusion_t *f, float accel_lsb_per_g, float gyro_lsb_per_dps);
+
+/**
+ * @brief 设置陀螺仪零偏（原始值）
+ */
+void mpu6050_fusion_set_gyro_bias(mpu6050_fusion_t *f, const mpu6050_gyro_bias_t *bias);
+
+/**
+ * @brief 以物理量更新一次姿态
+ *
+ * @param gx, gy, gz 角速度（rad/s）
+ * @param ax, ay, az 加速度（任意单位，内部归一化）
+ * @param dt 与上一样本的间隔（s），<= 0 时使用默认采样周期
+ */
+void mpu6050_fusion_update(mpu6050_fusion_t *f, float gx, float gy, float gz,
+                           float ax, float ay, float az, float dt);
+
+/**
+ * @brief 以原始值更新一次姿态（扣除零偏并换算后调用 mpu6050_fusion_update）
+ */
+void mpu6050_fusion_update_raw(mpu6050_fusion_t *f, const mpu6050_raw_data_t *raw, float dt);
+
+/**
+ * @brief 获取当前四元数
+ */
+mpu6050_quat_t mpu6050_fusion_get_quat(const mpu6050_fusion_t *f);
+
+/**
+ * @brief 获取当前欧拉角
+ */
+void mpu6050_fusion_get_euler(const mpu6050_fusion_t *f, mpu6050_euler_t *euler);
+
+#endif // __MPU6050_FUSION_H__
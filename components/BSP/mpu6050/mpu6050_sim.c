@@ -0,0 +1,413 @@
+#include "mpu6050_sim.h"
+#include "mpu6050_config.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "mpu6050_sim";
+
+#define SIM_REG_COUNT       128
+#define SIM_TWO_PI          6.28318531f
+
+// 数据源：返回设备启动后 t_us 时刻的原始样本（按当前量程换算）
+typedef void (*sim_source_fn_t)(mpu6050_sim_t *sim, uint64_t t_us, mpu6050_raw_data_t *out);
+
+typedef struct {
+    uint64_t t_us;
+    mpu6050_raw_data_t raw;
+} sim_record_t;
+
+struct mpu6050_sim {
+    const char *name;
+    sim_source_fn_t source;
+
+    uint8_t regs[SIM_REG_COUNT];
+    uint8_t fifo[MPU6050_FIFO_HW_SIZE];
+    size_t fifo_len;
+    int64_t t0_us;                      // 设备启动时间
+    uint64_t next_idx;                  // 下一个写入 FIFO 的样本序号（以当前 ODR 计）
+    uint32_t odr_hz;
+
+    // 合成数据
+    mpu6050_synth_config_t synth;
+    uint32_t rng;
+
+    // 回放数据
+    sim_record_t *records;
+    size_t num_records;
+    size_t cursor;
+    bool loop;
+};
+
+/* ================= Synthetic Source ================= */
+
+static float _rand_uniform(mpu6050_sim_t *sim)
+{
+    // xorshift32
+    uint32_t x = sim->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->rng = x;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+static float _rand_gauss(mpu6050_sim_t *sim)
+{
+    // 4 个均匀分布之和近似正态分布（方差 4/12），避免 log/sqrt
+    float s = _rand_uniform(sim) + _rand_uniform(sim) + _rand_uniform(sim) + _rand_uniform(sim);
+    return (s - 2.0f) * 1.7320508f;
+}
+
+static int16_t _saturate(float v)
+{
+    if (v > 32767.0f) {
+        return 32767;
+    }
+    if (v < -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)lroundf(v);
+}
+
+static void _synth_source(mpu6050_sim_t *sim, uint64_t t_us, mpu6050_raw_data_t *out)
+{
+    const mpu6050_synth_config_t *c = &sim->synth;
+    float t = (float)(t_us % 1000000000ULL) * 1e-6f;
+    float vib = sinf(SIM_TWO_PI * c->vib_hz * t);
+    float rot = sinf(SIM_TWO_PI * c->rot_hz * t);
+
+    // 当前量程由 ACCEL_CONFIG/GYRO_CONFIG 的 FS_SEL 位决定
+    float accel_lsb = MPU6050_ACCEL_SENS_2G / (float)(1 << ((sim->regs[MPU6050_REG_ACCEL_CONFIG] >> 3) & 3));
+    float gyro_lsb = MPU6050_GYRO_SENS_250 / (float)(1 << ((sim->regs[MPU6050_REG_GYRO_CONFIG] >> 3) & 3));
+
+    int16_t *accel[3] = {&out->accel_x, &out->accel_y, &out->accel_z};
+    int16_t *gyro[3] = {&out->gyro_x, &out->gyro_y, &out->gyro_z};
+    for (int i = 0; i < 3; i++) {
+        float a = c->gravity_g[i] + c->vib_amp_g[i] * vib + c->accel_noise_g * _rand_gauss(sim);
+        float g = c->gyro_bias_dps[i] + c->rot_amp_dps[i] * rot + c->gyro_noise_dps * _rand_gauss(sim);
+        *accel[i] = _saturate(a * accel_lsb);
+        *gyro[i] = _saturate(g * gyro_lsb);
+    }
+}
+
+/* ================= Replay Source ================= */
+
+static void _replay_source(mpu6050_sim_t *sim, uint64_t t_us, mpu6050_raw_data_t *out)
+{
+    const sim_record_t *rec = sim->records;
+    const size_t n = sim->num_records;
+    uint64_t span = rec[n - 1].t_us - rec[0].t_us;
+
+    uint64_t t = rec[0].t_us + t_us;
+    if (t_us > span) {
+        if (!sim->loop) {
+            *out = rec[n - 1].raw;
+            return;
+        }
+        // 循环播放：时间回绕到文件开头，同时复位游标
+        t = rec[0].t_us + t_us % (span + 1);
+        if (t < rec[sim->cursor].t_us) {
+            sim->cursor = 0;
+        }
+    }
+
+    // 采样时间单调递增，游标只需向前移动（采样保持）
+    while (sim->cursor + 1 < n && rec[sim->cursor + 1].t_us <= t) {
+        sim->cursor++;
+    }
+    *out = rec[sim->cursor].raw;
+}
+
+static esp_err_t _replay_load(mpu6050_sim_t *sim, const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        ESP_LOGE(TAG, "无法打开回放文件: %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t cap = 0;
+    char line[128];
+    esp_err_t err = ESP_OK;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+
+        unsigned long long t;
+        int v[6];
+        if (sscanf(line, "%llu,%d,%d,%d,%d,%d,%d", &t, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 7) {
+            ESP_LOGW(TAG, "跳过无法解析的行: %s", line);
+            continue;
+        }
+        if (sim->num_records > 0 && t < sim->records[sim->num_records - 1].t_us) {
+            ESP_LOGE(TAG, "时间戳必须单调递增");
+            err = ESP_ERR_INVALID_ARG;
+            break;
+        }
+
+        if (sim->num_records == cap) {
+            cap = cap ? cap * 2 : 1024;
+#if CONFIG_SPIRAM
+            sim_record_t *p = heap_caps_realloc(sim->records, cap * sizeof(sim_record_t), MALLOC_CAP_SPIRAM);
+#else
+            sim_record_t *p = realloc(sim->records, cap * sizeof(sim_record_t));
+#endif
+            if (p == NULL) {
+                err = ESP_ERR_NO_MEM;
+                break;
+            }
+            sim->records = p;
+        }
+
+        sim_record_t *r = &sim->records[sim->num_records++];
+        r->t_us = t;
+        r->raw.accel_x = _saturate(v[0]);
+        r->raw.accel_y = _saturate(v[1]);
+        r->raw.accel_z = _saturate(v[2]);
+        r->raw.gyro_x = _saturate(v[3]);
+        r->raw.gyro_y = _saturate(v[4]);
+        r->raw.gyro_z = _saturate(v[5]);
+    }
+    fclose(fp);
+
+    if (err == ESP_OK && sim->num_records == 0) {
+        ESP_LOGE(TAG, "回放文件为空: %s", path);
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    return err;
+}
+
+/* ================= Register Emulation ================= */
+
+static void _update_odr(mpu6050_sim_t *sim)
+{
+    uint8_t dlpf = sim->regs[MPU6050_REG_CONFIG] & 0x07;
+    uint32_t base_hz = (dlpf == MPU6050_DLPF_260HZ || dlpf == 7) ? 8000 : 1000;
+    sim->odr_hz = base_hz / (sim->regs[MPU6050_REG_SMPLRT_DIV] + 1u);
+}
+
+static uint64_t _sample_time_us(const mpu6050_sim_t *sim, uint64_t idx)
+{
+    return idx * 1000000ULL / sim->odr_hz;
+}
+
+// 以当前时间为基准对齐样本序号（FIFO 复位或改变 ODR 后调用）
+static void _realign(mpu6050_sim_t *sim, int64_t now)
+{
+    sim->next_idx = (uint64_t)(now - sim->t0_us) * sim->odr_hz / 1000000ULL + 1;
+}
+
+static bool _fifo_enabled(const mpu6050_sim_t *sim)
+{
+    return (sim->regs[MPU6050_REG_USER_CTRL] & MPU6050_USER_CTRL_FIFO_EN) &&
+           (sim->regs[MPU6050_REG_FIFO_EN] & MPU6050_FIFO_EN_ACCEL_GYRO) &&
+           !(sim->regs[MPU6050_REG_PWR_MGMT_1] & MPU6050_PWR_MGMT_1_SLEEP_BIT);
+}
+
+// 把截至 now 应产生的样本写入 FIFO
+static void _advance(mpu6050_sim_t *sim, int64_t now)
+{
+    if (!_fifo_enabled(sim)) {
+        return;
+    }
+
+    uint64_t due = (uint64_t)(now - sim->t0_us) * sim->odr_hz / 1000000ULL + 1;
+    if (due <= sim->next_idx) {
+        return;
+    }
+    if (due - sim->next_idx > MPU6050_SIM_MAX_CATCHUP) {
+        // 长时间未读取，必然溢出，只生成最后一段（更早的样本反正会被覆盖）
+        sim->regs[MPU6050_REG_INT_STATUS] |= MPU6050_INT_FIFO_OFLOW;
+        sim->next_idx = due - MPU6050_SIM_MAX_CATCHUP;
+    }
+
+    for (; sim->next_idx < due; sim->next_idx++) {
+        if (sim->fifo_len + MPU6050_FIFO_SAMPLE_BYTES > sizeof(sim->fifo)) {
+            // 与硬件一致：溢出时覆盖最旧的数据并置位中断状态
+            sim->regs[MPU6050_REG_INT_STATUS] |= MPU6050_INT_FIFO_OFLOW;
+            sim->fifo_len -= MPU6050_FIFO_SAMPLE_BYTES;
+            memmove(sim->fifo, sim->fifo + MPU6050_FIFO_SAMPLE_BYTES, sim->fifo_len);
+        }
+
+        mpu6050_raw_data_t raw;
+        sim->source(sim, _sample_time_us(sim, sim->next_idx), &raw);
+        const int16_t v[6] = {raw.accel_x, raw.accel_y, raw.accel_z, raw.gyro_x, raw.gyro_y, raw.gyro_z};
+        uint8_t *p = &sim->fifo[sim->fifo_len];
+        for (int i = 0; i < 6; i++) {
+            p[i * 2] = (uint8_t)((uint16_t)v[i] >> 8);
+            p[i * 2 + 1] = (uint8_t)v[i];
+        }
+        sim->fifo_len += MPU6050_FIFO_SAMPLE_BYTES;
+        sim->regs[MPU6050_REG_INT_STATUS] |= MPU6050_INT_DATA_RDY;
+    }
+}
+
+void mpu6050_sim_power_on(mpu6050_sim_t *sim, int64_t now_us)
+{
+    memset(sim->regs, 0, sizeof(sim->regs));
+    sim->regs[MPU6050_REG_PWR_MGMT_1] = MPU6050_PWR_MGMT_1_SLEEP;      // 上电默认休眠
+    sim->regs[MPU6050_REG_WHO_AM_I] = MPU6050_WHO_AM_I_VALUE;
+    sim->fifo_len = 0;
+    sim->cursor = 0;
+    sim->t0_us = now_us;
+    _update_odr(sim);
+    _realign(sim, now_us);
+}
+
+void mpu6050_sim_read_regs(mpu6050_sim_t *sim, int64_t now, uint8_t reg, uint8_t *data, size_t len)
+{
+    _advance(sim, now);
+
+    if (reg == MPU6050_REG_FIFO_R_W) {
+        // FIFO_R_W 地址不自增，FIFO 为空时与硬件一样返回无效数据
+        size_t n = len < sim->fifo_len ? len : sim->fifo_len;
+        memcpy(data, sim->fifo, n);
+        memset(data + n, 0xFF, len - n);
+        sim->fifo_len -= n;
+        memmove(sim->fifo, sim->fifo + n, sim->fifo_len);
+        return;
+    }
+
+    // 数据寄存器：当前时刻的样本（温度固定为 25°C），只在读取范围覆盖时生成
+    uint8_t out_regs[MPU6050_FULL_DATA_BYTES];
+    if (reg <= MPU6050_REG_GYRO_ZOUT_L && reg + len > MPU6050_REG_ACCEL_XOUT_H) {
+        mpu6050_raw_data_t raw;
+        sim->source(sim, (uint64_t)(now - sim->t0_us), &raw);
+        const int16_t v[7] = {raw.accel_x, raw.accel_y, raw.accel_z, (int16_t)((25.0f - 36.53f) * 340.0f),
+                              raw.gyro_x, raw.gyro_y, raw.gyro_z};
+        for (int i = 0; i < 7; i++) {
+            out_regs[i * 2] = (uint8_t)((uint16_t)v[i] >> 8);
+            out_regs[i * 2 + 1] = (uint8_t)v[i];
+        }
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t r = (uint8_t)(reg + i);
+        if (r >= MPU6050_REG_ACCEL_XOUT_H && r <= MPU6050_REG_GYRO_ZOUT_L) {
+            data[i] = out_regs[r - MPU6050_REG_ACCEL_XOUT_H];
+        } else if (r == MPU6050_REG_FIFO_COUNT_H) {
+            data[i] = (uint8_t)(sim->fifo_len >> 8);
+        } else if (r == MPU6050_REG_FIFO_COUNT_H + 1) {
+            data[i] = (uint8_t)sim->fifo_len;
+        } else if (r < SIM_REG_COUNT) {
+            data[i] = sim->regs[r];
+        } else {
+            data[i] = 0;
+        }
+    }
+    // INT_PIN_CFG 配置为读取即清除
+    if (reg <= MPU6050_REG_INT_STATUS && reg + len > MPU6050_REG_INT_STATUS) {
+        sim->regs[MPU6050_REG_INT_STATUS] = 0;
+    }
+}
+
+esp_err_t mpu6050_sim_write_reg(mpu6050_sim_t *sim, int64_t now, uint8_t reg, uint8_t value)
+{
+    if (reg >= SIM_REG_COUNT || reg == MPU6050_REG_WHO_AM_I) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 先按旧配置补齐 FIFO，再应用新配置
+    _advance(sim, now);
+
+    if (reg == MPU6050_REG_PWR_MGMT_1 && (value & MPU6050_PWR_MGMT_1_DEVICE_RESET)) {
+        memset(sim->regs, 0, sizeof(sim->regs));
+        sim->regs[MPU6050_REG_PWR_MGMT_1] = MPU6050_PWR_MGMT_1_SLEEP;
+        sim->regs[MPU6050_REG_WHO_AM_I] = MPU6050_WHO_AM_I_VALUE;
+        sim->fifo_len = 0;
+    } else if (reg == MPU6050_REG_USER_CTRL) {
+        if (value & MPU6050_USER_CTRL_FIFO_RESET) {
+            sim->fifo_len = 0;
+            sim->regs[MPU6050_REG_INT_STATUS] &= ~MPU6050_INT_FIFO_OFLOW;
+        }
+        // 复位位自动清零
+        sim->regs[reg] = value & ~MPU6050_USER_CTRL_FIFO_RESET;
+    } else {
+        sim->regs[reg] = value;
+    }
+
+    if (reg == MPU6050_REG_CONFIG || reg == MPU6050_REG_SMPLRT_DIV) {
+        _update_odr(sim);
+    }
+    // FIFO 开启或复位后从当前时刻开始计数
+    if (reg == MPU6050_REG_USER_CTRL || reg == MPU6050_REG_FIFO_EN || reg == MPU6050_REG_CONFIG ||
+        reg == MPU6050_REG_SMPLRT_DIV || reg == MPU6050_REG_PWR_MGMT_1) {
+        _realign(sim, now);
+    }
+    return ESP_OK;
+}
+
+static mpu6050_sim_t *_sim_create(const char *name, sim_source_fn_t source)
+{
+    mpu6050_sim_t *sim = calloc(1, sizeof(mpu6050_sim_t));
+    if (sim == NULL) {
+        return NULL;
+    }
+
+    sim->name = name;
+    sim->source = source;
+    sim->odr_hz = 1000;
+    return sim;
+}
+
+esp_err_t mpu6050_sim_create_synthetic(const mpu6050_synth_config_t *config, mpu6050_sim_t **ret_sim)
+{
+    if (ret_sim == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mpu6050_sim_t *sim = _sim_create("synthetic", _synth_source);
+    if (sim == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    mpu6050_synth_config_t def = MPU6050_SYNTH_DEFAULT_CONFIG();
+    sim->synth = config ? *config : def;
+    sim->rng = sim->synth.seed ? sim->synth.seed : 1;
+
+    *ret_sim = sim;
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_sim_create_replay(const char *path, bool loop, mpu6050_sim_t **ret_sim)
+{
+    if (path == NULL || ret_sim == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mpu6050_sim_t *sim = _sim_create("replay", _replay_source);
+    if (sim == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    sim->loop = loop;
+
+    esp_err_t err = _replay_load(sim, path);
+    if (err != ESP_OK) {
+        mpu6050_sim_delete(sim);
+        return err;
+    }
+
+    ESP_LOGI(TAG, "已加载 %u 条记录，时长 %.2f s%s", (unsigned)sim->num_records,
+             (sim->records[sim->num_records - 1].t_us - sim->records[0].t_us) * 1e-6,
+             loop ? "（循环）" : "");
+    *ret_sim = sim;
+    return ESP_OK;
+}
+
+void mpu6050_sim_delete(mpu6050_sim_t *sim)
+{
+    if (sim == NULL) {
+        return;
+    }
+    free(sim->records);
+    free(sim);
+}
+
+const char *mpu6050_sim_name(const mpu6050_sim_t *sim)
+{
+    return sim->name;
+}
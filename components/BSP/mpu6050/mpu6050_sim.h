@@ -0,0 +1,60 @@
+#ifndef __MPU6050_SIM_H__
+#define __MPU6050_SIM_H__
+
+#include "esp_err.h"
+#include "mpu6050.h"
+#include "mpu6050_backend.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 模拟设备核心：寄存器、采样率分频与 1024 字节硬件 FIFO 的纯软件模型。
+ *
+ * 不依赖 FreeRTOS、esp_timer 与任何驱动，时间由调用者传入（设备时间，微秒），
+ * 因此可以直接在主机上编译，用虚拟时钟确定性地运行（见 tools/host_bench）。
+ * 非线程安全，由调用者串行访问；在目标上通过 mpu6050_backend_synthetic_create /
+ * mpu6050_backend_replay_create 包装为加锁、按 esp_timer 计时的后端。
+ */
+typedef struct mpu6050_sim mpu6050_sim_t;
+
+/**
+ * @brief 创建合成数据设备
+ *
+ * @param config 配置，NULL 使用 MPU6050_SYNTH_DEFAULT_CONFIG
+ */
+esp_err_t mpu6050_sim_create_synthetic(const mpu6050_synth_config_t *config, mpu6050_sim_t **ret_sim);
+
+/**
+ * @brief 创建文件回放设备（文件格式见 mpu6050_backend_replay_create）
+ */
+esp_err_t mpu6050_sim_create_replay(const char *path, bool loop, mpu6050_sim_t **ret_sim);
+
+/**
+ * @brief 释放设备
+ */
+void mpu6050_sim_delete(mpu6050_sim_t *sim);
+
+/**
+ * @brief 设备名（"synthetic" / "replay"）
+ */
+const char *mpu6050_sim_name(const mpu6050_sim_t *sim);
+
+/**
+ * @brief 上电：寄存器恢复默认值（休眠），now_us 作为设备时间零点
+ */
+void mpu6050_sim_power_on(mpu6050_sim_t *sim, int64_t now_us);
+
+/**
+ * @brief 读寄存器（先把截至 now_us 应产生的样本写入 FIFO）
+ */
+void mpu6050_sim_read_regs(mpu6050_sim_t *sim, int64_t now_us, uint8_t reg, uint8_t *data, size_t len);
+
+/**
+ * @brief 写寄存器（先按旧配置补齐 FIFO，再应用新配置）
+ *
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 只读或不存在的寄存器
+ */
+esp_err_t mpu6050_sim_write_reg(mpu6050_sim_t *sim, int64_t now_us, uint8_t reg, uint8_t value);
+
+#endif // __MPU6050_SIM_H__
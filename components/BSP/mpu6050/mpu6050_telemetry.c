@@ -0,0 +1,181 @@
+#include "mpu6050_telemetry.h"
+#include <string.h>
+
+// 小端读写（与 CPU 字节序无关）
+static inline void _put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void _put_u32(uint8_t *p, uint32_t v)
+{
+    _put_u16(p, (uint16_t)v);
+    _put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline void _put_u64(uint8_t *p, uint64_t v)
+{
+    _put_u32(p, (uint32_t)v);
+    _put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline uint16_t _get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t _get_u32(const uint8_t *p)
+{
+    return _get_u16(p) | ((uint32_t)_get_u16(p + 2) << 16);
+}
+
+static inline uint64_t _get_u64(const uint8_t *p)
+{
+    return _get_u32(p) | ((uint64_t)_get_u32(p + 4) << 32);
+}
+
+static inline void _put_f32(uint8_t *p, float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    _put_u32(p, v);
+}
+
+static inline float _get_f32(const uint8_t *p)
+{
+    uint32_t v = _get_u32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+esp_err_t mpu6050_telemetry_init(mpu6050_telemetry_t *t, uint8_t *buf, size_t cap,
+                                 float accel_lsb_per_g, float gyro_lsb_per_dps)
+{
+    if (t == NULL || buf == NULL || cap < MPU6050_TELEMETRY_BUF_SIZE(1)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(t, 0, sizeof(*t));
+    t->buf = buf;
+    t->cap = cap;
+
+    memset(buf, 0, MPU6050_TELEMETRY_HEADER_SIZE);
+    _put_u16(buf + 0, MPU6050_TELEMETRY_MAGIC);
+    buf[2] = MPU6050_TELEMETRY_VERSION;
+    buf[3] = 0;
+    _put_f32(buf + 16, accel_lsb_per_g);
+    _put_f32(buf + 20, gyro_lsb_per_dps);
+
+    mpu6050_telemetry_reset(t);
+    return ESP_OK;
+}
+
+void mpu6050_telemetry_reset(mpu6050_telemetry_t *t)
+{
+    t->len = MPU6050_TELEMETRY_HEADER_SIZE;
+    t->count = 0;
+    t->last_ts_us = 0;
+    _put_u16(t->buf + 4, 0);
+    _put_u64(t->buf + 8, 0);
+}
+
+esp_err_t mpu6050_telemetry_add(mpu6050_telemetry_t *t, const mpu6050_raw_data_t *raw, uint64_t ts_us)
+{
+    if (t == NULL || raw == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (t->len + MPU6050_TELEMETRY_SAMPLE_SIZE > t->cap || t->count == UINT16_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint16_t dt = 0;
+    if (t->count == 0) {
+        _put_u64(t->buf + 8, ts_us);
+    } else {
+        if (ts_us < t->last_ts_us || ts_us - t->last_ts_us > UINT16_MAX) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        dt = (uint16_t)(ts_us - t->last_ts_us);
+    }
+
+    uint8_t *p = t->buf + t->len;
+    _put_u16(p + 0, dt);
+    _put_u16(p + 2, (uint16_t)raw->accel_x);
+    _put_u16(p + 4, (uint16_t)raw->accel_y);
+    _put_u16(p + 6, (uint16_t)raw->accel_z);
+    _put_u16(p + 8, (uint16_t)raw->gyro_x);
+    _put_u16(p + 10, (uint16_t)raw->gyro_y);
+    _put_u16(p + 12, (uint16_t)raw->gyro_z);
+
+    t->len += MPU6050_TELEMETRY_SAMPLE_SIZE;
+    t->count++;
+    t->last_ts_us = ts_us;
+    return ESP_OK;
+}
+
+size_t mpu6050_telemetry_finish(mpu6050_telemetry_t *t)
+{
+    if (t == NULL || t->count == 0) {
+        return 0;
+    }
+    _put_u16(t->buf + 4, t->count);
+    return t->len;
+}
+
+esp_err_t mpu6050_telemetry_parse_header(const uint8_t *buf, size_t len, mpu6050_telemetry_header_t *hdr)
+{
+    if (buf == NULL || hdr == NULL || len < MPU6050_TELEMETRY_HEADER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (_get_u16(buf) != MPU6050_TELEMETRY_MAGIC) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (buf[2] != MPU6050_TELEMETRY_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    hdr->version = buf[2];
+    hdr->flags = buf[3];
+    hdr->count = _get_u16(buf + 4);
+    hdr->base_ts_us = _get_u64(buf + 8);
+    hdr->accel_lsb_per_g = _get_f32(buf + 16);
+    hdr->gyro_lsb_per_dps = _get_f32(buf + 20);
+
+    if (len < MPU6050_TELEMETRY_BUF_SIZE((size_t)hdr->count)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_telemetry_get_sample(const uint8_t *buf, size_t len, uint16_t index,
+                                       mpu6050_raw_data_t *raw, uint64_t *ts_us)
+{
+    mpu6050_telemetry_header_t hdr;
+    esp_err_t err = mpu6050_telemetry_parse_header(buf, len, &hdr);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (index >= hdr.count || raw == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint8_t *samples = buf + MPU6050_TELEMETRY_HEADER_SIZE;
+    if (ts_us != NULL) {
+        uint64_t ts = hdr.base_ts_us;
+        for (uint16_t i = 0; i <= index; i++) {
+            ts += _get_u16(samples + i * MPU6050_TELEMETRY_SAMPLE_SIZE);
+        }
+        *ts_us = ts;
+    }
+
+    const uint8_t *p = samples + index * MPU6050_TELEMETRY_SAMPLE_SIZE;
+    raw->accel_x = (int16_t)_get_u16(p + 2);
+    raw->accel_y = (int16_t)_get_u16(p + 4);
+    raw->accel_z = (int16_t)_get_u16(p + 6);
+    raw->gyro_x = (int16_t)_get_u16(p + 8);
+    raw->gyro_y = (int16_t)_get_u16(p + 10);
+    raw->gyro_z = (int16_t)_get_u16(p + 12);
+    return ESP_OK;
+}
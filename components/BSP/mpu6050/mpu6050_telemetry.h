@@ -0,0 +1,91 @@
+#ifndef __MPU6050_TELEMETRY_H__
+#define __MPU6050_TELEMETRY_H__
+
+#include "esp_err.h"
+#include "mpu6050.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 批量二进制遥测格式（全部小端）
+ *
+ * 头部 24 字节：
+ *   u16 magic (0x364D, "M6")   u8 version   u8 flags
+ *   u16 count                  u16 reserved
+ *   u64 base_ts_us（第一个样本的时间戳）
+ *   f32 accel_lsb_per_g        f32 gyro_lsb_per_dps
+ * 样本 14 字节 × count：
+ *   u16 dt_us（与上一样本的间隔，第一个样本为 0）
+ *   i16 accel_x/y/z            i16 gyro_x/y/z（原始值）
+ */
+#define MPU6050_TELEMETRY_MAGIC         0x364D
+#define MPU6050_TELEMETRY_VERSION       1
+#define MPU6050_TELEMETRY_HEADER_SIZE   24
+#define MPU6050_TELEMETRY_SAMPLE_SIZE   14
+#define MPU6050_TELEMETRY_BUF_SIZE(n)   (MPU6050_TELEMETRY_HEADER_SIZE + (n) * MPU6050_TELEMETRY_SAMPLE_SIZE)
+
+/**
+ * @brief 遥测批次编码器
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    uint16_t count;
+    uint64_t last_ts_us;
+} mpu6050_telemetry_t;
+
+/**
+ * @brief 批次头部（解码用）
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t flags;
+    uint16_t count;
+    uint64_t base_ts_us;
+    float accel_lsb_per_g;
+    float gyro_lsb_per_dps;
+} mpu6050_telemetry_header_t;
+
+/**
+ * @brief 初始化编码器并写入头部
+ *
+ * @param buf 输出缓冲区，大小至少 MPU6050_TELEMETRY_BUF_SIZE(1)
+ * @param accel_lsb_per_g  当前加速度计灵敏度（mpu6050_get_accel_sensitivity）
+ * @param gyro_lsb_per_dps 当前陀螺仪灵敏度（mpu6050_get_gyro_sensitivity）
+ */
+esp_err_t mpu6050_telemetry_init(mpu6050_telemetry_t *t, uint8_t *buf, size_t cap,
+                                 float accel_lsb_per_g, float gyro_lsb_per_dps);
+
+/**
+ * @brief 清空样本，开始新的批次（保留头部中的灵敏度）
+ */
+void mpu6050_telemetry_reset(mpu6050_telemetry_t *t);
+
+/**
+ * @brief 追加一个样本
+ *
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 缓冲区已满，
+ *         ESP_ERR_INVALID_STATE 与上一样本间隔超出 u16 范围（需先发送当前批次）
+ */
+esp_err_t mpu6050_telemetry_add(mpu6050_telemetry_t *t, const mpu6050_raw_data_t *raw, uint64_t ts_us);
+
+/**
+ * @brief 完成批次（回填样本数）
+ *
+ * @return 编码后的字节数，无样本时返回 0
+ */
+size_t mpu6050_telemetry_finish(mpu6050_telemetry_t *t);
+
+/**
+ * @brief 解析批次头部并校验长度
+ */
+esp_err_t mpu6050_telemetry_parse_header(const uint8_t *buf, size_t len, mpu6050_telemetry_header_t *hdr);
+
+/**
+ * @brief 读取第 index 个样本及其绝对时间戳（基准时间加前序间隔之和）
+ */
+esp_err_t mpu6050_telemetry_get_sample(const uint8_t *buf, size_t len, uint16_t index,
+                                       mpu6050_raw_data_t *raw, uint64_t *ts_us);
+
+#endif // __MPU6050_TELEMETRY_H__
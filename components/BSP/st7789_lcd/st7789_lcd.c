@@ -2,10 +2,13 @@
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_commands.h"
 #include "driver/spi_master.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <string.h>
 
 static const char *TAG = "ST7789";
 
@@ -17,11 +20,97 @@ static const char *TAG = "ST7789";
 #define ST7789_DC_PIN                20                     // 数据/命令引脚
 #define ST7789_CS_PIN                -1                     // 片选引脚 (未使用)
 #define LCD_PIXEL_CLOCK_HZ           (40 * 1000 * 1000)     // SPI 时钟频率
-#define LCD_H_RES                    240                    // 水平分辨率
-#define LCD_V_RES                    240                    // 垂直分辨率
+#define LCD_H_RES                    240                    // 水平分辨率（0° 方向）
+#define LCD_V_RES                    240                    // 垂直分辨率（0° 方向）
+#define LCD_GAP                      80                     // 控制器 GRAM(240x320) 与可视区的偏移
+#define LCD_STRIPE_LINES             (LCD_V_RES / 8)        // 条带行数（与 SPI 单次 DMA 上限一致）
+#define LCD_STRIPE_PIXELS            (LCD_H_RES * LCD_STRIPE_LINES)
+#define LCD_DEFAULT_ROTATION         ST7789_LCD_ROTATION_0
+
+// 各旋转方向对应的 MADCTL 设置（MV/MX/MY）及显示偏移
+typedef struct {
+    bool swap_xy;
+    bool mirror_x;
+    bool mirror_y;
+    int gap_x;
+    int gap_y;
+} st7789_lcd_orient_t;
+
+static const st7789_lcd_orient_t s_orient_table[] = {
+    [ST7789_LCD_ROTATION_0]   = { false, true,  true,  0,       LCD_GAP },
+    [ST7789_LCD_ROTATION_90]  = { true,  false, true,  LCD_GAP, 0       },
+    [ST7789_LCD_ROTATION_180] = { false, false, false, 0,       0       },
+    [ST7789_LCD_ROTATION_270] = { true,  true,  false, 0,       0       },
+};
+
+// 显示上下文
+typedef struct {
+    st7789_lcd_rotation_t rotation;
+    int h_res;                      // 当前方向下的宽
+    int v_res;                      // 当前方向下的高
+    uint16_t *stripe_buf[2];        // 条带乒乓缓冲区（DMA 内存，按需分配）
+} st7789_lcd_ctx_t;
 
 static esp_lcd_panel_io_handle_t s_io_handle = NULL;
 static esp_lcd_panel_handle_t s_panel_handle = NULL;
+static st7789_lcd_ctx_t s_ctx = {
+    .rotation = LCD_DEFAULT_ROTATION,
+    .h_res = LCD_H_RES,
+    .v_res = LCD_V_RES,
+};
+
+static esp_err_t _apply_orientation(st7789_lcd_rotation_t rotation)
+{
+    const st7789_lcd_orient_t *o = &s_orient_table[rotation];
+
+    ESP_ERROR_CHECK(esp_lcd_panel_swap_xy(s_panel_handle, o->swap_xy));
+    ESP_ERROR_CHECK(esp_lcd_panel_mirror(s_panel_handle, o->mirror_x, o->mirror_y));
+    ESP_ERROR_CHECK(esp_lcd_panel_set_gap(s_panel_handle, o->gap_x, o->gap_y));
+
+    s_ctx.rotation = rotation;
+    s_ctx.h_res = o->swap_xy ? LCD_V_RES : LCD_H_RES;
+    s_ctx.v_res = o->swap_xy ? LCD_H_RES : LCD_V_RES;
+    return ESP_OK;
+}
+
+// 等待已排队的颜色传输完成（参数类命令会先回收所有在途事务）
+static void _wait_trans_done(void)
+{
+    esp_lcd_panel_io_tx_param(s_io_handle, LCD_CMD_NOP, NULL, 0);
+}
+
+static esp_err_t _stripe_buf_alloc(void)
+{
+    for (int i = 0; i < 2; i++) {
+        if (s_ctx.stripe_buf[i] == NULL) {
+            s_ctx.stripe_buf[i] = heap_caps_malloc(LCD_STRIPE_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA);
+            if (s_ctx.stripe_buf[i] == NULL) {
+                ESP_LOGE(TAG, "条带缓冲区分配失败");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+// 字节序交换（ST7789 大端 <-> CPU 小端）
+static inline uint16_t _swap16(uint16_t v)
+{
+    return (uint16_t)((v >> 8) | (v << 8));
+}
+
+// 双线性插值，输入输出均为交换后的 RGB565，w 为 8 位权重
+static inline uint16_t _lerp565(uint16_t a, uint16_t b, uint32_t w)
+{
+    uint32_t ca = _swap16(a);
+    uint32_t cb = _swap16(b);
+    // 拆成 0x07E0F81F 排列，一次乘法同时插值三个通道
+    ca = (ca | (ca << 16)) & 0x07E0F81F;
+    cb = (cb | (cb << 16)) & 0x07E0F81F;
+    uint32_t w5 = w >> 3;
+    uint32_t c = ((ca * (32 - w5) + cb * w5) >> 5) & 0x07E0F81F;
+    return _swap16((uint16_t)(c | (c >> 16)));
+}
 
 esp_err_t st7789_lcd_init(void)
 {
@@ -58,8 +147,7 @@ esp_err_t st7789_lcd_init(void)
     ESP_ERROR_CHECK(esp_lcd_panel_init(s_panel_handle));                // 初始化 LCD 寄存器
     vTaskDelay(pdMS_TO_TICKS(20)); 
     ESP_ERROR_CHECK(esp_lcd_panel_invert_color(s_panel_handle, true));  // 反转颜色
-    ESP_ERROR_CHECK(esp_lcd_panel_mirror(s_panel_handle, true, true));  // 镜像显示（水平+垂直）
-    ESP_ERROR_CHECK(esp_lcd_panel_set_gap(s_panel_handle, 0, 80));      // 设置显示偏移
+    ESP_ERROR_CHECK(_apply_orientation(LCD_DEFAULT_ROTATION));          // 设置方向（MADCTL + 显示偏移）
     vTaskDelay(pdMS_TO_TICKS(10));
     st7789_lcd_clear_screen(0x0000);
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(s_panel_handle, true));   // 打开显示 
@@ -84,28 +172,186 @@ void st7789_lcd_draw_bitmap(int x1, int y1, int x2, int y2, void *color_data)
 
 void st7789_lcd_clear_screen(uint16_t color)
 {
-    uint16_t *buffer = heap_caps_malloc(LCD_H_RES * sizeof(uint16_t), MALLOC_CAP_DMA);
+    uint16_t *buffer = heap_caps_malloc(s_ctx.h_res * sizeof(uint16_t), MALLOC_CAP_DMA);
     if (!buffer) return;
     
     // ST7789 字节序：需要交换高低字节
-    uint16_t swapped_color = (color >> 8) | (color << 8);
-    for (int i = 0; i < LCD_H_RES; i++) {
+    uint16_t swapped_color = _swap16(color);
+    for (int i = 0; i < s_ctx.h_res; i++) {
         buffer[i] = swapped_color;
     }
     
-    for (int y = 0; y < LCD_V_RES; y++) {
-        esp_lcd_panel_draw_bitmap(s_panel_handle, 0, y, LCD_H_RES, y + 1, buffer);
+    for (int y = 0; y < s_ctx.v_res; y++) {
+        esp_lcd_panel_draw_bitmap(s_panel_handle, 0, y, s_ctx.h_res, y + 1, buffer);
     }
     
+    // 传输是异步的，释放前需等待 DMA 完成
+    _wait_trans_done();
     free(buffer);
 }
 
 int st7789_lcd_get_h_res(void)
 {
-    return LCD_H_RES;
+    return s_ctx.h_res;
 }
 
 int st7789_lcd_get_v_res(void)
 {
-    return LCD_V_RES;
+    return s_ctx.v_res;
+}
+
+void st7789_lcd_wait_trans_done(void)
+{
+    if (s_io_handle != NULL) {
+        _wait_trans_done();
+    }
+}
+
+esp_err_t st7789_lcd_set_rotation(st7789_lcd_rotation_t rotation)
+{
+    if (s_panel_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (rotation > ST7789_LCD_ROTATION_270) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (rotation == s_ctx.rotation) {
+        return ESP_OK;
+    }
+
+    _wait_trans_done();
+    _apply_orientation(rotation);
+
+    ESP_LOGI(TAG, "Rotation: %d, %dx%d", rotation * 90, s_ctx.h_res, s_ctx.v_res);
+    return ESP_OK;
+}
+
+st7789_lcd_rotation_t st7789_lcd_get_rotation(void)
+{
+    return s_ctx.rotation;
+}
+
+esp_err_t st7789_lcd_draw_window(int x, int y, const uint16_t *src, int src_stride,
+                                 int src_x, int src_y, int w, int h)
+{
+    if (s_panel_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (src == NULL || w <= 0 || h <= 0 || src_x < 0 || src_y < 0 || src_stride < src_x + w) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 裁剪到屏幕范围
+    if (x < 0) { src_x -= x; w += x; x = 0; }
+    if (y < 0) { src_y -= y; h += y; y = 0; }
+    if (x + w > s_ctx.h_res) w = s_ctx.h_res - x;
+    if (y + h > s_ctx.v_res) h = s_ctx.v_res - y;
+    if (w <= 0 || h <= 0) {
+        return ESP_OK;
+    }
+
+    const uint16_t *origin = src + src_y * src_stride + src_x;
+
+    // 源数据行连续时直接交给硬件窗口，无需拷贝（DMA 直接读取 src，返回前等待完成）
+    if (w == src_stride) {
+        esp_lcd_panel_draw_bitmap(s_panel_handle, x, y, x + w, y + h, origin);
+        _wait_trans_done();
+        return ESP_OK;
+    }
+
+    esp_err_t err = _stripe_buf_alloc();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    int lines_per_stripe = LCD_STRIPE_PIXELS / w;
+    int idx = 0;
+    for (int row = 0; row < h; row += lines_per_stripe) {
+        int lines = (h - row < lines_per_stripe) ? (h - row) : lines_per_stripe;
+        uint16_t *buf = s_ctx.stripe_buf[idx];
+        for (int i = 0; i < lines; i++) {
+            memcpy(buf + i * w, origin + (row + i) * src_stride, w * sizeof(uint16_t));
+        }
+        esp_lcd_panel_draw_bitmap(s_panel_handle, x, y + row, x + w, y + row + lines, buf);
+        idx ^= 1;
+    }
+    _wait_trans_done();
+
+    return ESP_OK;
+}
+
+esp_err_t st7789_lcd_draw_scaled(int x, int y, int dst_w, int dst_h,
+                                 const uint16_t *src, int src_w, int src_h,
+                                 st7789_lcd_scale_mode_t mode)
+{
+    if (s_panel_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (src == NULL || src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (x < 0 || y < 0 || x + dst_w > s_ctx.h_res || y + dst_h > s_ctx.v_res) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 尺寸一致时退化为普通窗口绘制
+    if (src_w == dst_w && src_h == dst_h) {
+        return st7789_lcd_draw_window(x, y, src, src_w, 0, 0, src_w, src_h);
+    }
+
+    esp_err_t err = _stripe_buf_alloc();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // 16.16 定点步长
+    uint32_t step_x = ((uint32_t)src_w << 16) / dst_w;
+    uint32_t step_y = ((uint32_t)src_h << 16) / dst_h;
+    int lines_per_stripe = LCD_STRIPE_PIXELS / dst_w;
+    int idx = 0;
+
+    for (int row = 0; row < dst_h; row += lines_per_stripe) {
+        int lines = (dst_h - row < lines_per_stripe) ? (dst_h - row) : lines_per_stripe;
+        uint16_t *out = s_ctx.stripe_buf[idx];
+
+        for (int i = 0; i < lines; i++) {
+            int dy = row + i;
+            if (mode == ST7789_LCD_SCALE_NEAREST) {
+                const uint16_t *line = src + ((dy * step_y) >> 16) * src_w;
+                uint32_t fx = 0;
+                for (int dx = 0; dx < dst_w; dx++) {
+                    *out++ = line[fx >> 16];
+                    fx += step_x;
+                }
+            } else {
+                // 像素中心对齐采样
+                int32_t fy = (int32_t)(dy * step_y + (step_y >> 1)) - 0x8000;
+                if (fy < 0) fy = 0;
+                int sy0 = fy >> 16;
+                int sy1 = (sy0 + 1 < src_h) ? sy0 + 1 : sy0;
+                uint32_t wy = (fy >> 8) & 0xFF;
+                const uint16_t *l0 = src + sy0 * src_w;
+                const uint16_t *l1 = src + sy1 * src_w;
+
+                for (int dx = 0; dx < dst_w; dx++) {
+                    int32_t fx = (int32_t)(dx * step_x + (step_x >> 1)) - 0x8000;
+                    if (fx < 0) fx = 0;
+                    int sx0 = fx >> 16;
+                    int sx1 = (sx0 + 1 < src_w) ? sx0 + 1 : sx0;
+                    uint32_t wx = (fx >> 8) & 0xFF;
+                    uint16_t top = _lerp565(l0[sx0], l0[sx1], wx);
+                    uint16_t bottom = _lerp565(l1[sx0], l1[sx1], wx);
+                    *out++ = _lerp565(top, bottom, wy);
+                }
+            }
+        }
+
+        // 乒乓缓冲：下一次绘制会先回收本次传输，之后才覆写另一块缓冲区
+        esp_lcd_panel_draw_bitmap(s_panel_handle, x, y + row, x + dst_w, y + row + lines,
+                                  s_ctx.stripe_buf[idx]);
+        idx ^= 1;
+    }
+    _wait_trans_done();
+
+    return ESP_OK;
 }
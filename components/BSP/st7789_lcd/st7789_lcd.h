@@ -5,6 +5,24 @@
 #include "esp_lcd_panel_io.h"
 #include <stdint.h>
 
+/**
+ * @brief 屏幕旋转方向（通过 MADCTL 由面板硬件完成，不做 CPU 像素旋转）
+ */
+typedef enum {
+    ST7789_LCD_ROTATION_0 = 0,      // 默认方向
+    ST7789_LCD_ROTATION_90,         // 顺时针 90°
+    ST7789_LCD_ROTATION_180,        // 顺时针 180°
+    ST7789_LCD_ROTATION_270,        // 顺时针 270°
+} st7789_lcd_rotation_t;
+
+/**
+ * @brief 缩放插值方式
+ */
+typedef enum {
+    ST7789_LCD_SCALE_NEAREST = 0,   // 最近邻（速度快，适合像素图）
+    ST7789_LCD_SCALE_BILINEAR,      // 双线性（画面平滑，CPU 开销更大）
+} st7789_lcd_scale_mode_t;
+
 esp_err_t st7789_lcd_init(void);
 esp_err_t st7789_lcd_register_trans_done_cb(esp_lcd_panel_io_color_trans_done_cb_t cb, void *user_ctx);
 void st7789_lcd_draw_bitmap(int x1, int y1, int x2, int y2, void *color_data);
@@ -12,4 +30,37 @@ void st7789_lcd_clear_screen(uint16_t color);
 int st7789_lcd_get_h_res(void);
 int st7789_lcd_get_v_res(void);
 
+/**
+ * @brief 等待已提交的绘制（DMA 传输）全部完成
+ */
+void st7789_lcd_wait_trans_done(void);
+
+/**
+ * @brief 设置屏幕旋转方向（运行时切换，宽高随方向更新）
+ */
+esp_err_t st7789_lcd_set_rotation(st7789_lcd_rotation_t rotation);
+st7789_lcd_rotation_t st7789_lcd_get_rotation(void);
+
+/**
+ * @brief 将源图像中的子矩形绘制到屏幕窗口 (x, y)
+ *
+ * @param src      源图像（RGB565，已按 ST7789 要求交换高低字节）
+ * @param src_stride 源图像每行像素数
+ * @param src_x, src_y 子矩形在源图像中的起点
+ * @param w, h     子矩形尺寸（超出屏幕部分会被裁剪）
+ *
+ * @note 同步接口：返回时传输已完成，src 可立即复用或释放
+ */
+esp_err_t st7789_lcd_draw_window(int x, int y, const uint16_t *src, int src_stride,
+                                 int src_x, int src_y, int w, int h);
+
+/**
+ * @brief 将 src_w x src_h 的源图像缩放后绘制到屏幕窗口 (x, y, dst_w, dst_h)
+ *
+ * 按 30 行条带生成并通过 DMA 发送，适合 120x120 等小图全屏显示。
+ */
+esp_err_t st7789_lcd_draw_scaled(int x, int y, int dst_w, int dst_h,
+                                 const uint16_t *src, int src_w, int src_h,
+                                 st7789_lcd_scale_mode_t mode);
+
 #endif /* ST7789_LCD_H */
@@ -0,0 +1,300 @@
+#include "disp_profiler.h"
+#include "lvgl.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+static const char *TAG = "DISP_PROF";
+
+#define DISP_PROFILER_WINDOW            64          // 滚动窗口帧数
+#define DISP_PROFILER_OVERLAY_PERIOD_MS 500         // 浮层刷新周期
+
+typedef struct {
+    uint32_t render_us;
+    uint32_t flush_us;
+    uint32_t dma_us;
+    uint32_t total_us;
+    int64_t end_us;                 // 帧完成时间（用于计算 fps）
+} disp_profiler_frame_t;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_enabled = false;
+
+// 滚动窗口
+static disp_profiler_frame_t s_ring[DISP_PROFILER_WINDOW];
+static uint32_t s_ring_head = 0;
+static uint32_t s_ring_count = 0;
+static uint32_t s_frames = 0;
+
+// 当前帧（仅在 LVGL 任务中访问）
+static disp_profiler_frame_t s_cur;
+static int64_t s_cycle_start_us = 0;
+static int64_t s_frame_start_us = 0;
+static int64_t s_mark_us = 0;               // 上次 flush 返回（或本轮开始）的时间
+static bool s_in_frame = false;
+
+// 等待 DMA 完成的块
+static bool s_pending = false;
+static bool s_pending_last = false;
+static int64_t s_pending_end_us = 0;
+static uint32_t s_pending_seq = 0;
+
+// DMA 完成时间（中断中写入，64 位读写非原子，读写均需持 s_lock）
+static int64_t s_dma_done_us = 0;
+static uint32_t s_dma_done_seq = 0;
+
+static lv_obj_t *s_overlay = NULL;
+static lv_timer_t *s_overlay_timer = NULL;
+
+static void _commit_frame(int64_t end_us)
+{
+    s_cur.end_us = end_us;
+    s_cur.total_us = (uint32_t)(end_us - s_frame_start_us);
+
+    portENTER_CRITICAL(&s_lock);
+    s_ring[s_ring_head] = s_cur;
+    s_ring_head = (s_ring_head + 1) % DISP_PROFILER_WINDOW;
+    if (s_ring_count < DISP_PROFILER_WINDOW) {
+        s_ring_count++;
+    }
+    s_frames++;
+    portEXIT_CRITICAL(&s_lock);
+
+    memset(&s_cur, 0, sizeof(s_cur));
+    s_in_frame = false;
+}
+
+// 结算上一块的 DMA 时间（DMA 尚未完成时返回 false）
+static bool _settle_pending(void)
+{
+    if (!s_pending) {
+        return true;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t done_seq = s_dma_done_seq;
+    int64_t done_us = s_dma_done_us;
+    portEXIT_CRITICAL(&s_lock);
+    if (done_seq == s_pending_seq) {
+        return false;
+    }
+
+    if (done_us > s_pending_end_us) {
+        s_cur.dma_us += (uint32_t)(done_us - s_pending_end_us);
+    }
+    s_pending = false;
+
+    if (s_pending_last) {
+        _commit_frame(done_us > s_pending_end_us ? done_us : s_pending_end_us);
+    }
+    return true;
+}
+
+void disp_profiler_cycle_begin(void)
+{
+    if (!s_enabled) {
+        return;
+    }
+    _settle_pending();
+    s_cycle_start_us = esp_timer_get_time();
+}
+
+void disp_profiler_flush_begin(void)
+{
+    if (!s_enabled) {
+        return;
+    }
+
+    // LVGL 在上一块 flush_ready 之后才会再次 flush，此时上一块 DMA 一定已完成
+    _settle_pending();
+
+    int64_t now = esp_timer_get_time();
+    if (!s_in_frame) {
+        s_in_frame = true;
+        s_frame_start_us = s_cycle_start_us ? s_cycle_start_us : now;
+        s_mark_us = s_frame_start_us;
+    }
+    s_cur.render_us += (uint32_t)(now - s_mark_us);
+    s_mark_us = now;
+    portENTER_CRITICAL(&s_lock);
+    s_pending_seq = s_dma_done_seq;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void disp_profiler_flush_end(bool last)
+{
+    if (!s_enabled || !s_in_frame) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    s_cur.flush_us += (uint32_t)(now - s_mark_us);
+    s_mark_us = now;
+
+    s_pending = true;
+    s_pending_last = last;
+    s_pending_end_us = now;
+}
+
+void disp_profiler_dma_done(void)
+{
+    if (!s_enabled) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&s_lock);
+    s_dma_done_us = now;
+    s_dma_done_seq++;
+    portEXIT_CRITICAL_ISR(&s_lock);
+}
+
+void disp_profiler_enable(bool enable)
+{
+    if (enable && !s_enabled) {
+        disp_profiler_reset();
+    }
+    s_enabled = enable;
+    ESP_LOGI(TAG, "%s", enable ? "Enabled" : "Disabled");
+}
+
+bool disp_profiler_is_enabled(void)
+{
+    return s_enabled;
+}
+
+void disp_profiler_reset(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_ring_head = 0;
+    s_ring_count = 0;
+    s_frames = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    memset(&s_cur, 0, sizeof(s_cur));
+    s_in_frame = false;
+    s_pending = false;
+    s_cycle_start_us = 0;
+}
+
+static int _cmp_u32(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+static void _calc_pct(uint32_t *values, uint32_t n, disp_profiler_pct_t *out)
+{
+    if (n == 0) {
+        return;
+    }
+    qsort(values, n, sizeof(uint32_t), _cmp_u32);
+    out->p50 = values[(n - 1) * 50 / 100] / 1000.0f;
+    out->p90 = values[(n - 1) * 90 / 100] / 1000.0f;
+    out->p99 = values[(n - 1) * 99 / 100] / 1000.0f;
+    out->max = values[n - 1] / 1000.0f;
+}
+
+// 在锁内拷贝窗口中某一字段（按 offsetof 取值），返回样本数
+static uint32_t _collect(size_t field_ofs, uint32_t *values)
+{
+    portENTER_CRITICAL(&s_lock);
+    uint32_t n = s_ring_count;
+    for (uint32_t i = 0; i < n; i++) {
+        values[i] = *(const uint32_t *)((const uint8_t *)&s_ring[i] + field_ofs);
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return n;
+}
+
+esp_err_t disp_profiler_get_stats(disp_profiler_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t values[DISP_PROFILER_WINDOW];
+    int64_t first_end_us, last_end_us;
+
+    memset(stats, 0, sizeof(*stats));
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t n = s_ring_count;
+    stats->frames = s_frames;
+    first_end_us = s_ring[(s_ring_head + DISP_PROFILER_WINDOW - n) % DISP_PROFILER_WINDOW].end_us;
+    last_end_us = s_ring[(s_ring_head + DISP_PROFILER_WINDOW - 1) % DISP_PROFILER_WINDOW].end_us;
+    portEXIT_CRITICAL(&s_lock);
+
+    stats->samples = n;
+    if (n == 0) {
+        return ESP_OK;
+    }
+
+    // 窗口内最旧与最新帧的时间跨度
+    if (n > 1 && last_end_us > first_end_us) {
+        stats->fps = (n - 1) * 1000000.0f / (float)(last_end_us - first_end_us);
+    }
+
+    // 统计过程中可能有新帧写入，以各字段实际拷贝的样本数为准
+    n = _collect(offsetof(disp_profiler_frame_t, render_us), values);
+    _calc_pct(values, n, &stats->render);
+    n = _collect(offsetof(disp_profiler_frame_t, flush_us), values);
+    _calc_pct(values, n, &stats->flush);
+    n = _collect(offsetof(disp_profiler_frame_t, dma_us), values);
+    _calc_pct(values, n, &stats->dma);
+    n = _collect(offsetof(disp_profiler_frame_t, total_us), values);
+    _calc_pct(values, n, &stats->total);
+
+    return ESP_OK;
+}
+
+// 浮层刷新（运行在 LVGL 任务中）
+static void _overlay_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    disp_profiler_stats_t stats;
+    disp_profiler_get_stats(&stats);
+    lv_label_set_text_fmt(s_overlay, "%d fps\nR %d.%d F %d.%d D %d.%d",
+                          (int)(stats.fps + 0.5f),
+                          (int)stats.render.p50, (int)(stats.render.p50 * 10) % 10,
+                          (int)stats.flush.p50, (int)(stats.flush.p50 * 10) % 10,
+                          (int)stats.dma.p50, (int)(stats.dma.p50 * 10) % 10);
+}
+
+esp_err_t disp_profiler_show_overlay(bool show)
+{
+    if (show) {
+        if (s_overlay != NULL) {
+            return ESP_OK;
+        }
+        if (!s_enabled) {
+            disp_profiler_enable(true);
+        }
+
+        s_overlay = lv_label_create(lv_layer_top());
+        if (s_overlay == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        lv_obj_set_style_bg_color(s_overlay, lv_color_black(), 0);
+        lv_obj_set_style_bg_opa(s_overlay, LV_OPA_60, 0);
+        lv_obj_set_style_text_color(s_overlay, lv_color_white(), 0);
+        lv_obj_set_style_pad_all(s_overlay, 2, 0);
+        lv_obj_align(s_overlay, LV_ALIGN_TOP_LEFT, 0, 0);
+        lv_label_set_text(s_overlay, "-- fps");
+
+        s_overlay_timer = lv_timer_create(_overlay_timer_cb, DISP_PROFILER_OVERLAY_PERIOD_MS, NULL);
+    } else {
+        if (s_overlay_timer != NULL) {
+            lv_timer_del(s_overlay_timer);
+            s_overlay_timer = NULL;
+        }
+        if (s_overlay != NULL) {
+            lv_obj_del(s_overlay);
+            s_overlay = NULL;
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,55 @@
+#ifndef DISP_PROFILER_H
+#define DISP_PROFILER_H
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief 单个阶段的分位统计（单位 ms）
+ */
+typedef struct {
+    float p50;
+    float p90;
+    float p99;
+    float max;
+} disp_profiler_pct_t;
+
+/**
+ * @brief 帧耗时统计（最近 DISP_PROFILER_WINDOW 帧）
+ *
+ * render: LVGL 渲染（两次 flush 之间的时间，含等待上一块 DMA）
+ * flush:  _flush_cb 内提交绘制命令的时间
+ * dma:    flush 返回到 DMA 传输完成的时间
+ * total:  一帧从 lv_timer_handler 开始到最后一块 DMA 完成
+ */
+typedef struct {
+    uint32_t frames;                // 累计帧数
+    uint32_t samples;               // 窗口内有效样本数
+    float fps;                      // 窗口内平均帧率
+    disp_profiler_pct_t render;
+    disp_profiler_pct_t flush;
+    disp_profiler_pct_t dma;
+    disp_profiler_pct_t total;
+} disp_profiler_stats_t;
+
+/**
+ * @brief 启用/停用统计（默认停用，停用时各钩子只有一次判断开销）
+ */
+void disp_profiler_enable(bool enable);
+bool disp_profiler_is_enabled(void);
+void disp_profiler_reset(void);
+esp_err_t disp_profiler_get_stats(disp_profiler_stats_t *stats);
+
+/**
+ * @brief 显示/隐藏左上角的 fps 与各阶段耗时浮层（需持有 lvgl_port 锁）
+ */
+esp_err_t disp_profiler_show_overlay(bool show);
+
+/* ---------- 以下钩子由 lvgl_port 调用 ---------- */
+void disp_profiler_cycle_begin(void);           // lv_timer_handler 之前
+void disp_profiler_flush_begin(void);           // _flush_cb 入口
+void disp_profiler_flush_end(bool last);        // _flush_cb 返回前，last 表示一帧的最后一块
+void disp_profiler_dma_done(void);              // DMA 完成回调（中断上下文）
+
+#endif /* DISP_PROFILER_H */
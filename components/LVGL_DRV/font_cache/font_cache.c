@@ -0,0 +1,353 @@
+#include "font_cache.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "FONT_CACHE";
+
+#define FONT_CACHE_EMPTY_LETTER     0           // 空槽标记（字符 0 不会被绘制）
+
+typedef struct {
+    uint32_t letter;
+    uint32_t offset;        // 位图在 arena 中的偏移
+    uint16_t box_w;
+    uint16_t box_h;
+    bool fresh;             // 由 LVGL 排版查询加入，已计为 miss，首次取位图不再计 hit
+} font_cache_entry_t;
+
+struct font_cache_t {
+    lv_font_t font;                 // 对外提供的包装字体
+    const lv_font_t *base;          // 原始字体
+    font_cache_entry_t *table;      // 开放寻址哈希表
+    uint32_t table_mask;
+    uint32_t max_glyphs;
+    uint8_t *arena;                 // 8bpp 位图区
+    size_t arena_size;
+    size_t arena_used;
+    font_cache_stats_t stats;
+};
+
+static inline uint32_t _hash(uint32_t letter)
+{
+    return letter * 2654435761u;
+}
+
+static font_cache_entry_t *_lookup(struct font_cache_t *cache, uint32_t letter)
+{
+    uint32_t i = _hash(letter) & cache->table_mask;
+    while (cache->table[i].letter != FONT_CACHE_EMPTY_LETTER) {
+        if (cache->table[i].letter == letter) {
+            return &cache->table[i];
+        }
+        i = (i + 1) & cache->table_mask;
+    }
+    return NULL;
+}
+
+// 将原字体位图（1/2/4/8bpp，按位连续存放）展开为 8bpp
+static void _expand_a8(const uint8_t *src, uint8_t bpp, uint8_t *dst, uint32_t px_cnt)
+{
+    if (bpp == 8) {
+        memcpy(dst, src, px_cnt);
+        return;
+    }
+
+    uint32_t max_val = (1u << bpp) - 1;
+    uint32_t bit = 0;
+    for (uint32_t i = 0; i < px_cnt; i++) {
+        uint32_t shift = 8 - bpp - (bit & 7);
+        uint32_t v = (src[bit >> 3] >> shift) & max_val;
+        dst[i] = (uint8_t)(v * 255 / max_val);
+        bit += bpp;
+    }
+}
+
+static inline bool _bpp_ok(uint8_t bpp)
+{
+    return bpp == 1 || bpp == 2 || bpp == 4 || bpp == 8;
+}
+
+// 光栅化字形并加入缓存（调用方已确认未命中）；缓存不可用时返回 NULL
+static font_cache_entry_t *_insert(struct font_cache_t *cache, uint32_t letter, const lv_font_glyph_dsc_t *dsc)
+{
+    uint32_t px_cnt = (uint32_t)dsc->box_w * dsc->box_h;
+    if (!_bpp_ok(dsc->bpp) || dsc->is_placeholder || cache->stats.glyphs >= cache->max_glyphs ||
+        cache->arena_used + px_cnt > cache->arena_size) {
+        return NULL;
+    }
+
+    const uint8_t *src = NULL;
+    if (px_cnt > 0) {
+        src = cache->base->get_glyph_bitmap(cache->base, letter);
+        if (src == NULL) {
+            return NULL;
+        }
+    }
+
+    font_cache_entry_t *e;
+
+    uint32_t i = _hash(letter) & cache->table_mask;
+    while (cache->table[i].letter != FONT_CACHE_EMPTY_LETTER) {
+        i = (i + 1) & cache->table_mask;
+    }
+    e = &cache->table[i];
+    e->letter = letter;
+    e->offset = cache->arena_used;
+    e->box_w = dsc->box_w;
+    e->box_h = dsc->box_h;
+    e->fresh = false;
+
+    if (px_cnt > 0) {
+        _expand_a8(src, dsc->bpp, cache->arena + e->offset, px_cnt);
+    }
+    cache->arena_used += px_cnt;
+    cache->stats.glyphs++;
+    cache->stats.misses++;
+    return e;
+}
+
+static inline void _count_hit(struct font_cache_t *cache, font_cache_entry_t *e)
+{
+    if (e->fresh) {
+        e->fresh = false;
+    } else {
+        cache->stats.hits++;
+    }
+}
+
+// 绘制时取字形：命中、新光栅化、旁路三者每次绘制只计一次
+static font_cache_entry_t *_fetch(struct font_cache_t *cache, uint32_t letter, const lv_font_glyph_dsc_t *dsc)
+{
+    font_cache_entry_t *e = _lookup(cache, letter);
+    if (e != NULL) {
+        _count_hit(cache, e);
+        return e;
+    }
+
+    e = _insert(cache, letter, dsc);
+    if (e == NULL) {
+        cache->stats.bypass++;
+    }
+    return e;
+}
+
+static bool _get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    struct font_cache_t *cache = font->user_data;
+
+    // 字距调整由原字体计算，缓存只负责位图
+    if (!cache->base->get_glyph_dsc(cache->base, dsc, letter, letter_next)) {
+        return false;
+    }
+
+    // LVGL 排版和绘制会对同一字形多次查询描述，这里不计 hit/bypass，统一在取位图时计数
+    font_cache_entry_t *e = _lookup(cache, letter);
+    if (e == NULL) {
+        e = _insert(cache, letter, dsc);
+        if (e != NULL) {
+            e->fresh = true;
+        }
+    }
+    if (e != NULL) {
+        dsc->bpp = 8;
+    }
+    return true;
+}
+
+static const uint8_t *_get_glyph_bitmap(const lv_font_t *font, uint32_t letter)
+{
+    struct font_cache_t *cache = font->user_data;
+
+    font_cache_entry_t *e = _lookup(cache, letter);
+    if (e != NULL) {
+        _count_hit(cache, e);
+        return cache->arena + e->offset;
+    }
+    cache->stats.bypass++;
+    return cache->base->get_glyph_bitmap(cache->base, letter);
+}
+
+esp_err_t font_cache_create(const lv_font_t *base, uint32_t max_glyphs, size_t arena_size,
+                            font_cache_handle_t *ret)
+{
+    if (base == NULL || ret == NULL || max_glyphs == 0 || arena_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct font_cache_t *cache = calloc(1, sizeof(struct font_cache_t));
+    if (cache == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 哈希表容量取 2 的幂且不低于 2 倍字形数，保证探测链较短
+    uint32_t table_size = 1;
+    while (table_size < max_glyphs * 2) {
+        table_size <<= 1;
+    }
+
+    cache->table = calloc(table_size, sizeof(font_cache_entry_t));
+#if CONFIG_SPIRAM
+    cache->arena = heap_caps_malloc(arena_size, MALLOC_CAP_SPIRAM);
+#else
+    cache->arena = malloc(arena_size);
+#endif
+    if (cache->table == NULL || cache->arena == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate cache (%u bytes)", (unsigned)arena_size);
+        font_cache_delete(cache);
+        return ESP_ERR_NO_MEM;
+    }
+
+    cache->base = base;
+    cache->table_mask = table_size - 1;
+    cache->max_glyphs = max_glyphs;
+    cache->arena_size = arena_size;
+    cache->stats.bytes_total = arena_size;
+
+    // 复制字体度量信息，替换字形回调
+    cache->font = *base;
+    cache->font.get_glyph_dsc = _get_glyph_dsc;
+    cache->font.get_glyph_bitmap = _get_glyph_bitmap;
+    cache->font.user_data = cache;
+
+    *ret = cache;
+    ESP_LOGI(TAG, "Created: %u glyphs, %u bytes", (unsigned)max_glyphs, (unsigned)arena_size);
+    return ESP_OK;
+}
+
+void font_cache_delete(font_cache_handle_t cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+    free(cache->table);
+    free(cache->arena);
+    free(cache);
+}
+
+const lv_font_t *font_cache_get_font(font_cache_handle_t cache)
+{
+    return cache ? &cache->font : NULL;
+}
+
+esp_err_t font_cache_preload(font_cache_handle_t cache, const char *utf8)
+{
+    if (cache == NULL || utf8 == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t i = 0;
+    uint32_t letter;
+    while ((letter = _lv_txt_encoded_next(utf8, &i)) != 0) {
+        lv_font_glyph_dsc_t dsc;
+        if (_lookup(cache, letter) == NULL && cache->base->get_glyph_dsc(cache->base, &dsc, letter, 0)) {
+            _insert(cache, letter, &dsc);
+        }
+    }
+
+    ESP_LOGI(TAG, "Preloaded: %u glyphs, %u/%u bytes", (unsigned)cache->stats.glyphs,
+             (unsigned)cache->arena_used, (unsigned)cache->arena_size);
+    return ESP_OK;
+}
+
+// alpha 混合，dst 为交换后的 RGB565，fg 为未交换的 RGB565
+static inline uint16_t _blend565(uint16_t dst, uint32_t fg, uint8_t alpha)
+{
+    uint32_t bg = (uint16_t)((dst >> 8) | (dst << 8));
+    bg = (bg | (bg << 16)) & 0x07E0F81F;
+    uint32_t a5 = (alpha + 4) >> 3;
+    uint32_t c = ((fg * a5 + bg * (32 - a5)) >> 5) & 0x07E0F81F;
+    c = c | (c >> 16);
+    return (uint16_t)((c >> 8) | (c << 8));
+}
+
+// 缓存未命中且无法加入时，按原字体 bpp 直接混合（1/2/4/8bpp，按位连续存放）
+static void _draw_packed(uint16_t *buf, int buf_w, int buf_h, int gx, int gy,
+                         const uint8_t *bmp, const lv_font_glyph_dsc_t *dsc, uint32_t fg)
+{
+    uint8_t bpp = dsc->bpp;
+    uint32_t max_val = (1u << bpp) - 1;
+    for (int row = 0; row < dsc->box_h; row++) {
+        int py = gy + row;
+        if (py < 0 || py >= buf_h) {
+            continue;
+        }
+        uint16_t *dst = buf + py * buf_w;
+        uint32_t bit = (uint32_t)row * dsc->box_w * bpp;
+        for (int col = 0; col < dsc->box_w; col++, bit += bpp) {
+            int px = gx + col;
+            if (px < 0 || px >= buf_w) {
+                continue;
+            }
+            uint32_t v = (bmp[bit >> 3] >> (8 - bpp - (bit & 7))) & max_val;
+            if (v != 0) {
+                dst[px] = _blend565(dst[px], fg, (uint8_t)(v * 255 / max_val));
+            }
+        }
+    }
+}
+
+esp_err_t font_cache_draw_text(font_cache_handle_t cache, uint16_t *buf, int buf_w, int buf_h,
+                               int x, int y, const char *utf8, uint16_t color)
+{
+    if (cache == NULL || buf == NULL || utf8 == NULL || buf_w <= 0 || buf_h <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const lv_font_t *font = cache->base;
+    uint32_t fg = ((uint32_t)color | ((uint32_t)color << 16)) & 0x07E0F81F;
+    int baseline_y = y + (font->line_height - font->base_line);
+
+    uint32_t i = 0;
+    uint32_t letter = _lv_txt_encoded_next(utf8, &i);
+    while (letter != 0) {
+        uint32_t letter_next = _lv_txt_encoded_next(utf8, &i);
+
+        lv_font_glyph_dsc_t dsc;
+        if (!font->get_glyph_dsc(font, &dsc, letter, letter_next)) {
+            letter = letter_next;
+            continue;
+        }
+
+        font_cache_entry_t *e = _fetch(cache, letter, &dsc);
+        if (e != NULL && e->box_w > 0) {
+            const uint8_t *bmp = cache->arena + e->offset;
+            int gx = x + dsc.ofs_x;
+            int gy = baseline_y - dsc.box_h - dsc.ofs_y;
+
+            for (int row = 0; row < e->box_h; row++) {
+                int py = gy + row;
+                if (py < 0 || py >= buf_h) {
+                    continue;
+                }
+                uint16_t *dst = buf + py * buf_w;
+                const uint8_t *a = bmp + row * e->box_w;
+                for (int col = 0; col < e->box_w; col++) {
+                    int px = gx + col;
+                    if (px < 0 || px >= buf_w || a[col] == 0) {
+                        continue;
+                    }
+                    dst[px] = _blend565(dst[px], fg, a[col]);
+                }
+            }
+        } else if (e == NULL && dsc.box_w > 0 && !dsc.is_placeholder && _bpp_ok(dsc.bpp)) {
+            const uint8_t *bmp = font->get_glyph_bitmap(font, letter);
+            if (bmp != NULL) {
+                _draw_packed(buf, buf_w, buf_h, x + dsc.ofs_x, baseline_y - dsc.box_h - dsc.ofs_y, bmp, &dsc, fg);
+            }
+        }
+
+        x += dsc.adv_w;
+        letter = letter_next;
+    }
+
+    return ESP_OK;
+}
+
+void font_cache_get_stats(font_cache_handle_t cache, font_cache_stats_t *stats)
+{
+    if (cache == NULL || stats == NULL) {
+        return;
+    }
+    *stats = cache->stats;
+    stats->bytes_used = cache->arena_used;
+}
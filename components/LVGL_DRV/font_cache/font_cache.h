@@ -0,0 +1,63 @@
+#ifndef FONT_CACHE_H
+#define FONT_CACHE_H
+
+#include "lvgl.h"
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct font_cache_t *font_cache_handle_t;
+
+/**
+ * @brief 字形缓存统计
+ */
+typedef struct {
+    uint32_t hits;          // 命中次数（每次绘制字形计一次）
+    uint32_t misses;        // 未命中次数（已光栅化并加入缓存）
+    uint32_t bypass;        // 缓存已满或格式不支持，按原字体 bpp 绘制的次数
+    uint32_t glyphs;        // 当前缓存字形数
+    size_t bytes_used;      // 位图区已用字节数
+    size_t bytes_total;     // 位图区总字节数
+} font_cache_stats_t;
+
+/**
+ * @brief 为字体创建字形缓存（位图预展开为 8bpp 灰度并存放在 PSRAM）
+ *
+ * 通过 font_cache_get_font() 取得包装后的字体，可直接用于 LVGL 样式；
+ * 与 LVGL 共用时，所有接口都需在 lvgl_port 锁内调用。
+ *
+ * @param base       原始字体（如 lv_font_montserrat_14、CJK 字体）
+ * @param max_glyphs 最多缓存的字形数
+ * @param arena_size 位图区大小（字节）
+ * @param ret        返回缓存句柄
+ */
+esp_err_t font_cache_create(const lv_font_t *base, uint32_t max_glyphs, size_t arena_size,
+                            font_cache_handle_t *ret);
+void font_cache_delete(font_cache_handle_t cache);
+
+/**
+ * @brief 获取带缓存的字体
+ */
+const lv_font_t *font_cache_get_font(font_cache_handle_t cache);
+
+/**
+ * @brief 预先光栅化文本中的所有字形（用于界面常用的中文等）
+ */
+esp_err_t font_cache_preload(font_cache_handle_t cache, const char *utf8);
+
+/**
+ * @brief 不经过 LVGL，直接将文本以 alpha 混合方式绘制到 RGB565 缓冲区
+ *
+ * 缓冲区字节序与 st7789_lcd 一致（高低字节已交换），可直接用 st7789_lcd_draw_window 发送。
+ *
+ * @param buf    目标缓冲区
+ * @param buf_w, buf_h 缓冲区尺寸
+ * @param x, y   文本左上角
+ * @param color  文字颜色（RGB565，未交换）
+ */
+esp_err_t font_cache_draw_text(font_cache_handle_t cache, uint16_t *buf, int buf_w, int buf_h,
+                               int x, int y, const char *utf8, uint16_t color);
+
+void font_cache_get_stats(font_cache_handle_t cache, font_cache_stats_t *stats);
+
+#endif /* FONT_CACHE_H */
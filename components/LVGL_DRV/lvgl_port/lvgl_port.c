@@ -1,5 +1,6 @@
 #include "lvgl_port.h"
 #include "st7789_lcd.h"
+#include "disp_profiler.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
@@ -21,6 +22,7 @@ static lv_disp_drv_t s_disp_drv;
 // DMA 传输完成回调（通知 LVGL 刷新已完成）
 static bool _lcd_dma_trans_done_cb(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
 {
+    disp_profiler_dma_done();
     lv_disp_flush_ready(&s_disp_drv);
     return false;
 }
@@ -28,7 +30,9 @@ static bool _lcd_dma_trans_done_cb(esp_lcd_panel_io_handle_t panel_io, esp_lcd_p
 // LVGL 刷新回调
 static void _flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
+    disp_profiler_flush_begin();
     st7789_lcd_draw_bitmap(area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_map);
+    disp_profiler_flush_end(lv_disp_flush_is_last(drv));
 }
 
 // LVGL 时钟回调
@@ -45,6 +49,7 @@ static void _task(void *arg)
     
     while (1) {
         if (xSemaphoreTake(s_lvgl_mux, portMAX_DELAY) == pdTRUE) {
+            disp_profiler_cycle_begin();
             delay_ms = lv_timer_handler();
             xSemaphoreGive(s_lvgl_mux);
         }
@@ -1,20 +1,700 @@
 #include "mqtt_app.h"
 #include "mqtt_app_config.h"
+#include "mqtt_router.h"
+#include "mqtt_outbox.h"
+#include "mqtt_loopback.h"
+#include "mqtt_compress.h"
 #include "mqtt_client.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#if !MQTT_APP_LOOPBACK
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_netif.h"
+#include "freertos/timers.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "mqtt_app";
 
+#if !MQTT_APP_LOOPBACK
 static esp_mqtt_client_handle_t s_hmqtt = NULL;
+#endif
 static bool s_inited = false;
 static volatile bool s_connected = false;
 
+// 连接管理：自动重连由本模块按指数退避驱动，网络恢复时立即重连
+#if !MQTT_APP_LOOPBACK
+static char s_client_id[48];
+static TimerHandle_t s_reconnect_timer = NULL;
+#endif
+static uint32_t s_reconnect_attempts = 0;
+static mqtt_app_conn_stats_t s_conn_stats = {0};
+static int64_t s_attempt_us = 0;            // 本次连接尝试开始
+static int64_t s_connected_us = 0;          // 最近一次连上
+static int64_t s_down_us = 0;               // 最近一次断开（0 表示未曾连上）
+static int64_t s_net_up_us = 0;             // 最近一次获取 IP
+static volatile bool s_first_pub_pending = false;
+// 就绪通知：等待者阻塞在事件组上，回调在连接状态变化时调用
+// s_conn_lock 串行化状态通知与回调注册：注册时的首次回调与后续通知不会交错或乱序
+#define MQTT_APP_CONNECTED_BIT  (1 << 0)
+
+typedef struct {
+    mqtt_app_conn_cb_t cb;
+    void *user_ctx;
+} conn_listener_t;
+
+static EventGroupHandle_t s_conn_events = NULL;
+static SemaphoreHandle_t s_conn_lock = NULL;
+static conn_listener_t s_conn_listeners[MQTT_APP_CONN_CB_MAX];
+
+static int s_resub_last_id = -1;            // 重新订阅的最后一个 msg_id（SUBACK 按序返回）
+static uint32_t s_resub_count = 0;
+
 static mqtt_data_handler_t s_data_handler = NULL;
+static mqtt_stripe_handler_t s_stripe_handler = NULL;
+static const mqtt_app_report_hooks_t *s_report = NULL;
+
+// 重组槽位状态
+typedef enum {
+    SLOT_FREE = 0,      // 空闲
+    SLOT_FILLING,       // 正在接收分片
+    SLOT_READY,         // 已完整，等待消费任务处理
+    SLOT_BUSY,          // 消费者处理中（条带模式下为绘制中）
+} frame_slot_state_t;
+
+typedef struct {
+    uint8_t *buf;               // 按消息大小分配，槽位释放时归还
+    size_t size;                // 消息字节数（压缩帧为解压后大小）
+    size_t len;                 // 已写入字节数（压缩帧为已解压字节数）
+    size_t wire_len;            // 已接收的负载字节数
+    size_t pix_off;             // 像素数据偏移（图像头长度，旧格式为 0）
+    size_t stripe_sent;         // 已交付的像素字节数
+    mqtt_app_img_rect_t rect;   // 图像区域（解析图像头之前 w 为 0）
+    frame_slot_state_t state;
+    bool aborted;               // 条带已交付但中途中止
+    uint32_t seq;               // 帧序号（用于识别最旧帧，按序交付）
+    int64_t start_us;           // 首个分片到达时间
+} frame_slot_t;
+
+static portMUX_TYPE s_slot_lock = portMUX_INITIALIZER_UNLOCKED;
+static frame_slot_t s_slots[MQTT_APP_FRAME_SLOTS];
+static frame_slot_t *s_cur_slot = NULL;     // 当前接收中的槽位
+static bool s_skip_msg = false;             // 当前消息已被丢弃，忽略其余分片
+static uint32_t s_frame_seq = 0;
+static TaskHandle_t s_frame_task = NULL;    // 帧消费任务（READY 槽位即待交付帧，有新帧时通知）
+static mqtt_app_drop_policy_t s_drop_policy = MQTT_APP_FRAME_DROP_POLICY;
+
+static mqtt_app_img_stats_t s_img_stats = {0};
+
+#if MQTT_APP_IMG_COMPRESSED
+static mqtt_decomp_t s_decomp;              // 当前帧的流式解压状态
+#endif
+
+// 当前消息的主题与匹配到的路由
+static char s_cur_topic[MQTT_APP_TOPIC_MAX_LEN];
+static mqtt_route_t *s_cur_routes[MQTT_ROUTER_MAX_MATCH];
+static int s_cur_route_cnt = 0;
+static uint64_t s_latency_sum_us = 0;
+
+static void _record_latency(const frame_slot_t *slot)
+{
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - slot->start_us);
+    s_img_stats.frames++;
+    s_img_stats.last_latency_us = latency_us;
+    s_latency_sum_us += latency_us;
+    s_img_stats.avg_latency_us = (uint32_t)(s_latency_sum_us / s_img_stats.frames);
+
+    ESP_LOGI(TAG, "帧完成: 接收 %lu ms, 延迟 %lu ms",
+             s_img_stats.last_recv_us / 1000, latency_us / 1000);
+}
+
+// 重组缓冲区：小区域更新放在内部 RAM，其余放在 PSRAM
+static uint8_t *_img_alloc(size_t size)
+{
+    uint8_t *buf = NULL;
+    if (size <= MQTT_APP_IMG_INTERNAL_MAX) {
+        buf = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    }
+    if (buf == NULL) {
+        buf = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    }
+    return buf;
+}
+
+// 归还槽位（先释放缓冲区，再标记空闲）
+static void _release_slot(frame_slot_t *slot)
+{
+    heap_caps_free(slot->buf);
+    slot->buf = NULL;
+    portENTER_CRITICAL(&s_slot_lock);
+    slot->state = SLOT_FREE;
+    portEXIT_CRITICAL(&s_slot_lock);
+}
+
+// 条带模式下槽位由消费者释放，drop-oldest 无帧可回收
+static void _warn_drop_policy(void)
+{
+    if (s_stripe_handler && s_drop_policy == MQTT_APP_DROP_OLDEST) {
+        ESP_LOGW(TAG, "条带模式下 drop-oldest 不生效，槽位耗尽时丢弃新消息");
+    }
+}
+
+// 为新消息申请槽位，槽位耗尽时按策略丢帧（只有整帧模式的 READY 槽位可被回收）
+static frame_slot_t *_acquire_slot(size_t size)
+{
+    frame_slot_t *slot = NULL;
+    frame_slot_t *oldest = NULL;
+    uint8_t *stale = NULL;
+
+    portENTER_CRITICAL(&s_slot_lock);
+    for (int i = 0; i < MQTT_APP_FRAME_SLOTS; i++) {
+        if (s_slots[i].state == SLOT_FREE) {
+            slot = &s_slots[i];
+            break;
+        }
+        if (s_slots[i].state == SLOT_READY && (oldest == NULL || s_slots[i].seq < oldest->seq)) {
+            oldest = &s_slots[i];
+        }
+    }
+
+    // 回收尚未被消费的最旧帧（READY 状态只存在于槽位中，回收后不会再被交付）
+    if (slot == NULL && s_drop_policy == MQTT_APP_DROP_OLDEST && oldest != NULL) {
+        slot = oldest;
+        s_img_stats.dropped++;
+    }
+
+    if (slot != NULL) {
+        stale = slot->buf;
+        slot->buf = NULL;
+        slot->state = SLOT_FILLING;
+        slot->size = size;
+        slot->len = 0;
+        slot->wire_len = 0;
+        slot->pix_off = 0;
+        slot->stripe_sent = 0;
+        slot->rect.w = 0;
+        slot->aborted = false;
+        slot->seq = ++s_frame_seq;
+        slot->start_us = esp_timer_get_time();
+    } else {
+        s_img_stats.dropped++;
+    }
+    portEXIT_CRITICAL(&s_slot_lock);
+
+    if (slot == NULL) {
+        return NULL;
+    }
+
+    // 堆操作不能放在临界区内：被回收帧的缓冲区在这里释放
+    heap_caps_free(stale);
+    slot->buf = _img_alloc(size);
+    if (slot->buf == NULL) {
+        ESP_LOGE(TAG, "重组缓冲区分配失败 (%u 字节)", size);
+        _release_slot(slot);
+        s_img_stats.dropped++;
+        return NULL;
+    }
+    return slot;
+}
+
+// 中止当前帧（已交付过条带时通知消费者释放；通知未送达时直接归还槽位）
+static void _abort_frame(void)
+{
+    frame_slot_t *slot = s_cur_slot;
+    s_cur_slot = NULL;
+    if (slot == NULL) {
+        return;
+    }
+
+    s_img_stats.partial++;
+    if (s_stripe_handler && slot->stripe_sent > 0) {
+        // 槽位保持占用，直到消费者调用 mqtt_app_frame_release
+        slot->aborted = true;
+        slot->state = SLOT_BUSY;
+        if (s_stripe_handler(NULL, &slot->rect, true) == ESP_OK) {
+            return;
+        }
+        // 消费者收不到中止通知就不会释放，槽位将永远占用
+        ESP_LOGW(TAG, "中止通知未送达，直接释放槽位");
+    }
+    _release_slot(slot);
+}
+
+// 解析图像头，确定绘制区域与像素偏移（不带头的整屏消息按旧格式处理）
+static esp_err_t _parse_img_header(frame_slot_t *slot)
+{
+    const uint8_t *p = slot->buf;
+    mqtt_app_img_rect_t rect = {0};
+    size_t pix_off = 0;
+
+    if (slot->size >= MQTT_APP_IMG_HDR_LEN && p[0] == MQTT_APP_IMG_MAGIC0 && p[1] == MQTT_APP_IMG_MAGIC1) {
+        rect.format = p[2];
+        rect.x = p[4] | (p[5] << 8);
+        rect.y = p[6] | (p[7] << 8);
+        rect.w = p[8] | (p[9] << 8);
+        rect.h = p[10] | (p[11] << 8);
+        pix_off = MQTT_APP_IMG_HDR_LEN;
+    }
+
+    bool valid = (rect.format == MQTT_APP_IMG_FMT_RGB565 && rect.w > 0 && rect.h > 0 &&
+                  rect.x + rect.w <= MQTT_APP_IMG_WIDTH && rect.y + rect.h <= MQTT_APP_IMG_HEIGHT &&
+                  pix_off + (size_t)rect.w * rect.h * MQTT_APP_IMG_PIXEL_SIZE == slot->size);
+    if (!valid) {
+        if (slot->size != MQTT_APP_IMG_BUF_SIZE) {
+            ESP_LOGW(TAG, "图像头无效 (%u,%u %ux%u 格式 %u, 消息 %u 字节)",
+                     rect.x, rect.y, rect.w, rect.h, rect.format, slot->size);
+            return ESP_ERR_INVALID_ARG;
+        }
+        rect = (mqtt_app_img_rect_t){
+            .w = MQTT_APP_IMG_WIDTH,
+            .h = MQTT_APP_IMG_HEIGHT,
+            .format = MQTT_APP_IMG_FMT_RGB565,
+        };
+        pix_off = 0;
+    }
+
+    slot->rect = rect;
+    slot->pix_off = pix_off;
+    return ESP_OK;
+}
+
+// 将已凑齐的条带交给消费者（条带为整行，行宽取自图像头），消费者拒收时返回其错误码
+static esp_err_t _deliver_stripes(frame_slot_t *slot)
+{
+    size_t row_bytes = (size_t)slot->rect.w * MQTT_APP_IMG_PIXEL_SIZE;
+    size_t stripe_size = row_bytes * MQTT_APP_IMG_STRIPE_LINES;
+    size_t pix_total = slot->size - slot->pix_off;
+    size_t pix_ready = slot->len - slot->pix_off;
+
+    while (slot->stripe_sent < pix_total) {
+        size_t n = pix_total - slot->stripe_sent;
+        if (n > stripe_size) {
+            n = stripe_size;
+        }
+        if (slot->stripe_sent + n > pix_ready) {
+            break;
+        }
+
+        mqtt_app_img_rect_t rect = slot->rect;
+        rect.y += slot->stripe_sent / row_bytes;
+        rect.h = n / row_bytes;
+        bool last = (slot->stripe_sent + n == pix_total);
+        esp_err_t err = s_stripe_handler(slot->buf + slot->pix_off + slot->stripe_sent, &rect, last);
+        if (err != ESP_OK) {
+            return err;
+        }
+        slot->stripe_sent += n;
+    }
+    return ESP_OK;
+}
+
+// 整帧接收完成
+static void _complete_frame(frame_slot_t *slot)
+{
+    s_img_stats.last_recv_us = (uint32_t)(esp_timer_get_time() - slot->start_us);
+    s_cur_slot = NULL;
+
+    // 条带模式：槽位在 mqtt_app_frame_release 时释放
+    if (s_stripe_handler) {
+        slot->state = SLOT_BUSY;
+        return;
+    }
+
+    portENTER_CRITICAL(&s_slot_lock);
+    slot->state = SLOT_READY;
+    portEXIT_CRITICAL(&s_slot_lock);
+    xTaskNotifyGive(s_frame_task);
+}
+
+// 取出最旧的待交付帧并标记为处理中
+static frame_slot_t *_take_ready_slot(void)
+{
+    frame_slot_t *slot = NULL;
+
+    portENTER_CRITICAL(&s_slot_lock);
+    for (int i = 0; i < MQTT_APP_FRAME_SLOTS; i++) {
+        if (s_slots[i].state == SLOT_READY && (slot == NULL || s_slots[i].seq < slot->seq)) {
+            slot = &s_slots[i];
+        }
+    }
+    if (slot != NULL) {
+        slot->state = SLOT_BUSY;
+    }
+    portEXIT_CRITICAL(&s_slot_lock);
+    return slot;
+}
+
+// 帧消费任务：在 MQTT 任务之外调用数据处理回调
+static void _frame_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 一次通知可能对应多帧；已被 drop-oldest 回收的帧不再是 READY
+        frame_slot_t *slot;
+        while ((slot = _take_ready_slot()) != NULL) {
+            if (s_data_handler) {
+                s_data_handler(slot->buf + slot->pix_off, slot->size - slot->pix_off, &slot->rect);
+            }
+            _record_latency(slot);
+            _release_slot(slot);
+        }
+    }
+}
+
+// 图像主题的分片处理（作为 stream 路由注册，数据直接拷入重组槽位）
+static esp_err_t _image_fragment_handler(const char *topic, const uint8_t *data, size_t len,
+                                         size_t offset, size_t total_len, void *user_ctx)
+{
+    (void)user_ctx;
+
+    // 尚未注册数据/条带回调（仅 mqtt_app_subscribe 订阅了主题）：没有消费者，直接丢弃
+    if (s_frame_task == NULL) {
+        return ESP_OK;
+    }
+
+    // 图像流期间关闭省电，避免每个分片都等待 AP 缓存到下一个信标（见 mqtt_app_report_to_wifi）
+    if (s_report && s_report->stream) {
+        s_report->stream();
+    }
+
+    // 新消息开始：按消息大小申请槽位（上一条未接收完整的消息作为残帧丢弃）
+    if (offset == 0) {
+        _abort_frame();
+        size_t size = total_len;
+#if MQTT_APP_IMG_COMPRESSED
+        if (mqtt_compress_peek(data, len, &size) != ESP_OK) {
+            size = 0;
+        }
+#endif
+        if (size == 0 || size > MQTT_APP_IMG_BUF_SIZE + MQTT_APP_IMG_HDR_LEN) {
+            ESP_LOGW(TAG, "图像大小无效 (%u 字节)，丢弃", size);
+            s_skip_msg = true;
+            return ESP_ERR_INVALID_SIZE;
+        }
+        s_cur_slot = _acquire_slot(size);
+        s_skip_msg = (s_cur_slot == NULL);
+        if (s_skip_msg) {
+            ESP_LOGW(TAG, "重组槽位已满，丢弃新消息");
+            return ESP_ERR_NO_MEM;
+        }
+#if MQTT_APP_IMG_COMPRESSED
+        mqtt_decomp_begin(&s_decomp, s_cur_slot->buf, size);
+#endif
+    } else if (s_skip_msg) {
+        return ESP_OK;
+    } else if (s_cur_slot == NULL || offset != s_cur_slot->wire_len) {
+        // 分片不连续，整帧作废
+        ESP_LOGW(TAG, "分片不连续 (偏移: %u)，丢弃本帧", offset);
+        _abort_frame();
+        s_skip_msg = true;
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    frame_slot_t *slot = s_cur_slot;
+    slot->wire_len = offset + len;
+
+#if MQTT_APP_IMG_COMPRESSED
+    // 分片直接解压进槽位，条带按解压进度交付（原始长度在压缩头解析后才可知）
+    esp_err_t err = mqtt_decomp_feed(&s_decomp, data, len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "图像解压失败 (%s, 输入 %u, 输出 %u)", esp_err_to_name(err), slot->wire_len, s_decomp.out);
+        _abort_frame();
+        s_skip_msg = true;
+        return err;
+    }
+    slot->len = s_decomp.out;
+#else
+    // 检查是否会溢出
+    if (offset + len > slot->size) {
+        ESP_LOGE(TAG, "分片缓冲区溢出，丢弃数据 (需要: %u, 可用: %u)", offset + len, slot->size);
+        _abort_frame();
+        s_skip_msg = true;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 将数据写入正确的位置
+    memcpy(slot->buf + offset, data, len);
+    slot->len = offset + len;
+#endif
+
+    // 图像头到齐后确定绘制区域
+    if (slot->rect.w == 0 && (slot->len >= MQTT_APP_IMG_HDR_LEN || slot->len == slot->size)) {
+        if (_parse_img_header(slot) != ESP_OK) {
+            _abort_frame();
+            s_skip_msg = true;
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    // 条带模式：边接收边交付（条带未送达则整帧作废，避免缺条带或丢失帧结束通知）
+    if (s_stripe_handler && slot->rect.w > 0) {
+        esp_err_t err = _deliver_stripes(slot);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "条带交付失败 (%s)，丢弃本帧", esp_err_to_name(err));
+            _abort_frame();
+            s_skip_msg = true;
+            return err;
+        }
+    }
+
+    // 检查是否收到了完整消息
+    if (slot->wire_len == total_len) {
+#if MQTT_APP_IMG_COMPRESSED
+        if (!mqtt_decomp_finish(&s_decomp)) {
+            ESP_LOGE(TAG, "图像解压不完整 (输出 %u / %u)", s_decomp.out, s_decomp.raw_len);
+            _abort_frame();
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        mqtt_compress_record(topic, s_decomp.raw_len, total_len, s_decomp.cpu_us,
+                             s_decomp.method == MQTT_COMPRESS_LZ4);
+#endif
+        _complete_frame(slot);
+    }
+    return ESP_OK;
+}
+
+// 首次注册图像回调时分配槽位并添加图像路由
+static esp_err_t _image_route_init(void)
+{
+    if (s_frame_task != NULL) {
+        return ESP_OK;
+    }
 
-static uint8_t *s_img_buf = NULL;           // 分片缓冲区
-static size_t s_fragment_len = 0;           // 当前已接收字节数
+    // 槽位缓冲区在每条消息到达时按大小分配
+    if (xTaskCreate(_frame_task, "mqtt_frame", MQTT_APP_FRAME_TASK_STACK, NULL,
+                    MQTT_APP_FRAME_TASK_PRIORITY, &s_frame_task) != pdPASS) {
+        ESP_LOGE(TAG, "帧消费任务创建失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // mqtt_app_subscribe 可能已为图像主题添加过同一路由
+    if (mqtt_router_find(MQTT_APP_TOPIC_IMAGE, _image_fragment_handler, NULL) != NULL) {
+        return ESP_OK;
+    }
+    return mqtt_app_route_stream(MQTT_APP_TOPIC_IMAGE, 1, _image_fragment_handler, NULL);
+}
+
+// 客户端调用（回环模式下交给进程内代理替身；结果经上报钩子交给链路监测）
+static int _client_publish_raw(const char *topic, const void *data, size_t len, int qos)
+{
+#if MQTT_APP_LOOPBACK
+    int msg_id = mqtt_loopback_publish(topic, data, len, qos);
+#else
+    int msg_id = esp_mqtt_client_publish(s_hmqtt, topic, (const char *)data, len, qos, 0);
+#endif
+    const mqtt_app_report_hooks_t *report = s_report;
+    if (report && report->tx) {
+        report->tx(len, msg_id >= 0);
+    }
+    return msg_id;
+}
+
+// 发布（开启压缩的主题加压缩头；发件箱合并之后才压缩，合并后的整条消息只带一个头）
+static int _client_publish(const char *topic, const void *data, size_t len, int qos)
+{
+    uint8_t *packed = NULL;
+    size_t packed_len = 0;
+    esp_err_t err = mqtt_compress_pack(topic, data, len, &packed, &packed_len);
+    if (err == ESP_ERR_NOT_FOUND) {
+        return _client_publish_raw(topic, data, len, qos);
+    }
+    if (err != ESP_OK) {
+        // 不能退回无头发送，否则接收端会误解析
+        ESP_LOGW(TAG, "压缩失败 (%s): %s", esp_err_to_name(err), topic);
+        return -1;
+    }
+
+    int msg_id = _client_publish_raw(topic, packed, packed_len, qos);
+    free(packed);
+    return msg_id;
+}
+
+static int _client_subscribe(const char *filter, int qos)
+{
+#if MQTT_APP_LOOPBACK
+    return mqtt_loopback_subscribe(filter, qos);
+#else
+    return esp_mqtt_client_subscribe(s_hmqtt, filter, qos);
+#endif
+}
+
+static int _client_unsubscribe(const char *filter)
+{
+#if MQTT_APP_LOOPBACK
+    return mqtt_loopback_unsubscribe(filter);
+#else
+    return esp_mqtt_client_unsubscribe(s_hmqtt, filter);
+#endif
+}
+
+static int _subscribe_route(mqtt_route_t *route)
+{
+    int msg_id = _client_subscribe(route->filter, route->qos);
+    if (msg_id >= 0) {
+        route->subscribed = true;
+    }
+    return msg_id;
+}
+
+// 连接后订阅路由：会话已恢复时代理仍保留订阅，只补订断线期间新增的路由
+static void _resubscribe_route(mqtt_route_t *route, void *arg)
+{
+    bool resumed = *(const bool *)arg;
+    if (resumed && route->subscribed) {
+        return;
+    }
+
+    int msg_id = _subscribe_route(route);
+    if (msg_id >= 0) {
+        s_resub_last_id = msg_id;
+        s_resub_count++;
+    }
+}
+
+// 将分片交给一条路由
+static void _dispatch(mqtt_route_t *route, const uint8_t *data, size_t len, size_t offset, size_t total_len)
+{
+    if (route->mode == MQTT_ROUTE_STREAM) {
+        route->on_fragment(s_cur_topic, data, len, offset, total_len, route->user_ctx);
+        return;
+    }
+
+    // MESSAGE 模式：按路由自己的上限重组
+    if (offset == 0) {
+        route->len = 0;
+        route->skip = (total_len > route->max_len);
+        if (route->skip) {
+            ESP_LOGW(TAG, "消息超出路由上限，丢弃 (%s: %u > %u)", route->filter, total_len, route->max_len);
+            return;
+        }
+        if (route->buf == NULL) {
+            route->buf = malloc(route->max_len);
+            if (route->buf == NULL) {
+                route->skip = true;
+                return;
+            }
+        }
+    }
+    if (route->skip) {
+        return;
+    }
+    if (offset != route->len) {
+        route->skip = true;
+        return;
+    }
+
+    memcpy(route->buf + offset, data, len);
+    route->len = offset + len;
+    if (route->len == total_len) {
+        route->on_message(s_cur_topic, route->buf, route->len, route->user_ctx);
+    }
+}
+
+static void _record_first_publish(void)
+{
+    if (!s_first_pub_pending) {
+        return;
+    }
+    s_first_pub_pending = false;
+    s_conn_stats.last_first_pub_ms = (uint32_t)((esp_timer_get_time() - s_net_up_us) / 1000);
+    ESP_LOGI(TAG, "网络就绪到首条消息发出: %lu ms", s_conn_stats.last_first_pub_ms);
+}
+
+// 发件箱发送函数（在发件箱任务中执行）
+static int _outbox_send(const char *topic, const uint8_t *data, size_t len, int qos, void *ctx)
+{
+    (void)ctx;
+    if (!s_connected) {
+        return -1;
+    }
+    int msg_id = _client_publish(topic, data, len, qos);
+    if (msg_id >= 0) {
+        _record_first_publish();
+    }
+    return msg_id;
+}
+
+#if !MQTT_APP_LOOPBACK
+static void _reconnect_timer_callback(TimerHandle_t timer)
+{
+    (void)timer;
+    ESP_LOGI(TAG, "重连 (第 %lu 次)", s_reconnect_attempts);
+    esp_mqtt_client_reconnect(s_hmqtt);
+}
+#endif
+
+static void _schedule_reconnect(void)
+{
+#if !MQTT_APP_LOOPBACK
+    if (s_reconnect_timer == NULL) {
+        return;
+    }
+
+    // 指数退避：0.5s, 1s, 2s ... 16s(上限)，±25% 抖动避免多台设备同时重连
+    uint32_t shift = s_reconnect_attempts < 16 ? s_reconnect_attempts : 16;
+    uint32_t delay_ms = MQTT_APP_RECONNECT_MIN_MS << shift;
+    if (delay_ms > MQTT_APP_RECONNECT_MAX_MS) {
+        delay_ms = MQTT_APP_RECONNECT_MAX_MS;
+    }
+    delay_ms = delay_ms * 3 / 4 + esp_random() % (delay_ms / 2 + 1);
+    s_reconnect_attempts++;
+
+    ESP_LOGI(TAG, "延迟 %lu ms 后重连", delay_ms);
+    xTimerChangePeriod(s_reconnect_timer, pdMS_TO_TICKS(delay_ms), 0);
+#endif
+}
+
+#if !MQTT_APP_LOOPBACK
+// 获取 IP：立即重连（不等退避），IP 变化时主动断开失效的旧连接（不等心跳超时）
+static void _ip_event_handler(void *arg, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    (void)arg;
+    (void)base;
+    (void)event_id;
+    ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+
+    s_net_up_us = esp_timer_get_time();
+    s_first_pub_pending = true;
+
+    if (!s_connected) {
+        s_reconnect_attempts = 0;
+        xTimerStop(s_reconnect_timer, 0);
+        esp_mqtt_client_reconnect(s_hmqtt);
+    } else if (event->ip_changed) {
+        ESP_LOGW(TAG, "IP 已变化，断开旧连接");
+        esp_mqtt_client_disconnect(s_hmqtt);
+    }
+}
+#endif
+
+// 连接状态变化：更新事件组并通知回调（在 MQTT 任务中执行）
+static void _notify_conn(bool connected)
+{
+    xSemaphoreTakeRecursive(s_conn_lock, portMAX_DELAY);
+    if (connected) {
+        xEventGroupSetBits(s_conn_events, MQTT_APP_CONNECTED_BIT);
+    } else {
+        xEventGroupClearBits(s_conn_events, MQTT_APP_CONNECTED_BIT);
+    }
+
+    for (int i = 0; i < MQTT_APP_CONN_CB_MAX; i++) {
+        if (s_conn_listeners[i].cb != NULL) {
+            s_conn_listeners[i].cb(connected, s_conn_listeners[i].user_ctx);
+        }
+    }
+    xSemaphoreGiveRecursive(s_conn_lock);
+}
 
 // MQTT 事件处理
 static void _mqtt_app_event_handler(void *arg, esp_event_base_t base, int32_t event_id, void *event_data)
@@ -24,53 +704,100 @@ static void _mqtt_app_event_handler(void *arg, esp_event_base_t base, int32_t ev
     esp_mqtt_event_handle_t event = event_data;
 
     switch (event->event_id) {
-    case MQTT_EVENT_CONNECTED:
-        ESP_LOGI(TAG, "已连接");
+    case MQTT_EVENT_BEFORE_CONNECT:
+        s_attempt_us = esp_timer_get_time();
+        s_conn_stats.attempts++;
+        break;
+
+    case MQTT_EVENT_CONNECTED: {
+        int64_t now = esp_timer_get_time();
+        s_connected_us = now;
+        s_conn_stats.connects++;
+        s_conn_stats.last_connect_ms = (uint32_t)((now - s_attempt_us) / 1000);
+        if (s_down_us != 0) {
+            s_conn_stats.last_outage_ms = (uint32_t)((now - s_down_us) / 1000);
+            if (s_conn_stats.last_outage_ms > s_conn_stats.max_outage_ms) {
+                s_conn_stats.max_outage_ms = s_conn_stats.last_outage_ms;
+            }
+        }
+        s_reconnect_attempts = 0;
         s_connected = true;
-        // 自动订阅图像主题
-        if (s_data_handler) {
-            esp_mqtt_client_subscribe(s_hmqtt, MQTT_APP_TOPIC_IMAGE, 1);
+
+        // 持久会话恢复时代理仍保留订阅，只补订新增路由
+        bool resumed = (!MQTT_APP_CLEAN_SESSION && event->session_present);
+        if (resumed) {
+            s_conn_stats.session_resumed++;
         }
+        s_resub_count = 0;
+        s_resub_last_id = -1;
+        mqtt_router_foreach(_resubscribe_route, &resumed);
+        s_conn_stats.last_resub_count = s_resub_count;
+        s_conn_stats.last_resub_ms = 0;
+
+        ESP_LOGI(TAG, "已连接: 握手 %lu ms, 中断 %lu ms, %s, 订阅 %lu 个主题",
+                 s_conn_stats.last_connect_ms, s_down_us != 0 ? s_conn_stats.last_outage_ms : 0,
+                 resumed ? "会话已恢复" : "新会话", s_resub_count);
+        s_down_us = 0;
+        mqtt_outbox_on_connected();
+        _notify_conn(true);
         break;
+    }
 
-    case MQTT_EVENT_DISCONNECTED:
+    case MQTT_EVENT_DISCONNECTED: {
         ESP_LOGW(TAG, "已断开");
+        bool was_connected = s_connected;
+        if (was_connected) {
+            s_down_us = esp_timer_get_time();
+            s_conn_stats.disconnects++;
+        }
         s_connected = false;
-        s_fragment_len = 0;
+        mqtt_outbox_on_disconnected();
+        _abort_frame();
+        s_cur_route_cnt = 0;
+        _schedule_reconnect();
+        if (was_connected) {
+            _notify_conn(false);
+        }
+        break;
+    }
+
+    case MQTT_EVENT_SUBSCRIBED:
+        if (event->msg_id == s_resub_last_id) {
+            s_resub_last_id = -1;
+            s_conn_stats.last_resub_ms = (uint32_t)((esp_timer_get_time() - s_connected_us) / 1000);
+            ESP_LOGI(TAG, "重新订阅完成: %lu 个主题, %lu ms", s_conn_stats.last_resub_count,
+                     s_conn_stats.last_resub_ms);
+        }
+        break;
+
+    case MQTT_EVENT_PUBLISHED:
+        mqtt_outbox_on_published(event->msg_id);
         break;
 
     case MQTT_EVENT_DATA:
-        // 接收到数据分片，进行重组
         if (event->data && event->data_len > 0) {
-            const uint8_t *data = (const uint8_t *)event->data;
-            size_t len = event->data_len;
-            uint32_t offset = event->current_data_offset;
-            uint32_t total_len = event->total_data_len;
-
-            // 如果是新消息的开始，重置缓冲区
-            if (offset == 0) {
-                s_fragment_len = 0;
+            size_t offset = event->current_data_offset;
+            if (s_report && s_report->rx) {
+                s_report->rx(event->data_len);
             }
 
-            // 检查是否会溢出
-            if (offset + len > MQTT_APP_IMG_BUF_SIZE) {
-                ESP_LOGE(TAG, "分片缓冲区溢出，丢弃数据 (需要: %u, 可用: %u)", offset + len, MQTT_APP_IMG_BUF_SIZE);
-                s_fragment_len = 0;
-                break;
+            // 主题只在首个分片中携带，匹配结果沿用到本消息的后续分片
+            if (offset == 0) {
+                size_t topic_len = event->topic_len;
+                if (topic_len >= sizeof(s_cur_topic)) {
+                    topic_len = sizeof(s_cur_topic) - 1;
+                }
+                memcpy(s_cur_topic, event->topic, topic_len);
+                s_cur_topic[topic_len] = '\0';
+                s_cur_route_cnt = mqtt_router_match(s_cur_topic, s_cur_routes, MQTT_ROUTER_MAX_MATCH);
+                if (s_cur_route_cnt == 0) {
+                    ESP_LOGW(TAG, "未匹配的主题: %s", s_cur_topic);
+                }
             }
 
-            // 将数据写入正确的位置
-            memcpy(s_img_buf + offset, data, len);
-            s_fragment_len = offset + len;
-
-            // 检查是否收到了完整消息
-            if (s_fragment_len == total_len) {
-                // 调用处理函数，传递完整数据
-                if (s_data_handler) {
-                    s_data_handler(s_img_buf, s_fragment_len);
-                }
-                // 重置缓冲区
-                s_fragment_len = 0;
+            for (int i = 0; i < s_cur_route_cnt; i++) {
+                _dispatch(s_cur_routes[i], (const uint8_t *)event->data, event->data_len,
+                          offset, event->total_data_len);
             }
         }
         break;
@@ -90,23 +817,59 @@ esp_err_t mqtt_app_init(void)
         return ESP_OK;
     }
 
-    // 分配分片缓冲区
-    s_img_buf = heap_caps_malloc(MQTT_APP_IMG_BUF_SIZE, MALLOC_CAP_SPIRAM);
-    if (s_img_buf == NULL) {
-        ESP_LOGE(TAG, "分片缓冲区分配失败");
-        return ESP_ERR_NO_MEM;
+    esp_err_t err = mqtt_router_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = mqtt_compress_init();
+    if (err != ESP_OK) {
+        return err;
     }
 
+    if (s_conn_events == NULL) {
+        s_conn_events = xEventGroupCreate();
+        s_conn_lock = xSemaphoreCreateRecursiveMutex();
+        if (s_conn_events == NULL || s_conn_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+#if MQTT_APP_LOOPBACK
+    // 回环模式：不连接代理，发布的消息由进程内代理替身按订阅投递回本模块
+    err = mqtt_outbox_init(_outbox_send, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_inited = true;
+    return mqtt_loopback_start(_mqtt_app_event_handler);
+#else
+    // 持久会话要求客户端ID每台设备唯一且重启不变
+#if MQTT_APP_CLIENT_ID_MAC_SUFFIX
+    uint8_t mac[6];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    snprintf(s_client_id, sizeof(s_client_id), "%s_%02x%02x%02x", MQTT_APP_CLIENT_ID, mac[3], mac[4], mac[5]);
+#else
+    snprintf(s_client_id, sizeof(s_client_id), "%s", MQTT_APP_CLIENT_ID);
+#endif
+
     // MQTT 客户端配置
     esp_mqtt_client_config_t cfg = {
         .broker.address.uri = MQTT_APP_BROKER_URI,                   // 代理服务器地址
-        .credentials.client_id = MQTT_APP_CLIENT_ID,                 // 客户端ID
+        .credentials.client_id = s_client_id,                        // 客户端ID
         .credentials.username = MQTT_APP_USERNAME,                   // 用户名
         .credentials.authentication.password = MQTT_APP_PASSWORD,    // 密码
+        .session.keepalive = MQTT_APP_KEEPALIVE_S,                   // 心跳间隔
+        .session.disable_clean_session = !MQTT_APP_CLEAN_SESSION,    // 持久会话
         .buffer.size = MQTT_APP_RX_BUFFER_SIZE,                      // 接收缓冲区大小
-        .network.disable_auto_reconnect = false,                     // 启用自动重连
+        .network.timeout_ms = MQTT_APP_NETWORK_TIMEOUT_MS,           // 网络超时
+        .network.disable_auto_reconnect = true,                      // 由本模块按退避策略重连
     };
 
+    s_reconnect_timer = xTimerCreate("mqtt_reconnect", 1, pdFALSE, NULL, _reconnect_timer_callback);
+    if (s_reconnect_timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
     // 创建 MQTT 客户端
     s_hmqtt = esp_mqtt_client_init(&cfg);
     if (s_hmqtt == NULL) {
@@ -114,8 +877,19 @@ esp_err_t mqtt_app_init(void)
         return ESP_FAIL;
     }
 
+    // 发件箱：断线期间缓存待发送消息
+    err = mqtt_outbox_init(_outbox_send, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     // 注册事件回调
     ESP_ERROR_CHECK(esp_mqtt_client_register_event(s_hmqtt, ESP_EVENT_ANY_ID, _mqtt_app_event_handler, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, _ip_event_handler, NULL));
+
+    // 通常在 WiFi 已连接后初始化，首条消息耗时从此刻算起
+    s_net_up_us = esp_timer_get_time();
+    s_first_pub_pending = true;
 
     // 启动客户端
     ESP_ERROR_CHECK(esp_mqtt_client_start(s_hmqtt));
@@ -123,6 +897,7 @@ esp_err_t mqtt_app_init(void)
     s_inited = true;
     ESP_LOGI(TAG, "初始化完成");
     return ESP_OK;
+#endif
 }
 
 bool mqtt_app_is_inited(void)
@@ -137,7 +912,79 @@ esp_err_t mqtt_app_register_data_handler(mqtt_data_handler_t handler)
     }
     s_data_handler = handler;
     ESP_LOGI(TAG, "数据处理回调已注册");
-    return ESP_OK;
+    return _image_route_init();
+}
+
+esp_err_t mqtt_app_register_stripe_handler(mqtt_stripe_handler_t handler)
+{
+    if (handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_stripe_handler = handler;
+    ESP_LOGI(TAG, "条带处理回调已注册 (%d 行/条带)", MQTT_APP_IMG_STRIPE_LINES);
+    _warn_drop_policy();
+    return _image_route_init();
+}
+
+void mqtt_app_frame_release(void)
+{
+    // 条带模式下按接收顺序释放最旧的占用槽位
+    frame_slot_t *slot = NULL;
+    portENTER_CRITICAL(&s_slot_lock);
+    for (int i = 0; i < MQTT_APP_FRAME_SLOTS; i++) {
+        if (s_slots[i].state == SLOT_BUSY && (slot == NULL || s_slots[i].seq < slot->seq)) {
+            slot = &s_slots[i];
+        }
+    }
+    portEXIT_CRITICAL(&s_slot_lock);
+
+    if (slot == NULL) {
+        return;
+    }
+
+    if (!slot->aborted) {
+        _record_latency(slot);
+    }
+    _release_slot(slot);
+}
+
+void mqtt_app_set_report_hooks(const mqtt_app_report_hooks_t *hooks)
+{
+    s_report = hooks;
+}
+
+void mqtt_app_set_drop_policy(mqtt_app_drop_policy_t policy)
+{
+    s_drop_policy = policy;
+    ESP_LOGI(TAG, "丢帧策略: %s", policy == MQTT_APP_DROP_OLDEST ? "drop-oldest" : "drop-newest");
+    _warn_drop_policy();
+}
+
+void mqtt_app_get_img_stats(mqtt_app_img_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = s_img_stats;
+    }
+}
+
+esp_err_t mqtt_app_route_stream(const char *filter, int qos, mqtt_fragment_handler_t handler, void *user_ctx)
+{
+    mqtt_route_t *route = NULL;
+    esp_err_t err = mqtt_router_add(filter, qos, MQTT_ROUTE_STREAM, handler, NULL, 0, user_ctx, &route);
+    if (err == ESP_OK && s_connected) {
+        _subscribe_route(route);
+    }
+    return err;
+}
+
+esp_err_t mqtt_app_route_message(const char *filter, int qos, size_t max_len, mqtt_message_handler_t handler, void *user_ctx)
+{
+    mqtt_route_t *route = NULL;
+    esp_err_t err = mqtt_router_add(filter, qos, MQTT_ROUTE_MESSAGE, NULL, handler, max_len, user_ctx, &route);
+    if (err == ESP_OK && s_connected) {
+        _subscribe_route(route);
+    }
+    return err;
 }
 
 bool mqtt_app_is_connected(void)
@@ -145,27 +992,137 @@ bool mqtt_app_is_connected(void)
     return s_connected;
 }
 
+esp_err_t mqtt_app_wait_connected(TickType_t timeout)
+{
+    if (s_conn_events == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(s_conn_events, MQTT_APP_CONNECTED_BIT, pdFALSE, pdFALSE, timeout);
+    return (bits & MQTT_APP_CONNECTED_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t mqtt_app_register_conn_cb(mqtt_app_conn_cb_t cb, void *user_ctx)
+{
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_conn_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    xSemaphoreTakeRecursive(s_conn_lock, portMAX_DELAY);
+    for (int i = 0; i < MQTT_APP_CONN_CB_MAX; i++) {
+        if (s_conn_listeners[i].cb == NULL) {
+            s_conn_listeners[i].user_ctx = user_ctx;
+            s_conn_listeners[i].cb = cb;
+            // 持锁以当前状态回调一次：注册晚于连接也不会错过，且不会与状态通知交错
+            // 取事件组状态而非 s_connected：前者只在锁内随通知更新
+            cb((xEventGroupGetBits(s_conn_events) & MQTT_APP_CONNECTED_BIT) != 0, user_ctx);
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGiveRecursive(s_conn_lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "连接回调已满");
+    }
+    return ret;
+}
+
 esp_err_t mqtt_app_publish(const char *topic, const void *data, size_t len, int qos)
 {
     if (!s_inited || !s_connected) return ESP_ERR_INVALID_STATE;
     if (topic == NULL || data == NULL) return ESP_ERR_INVALID_ARG;
 
-    int ret = esp_mqtt_client_publish(s_hmqtt, topic, data, len, qos, 0);
-    return (ret >= 0) ? ESP_OK : ESP_FAIL;
+    int ret = _client_publish(topic, data, len, qos);
+    if (ret < 0) {
+        return ESP_FAIL;
+    }
+    _record_first_publish();
+    return ESP_OK;
+}
+
+esp_err_t mqtt_app_enqueue(const char *topic, const void *data, size_t len, int qos)
+{
+    if (!s_inited) return ESP_ERR_INVALID_STATE;
+
+    return mqtt_outbox_enqueue(topic, data, len, qos);
+}
+
+esp_err_t mqtt_app_set_coalesce(const char *topic, mqtt_outbox_coalesce_t mode, uint32_t window_ms,
+                                size_t max_len, int delimiter)
+{
+    return mqtt_outbox_set_coalesce(topic, mode, window_ms, max_len, delimiter);
+}
+
+esp_err_t mqtt_app_set_topic_class(const char *topic, mqtt_outbox_prio_t prio, uint32_t rate_bps,
+                                   uint32_t burst_bytes)
+{
+    return mqtt_outbox_set_topic_class(topic, prio, rate_bps, burst_bytes);
+}
+
+void mqtt_app_set_outbox_spill(mqtt_outbox_spill_fn_t spill)
+{
+    mqtt_outbox_set_spill_handler(spill);
+}
+
+void mqtt_app_get_outbox_stats(mqtt_outbox_stats_t *stats)
+{
+    mqtt_outbox_get_stats(stats);
+}
+
+esp_err_t mqtt_app_set_compression(const char *topic, bool enable)
+{
+    if (!s_inited) return ESP_ERR_INVALID_STATE;
+
+    return mqtt_compress_set_topic(topic, enable);
+}
+
+esp_err_t mqtt_app_get_compress_stats(const char *topic, mqtt_compress_stats_t *stats)
+{
+    return mqtt_compress_get_stats(topic, stats);
+}
+
+void mqtt_app_get_conn_stats(mqtt_app_conn_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = s_conn_stats;
+    }
 }
 
 esp_err_t mqtt_app_subscribe(const char *topic, int qos)
 {
     if (!s_inited || topic == NULL) return ESP_ERR_INVALID_ARG;
 
-    int ret = esp_mqtt_client_subscribe(s_hmqtt, topic, qos);
-    return (ret >= 0) ? ESP_OK : ESP_FAIL;
+    // 经路由表订阅：消息按图像格式重组后交给数据处理回调，重连后自动重新订阅
+    mqtt_route_t *route = mqtt_router_find(topic, _image_fragment_handler, NULL);
+    if (route == NULL) {
+        esp_err_t err = mqtt_router_add(topic, qos, MQTT_ROUTE_STREAM, _image_fragment_handler, NULL, 0,
+                                        NULL, &route);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    if (!s_connected) {
+        return ESP_OK;
+    }
+    return (_subscribe_route(route) >= 0) ? ESP_OK : ESP_FAIL;
 }
 
 esp_err_t mqtt_app_unsubscribe(const char *topic)
 {
     if (!s_inited || topic == NULL) return ESP_ERR_INVALID_ARG;
 
-    int ret = esp_mqtt_client_unsubscribe(s_hmqtt, topic);
+    mqtt_route_t *route = mqtt_router_find(topic, _image_fragment_handler, NULL);
+    if (route != NULL) {
+        mqtt_router_remove(route);
+    }
+    if (!s_connected) {
+        return ESP_OK;
+    }
+    int ret = _client_unsubscribe(topic);
     return (ret >= 0) ? ESP_OK : ESP_FAIL;
 }
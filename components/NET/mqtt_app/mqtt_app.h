@@ -5,15 +5,222 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "mqtt_router.h"
+#include "mqtt_outbox.h"
+#include "mqtt_compress.h"
+#include "freertos/FreeRTOS.h"
 
-typedef esp_err_t (*mqtt_data_handler_t)(const uint8_t *data, size_t len);
+/*
+ * 图像消息格式（多字节字段为小端）：
+ *   [0..1]  'I' 'M'
+ *   [2]     像素格式（mqtt_app_img_format_t）
+ *   [3]     保留，填 0
+ *   [4..11] x, y, w, h（uint16，屏幕坐标，区域不得超出屏幕）
+ *   [12..]  w * h 个像素，逐行排列
+ * 不带头且长度恰为整屏（MQTT_APP_IMG_BUF_SIZE）的消息按旧格式绘制在 (0, 0)。
+ */
+#define MQTT_APP_IMG_HDR_LEN        12
+#define MQTT_APP_IMG_MAGIC0         'I'
+#define MQTT_APP_IMG_MAGIC1         'M'
+
+typedef enum {
+    MQTT_APP_IMG_FMT_RGB565 = 0,    // 与 LCD 字节序一致，2 字节/像素
+} mqtt_app_img_format_t;
+
+/**
+ * @brief 屏幕上的矩形区域
+ */
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint8_t format;             // mqtt_app_img_format_t
+} mqtt_app_img_rect_t;
+
+/**
+ * @brief 完整帧回调（在 mqtt_frame 任务中执行，不阻塞 MQTT 接收）
+ *
+ * 注册了条带回调时，完整帧不再通过此回调交付。
+ *
+ * @param data 像素数据（不含图像头）
+ * @param len  像素字节数
+ * @param rect 图像在屏幕上的区域
+ */
+typedef esp_err_t (*mqtt_data_handler_t)(const uint8_t *data, size_t len, const mqtt_app_img_rect_t *rect);
+
+/**
+ * @brief 条带回调：每凑齐一个完整条带即调用（在 MQTT 任务中执行，不可阻塞）
+ *
+ * @param data   条带像素（指向重组缓冲区，在 mqtt_app_frame_release 之前保持有效）
+ *               为 NULL 时表示本帧中途中止，消费者需直接释放帧
+ * @param rect   条带在屏幕上的区域（整行，行数最多 MQTT_APP_IMG_STRIPE_LINES）
+ * @param last   是否为本帧最后一个条带
+ * @return ESP_OK 已接收；其他值表示拒收（如队列满），本帧随即中止：已交付过条带时再以
+ *         data 为 NULL 通知一次，该通知也被拒收时由 mqtt_app 直接释放槽位，消费者不得再
+ *         访问本帧的条带。消费者的队列应能容纳 MQTT_APP_FRAME_SLOTS 帧的条带，以免拒收
+ */
+typedef esp_err_t (*mqtt_stripe_handler_t)(const uint8_t *data, const mqtt_app_img_rect_t *rect, bool last);
+
+/**
+ * @brief 重组槽位耗尽时的丢帧策略
+ *
+ * 只在整帧模式（mqtt_app_register_data_handler）下有区别。条带模式下帧的条带在接收中
+ * 已交给消费者，槽位直到 mqtt_app_frame_release 才能回收，因此总是丢弃新消息；
+ * 此时设置 MQTT_APP_DROP_OLDEST 会打印警告。
+ */
+typedef enum {
+    MQTT_APP_DROP_OLDEST = 0,   // 丢弃最旧的待处理完整帧，腾出槽位接收新消息（仅整帧模式）
+    MQTT_APP_DROP_NEWEST,       // 丢弃新到达的消息
+} mqtt_app_drop_policy_t;
+
+/**
+ * @brief 图像帧统计
+ */
+typedef struct {
+    uint32_t frames;            // 完成并交付的帧数
+    uint32_t dropped;           // 因槽位耗尽被丢弃的帧数
+    uint32_t partial;           // 未接收完整即中止的帧数（断线、乱序、溢出、被新消息打断）
+    uint32_t last_recv_us;      // 最近一帧：首个分片到最后一个分片
+    uint32_t last_latency_us;   // 最近一帧：首个分片到处理完成（条带模式为绘制完成）
+    uint32_t avg_latency_us;    // 平均帧延迟
+} mqtt_app_img_stats_t;
+
+/**
+ * @brief 连接统计（用于评估 AP 抖动后的恢复时间）
+ */
+typedef struct {
+    uint32_t attempts;          // 连接尝试次数（含失败）
+    uint32_t connects;          // 连接成功次数
+    uint32_t disconnects;       // 连接后断开次数
+    uint32_t session_resumed;   // 代理保留了会话（跳过重新订阅）的次数
+    uint32_t last_connect_ms;   // 最近一次：发起连接到 CONNACK
+    uint32_t last_outage_ms;    // 最近一次：断开到重新连上
+    uint32_t max_outage_ms;     // 最长中断
+    uint32_t last_first_pub_ms; // 最近一次：网络就绪（获取 IP）到首条消息发出
+    uint32_t last_resub_count;  // 最近一次连接后订阅的主题数
+    uint32_t last_resub_ms;     // 最近一次：CONNACK 到最后一个 SUBACK（未订阅时为 0）
+} mqtt_app_conn_stats_t;
+
+/**
+ * @brief 连接状态回调（在 MQTT 任务中执行，不可阻塞）
+ */
+typedef void (*mqtt_app_conn_cb_t)(bool connected, void *user_ctx);
+
+/**
+ * @brief 流量上报钩子（成员可为 NULL；在 MQTT 任务或发件箱任务中调用，不可阻塞）
+ */
+typedef struct {
+    void (*tx)(size_t bytes, bool ok);  // 每次发布后（ok 为客户端是否接受）
+    void (*rx)(size_t bytes);           // 每个接收分片
+    void (*stream)(void);               // 每个图像分片（持续的流式接收）
+} mqtt_app_report_hooks_t;
 
 esp_err_t mqtt_app_init(void);
 esp_err_t mqtt_app_register_data_handler(mqtt_data_handler_t handler);
+esp_err_t mqtt_app_register_stripe_handler(mqtt_stripe_handler_t handler);
+void mqtt_app_frame_release(void);
+void mqtt_app_set_drop_policy(mqtt_app_drop_policy_t policy);
+void mqtt_app_get_img_stats(mqtt_app_img_stats_t *stats);
 bool mqtt_app_is_inited(void);
 bool mqtt_app_is_connected(void);
+
+/**
+ * @brief 阻塞等待连上代理（须在 mqtt_app_init 之后调用）
+ *
+ * @param timeout 等待时间（tick），portMAX_DELAY 表示一直等待
+ * @return ESP_OK 已连接，ESP_ERR_TIMEOUT 超时，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t mqtt_app_wait_connected(TickType_t timeout);
+
+/**
+ * @brief 注册连接状态回调（须在 mqtt_app_init 之后调用）
+ *
+ * 注册时在调用者任务中以当前状态回调一次，与 MQTT 任务中的连接通知互斥，不会乱序。
+ */
+esp_err_t mqtt_app_register_conn_cb(mqtt_app_conn_cb_t cb, void *user_ctx);
 esp_err_t mqtt_app_publish(const char *topic, const void *data, size_t len, int qos);
+
+/**
+ * @brief 设置流量上报钩子（hooks 须长期有效，NULL 表示不上报）
+ */
+void mqtt_app_set_report_hooks(const mqtt_app_report_hooks_t *hooks);
+
+/**
+ * @brief 把流量上报给 Wi-Fi 链路监测与省电管理（见 mqtt_app_wifi.c）
+ *
+ * 收发结果计入 wifi_link_monitor，接收分片与图像流触发 wifi_power 的档位切换。
+ */
+void mqtt_app_report_to_wifi(void);
+
+/**
+ * @brief 经发件箱发布：断线时缓存，重连后按顺序发送（QoS1/2 受未确认窗口限制）
+ *
+ * @return ESP_OK 已入队，ESP_ERR_INVALID_SIZE 消息过大，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t mqtt_app_enqueue(const char *topic, const void *data, size_t len, int qos);
+
+/**
+ * @brief 设置主题合并（仅作用于 mqtt_app_enqueue，须在 mqtt_app_init 之后调用）
+ */
+esp_err_t mqtt_app_set_coalesce(const char *topic, mqtt_outbox_coalesce_t mode, uint32_t window_ms,
+                                size_t max_len, int delimiter);
+
+/**
+ * @brief 设置主题优先级类与限速（仅作用于 mqtt_app_enqueue，须在 mqtt_app_init 之后调用）
+ */
+esp_err_t mqtt_app_set_topic_class(const char *topic, mqtt_outbox_prio_t prio, uint32_t rate_bps,
+                                   uint32_t burst_bytes);
+
+/**
+ * @brief 设置发件箱溢出转存回调
+ */
+void mqtt_app_set_outbox_spill(mqtt_outbox_spill_fn_t spill);
+
+/**
+ * @brief 获取发件箱统计
+ */
+void mqtt_app_get_outbox_stats(mqtt_outbox_stats_t *stats);
+
+/**
+ * @brief 开启/关闭主题的发布压缩（精确匹配主题，须在 mqtt_app_init 之后调用）
+ *
+ * 开启后该主题每条消息带 4 字节压缩头（格式见 mqtt_compress.h），接收端须能识别；
+ * 压缩无收益的消息带“原样”头发送。经发件箱的消息在合并之后、发送时压缩。
+ */
+esp_err_t mqtt_app_set_compression(const char *topic, bool enable);
+
+/**
+ * @brief 获取主题压缩统计（发布方向为压缩，接收方向为解压）
+ */
+esp_err_t mqtt_app_get_compress_stats(const char *topic, mqtt_compress_stats_t *stats);
+
+/**
+ * @brief 获取连接统计
+ */
+void mqtt_app_get_conn_stats(mqtt_app_conn_stats_t *stats);
+
+/**
+ * @brief 订阅主题，消息按图像格式重组后交给 mqtt_app_register_data_handler 注册的回调
+ *        （经路由表订阅，断线重连后自动重新订阅；未注册回调时消息被丢弃）
+ */
 esp_err_t mqtt_app_subscribe(const char *topic, int qos);
+
+/**
+ * @brief 取消 mqtt_app_subscribe 的订阅并删除其路由
+ */
 esp_err_t mqtt_app_unsubscribe(const char *topic);
 
+/**
+ * @brief 注册分片路由：匹配 filter（支持 + / #）的消息分片直接回调，不经过任何缓冲区
+ *        （须在 mqtt_app_init 之后调用）
+ */
+esp_err_t mqtt_app_route_stream(const char *filter, int qos, mqtt_fragment_handler_t handler, void *user_ctx);
+
+/**
+ * @brief 注册消息路由：匹配 filter 的消息在路由自己的缓冲区（上限 max_len）中重组后回调
+ *        （须在 mqtt_app_init 之后调用）
+ */
+esp_err_t mqtt_app_route_message(const char *filter, int qos, size_t max_len, mqtt_message_handler_t handler, void *user_ctx);
+
 #endif /* __MQTT_APP_H__ */
@@ -7,18 +7,70 @@
 #define MQTT_APP_USERNAME            "RobiEcho"
 #define MQTT_APP_PASSWORD            "123456"
 
+/* ================= Session Config ================= */
+#define MQTT_APP_CLIENT_ID_MAC_SUFFIX 1             // 客户端ID追加 MAC 后 3 字节（每台设备唯一且重启不变）
+#define MQTT_APP_CLEAN_SESSION       0              // 0：持久会话，代理保留订阅与未送达的 QoS1 消息（依赖稳定的客户端ID）
+#define MQTT_APP_KEEPALIVE_S         30             // 心跳间隔（客户端默认 120s，缩短可更快发现失效连接）
+#define MQTT_APP_NETWORK_TIMEOUT_MS  5000           // 连接与收发超时
+
+/* ================= Reconnect Config ================= */
+#define MQTT_APP_RECONNECT_MIN_MS    500            // 首次重连延迟
+#define MQTT_APP_RECONNECT_MAX_MS    16000          // 指数退避上限（实际延迟带 ±25% 抖动）
+#define MQTT_APP_CONN_CB_MAX         4              // 连接状态回调数量
+
 /* ================= Buffer Config ================= */
 #define MQTT_APP_RX_BUFFER_SIZE      (16 * 1024)    // 接收缓冲区大小（16KB）
 
 /* ================= Topic Config ================= */
-#define MQTT_APP_TOPIC_MPU6050       "esp32s3/mpu6050_data"   // MPU6050 数据主题
+#define MQTT_APP_TOPIC_MAX_LEN       128            // 接收主题最大长度
+#define MQTT_APP_TOPIC_MPU6050       "esp32s3/mpu6050_data"   // MPU6050 数据主题（JSON）
+#define MQTT_APP_TOPIC_MPU6050_BATCH "esp32s3/mpu6050_batch"  // MPU6050 批量二进制数据主题（格式见 mpu6050_telemetry.h）
+#define MQTT_APP_TOPIC_MPU6050_FEATURES "esp32s3/mpu6050_features"   // MPU6050 振动特征主题（JSON，每窗口一条）
 #define MQTT_APP_TOPIC_IMAGE         "esp32s3/image"     // 接收图像主题
+#define MQTT_APP_TOPIC_LINK          "esp32s3/link"      // Wi-Fi 链路指标主题（JSON，见 wifi_link_monitor.h）
 
 /* ================= Image Config ================= */
-#define MQTT_APP_IMG_WIDTH           240
-#define MQTT_APP_IMG_HEIGHT          240
+#define MQTT_APP_IMG_WIDTH           240            // 屏幕宽度（图像区域不得超出屏幕）
+#define MQTT_APP_IMG_HEIGHT          240            // 屏幕高度
 #define MQTT_APP_IMG_PIXEL_SIZE      2              // RGB565: 2字节/像素
-#define MQTT_APP_IMG_BUF_SIZE        (MQTT_APP_IMG_WIDTH * MQTT_APP_IMG_HEIGHT * MQTT_APP_IMG_PIXEL_SIZE)
+#define MQTT_APP_IMG_BUF_SIZE        (MQTT_APP_IMG_WIDTH * MQTT_APP_IMG_HEIGHT * MQTT_APP_IMG_PIXEL_SIZE)   // 整屏像素字节数
+#define MQTT_APP_IMG_INTERNAL_MAX    (8 * 1024)     // 不超过此大小的图像在内部 RAM 中重组（小区域更新，DMA 更快）
 #define MQTT_APP_IMG_TIMEOUT_US      (2000 * 1000)  // 图像接收超时（2秒）
+#define MQTT_APP_IMG_STRIPE_LINES    30             // 条带行数（与 LCD 单次 DMA 大小一致）
+#define MQTT_APP_IMG_COMPRESSED      0              // 1：图像负载带压缩头（格式见 mqtt_compress.h），分片边收边解压
+
+/* ================= Frame Pool Config ================= */
+#define MQTT_APP_FRAME_SLOTS         2              // 重组槽位数（每个槽位一帧，缓冲区按消息大小分配）
+#define MQTT_APP_FRAME_DROP_POLICY   MQTT_APP_DROP_OLDEST   // 槽位耗尽时的默认策略（drop-oldest 仅整帧模式生效）
+#define MQTT_APP_FRAME_TASK_STACK    (4 * 1024)     // 帧消费任务栈大小
+#define MQTT_APP_FRAME_TASK_PRIORITY 5              // 帧消费任务优先级
+
+/* ================= Outbox Config ================= */
+#define MQTT_APP_OUTBOX_CONTROL_SIZE (8 * 1024)     // 控制类环形缓冲区
+#define MQTT_APP_OUTBOX_NORMAL_SIZE  (56 * 1024)    // 普通类环形缓冲区
+#define MQTT_APP_OUTBOX_BULK_SIZE    (64 * 1024)    // 批量类环形缓冲区
+#define MQTT_APP_OUTBOX_SIZE         (MQTT_APP_OUTBOX_CONTROL_SIZE + MQTT_APP_OUTBOX_NORMAL_SIZE + \
+                                      MQTT_APP_OUTBOX_BULK_SIZE)    // 总大小（优先位于 PSRAM）
+#define MQTT_APP_OUTBOX_INFLIGHT     8              // QoS1/2 未确认消息窗口
+#define MQTT_APP_OUTBOX_INFLIGHT_RESERVE 2          // 窗口中只留给控制类的部分
+#define MQTT_APP_OUTBOX_COALESCE_SLOTS 4            // 可设置合并的主题数
+#define MQTT_APP_OUTBOX_RULE_SLOTS   8              // 可设置优先级/限速的主题数
+#define MQTT_APP_OUTBOX_RETRY_MS     200            // 发送失败后的重试间隔
+#define MQTT_APP_OUTBOX_TASK_STACK   (4 * 1024)     // 发送任务栈大小
+#define MQTT_APP_OUTBOX_TASK_PRIORITY 4             // 发送任务优先级（低于帧消费任务）
+
+/* ================= Compression Config ================= */
+#define MQTT_APP_COMPRESS_SLOTS      4              // 可开启压缩/统计压缩率的主题数
+#define MQTT_APP_COMPRESS_HASH_BITS  12             // 匹配查找表 2^n 项 x 4 字节（首次开启压缩时分配，内部 RAM）
+#define MQTT_APP_COMPRESS_MIN_LEN    64             // 短于此长度的消息不尝试压缩（只加头）
+#define MQTT_APP_COMPRESS_PSRAM_THRESHOLD (4 * 1024)   // 压缩输出缓冲区超过此大小时优先分配在 PSRAM
+
+/* ================= Loopback Config ================= */
+#ifndef MQTT_APP_LOOPBACK                           // 主机构建（tools/host_bench）以 -DMQTT_APP_LOOPBACK=1 编译
+#define MQTT_APP_LOOPBACK            0              // 1：不连接代理，发布的消息经进程内代理替身回环（性能测试用）
+#endif
+#define MQTT_APP_LOOPBACK_QUEUE_LEN  32             // 待投递消息队列长度（满时发布返回失败）
+#define MQTT_APP_LOOPBACK_TASK_STACK (4 * 1024)     // 代理任务栈大小
+#define MQTT_APP_LOOPBACK_TASK_PRIORITY 5           // 与 esp-mqtt 任务默认优先级一致
 
 #endif /* __MQTT_APP_CONFIG_H__ */
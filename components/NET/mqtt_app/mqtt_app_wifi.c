@@ -0,0 +1,26 @@
+#include "mqtt_app.h"
+#include "wifi_link_monitor.h"
+#include "wifi_power.h"
+
+// 接收分片计入链路吞吐，并按交互类流量降低省电档位
+static void _report_rx(size_t bytes)
+{
+    wifi_link_report_rx(bytes);
+    wifi_power_notify(WIFI_TRAFFIC_INTERACTIVE);
+}
+
+static void _report_stream(void)
+{
+    wifi_power_notify(WIFI_TRAFFIC_STREAM);
+}
+
+static const mqtt_app_report_hooks_t s_wifi_hooks = {
+    .tx = wifi_link_report_tx,
+    .rx = _report_rx,
+    .stream = _report_stream,
+};
+
+void mqtt_app_report_to_wifi(void)
+{
+    mqtt_app_set_report_hooks(&s_wifi_hooks);
+}
@@ -0,0 +1,475 @@
+#include "mqtt_compress.h"
+#include "mqtt_app_config.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "mqtt_compress";
+
+/* LZ4 块格式约束：最短匹配 4 字节，最后一个匹配须在结尾 12 字节之前开始，最后 5 字节必须是字面量 */
+#define LZ4_MIN_MATCH       4
+#define LZ4_MF_LIMIT        12
+#define LZ4_LAST_LITERALS   5
+#define LZ4_MAX_OFFSET      0xFFFF
+#define HASH_SIZE           (1u << MQTT_APP_COMPRESS_HASH_BITS)
+
+// 解压状态
+enum {
+    DEC_HDR = 0,        // 读取压缩头
+    DEC_RAW,            // 原样负载
+    DEC_TOKEN,          // 序列首字节
+    DEC_LIT_EXT,        // 字面量长度扩展字节
+    DEC_LIT,            // 字面量
+    DEC_OFF_LO,         // 匹配偏移低字节（也是合法的结束位置）
+    DEC_OFF_HI,         // 匹配偏移高字节
+    DEC_MATCH_EXT,      // 匹配长度扩展字节
+};
+
+typedef struct {
+    char topic[MQTT_APP_TOPIC_MAX_LEN];
+    bool enabled;               // 发布时压缩
+    mqtt_compress_stats_t stats;
+} compress_topic_t;
+
+static SemaphoreHandle_t s_lock = NULL;
+static compress_topic_t s_topics[MQTT_APP_COMPRESS_SLOTS];
+static uint32_t *s_hash = NULL;     // 匹配查找表（位置），压缩在锁内进行
+
+static compress_topic_t *_find(const char *topic, bool create)
+{
+    compress_topic_t *empty = NULL;
+    for (int i = 0; i < MQTT_APP_COMPRESS_SLOTS; i++) {
+        if (s_topics[i].topic[0] == '\0') {
+            if (empty == NULL) {
+                empty = &s_topics[i];
+            }
+        } else if (strcmp(s_topics[i].topic, topic) == 0) {
+            return &s_topics[i];
+        }
+    }
+    if (!create || empty == NULL) {
+        return NULL;
+    }
+    strlcpy(empty->topic, topic, sizeof(empty->topic));
+    return empty;
+}
+
+static void _account(compress_topic_t *t, size_t raw_len, size_t wire_len, uint32_t cpu_us, bool compressed)
+{
+    t->stats.messages++;
+    t->stats.compressed += compressed ? 1 : 0;
+    t->stats.raw_bytes += raw_len;
+    t->stats.wire_bytes += wire_len;
+    t->stats.cpu_us += cpu_us;
+}
+
+static inline uint32_t _read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t _hash(uint32_t seq)
+{
+    return (seq * 2654435761u) >> (32 - MQTT_APP_COMPRESS_HASH_BITS);
+}
+
+// 写入长度扩展字节（每字节 255，最后一个字节小于 255）
+static uint8_t *_put_len(uint8_t *op, const uint8_t *oend, size_t len)
+{
+    while (len >= 255) {
+        if (op >= oend) {
+            return NULL;
+        }
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= oend) {
+        return NULL;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+// 输出一个序列（match_len 为 0 时只有字面量，即最后一个序列）
+static uint8_t *_emit(uint8_t *op, const uint8_t *oend, const uint8_t *lit, size_t lit_len,
+                      uint16_t offset, size_t match_len)
+{
+    if (op >= oend) {
+        return NULL;
+    }
+    uint8_t *token = op++;
+    *token = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15 && (op = _put_len(op, oend, lit_len - 15)) == NULL) {
+        return NULL;
+    }
+    if ((size_t)(oend - op) < lit_len) {
+        return NULL;
+    }
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if (match_len == 0) {
+        return op;
+    }
+    if (oend - op < 2) {
+        return NULL;
+    }
+    *op++ = (uint8_t)(offset & 0xFF);
+    *op++ = (uint8_t)(offset >> 8);
+    size_t ml = match_len - LZ4_MIN_MATCH;
+    *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+    if (ml >= 15) {
+        op = _put_len(op, oend, ml - 15);
+    }
+    return op;
+}
+
+// 贪心 LZ4 块压缩，输出超过 cap 时返回 0（调用者改为原样发送）
+static size_t _lz4_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap)
+{
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *iend = src + len;
+    uint8_t *op = dst;
+    const uint8_t *oend = dst + cap;
+
+    if (len > LZ4_MF_LIMIT) {
+        const uint8_t *mflimit = iend - LZ4_MF_LIMIT;
+        const uint8_t *matchlimit = iend - LZ4_LAST_LITERALS;
+        memset(s_hash, 0, HASH_SIZE * sizeof(uint32_t));
+
+        while (ip < mflimit) {
+            uint32_t seq = _read32(ip);
+            uint32_t h = _hash(seq);
+            size_t pos = (size_t)(ip - src);
+            size_t ref = s_hash[h];
+            s_hash[h] = (uint32_t)pos;
+
+            if (ref >= pos || pos - ref > LZ4_MAX_OFFSET || _read32(src + ref) != seq) {
+                ip++;
+                continue;
+            }
+
+            // 向前扩展到上一个序列末尾，向后扩展到结尾字面量区之前
+            const uint8_t *match = src + ref;
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+            size_t match_len = LZ4_MIN_MATCH;
+            while (ip + match_len < matchlimit && ip[match_len] == match[match_len]) {
+                match_len++;
+            }
+
+            op = _emit(op, oend, anchor, (size_t)(ip - anchor), (uint16_t)(ip - match), match_len);
+            if (op == NULL) {
+                return 0;
+            }
+            ip += match_len;
+            anchor = ip;
+
+            // 补记匹配末尾附近的位置，提高连续匹配的命中率
+            if (ip - 2 > src && ip < mflimit) {
+                s_hash[_hash(_read32(ip - 2))] = (uint32_t)(ip - 2 - src);
+            }
+        }
+    }
+
+    op = _emit(op, oend, anchor, (size_t)(iend - anchor), 0, 0);
+    return op == NULL ? 0 : (size_t)(op - dst);
+}
+
+esp_err_t mqtt_compress_init(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    return s_lock != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t mqtt_compress_set_topic(const char *topic, bool enable)
+{
+    if (topic == NULL || strlen(topic) >= MQTT_APP_TOPIC_MAX_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (enable && s_hash == NULL) {
+        s_hash = heap_caps_malloc(HASH_SIZE * sizeof(uint32_t), MALLOC_CAP_INTERNAL);
+        if (s_hash == NULL) {
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+    compress_topic_t *t = (err == ESP_OK) ? _find(topic, enable) : NULL;
+    if (t != NULL) {
+        t->enabled = enable;
+    } else if (enable && err == ESP_OK) {
+        err = ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "%s 发布压缩: %s", enable ? "开启" : "关闭", topic);
+    } else {
+        ESP_LOGE(TAG, "设置压缩主题失败: %s", topic);
+    }
+    return err;
+}
+
+esp_err_t mqtt_compress_pack(const char *topic, const uint8_t *data, size_t len, uint8_t **out, size_t *out_len)
+{
+    if (s_lock == NULL || s_hash == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    compress_topic_t *t = _find(topic, false);
+    if (t == NULL || !t->enabled) {
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (len > MQTT_COMPRESS_MAX_LEN) {
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 压缩结果不小于原始长度时原样发送，缓冲区按原始长度分配即可
+    size_t size = MQTT_COMPRESS_HDR_LEN + len;
+    uint8_t *buf = (size > MQTT_APP_COMPRESS_PSRAM_THRESHOLD) ? heap_caps_malloc(size, MALLOC_CAP_SPIRAM) : NULL;
+    if (buf == NULL) {
+        buf = malloc(size);
+    }
+    if (buf == NULL) {
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int64_t start = esp_timer_get_time();
+    size_t packed = 0;
+    if (len >= MQTT_APP_COMPRESS_MIN_LEN) {
+        packed = _lz4_compress(data, len, buf + MQTT_COMPRESS_HDR_LEN, len - 1);
+    }
+    uint8_t method = (packed > 0) ? MQTT_COMPRESS_LZ4 : MQTT_COMPRESS_RAW;
+    if (packed == 0) {
+        memcpy(buf + MQTT_COMPRESS_HDR_LEN, data, len);
+        packed = len;
+    }
+    buf[0] = MQTT_COMPRESS_MAGIC | method;
+    buf[1] = (uint8_t)(len & 0xFF);
+    buf[2] = (uint8_t)((len >> 8) & 0xFF);
+    buf[3] = (uint8_t)((len >> 16) & 0xFF);
+
+    *out = buf;
+    *out_len = MQTT_COMPRESS_HDR_LEN + packed;
+    _account(t, len, *out_len, (uint32_t)(esp_timer_get_time() - start), method == MQTT_COMPRESS_LZ4);
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+void mqtt_compress_record(const char *topic, size_t raw_len, size_t wire_len, uint32_t cpu_us, bool compressed)
+{
+    if (s_lock == NULL || topic == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    compress_topic_t *t = _find(topic, true);
+    if (t != NULL) {
+        _account(t, raw_len, wire_len, cpu_us, compressed);
+    }
+    xSemaphoreGive(s_lock);
+}
+
+esp_err_t mqtt_compress_get_stats(const char *topic, mqtt_compress_stats_t *stats)
+{
+    if (topic == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_lock == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    compress_topic_t *t = _find(topic, false);
+    if (t != NULL) {
+        *stats = t->stats;
+    }
+    xSemaphoreGive(s_lock);
+    return t != NULL ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t mqtt_compress_peek(const uint8_t *data, size_t len, size_t *raw_len)
+{
+    if (len < MQTT_COMPRESS_HDR_LEN || (data[0] & 0xF0) != MQTT_COMPRESS_MAGIC) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    *raw_len = data[1] | ((size_t)data[2] << 8) | ((size_t)data[3] << 16);
+    return ESP_OK;
+}
+
+void mqtt_decomp_begin(mqtt_decomp_t *d, uint8_t *dst, size_t cap)
+{
+    memset(d, 0, sizeof(*d));
+    d->dst = dst;
+    d->cap = cap;
+    d->state = DEC_HDR;
+}
+
+// 解析压缩头，确定输出长度与方法
+static esp_err_t _parse_header(mqtt_decomp_t *d)
+{
+    if ((d->hdr[0] & 0xF0) != MQTT_COMPRESS_MAGIC) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    d->method = d->hdr[0] & 0x0F;
+    d->raw_len = d->hdr[1] | ((size_t)d->hdr[2] << 8) | ((size_t)d->hdr[3] << 16);
+    if (d->raw_len > d->cap) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (d->method == MQTT_COMPRESS_RAW) {
+        d->state = DEC_RAW;
+    } else if (d->method == MQTT_COMPRESS_LZ4) {
+        d->state = DEC_TOKEN;
+    } else {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return ESP_OK;
+}
+
+// 复制匹配（偏移小于长度时源与目标重叠，需逐字节复制）
+static esp_err_t _copy_match(mqtt_decomp_t *d)
+{
+    if (d->match_off == 0 || d->match_off > d->out) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (d->match_len > d->raw_len - d->out) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t *op = d->dst + d->out;
+    const uint8_t *ref = op - d->match_off;
+    if (d->match_off >= d->match_len) {
+        memcpy(op, ref, d->match_len);
+    } else {
+        for (size_t i = 0; i < d->match_len; i++) {
+            op[i] = ref[i];
+        }
+    }
+    d->out += d->match_len;
+    d->state = DEC_TOKEN;
+    return ESP_OK;
+}
+
+static esp_err_t _feed(mqtt_decomp_t *d, const uint8_t *ip, size_t len)
+{
+    const uint8_t *iend = ip + len;
+
+    while (ip < iend) {
+        size_t n;
+        uint8_t b;
+        esp_err_t err;
+
+        switch (d->state) {
+        case DEC_HDR:
+            d->hdr[d->hdr_len++] = *ip++;
+            if (d->hdr_len == MQTT_COMPRESS_HDR_LEN && (err = _parse_header(d)) != ESP_OK) {
+                return err;
+            }
+            continue;
+
+        case DEC_RAW:
+            n = (size_t)(iend - ip);
+            if (n > d->raw_len - d->out) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            memcpy(d->dst + d->out, ip, n);
+            d->out += n;
+            ip += n;
+            break;
+
+        case DEC_TOKEN:
+            b = *ip++;
+            d->lit_left = b >> 4;
+            d->match_len = (b & 0x0F) + LZ4_MIN_MATCH;
+            d->state = (d->lit_left == 15) ? DEC_LIT_EXT : (d->lit_left > 0 ? DEC_LIT : DEC_OFF_LO);
+            break;
+
+        case DEC_LIT_EXT:
+            b = *ip++;
+            d->lit_left += b;
+            if (b != 255) {
+                d->state = DEC_LIT;
+            }
+            break;
+
+        case DEC_LIT:
+            n = (size_t)(iend - ip);
+            if (n > d->lit_left) {
+                n = d->lit_left;
+            }
+            if (n > d->raw_len - d->out) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            memcpy(d->dst + d->out, ip, n);
+            d->out += n;
+            d->lit_left -= n;
+            ip += n;
+            if (d->lit_left == 0) {
+                d->state = DEC_OFF_LO;
+            }
+            break;
+
+        case DEC_OFF_LO:
+            d->match_off = *ip++;
+            d->state = DEC_OFF_HI;
+            break;
+
+        case DEC_OFF_HI:
+            d->match_off |= (uint16_t)(*ip++) << 8;
+            if (d->match_len == 15 + LZ4_MIN_MATCH) {
+                d->state = DEC_MATCH_EXT;
+            } else if ((err = _copy_match(d)) != ESP_OK) {
+                return err;
+            }
+            break;
+
+        case DEC_MATCH_EXT:
+            b = *ip++;
+            d->match_len += b;
+            if (b != 255 && (err = _copy_match(d)) != ESP_OK) {
+                return err;
+            }
+            break;
+
+        default:
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t mqtt_decomp_feed(mqtt_decomp_t *d, const uint8_t *data, size_t len)
+{
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = _feed(d, data, len);
+    d->wire_len += len;
+    d->cpu_us += (uint32_t)(esp_timer_get_time() - start);
+    return err;
+}
+
+bool mqtt_decomp_finish(const mqtt_decomp_t *d)
+{
+    if (d->out != d->raw_len) {
+        return false;
+    }
+    // 原样负载已全部写入，LZ4 块以只含字面量的序列结束
+    return d->state == DEC_RAW || d->state == DEC_OFF_LO;
+}
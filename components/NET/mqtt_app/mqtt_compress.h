@@ -0,0 +1,98 @@
+#ifndef __MQTT_COMPRESS_H__
+#define __MQTT_COMPRESS_H__
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 负载压缩头（开启压缩的主题上每条消息都带此头，4 字节）：
+ *   [0]    0xC0 | 方法（0：原样，1：LZ4 块格式）
+ *   [1..3] 原始长度（24 位小端）
+ * 头部自描述：发送端在压缩无收益时按原样发送，接收端两种都能处理。
+ * 压缩数据为标准 LZ4 块格式（不含帧头），上位机可直接用 lz4 块接口编解码。
+ */
+#define MQTT_COMPRESS_HDR_LEN       4
+#define MQTT_COMPRESS_MAGIC         0xC0
+#define MQTT_COMPRESS_MAX_LEN       0xFFFFFF
+
+typedef enum {
+    MQTT_COMPRESS_RAW = 0,
+    MQTT_COMPRESS_LZ4 = 1,
+} mqtt_compress_method_t;
+
+/**
+ * @brief 按主题统计（发送与接收分别记在各自主题上）
+ */
+typedef struct {
+    uint32_t messages;          // 消息数
+    uint32_t compressed;        // 实际压缩的消息数（其余无收益，按原样发送）
+    uint64_t raw_bytes;         // 原始字节数
+    uint64_t wire_bytes;        // 线上字节数（含压缩头）
+    uint64_t cpu_us;            // 压缩/解压耗时
+} mqtt_compress_stats_t;
+
+/**
+ * @brief 流式解压状态（分片按到达顺序喂入，输出直接写入目标缓冲区）
+ */
+typedef struct {
+    uint8_t *dst;
+    size_t cap;                 // 目标缓冲区大小
+    size_t out;                 // 已输出字节数
+    size_t raw_len;             // 头部声明的原始长度（解析头部前为 0）
+    size_t wire_len;            // 已输入字节数
+    uint32_t cpu_us;            // 本条消息累计解压耗时
+    uint8_t hdr[MQTT_COMPRESS_HDR_LEN];
+    uint8_t hdr_len;
+    uint8_t method;
+    uint8_t state;
+    size_t lit_left;            // 当前序列剩余字面量
+    size_t match_len;           // 当前序列匹配长度
+    uint16_t match_off;         // 当前序列匹配偏移
+} mqtt_decomp_t;
+
+esp_err_t mqtt_compress_init(void);
+
+/**
+ * @brief 开启/关闭主题的发布压缩（精确匹配，首次开启时分配哈希表）
+ */
+esp_err_t mqtt_compress_set_topic(const char *topic, bool enable);
+
+/**
+ * @brief 为开启压缩的主题生成带头负载（*out 由调用者 free）
+ *
+ * @return ESP_OK 已生成，ESP_ERR_NOT_FOUND 主题未开启压缩（按原样发布），其余为失败
+ */
+esp_err_t mqtt_compress_pack(const char *topic, const uint8_t *data, size_t len, uint8_t **out, size_t *out_len);
+
+/**
+ * @brief 记录一条已解压消息的统计（接收方向）
+ */
+void mqtt_compress_record(const char *topic, size_t raw_len, size_t wire_len, uint32_t cpu_us, bool compressed);
+
+/**
+ * @brief 获取主题统计（主题从未出现时返回 ESP_ERR_NOT_FOUND）
+ */
+esp_err_t mqtt_compress_get_stats(const char *topic, mqtt_compress_stats_t *stats);
+
+/**
+ * @brief 从消息首个分片读取压缩头中的原始长度（用于按需分配解压缓冲区）
+ */
+esp_err_t mqtt_compress_peek(const uint8_t *data, size_t len, size_t *raw_len);
+
+void mqtt_decomp_begin(mqtt_decomp_t *d, uint8_t *dst, size_t cap);
+
+/**
+ * @brief 喂入下一段负载（解析压缩头后 raw_len 有效，out 随解压推进）
+ *
+ * @return ESP_OK，ESP_ERR_INVALID_SIZE 超出目标缓冲区或声明长度，ESP_ERR_INVALID_RESPONSE 数据损坏
+ */
+esp_err_t mqtt_decomp_feed(mqtt_decomp_t *d, const uint8_t *data, size_t len);
+
+/**
+ * @brief 负载全部喂入后检查是否完整解出
+ */
+bool mqtt_decomp_finish(const mqtt_decomp_t *d);
+
+#endif /* __MQTT_COMPRESS_H__ */
@@ -0,0 +1,220 @@
+#include "mqtt_loopback.h"
+#include "mqtt_app_config.h"
+#include "mqtt_router.h"
+#include "mqtt_client.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "mqtt_loopback";
+
+typedef enum {
+    LOOP_MSG_PUBLISH = 0,
+    LOOP_MSG_SUBSCRIBE,
+} loop_msg_type_t;
+
+typedef struct {
+    loop_msg_type_t type;
+    int msg_id;
+    int qos;
+    size_t len;
+    char *topic;                // 与负载同一块内存（topic 在前）
+    uint8_t *data;
+} loop_msg_t;
+
+static QueueHandle_t s_queue = NULL;
+static esp_event_handler_t s_handler = NULL;
+static portMUX_TYPE s_id_lock = portMUX_INITIALIZER_UNLOCKED;
+static int s_next_id = 1;
+static mqtt_loopback_stats_t s_stats = {0};
+
+static int _next_msg_id(void)
+{
+    portENTER_CRITICAL(&s_id_lock);
+    int id = s_next_id++;
+    if (s_next_id > 0xFFFF) {
+        s_next_id = 1;
+    }
+    portEXIT_CRITICAL(&s_id_lock);
+    return id;
+}
+
+static void _dispatch(esp_mqtt_event_t *event)
+{
+    s_handler(NULL, NULL, event->event_id, event);
+}
+
+// 按 esp-mqtt 的方式投递：首个分片携带主题，后续分片只带偏移
+static void _deliver(const loop_msg_t *msg)
+{
+    mqtt_route_t *route;
+    if (mqtt_router_match(msg->topic, &route, 1) == 0) {
+        return;
+    }
+
+    esp_mqtt_event_t event = {
+        .event_id = MQTT_EVENT_DATA,
+        .total_data_len = (int)msg->len,
+        .qos = msg->qos,
+        .msg_id = msg->msg_id,
+    };
+    size_t offset = 0;
+    do {
+        size_t chunk = msg->len - offset;
+        if (chunk > MQTT_APP_RX_BUFFER_SIZE) {
+            chunk = MQTT_APP_RX_BUFFER_SIZE;
+        }
+        event.topic = offset == 0 ? msg->topic : NULL;
+        event.topic_len = offset == 0 ? (int)strlen(msg->topic) : 0;
+        event.data = (char *)msg->data + offset;
+        event.data_len = (int)chunk;
+        event.current_data_offset = (int)offset;
+        _dispatch(&event);
+        s_stats.fragments++;
+        offset += chunk;
+    } while (offset < msg->len);
+
+    s_stats.delivered++;
+    s_stats.bytes += msg->len;
+}
+
+static void _broker_task(void *arg)
+{
+    (void)arg;
+    loop_msg_t msg;
+
+    // 与 esp-mqtt 相同的连接事件序列（BEFORE_CONNECT 是握手耗时统计的起点）
+    esp_mqtt_event_t before = {
+        .event_id = MQTT_EVENT_BEFORE_CONNECT,
+    };
+    _dispatch(&before);
+
+    esp_mqtt_event_t connected = {
+        .event_id = MQTT_EVENT_CONNECTED,
+        .session_present = 0,
+    };
+    _dispatch(&connected);
+
+    while (1) {
+        if (xQueueReceive(s_queue, &msg, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        UBaseType_t waiting = uxQueueMessagesWaiting(s_queue) + 1;
+        if (waiting > s_stats.queue_high_water) {
+            s_stats.queue_high_water = waiting;
+        }
+
+        if (msg.type == LOOP_MSG_SUBSCRIBE) {
+            esp_mqtt_event_t event = {
+                .event_id = MQTT_EVENT_SUBSCRIBED,
+                .msg_id = msg.msg_id,
+            };
+            _dispatch(&event);
+            continue;
+        }
+
+        _deliver(&msg);
+        if (msg.qos > 0) {
+            esp_mqtt_event_t event = {
+                .event_id = MQTT_EVENT_PUBLISHED,
+                .msg_id = msg.msg_id,
+            };
+            _dispatch(&event);
+        }
+        free(msg.topic);
+    }
+}
+
+esp_err_t mqtt_loopback_start(esp_event_handler_t handler)
+{
+    if (handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_queue != NULL) {
+        return ESP_OK;
+    }
+
+    s_handler = handler;
+    s_queue = xQueueCreate(MQTT_APP_LOOPBACK_QUEUE_LEN, sizeof(loop_msg_t));
+    if (s_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(_broker_task, "mqtt_loopback", MQTT_APP_LOOPBACK_TASK_STACK, NULL,
+                    MQTT_APP_LOOPBACK_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "代理任务创建失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGW(TAG, "回环模式：消息不经过网络，仅用于性能测试");
+    return ESP_OK;
+}
+
+int mqtt_loopback_publish(const char *topic, const void *data, size_t len, int qos)
+{
+    if (s_queue == NULL || topic == NULL || (data == NULL && len > 0)) {
+        return -1;
+    }
+
+    // 与网络发送一样复制一份，发布方返回后即可复用缓冲区
+    size_t topic_size = strlen(topic) + 1;
+    char *buf = heap_caps_malloc(topic_size + len, MALLOC_CAP_SPIRAM);
+    if (buf == NULL) {
+        buf = malloc(topic_size + len);
+    }
+    if (buf == NULL) {
+        s_stats.rejected++;
+        return -1;
+    }
+    memcpy(buf, topic, topic_size);
+    memcpy(buf + topic_size, data, len);
+
+    loop_msg_t msg = {
+        .type = LOOP_MSG_PUBLISH,
+        .msg_id = qos > 0 ? _next_msg_id() : 0,
+        .qos = qos,
+        .len = len,
+        .topic = buf,
+        .data = (uint8_t *)buf + topic_size,
+    };
+    if (xQueueSend(s_queue, &msg, 0) != pdTRUE) {
+        free(buf);
+        s_stats.rejected++;
+        return -1;
+    }
+    s_stats.published++;
+    return msg.msg_id;
+}
+
+int mqtt_loopback_subscribe(const char *filter, int qos)
+{
+    (void)filter;
+    if (s_queue == NULL) {
+        return -1;
+    }
+
+    loop_msg_t msg = {
+        .type = LOOP_MSG_SUBSCRIBE,
+        .msg_id = _next_msg_id(),
+        .qos = qos,
+    };
+    return xQueueSend(s_queue, &msg, 0) == pdTRUE ? msg.msg_id : -1;
+}
+
+int mqtt_loopback_unsubscribe(const char *filter)
+{
+    (void)filter;
+    return s_queue != NULL ? _next_msg_id() : -1;
+}
+
+void mqtt_loopback_get_stats(mqtt_loopback_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = s_stats;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef __MQTT_LOOPBACK_H__
+#define __MQTT_LOOPBACK_H__
+
+#include "esp_err.h"
+#include "esp_event.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 回环代理统计
+ */
+typedef struct {
+    uint32_t published;         // 收到的发布
+    uint32_t delivered;         // 投递给订阅者的消息
+    uint32_t fragments;         // 投递的分片数（按接收缓冲区大小切分）
+    uint32_t rejected;          // 队列满或内存不足被拒绝的发布
+    uint64_t bytes;             // 投递的负载字节数
+    uint32_t queue_high_water;  // 待投递队列峰值
+} mqtt_loopback_stats_t;
+
+/**
+ * @brief 启动进程内代理替身（MQTT_APP_LOOPBACK 为 1 时由 mqtt_app_init 调用）
+ *
+ * 发布的消息被复制后由代理任务投递：匹配已注册路由的主题按接收缓冲区大小切分为
+ * MQTT_EVENT_DATA 分片，QoS > 0 的消息随后产生 MQTT_EVENT_PUBLISHED。所有事件都在
+ * 代理任务中回调 handler，与 esp-mqtt 的单任务事件模型一致。
+ */
+esp_err_t mqtt_loopback_start(esp_event_handler_t handler);
+
+/**
+ * @brief 发布（返回 msg_id，QoS 0 时为 0，队列满返回 -1）
+ */
+int mqtt_loopback_publish(const char *topic, const void *data, size_t len, int qos);
+
+/**
+ * @brief 订阅（订阅关系由路由表决定，这里只产生 MQTT_EVENT_SUBSCRIBED）
+ */
+int mqtt_loopback_subscribe(const char *filter, int qos);
+
+/**
+ * @brief 取消订阅（删除路由即停止投递，这里只分配 msg_id）
+ */
+int mqtt_loopback_unsubscribe(const char *filter);
+
+/**
+ * @brief 获取统计
+ */
+void mqtt_loopback_get_stats(mqtt_loopback_stats_t *stats);
+
+#endif /* __MQTT_LOOPBACK_H__ */
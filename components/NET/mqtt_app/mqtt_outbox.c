@@ -0,0 +1,726 @@
+#include "mqtt_outbox.h"
+#include "mqtt_app_config.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "mqtt_outbox";
+
+#define REC_WRAP            0xFFFF      // 记录头 topic_len 为该值表示回绕到缓冲区开头
+#define REC_ALIGN(x)        (((x) + 7) & ~(size_t)7)
+
+#define TOKEN_SCALE         1000000LL   // 令牌以 字节 x 1e6 计，按微秒补充时没有舍入误差
+
+// 环形缓冲区中的记录：头 + 主题（不含 '\0'）+ 负载，按 8 字节对齐（记录头含 int64）
+typedef struct {
+    uint32_t payload_len;
+    uint16_t topic_len;
+    uint8_t qos;
+    uint8_t rule;               // 主题规则序号 + 1，0 表示无规则
+    int64_t enqueue_us;
+} rec_hdr_t;
+
+// 每个优先级一个环形缓冲区，类内按顺序发送
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t head;
+    size_t tail;
+    size_t bytes;               // 记录占用字节数（不含回绕浪费）
+    uint32_t count;
+    bool sending;               // 队首记录正在发送，不可回收
+} ring_t;
+
+// 主题规则：优先级与令牌桶
+typedef struct {
+    char topic[MQTT_APP_TOPIC_MAX_LEN];
+    bool used;
+    mqtt_outbox_prio_t prio;
+    uint32_t rate_bps;          // 0 表示不限速
+    int64_t burst;              // 令牌上限（已乘 TOKEN_SCALE）
+    int64_t tokens;             // 可为负：超过突发量的单条消息先透支
+    int64_t last_us;
+} topic_rule_t;
+
+typedef struct {
+    char topic[MQTT_APP_TOPIC_MAX_LEN];
+    mqtt_outbox_coalesce_t mode;
+    int64_t window_us;
+    size_t max_len;
+    int delimiter;
+    uint8_t *buf;
+    size_t len;
+    int qos;
+    int64_t first_us;           // 第一条消息入队时间，0 表示为空
+} coalesce_slot_t;
+
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static mqtt_outbox_send_fn_t s_send = NULL;
+static void *s_send_ctx = NULL;
+static mqtt_outbox_spill_fn_t s_spill = NULL;
+static volatile bool s_connected = false;
+
+// 环形缓冲区（s_lock 保护）
+static uint8_t *s_buf = NULL;
+static ring_t s_rings[MQTT_OUTBOX_PRIO_MAX];
+static const size_t s_ring_size[MQTT_OUTBOX_PRIO_MAX] = {
+    MQTT_APP_OUTBOX_CONTROL_SIZE,
+    MQTT_APP_OUTBOX_NORMAL_SIZE,
+    MQTT_APP_OUTBOX_BULK_SIZE,
+};
+
+static coalesce_slot_t s_coalesce[MQTT_APP_OUTBOX_COALESCE_SLOTS];
+static topic_rule_t s_rules[MQTT_APP_OUTBOX_RULE_SLOTS];
+
+// 已发送未确认的 msg_id
+static int s_inflight[MQTT_APP_OUTBOX_INFLIGHT];
+static int s_inflight_cnt = 0;
+
+// 不在窗口中的确认：PUBLISHED 可能先于 s_send 返回到达（也可能属于直接发布的消息），
+// 记录最近几个，发送返回后据此不再计入窗口
+static int s_early_ack[MQTT_APP_OUTBOX_INFLIGHT];
+static int s_early_ack_pos = 0;
+
+static mqtt_outbox_stats_t s_stats = {0};
+static uint64_t s_delay_sum_us[MQTT_OUTBOX_PRIO_MAX];
+
+static size_t _rec_size(const rec_hdr_t *hdr)
+{
+    return REC_ALIGN(sizeof(rec_hdr_t) + hdr->topic_len + hdr->payload_len);
+}
+
+// 队首记录（必要时回绕），队列为空返回 NULL
+static rec_hdr_t *_ring_peek(ring_t *ring)
+{
+    if (ring->count == 0) {
+        return NULL;
+    }
+    if (ring->size - ring->tail < sizeof(rec_hdr_t) ||
+        ((rec_hdr_t *)(ring->buf + ring->tail))->topic_len == REC_WRAP) {
+        ring->tail = 0;
+    }
+    return (rec_hdr_t *)(ring->buf + ring->tail);
+}
+
+static void _ring_pop(ring_t *ring)
+{
+    rec_hdr_t *hdr = _ring_peek(ring);
+    if (hdr == NULL) {
+        return;
+    }
+    size_t size = _rec_size(hdr);
+    ring->tail += size;
+    ring->bytes -= size;
+    if (--ring->count == 0) {
+        ring->head = 0;
+        ring->tail = 0;
+    }
+}
+
+// 申请连续空间，不足返回 NULL
+static uint8_t *_ring_alloc(ring_t *ring, size_t need)
+{
+    if (ring->count == 0) {
+        ring->head = 0;
+        ring->tail = 0;
+    } else if (ring->head == ring->tail) {
+        return NULL;
+    }
+
+    if (ring->head >= ring->tail) {
+        if (ring->size - ring->head >= need) {
+            uint8_t *p = ring->buf + ring->head;
+            ring->head += need;
+            return p;
+        }
+        // 尾部放不下，回绕到开头（开头到队首之间的空间）
+        if (need <= ring->tail) {
+            if (ring->size - ring->head >= sizeof(rec_hdr_t)) {
+                ((rec_hdr_t *)(ring->buf + ring->head))->topic_len = REC_WRAP;
+            }
+            ring->head = need;
+            return ring->buf;
+        }
+        return NULL;
+    }
+
+    if (ring->tail - ring->head >= need) {
+        uint8_t *p = ring->buf + ring->head;
+        ring->head += need;
+        return p;
+    }
+    return NULL;
+}
+
+static void _count_drop(mqtt_outbox_prio_t prio)
+{
+    s_stats.dropped++;
+    s_stats.classes[prio].dropped++;
+}
+
+// 回收最旧的记录（有转存回调时先转存），正在发送的记录不能回收
+static bool _evict_oldest(mqtt_outbox_prio_t prio)
+{
+    ring_t *ring = &s_rings[prio];
+    rec_hdr_t *hdr = _ring_peek(ring);
+    if (hdr == NULL || ring->sending) {
+        // 队首正在发送时无法按顺序回收，改为丢弃新消息
+        return false;
+    }
+
+    const char *topic_raw = (const char *)(hdr + 1);
+    const uint8_t *payload = (const uint8_t *)topic_raw + hdr->topic_len;
+    if (s_spill) {
+        char topic[MQTT_APP_TOPIC_MAX_LEN];
+        memcpy(topic, topic_raw, hdr->topic_len);
+        topic[hdr->topic_len] = '\0';
+        if (s_spill(topic, payload, hdr->payload_len, hdr->qos) == ESP_OK) {
+            s_stats.spilled++;
+        } else {
+            _count_drop(prio);
+        }
+    } else {
+        _count_drop(prio);
+    }
+    _ring_pop(ring);
+    return true;
+}
+
+static topic_rule_t *_find_rule(const char *topic)
+{
+    for (int i = 0; i < MQTT_APP_OUTBOX_RULE_SLOTS; i++) {
+        if (s_rules[i].used && strcmp(s_rules[i].topic, topic) == 0) {
+            return &s_rules[i];
+        }
+    }
+    return NULL;
+}
+
+// 令牌不足时返回需等待的微秒数，否则扣除令牌并返回 0（调用者持有锁）
+static int64_t _rule_take(topic_rule_t *rule, size_t len, int64_t now)
+{
+    if (rule == NULL || !rule->used || rule->rate_bps == 0) {
+        return 0;
+    }
+
+    rule->tokens += (now - rule->last_us) * rule->rate_bps;
+    if (rule->tokens > rule->burst) {
+        rule->tokens = rule->burst;
+    }
+    rule->last_us = now;
+
+    // 超过突发量的消息只需桶满即可发送，之后由透支的令牌限速
+    int64_t need = (int64_t)len * TOKEN_SCALE;
+    if (need > rule->burst) {
+        need = rule->burst;
+    }
+    if (rule->tokens < need) {
+        return (need - rule->tokens) / rule->rate_bps + 1;
+    }
+    rule->tokens -= (int64_t)len * TOKEN_SCALE;
+    return 0;
+}
+
+// 写入一条记录，按主题规则选择优先级（调用者持有锁）
+static esp_err_t _ring_push(const char *topic, size_t topic_len, const void *data, size_t len, int qos,
+                            int64_t enqueue_us)
+{
+    topic_rule_t *rule = _find_rule(topic);
+    mqtt_outbox_prio_t prio = rule ? rule->prio : MQTT_OUTBOX_PRIO_NORMAL;
+    ring_t *ring = &s_rings[prio];
+
+    rec_hdr_t hdr = {
+        .payload_len = (uint32_t)len,
+        .topic_len = (uint16_t)topic_len,
+        .qos = (uint8_t)qos,
+        .rule = rule ? (uint8_t)(rule - s_rules + 1) : 0,
+        .enqueue_us = enqueue_us,
+    };
+    size_t need = _rec_size(&hdr);
+    if (need > ring->size / 2) {
+        _count_drop(prio);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t *p;
+    while ((p = _ring_alloc(ring, need)) == NULL) {
+        if (!_evict_oldest(prio)) {
+            _count_drop(prio);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    memcpy(p, &hdr, sizeof(hdr));
+    memcpy(p + sizeof(hdr), topic, topic_len);
+    memcpy(p + sizeof(hdr) + topic_len, data, len);
+    ring->bytes += need;
+    ring->count++;
+
+    size_t total = 0;
+    for (int i = 0; i < MQTT_OUTBOX_PRIO_MAX; i++) {
+        total += s_rings[i].bytes;
+    }
+    if (total > s_stats.high_water_bytes) {
+        s_stats.high_water_bytes = (uint32_t)total;
+    }
+    return ESP_OK;
+}
+
+static coalesce_slot_t *_find_coalesce(const char *topic)
+{
+    for (int i = 0; i < MQTT_APP_OUTBOX_COALESCE_SLOTS; i++) {
+        if (s_coalesce[i].mode != MQTT_OUTBOX_COALESCE_NONE && strcmp(s_coalesce[i].topic, topic) == 0) {
+            return &s_coalesce[i];
+        }
+    }
+    return NULL;
+}
+
+// 把合并缓冲区作为一条消息写入环形缓冲区（调用者持有锁）
+static void _flush_coalesce(coalesce_slot_t *slot)
+{
+    if (slot->first_us == 0) {
+        return;
+    }
+    _ring_push(slot->topic, strlen(slot->topic), slot->buf, slot->len, slot->qos, slot->first_us);
+    slot->len = 0;
+    slot->qos = 0;
+    slot->first_us = 0;
+}
+
+// 合并到主题缓冲区（调用者持有锁）
+static void _coalesce_add(coalesce_slot_t *slot, const void *data, size_t len, int qos, int64_t now)
+{
+    size_t extra = (slot->mode == MQTT_OUTBOX_COALESCE_CONCAT && slot->len > 0 && slot->delimiter >= 0) ? 1 : 0;
+
+    if (slot->first_us != 0) {
+        if (slot->mode == MQTT_OUTBOX_COALESCE_LATEST) {
+            slot->len = 0;
+            s_stats.coalesced++;
+        } else if (slot->len + extra + len > slot->max_len) {
+            _flush_coalesce(slot);
+            extra = 0;
+        } else {
+            s_stats.coalesced++;
+        }
+    }
+    if (slot->first_us == 0) {
+        slot->first_us = now;
+    }
+
+    if (extra) {
+        slot->buf[slot->len++] = (uint8_t)slot->delimiter;
+    }
+    memcpy(slot->buf + slot->len, data, len);
+    slot->len += len;
+    if (qos > slot->qos) {
+        slot->qos = qos;
+    }
+}
+
+// 发送窗口到期的合并消息，返回距下一个到期的时间
+static TickType_t _flush_expired(int64_t now)
+{
+    int64_t next_us = INT64_MAX;
+    for (int i = 0; i < MQTT_APP_OUTBOX_COALESCE_SLOTS; i++) {
+        coalesce_slot_t *slot = &s_coalesce[i];
+        if (slot->mode == MQTT_OUTBOX_COALESCE_NONE || slot->first_us == 0) {
+            continue;
+        }
+        int64_t due = slot->first_us + slot->window_us;
+        if (due <= now) {
+            _flush_coalesce(slot);
+        } else if (due - now < next_us) {
+            next_us = due - now;
+        }
+    }
+    if (next_us == INT64_MAX) {
+        return portMAX_DELAY;
+    }
+    return pdMS_TO_TICKS(next_us / 1000) + 1;
+}
+
+static bool _inflight_remove(int msg_id)
+{
+    for (int i = 0; i < s_inflight_cnt; i++) {
+        if (s_inflight[i] == msg_id) {
+            s_inflight[i] = s_inflight[--s_inflight_cnt];
+            return true;
+        }
+    }
+    return false;
+}
+
+// 取走已提前到达的确认
+static bool _early_ack_take(int msg_id)
+{
+    for (int i = 0; i < MQTT_APP_OUTBOX_INFLIGHT; i++) {
+        if (s_early_ack[i] == msg_id) {
+            s_early_ack[i] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 非控制类最多占用的未确认窗口，其余留给控制类
+static int _inflight_limit(mqtt_outbox_prio_t prio)
+{
+    return prio == MQTT_OUTBOX_PRIO_CONTROL ? MQTT_APP_OUTBOX_INFLIGHT
+                                            : MQTT_APP_OUTBOX_INFLIGHT - MQTT_APP_OUTBOX_INFLIGHT_RESERVE;
+}
+
+// 按优先级发送：每次从最高的可发送类取队首，类内保持顺序；返回下次需要唤醒的时间
+static TickType_t _drain(void)
+{
+    char topic[MQTT_APP_TOPIC_MAX_LEN];
+
+    while (s_connected) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        int64_t now = esp_timer_get_time();
+        int64_t wait_us = INT64_MAX;
+        mqtt_outbox_prio_t prio = MQTT_OUTBOX_PRIO_MAX;
+        rec_hdr_t *hdr = NULL;
+
+        for (int c = 0; c < MQTT_OUTBOX_PRIO_MAX; c++) {
+            rec_hdr_t *h = _ring_peek(&s_rings[c]);
+            if (h == NULL || (h->qos > 0 && s_inflight_cnt >= _inflight_limit(c))) {
+                // 队列为空，或等待 PUBLISHED 释放窗口
+                continue;
+            }
+            int64_t w = _rule_take(h->rule ? &s_rules[h->rule - 1] : NULL, h->payload_len, now);
+            if (w > 0) {
+                // 限速中，先发送低优先级类
+                if (w < wait_us) {
+                    wait_us = w;
+                }
+                continue;
+            }
+            prio = c;
+            hdr = h;
+            break;
+        }
+        if (hdr == NULL) {
+            xSemaphoreGive(s_lock);
+            return wait_us == INT64_MAX ? portMAX_DELAY : pdMS_TO_TICKS(wait_us / 1000) + 1;
+        }
+
+        // 队首记录在发送期间保持有效（生产者只写空闲区，回收会跳过 sending）
+        ring_t *ring = &s_rings[prio];
+        ring->sending = true;
+        memcpy(topic, hdr + 1, hdr->topic_len);
+        topic[hdr->topic_len] = '\0';
+        const uint8_t *payload = (const uint8_t *)(hdr + 1) + hdr->topic_len;
+        size_t len = hdr->payload_len;
+        int qos = hdr->qos;
+        uint8_t rule = hdr->rule;
+        int64_t enqueue_us = hdr->enqueue_us;
+        xSemaphoreGive(s_lock);
+
+        int msg_id = s_send(topic, payload, len, qos, s_send_ctx);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        ring->sending = false;
+        if (msg_id < 0) {
+            // 未发出，退还令牌
+            if (rule) {
+                s_rules[rule - 1].tokens += (int64_t)len * TOKEN_SCALE;
+            }
+            s_stats.send_failures++;
+            xSemaphoreGive(s_lock);
+            return pdMS_TO_TICKS(MQTT_APP_OUTBOX_RETRY_MS);
+        }
+        if (qos > 0 && msg_id > 0 && !_early_ack_take(msg_id) && s_inflight_cnt < MQTT_APP_OUTBOX_INFLIGHT) {
+            s_inflight[s_inflight_cnt++] = msg_id;
+        }
+        _ring_pop(ring);
+        s_stats.sent++;
+
+        mqtt_outbox_class_stats_t *cls = &s_stats.classes[prio];
+        int64_t delay_us = esp_timer_get_time() - enqueue_us;
+        uint32_t delay_ms = (uint32_t)(delay_us / 1000);
+        cls->sent++;
+        s_delay_sum_us[prio] += delay_us;
+        cls->avg_delay_ms = (uint32_t)(s_delay_sum_us[prio] / cls->sent / 1000);
+        if (delay_ms > cls->max_delay_ms) {
+            cls->max_delay_ms = delay_ms;
+        }
+        if (delay_ms > s_stats.max_delay_ms) {
+            s_stats.max_delay_ms = delay_ms;
+        }
+        xSemaphoreGive(s_lock);
+    }
+    return portMAX_DELAY;
+}
+
+static void _outbox_task(void *arg)
+{
+    (void)arg;
+    TickType_t wait = portMAX_DELAY;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        wait = _flush_expired(esp_timer_get_time());
+        xSemaphoreGive(s_lock);
+
+        TickType_t next = _drain();
+        if (next < wait) {
+            wait = next;
+        }
+    }
+}
+
+esp_err_t mqtt_outbox_init(mqtt_outbox_send_fn_t send, void *ctx)
+{
+    if (send == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+
+#if CONFIG_SPIRAM
+    s_buf = heap_caps_malloc(MQTT_APP_OUTBOX_SIZE, MALLOC_CAP_SPIRAM);
+#else
+    s_buf = heap_caps_malloc(MQTT_APP_OUTBOX_SIZE, MALLOC_CAP_INTERNAL);
+#endif
+    s_lock = xSemaphoreCreateMutex();
+    if (s_buf == NULL || s_lock == NULL) {
+        ESP_LOGE(TAG, "发件箱缓冲区分配失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t offset = 0;
+    for (int i = 0; i < MQTT_OUTBOX_PRIO_MAX; i++) {
+        s_rings[i].buf = s_buf + offset;
+        s_rings[i].size = s_ring_size[i];
+        offset += s_ring_size[i];
+    }
+    s_send = send;
+    s_send_ctx = ctx;
+
+    if (xTaskCreate(_outbox_task, "mqtt_outbox", MQTT_APP_OUTBOX_TASK_STACK, NULL,
+                    MQTT_APP_OUTBOX_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "发送任务创建失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "发件箱已启动 (控制/普通/批量 %u/%u/%u KB, QoS 窗口 %d)",
+             MQTT_APP_OUTBOX_CONTROL_SIZE / 1024, MQTT_APP_OUTBOX_NORMAL_SIZE / 1024,
+             MQTT_APP_OUTBOX_BULK_SIZE / 1024, MQTT_APP_OUTBOX_INFLIGHT);
+    return ESP_OK;
+}
+
+esp_err_t mqtt_outbox_enqueue(const char *topic, const void *data, size_t len, int qos)
+{
+    if (topic == NULL || (data == NULL && len > 0) || qos < 0 || qos > 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    size_t topic_len = strlen(topic);
+    if (topic_len == 0 || topic_len >= MQTT_APP_TOPIC_MAX_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+    esp_err_t err = ESP_OK;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.enqueued++;
+    coalesce_slot_t *slot = _find_coalesce(topic);
+    if (slot != NULL && len <= slot->max_len) {
+        _coalesce_add(slot, data, len, qos, now);
+    } else {
+        // 不合并的主题，或单条超过合并上限：先发送已合并的部分以保持顺序
+        if (slot != NULL) {
+            _flush_coalesce(slot);
+        }
+        err = _ring_push(topic, topic_len, data, len, qos, now);
+    }
+    xSemaphoreGive(s_lock);
+
+    xTaskNotifyGive(s_task);
+    return err;
+}
+
+esp_err_t mqtt_outbox_set_coalesce(const char *topic, mqtt_outbox_coalesce_t mode, uint32_t window_ms,
+                                   size_t max_len, int delimiter)
+{
+    if (topic == NULL || strlen(topic) >= MQTT_APP_TOPIC_MAX_LEN ||
+        (mode != MQTT_OUTBOX_COALESCE_NONE && (window_ms == 0 || max_len == 0))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    coalesce_slot_t *slot = _find_coalesce(topic);
+    if (slot != NULL) {
+        // 修改或取消设置前先发出已合并的数据
+        _flush_coalesce(slot);
+        free(slot->buf);
+        memset(slot, 0, sizeof(*slot));
+    }
+
+    if (mode != MQTT_OUTBOX_COALESCE_NONE) {
+        slot = NULL;
+        for (int i = 0; i < MQTT_APP_OUTBOX_COALESCE_SLOTS; i++) {
+            if (s_coalesce[i].mode == MQTT_OUTBOX_COALESCE_NONE) {
+                slot = &s_coalesce[i];
+                break;
+            }
+        }
+        if (slot == NULL) {
+            err = ESP_ERR_NO_MEM;
+        } else if ((slot->buf = malloc(max_len)) == NULL) {
+            err = ESP_ERR_NO_MEM;
+        } else {
+            strcpy(slot->topic, topic);
+            slot->mode = mode;
+            slot->window_us = (int64_t)window_ms * 1000;
+            slot->max_len = max_len;
+            slot->delimiter = delimiter;
+        }
+    }
+    xSemaphoreGive(s_lock);
+
+    if (err == ESP_OK && mode != MQTT_OUTBOX_COALESCE_NONE) {
+        ESP_LOGI(TAG, "主题合并: %s (%s, %lu ms, 上限 %u 字节)", topic,
+                 mode == MQTT_OUTBOX_COALESCE_CONCAT ? "拼接" : "保留最新",
+                 (unsigned long)window_ms, (unsigned)max_len);
+    }
+    return err;
+}
+
+esp_err_t mqtt_outbox_set_topic_class(const char *topic, mqtt_outbox_prio_t prio, uint32_t rate_bps,
+                                      uint32_t burst_bytes)
+{
+    if (topic == NULL || strlen(topic) >= MQTT_APP_TOPIC_MAX_LEN || prio >= MQTT_OUTBOX_PRIO_MAX ||
+        (rate_bps > 0 && burst_bytes == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    topic_rule_t *rule = _find_rule(topic);
+    if (prio == MQTT_OUTBOX_PRIO_NORMAL && rate_bps == 0) {
+        // 恢复默认：已排队的消息仍按原优先级发送
+        if (rule != NULL) {
+            rule->used = false;
+        }
+    } else {
+        if (rule == NULL) {
+            for (int i = 0; i < MQTT_APP_OUTBOX_RULE_SLOTS; i++) {
+                if (!s_rules[i].used) {
+                    rule = &s_rules[i];
+                    break;
+                }
+            }
+        }
+        if (rule == NULL) {
+            err = ESP_ERR_NO_MEM;
+        } else {
+            strcpy(rule->topic, topic);
+            rule->prio = prio;
+            rule->rate_bps = rate_bps;
+            rule->burst = (int64_t)burst_bytes * TOKEN_SCALE;
+            rule->tokens = rule->burst;
+            rule->last_us = esp_timer_get_time();
+            rule->used = true;
+        }
+    }
+    xSemaphoreGive(s_lock);
+
+    if (err == ESP_OK) {
+        static const char *names[] = {"控制", "普通", "批量"};
+        ESP_LOGI(TAG, "主题规则: %s (%s, %lu B/s, 突发 %lu 字节)", topic, names[prio],
+                 (unsigned long)rate_bps, (unsigned long)burst_bytes);
+    }
+    return err;
+}
+
+void mqtt_outbox_set_spill_handler(mqtt_outbox_spill_fn_t spill)
+{
+    s_spill = spill;
+}
+
+void mqtt_outbox_on_connected(void)
+{
+    if (s_task == NULL) {
+        return;
+    }
+
+    // 未确认的消息由 MQTT 客户端在重连后重发，窗口重新计数
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_inflight_cnt = 0;
+    memset(s_early_ack, 0, sizeof(s_early_ack));
+    uint32_t backlog = 0;
+    for (int i = 0; i < MQTT_OUTBOX_PRIO_MAX; i++) {
+        backlog += s_rings[i].count;
+    }
+    xSemaphoreGive(s_lock);
+
+    s_connected = true;
+    if (backlog > 0) {
+        ESP_LOGI(TAG, "重连后发送积压消息: %lu 条", (unsigned long)backlog);
+    }
+    xTaskNotifyGive(s_task);
+}
+
+void mqtt_outbox_on_disconnected(void)
+{
+    s_connected = false;
+}
+
+void mqtt_outbox_on_published(int msg_id)
+{
+    if (s_task == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (!_inflight_remove(msg_id) && msg_id > 0) {
+        s_early_ack[s_early_ack_pos] = msg_id;
+        s_early_ack_pos = (s_early_ack_pos + 1) % MQTT_APP_OUTBOX_INFLIGHT;
+    }
+    xSemaphoreGive(s_lock);
+    xTaskNotifyGive(s_task);
+}
+
+void mqtt_outbox_get_stats(mqtt_outbox_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_lock == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    stats->queued = 0;
+    stats->queued_bytes = 0;
+    for (int i = 0; i < MQTT_OUTBOX_PRIO_MAX; i++) {
+        stats->classes[i].queued = s_rings[i].count;
+        stats->queued += s_rings[i].count;
+        stats->queued_bytes += (uint32_t)s_rings[i].bytes;
+    }
+    stats->inflight = (uint32_t)s_inflight_cnt;
+    xSemaphoreGive(s_lock);
+}
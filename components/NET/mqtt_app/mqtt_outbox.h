@@ -0,0 +1,122 @@
+#ifndef __MQTT_OUTBOX_H__
+#define __MQTT_OUTBOX_H__
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 主题合并方式
+ */
+typedef enum {
+    MQTT_OUTBOX_COALESCE_NONE = 0,  // 不合并（取消该主题的合并设置）
+    MQTT_OUTBOX_COALESCE_CONCAT,    // 窗口内的消息按顺序拼接（可选分隔符，如 '\n' 组成 NDJSON）
+    MQTT_OUTBOX_COALESCE_LATEST,    // 窗口内只保留最新一条（状态类主题）
+} mqtt_outbox_coalesce_t;
+
+/**
+ * @brief 优先级类：每类独立的缓冲区，发送时总是先取最高的可发送类，类内保持顺序
+ */
+typedef enum {
+    MQTT_OUTBOX_PRIO_CONTROL = 0,   // 控制/状态：越过排队中的批量数据，并独占部分 QoS 窗口
+    MQTT_OUTBOX_PRIO_NORMAL,        // 默认
+    MQTT_OUTBOX_PRIO_BULK,          // 批量数据（音频、图像、原始采样）
+    MQTT_OUTBOX_PRIO_MAX,
+} mqtt_outbox_prio_t;
+
+/**
+ * @brief 发送函数（返回 msg_id，QoS 0 时为 0，失败返回负值）
+ */
+typedef int (*mqtt_outbox_send_fn_t)(const char *topic, const uint8_t *data, size_t len, int qos, void *ctx);
+
+/**
+ * @brief 溢出转存回调：缓冲区满时最旧的消息交给该回调（如写入 Flash），而不是直接丢弃
+ *
+ * 在持有发件箱锁的情况下调用，应尽快返回（不可在回调中擦写 Flash，应复制后交给其他任务）。
+ * 返回 ESP_OK 计为 spilled，否则计为 dropped。
+ */
+typedef esp_err_t (*mqtt_outbox_spill_fn_t)(const char *topic, const uint8_t *data, size_t len, int qos);
+
+/**
+ * @brief 单个优先级类的统计
+ */
+typedef struct {
+    uint32_t queued;            // 当前排队的消息数
+    uint32_t sent;              // 累计发送
+    uint32_t dropped;           // 缓冲区满或超长被丢弃
+    uint32_t avg_delay_ms;      // 入队到发送的平均延迟
+    uint32_t max_delay_ms;      // 入队到发送的最大延迟
+} mqtt_outbox_class_stats_t;
+
+/**
+ * @brief 发件箱统计
+ */
+typedef struct {
+    uint32_t queued;            // 当前排队的消息数
+    uint32_t queued_bytes;      // 当前占用的缓冲区字节数
+    uint32_t high_water_bytes;  // 占用峰值
+    uint32_t enqueued;          // 累计入队
+    uint32_t coalesced;         // 被合并进其他消息的条数
+    uint32_t sent;              // 累计交给 MQTT 客户端发送
+    uint32_t dropped;           // 缓冲区满或超长被丢弃
+    uint32_t spilled;           // 缓冲区满时转存
+    uint32_t send_failures;     // 发送失败（稍后重试）
+    uint32_t inflight;          // 已发送未确认的 QoS1/2 消息数
+    uint32_t max_delay_ms;      // 入队到发送的最大延迟
+    mqtt_outbox_class_stats_t classes[MQTT_OUTBOX_PRIO_MAX];
+} mqtt_outbox_stats_t;
+
+/**
+ * @brief 初始化发件箱并启动发送任务（缓冲区优先位于 PSRAM）
+ */
+esp_err_t mqtt_outbox_init(mqtt_outbox_send_fn_t send, void *ctx);
+
+/**
+ * @brief 入队（断线时保留，重连后按顺序发送）
+ *
+ * @return ESP_OK 已入队（或已合并），ESP_ERR_INVALID_SIZE 消息超过缓冲区容量，
+ *         ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t mqtt_outbox_enqueue(const char *topic, const void *data, size_t len, int qos);
+
+/**
+ * @brief 设置主题合并（窗口自第一条消息入队开始计时）
+ *
+ * @param delimiter CONCAT 模式下消息之间插入的分隔符，-1 表示不插入
+ * @param max_len   合并后消息的最大长度，超出时先发送已合并的部分
+ */
+esp_err_t mqtt_outbox_set_coalesce(const char *topic, mqtt_outbox_coalesce_t mode, uint32_t window_ms,
+                                   size_t max_len, int delimiter);
+
+/**
+ * @brief 设置主题的优先级类与令牌桶限速
+ *
+ * 令牌按 rate_bps 字节/秒补充，最多积累 burst_bytes；队首消息令牌不足时该类暂停，
+ * 先发送其他类。单条消息的上限为所在类缓冲区的一半。
+ *
+ * @param rate_bps    0 表示不限速
+ * @param burst_bytes 限速时的突发量
+ * @note  设为 NORMAL 且不限速即删除规则；只影响之后入队的消息
+ */
+esp_err_t mqtt_outbox_set_topic_class(const char *topic, mqtt_outbox_prio_t prio, uint32_t rate_bps,
+                                      uint32_t burst_bytes);
+
+/**
+ * @brief 设置溢出转存回调（NULL 表示缓冲区满时丢弃最旧的消息）
+ */
+void mqtt_outbox_set_spill_handler(mqtt_outbox_spill_fn_t spill);
+
+/**
+ * @brief 连接状态与发布确认通知（由 mqtt_app 的事件处理调用）
+ */
+void mqtt_outbox_on_connected(void);
+void mqtt_outbox_on_disconnected(void);
+void mqtt_outbox_on_published(int msg_id);
+
+/**
+ * @brief 获取统计
+ */
+void mqtt_outbox_get_stats(mqtt_outbox_stats_t *stats);
+
+#endif /* __MQTT_OUTBOX_H__ */
@@ -0,0 +1,294 @@
+#include "mqtt_router.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "mqtt_router";
+
+// 主题 trie 节点，每层对应主题中的一级
+typedef struct mqtt_trie_node {
+    char *level;                        // 层级名（"+" / "#" 为通配符）
+    struct mqtt_trie_node *child;
+    struct mqtt_trie_node *sibling;
+    mqtt_route_t *routes;
+} mqtt_trie_node_t;
+
+static mqtt_trie_node_t s_root = {0};
+static mqtt_route_t *s_route_list = NULL;
+static mqtt_route_t *s_retired = NULL;      // 已删除、等待释放的路由（经 list_next 链接）
+static SemaphoreHandle_t s_lock = NULL;
+
+esp_err_t mqtt_router_init(void)
+{
+    if (s_lock != NULL) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    return (s_lock != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// 校验过滤器：通配符必须独占一级，'#' 只能在最后一级
+static bool _filter_valid(const char *filter)
+{
+    if (filter == NULL || filter[0] == '\0') {
+        return false;
+    }
+
+    for (const char *p = filter; *p; p++) {
+        if (*p == '+' || *p == '#') {
+            bool start = (p == filter || p[-1] == '/');
+            bool end = (p[1] == '\0' || p[1] == '/');
+            if (!start || !end) {
+                return false;
+            }
+            if (*p == '#' && p[1] != '\0') {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static mqtt_trie_node_t *_get_child(mqtt_trie_node_t *node, const char *level, size_t len, bool create)
+{
+    for (mqtt_trie_node_t *c = node->child; c != NULL; c = c->sibling) {
+        if (strlen(c->level) == len && memcmp(c->level, level, len) == 0) {
+            return c;
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    mqtt_trie_node_t *c = calloc(1, sizeof(mqtt_trie_node_t));
+    if (c == NULL) {
+        return NULL;
+    }
+    c->level = strndup(level, len);
+    if (c->level == NULL) {
+        free(c);
+        return NULL;
+    }
+    c->sibling = node->child;
+    node->child = c;
+    return c;
+}
+
+esp_err_t mqtt_router_add(const char *filter, int qos, mqtt_route_mode_t mode,
+                          mqtt_fragment_handler_t on_fragment, mqtt_message_handler_t on_message,
+                          size_t max_len, void *user_ctx, mqtt_route_t **ret)
+{
+    if (s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!_filter_valid(filter)) {
+        ESP_LOGE(TAG, "无效的主题过滤器: %s", filter ? filter : "(null)");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((mode == MQTT_ROUTE_STREAM && on_fragment == NULL) ||
+        (mode == MQTT_ROUTE_MESSAGE && (on_message == NULL || max_len == 0))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mqtt_route_t *route = calloc(1, sizeof(mqtt_route_t));
+    if (route == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    route->filter = strdup(filter);
+    if (route->filter == NULL) {
+        free(route);
+        return ESP_ERR_NO_MEM;
+    }
+    route->mode = mode;
+    route->on_fragment = on_fragment;
+    route->on_message = on_message;
+    route->max_len = max_len;
+    route->user_ctx = user_ctx;
+    route->qos = qos;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // 逐级插入 trie
+    mqtt_trie_node_t *node = &s_root;
+    const char *p = filter;
+    while (node != NULL) {
+        const char *slash = strchr(p, '/');
+        size_t len = slash ? (size_t)(slash - p) : strlen(p);
+        node = _get_child(node, p, len, true);
+        if (slash == NULL) {
+            break;
+        }
+        p = slash + 1;
+    }
+
+    if (node == NULL) {
+        xSemaphoreGive(s_lock);
+        free(route->filter);
+        free(route);
+        return ESP_ERR_NO_MEM;
+    }
+
+    route->node_next = node->routes;
+    node->routes = route;
+    route->list_next = s_route_list;
+    s_route_list = route;
+    xSemaphoreGive(s_lock);
+
+    ESP_LOGI(TAG, "路由已添加: %s (%s)", filter, mode == MQTT_ROUTE_STREAM ? "stream" : "message");
+    if (ret != NULL) {
+        *ret = route;
+    }
+    return ESP_OK;
+}
+
+// 沿过滤器各级查找 trie 节点
+static mqtt_trie_node_t *_find_node(const char *filter)
+{
+    mqtt_trie_node_t *node = &s_root;
+    const char *p = filter;
+    while (node != NULL) {
+        const char *slash = strchr(p, '/');
+        size_t len = slash ? (size_t)(slash - p) : strlen(p);
+        node = _get_child(node, p, len, false);
+        if (slash == NULL) {
+            break;
+        }
+        p = slash + 1;
+    }
+    return node;
+}
+
+mqtt_route_t *mqtt_router_find(const char *filter, mqtt_fragment_handler_t on_fragment,
+                               mqtt_message_handler_t on_message)
+{
+    if (filter == NULL || s_lock == NULL) {
+        return NULL;
+    }
+
+    mqtt_route_t *found = NULL;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    mqtt_trie_node_t *node = _find_node(filter);
+    for (mqtt_route_t *r = node ? node->routes : NULL; r != NULL; r = r->node_next) {
+        if (r->on_fragment == on_fragment && r->on_message == on_message) {
+            found = r;
+            break;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    return found;
+}
+
+esp_err_t mqtt_router_remove(mqtt_route_t *route)
+{
+    if (route == NULL || s_lock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    mqtt_trie_node_t *node = _find_node(route->filter);
+    for (mqtt_route_t **pp = node ? &node->routes : NULL; pp != NULL && *pp != NULL; pp = &(*pp)->node_next) {
+        if (*pp == route) {
+            *pp = route->node_next;
+            err = ESP_OK;
+            break;
+        }
+    }
+    if (err == ESP_OK) {
+        for (mqtt_route_t **pp = &s_route_list; *pp != NULL; pp = &(*pp)->list_next) {
+            if (*pp == route) {
+                *pp = route->list_next;
+                break;
+            }
+        }
+        route->list_next = s_retired;
+        s_retired = route;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "路由已删除: %s", route->filter);
+    }
+    return err;
+}
+
+// 释放已删除的路由（调用者持有锁；MQTT 任务开始匹配新消息时，上一条消息的路由已不再使用）
+static void _free_retired(void)
+{
+    while (s_retired != NULL) {
+        mqtt_route_t *r = s_retired;
+        s_retired = r->list_next;
+        free(r->buf);
+        free(r->filter);
+        free(r);
+    }
+}
+
+static void _collect(mqtt_trie_node_t *node, mqtt_route_t **out, int max, int *cnt)
+{
+    for (mqtt_route_t *r = node->routes; r != NULL && *cnt < max; r = r->node_next) {
+        out[(*cnt)++] = r;
+    }
+}
+
+static void _match(mqtt_trie_node_t *node, const char *level, bool root, mqtt_route_t **out, int max, int *cnt)
+{
+    const char *slash = strchr(level, '/');
+    size_t len = slash ? (size_t)(slash - level) : strlen(level);
+    // '$' 开头的系统主题不参与首级通配
+    bool wildcard_ok = !(root && level[0] == '$');
+
+    for (mqtt_trie_node_t *c = node->child; c != NULL && *cnt < max; c = c->sibling) {
+        if (c->level[0] == '#' && wildcard_ok) {
+            _collect(c, out, max, cnt);
+            continue;
+        }
+
+        bool hit = (c->level[0] == '+' && c->level[1] == '\0' && wildcard_ok) ||
+                   (strlen(c->level) == len && memcmp(c->level, level, len) == 0);
+        if (!hit) {
+            continue;
+        }
+
+        if (slash == NULL) {
+            _collect(c, out, max, cnt);
+            // "a/#" 同样匹配 "a"
+            mqtt_trie_node_t *hash = _get_child(c, "#", 1, false);
+            if (hash != NULL) {
+                _collect(hash, out, max, cnt);
+            }
+        } else {
+            _match(c, slash + 1, false, out, max, cnt);
+        }
+    }
+}
+
+int mqtt_router_match(const char *topic, mqtt_route_t **out, int max)
+{
+    if (topic == NULL || out == NULL || max <= 0 || s_lock == NULL) {
+        return 0;
+    }
+
+    int cnt = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    _free_retired();
+    _match(&s_root, topic, true, out, max, &cnt);
+    xSemaphoreGive(s_lock);
+    return cnt;
+}
+
+void mqtt_router_foreach(void (*cb)(mqtt_route_t *route, void *arg), void *arg)
+{
+    if (cb == NULL || s_lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (mqtt_route_t *r = s_route_list; r != NULL; r = r->list_next) {
+        cb(r, arg);
+    }
+    xSemaphoreGive(s_lock);
+}
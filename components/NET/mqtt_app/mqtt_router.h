@@ -0,0 +1,89 @@
+#ifndef __MQTT_ROUTER_H__
+#define __MQTT_ROUTER_H__
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define MQTT_ROUTER_MAX_MATCH       4       // 单条消息最多匹配的路由数
+
+/**
+ * @brief 路由交付方式
+ */
+typedef enum {
+    MQTT_ROUTE_STREAM = 0,      // 分片直接回调（零拷贝，数据指向 MQTT 接收缓冲区）
+    MQTT_ROUTE_MESSAGE,         // 重组为完整消息后回调（使用路由自己的缓冲区）
+} mqtt_route_mode_t;
+
+/**
+ * @brief 分片回调（MQTT 任务中执行；data 仅在回调期间有效，offset == 0 表示新消息）
+ */
+typedef esp_err_t (*mqtt_fragment_handler_t)(const char *topic, const uint8_t *data, size_t len,
+                                             size_t offset, size_t total_len, void *user_ctx);
+
+/**
+ * @brief 完整消息回调（MQTT 任务中执行，适合小型控制主题）
+ */
+typedef esp_err_t (*mqtt_message_handler_t)(const char *topic, const uint8_t *data, size_t len,
+                                            void *user_ctx);
+
+typedef struct mqtt_route {
+    mqtt_route_mode_t mode;
+    mqtt_fragment_handler_t on_fragment;
+    mqtt_message_handler_t on_message;
+    void *user_ctx;
+    char *filter;               // 订阅过滤器（可含 + / #）
+    int qos;
+    bool subscribed;            // 已在当前会话中订阅（持久会话恢复时无需重新订阅）
+
+    // MESSAGE 模式的重组状态
+    size_t max_len;             // 缓冲区上限，超出的消息被丢弃
+    uint8_t *buf;               // 首次使用时分配
+    size_t len;
+    bool skip;                  // 当前消息超限或乱序，忽略其余分片
+
+    struct mqtt_route *node_next;   // 同一 trie 节点上的下一条路由
+    struct mqtt_route *list_next;   // 全部路由链表（用于重新订阅）
+} mqtt_route_t;
+
+/**
+ * @brief 创建路由表的锁（由 mqtt_app_init 调用，之前的其他调用返回 ESP_ERR_INVALID_STATE 或空结果）
+ */
+esp_err_t mqtt_router_init(void);
+
+/**
+ * @brief 添加路由（过滤器按 MQTT 规则校验，路由常驻直到 mqtt_router_remove）
+ */
+esp_err_t mqtt_router_add(const char *filter, int qos, mqtt_route_mode_t mode,
+                          mqtt_fragment_handler_t on_fragment, mqtt_message_handler_t on_message,
+                          size_t max_len, void *user_ctx, mqtt_route_t **ret);
+
+/**
+ * @brief 按主题查找匹配的路由
+ *
+ * @param topic 主题（以 '\0' 结尾）
+ * @param out   匹配结果
+ * @param max   out 容量
+ * @return 匹配数量
+ */
+int mqtt_router_match(const char *topic, mqtt_route_t **out, int max);
+
+/**
+ * @brief 按过滤器字符串与回调查找路由（不做通配匹配）
+ */
+mqtt_route_t *mqtt_router_find(const char *filter, mqtt_fragment_handler_t on_fragment,
+                               mqtt_message_handler_t on_message);
+
+/**
+ * @brief 删除路由：立即停止匹配，内存在下一次 mqtt_router_match 时释放
+ *        （MQTT 任务在一条消息的各分片之间仍会使用该消息匹配到的路由）
+ */
+esp_err_t mqtt_router_remove(mqtt_route_t *route);
+
+/**
+ * @brief 遍历所有路由（用于连接后批量订阅）
+ */
+void mqtt_router_foreach(void (*cb)(mqtt_route_t *route, void *arg), void *arg);
+
+#endif /* __MQTT_ROUTER_H__ */
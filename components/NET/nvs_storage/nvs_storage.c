@@ -105,6 +105,47 @@ esp_err_t nvs_storage_read_i32(const char *namespace_name, const char *key, int3
     return err;
 }
 
+esp_err_t nvs_storage_write_blob(const char *namespace_name, const char *key, const void *value, size_t len)
+{
+    if (!s_inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (namespace_name == NULL || key == NULL || value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t nvs_handle;
+    ESP_ERROR_CHECK(nvs_open(namespace_name, NVS_READWRITE, &nvs_handle));
+    ESP_ERROR_CHECK(nvs_set_blob(nvs_handle, key, value, len));
+    ESP_ERROR_CHECK(nvs_commit(nvs_handle));
+    nvs_close(nvs_handle);
+    
+    return ESP_OK;
+}
+
+esp_err_t nvs_storage_read_blob(const char *namespace_name, const char *key, void *value, size_t *len)
+{
+    if (!s_inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (namespace_name == NULL || key == NULL || value == NULL || len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(namespace_name, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = nvs_get_blob(nvs_handle, key, value, len);
+    nvs_close(nvs_handle);
+    
+    return err;
+}
+
 esp_err_t nvs_storage_delete_key(const char *namespace_name, const char *key)
 {
     if (!s_inited) {
@@ -8,6 +8,8 @@ esp_err_t nvs_storage_write_str(const char *namespace_name, const char *key, con
 esp_err_t nvs_storage_read_str(const char *namespace_name, const char *key, char *value, size_t value_len);
 esp_err_t nvs_storage_write_i32(const char *namespace_name, const char *key, int32_t value);
 esp_err_t nvs_storage_read_i32(const char *namespace_name, const char *key, int32_t *value);
+esp_err_t nvs_storage_write_blob(const char *namespace_name, const char *key, const void *value, size_t len);
+esp_err_t nvs_storage_read_blob(const char *namespace_name, const char *key, void *value, size_t *len);
 esp_err_t nvs_storage_delete_key(const char *namespace_name, const char *key);
 esp_err_t nvs_storage_delete_namespace(const char *namespace_name);
 
@@ -0,0 +1,575 @@
+#include "offline_log.h"
+#include "offline_log_config.h"
+#include "mqtt_app.h"
+#include "mqtt_app_config.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "offline_log";
+
+#define SECTOR_MAGIC        0x474F4C54u     // "TLOG"
+#define RECORD_MAGIC        0x5AA5
+#define STATE_LIVE          0xFFFF          // 未回放（擦除后的初始值）
+#define STATE_DONE          0x0000          // 已回放（NOR Flash 只需把 1 写成 0，无需擦除）
+#define REC_ALIGN(x)        (((x) + 3) & ~(size_t)3)
+#define MAX_RECORD_SIZE     (OFFLINE_LOG_SECTOR_SIZE - OFFLINE_LOG_SECTOR_HDR_SIZE)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;           // 扇区序号，单调递增，用于挂载时确定新旧
+    uint32_t state;         // 0xFFFFFFFF：含未回放记录；0：已全部回放
+    uint32_t reserved;
+} sector_hdr_t;
+
+// 记录：头 + 主题 + 负载，4 字节对齐，记录不跨扇区
+typedef struct {
+    uint16_t magic;
+    uint16_t state;
+    uint16_t payload_len;
+    uint8_t topic_len;
+    uint8_t qos;
+    uint32_t crc;           // 覆盖 payload_len 起的头部字段、主题与负载
+} record_hdr_t;
+
+_Static_assert(sizeof(sector_hdr_t) == OFFLINE_LOG_SECTOR_HDR_SIZE, "扇区头大小不匹配");
+
+static const esp_partition_t *s_part = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static QueueHandle_t s_stage = NULL;        // 已编码的记录（record_hdr_t + 主题 + 负载），由日志任务写入
+static uint32_t s_sectors = 0;
+static volatile bool s_replay_enabled = true;
+
+// 写入位置：当前扇区、序号，以及尚未写入 Flash 的缓冲区
+static uint32_t s_wr_sector = 0;
+static uint32_t s_wr_seq = 0;
+static uint8_t *s_wbuf = NULL;
+static size_t s_wbuf_off = 0;       // 缓冲区对应的扇区内偏移（其前的数据已写入 Flash）
+static size_t s_wbuf_len = 0;
+static int64_t s_wbuf_first_us = 0;
+
+// 回放位置
+static uint32_t s_rd_sector = 0;
+static size_t s_rd_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+
+// 回放读取缓冲区（仅日志任务使用）
+static uint8_t *s_rbuf = NULL;
+
+static offline_log_stats_t s_stats = {0};
+
+static size_t _sector_addr(uint32_t sector)
+{
+    return (size_t)sector * OFFLINE_LOG_SECTOR_SIZE;
+}
+
+static size_t _record_size(const record_hdr_t *hdr)
+{
+    return REC_ALIGN(sizeof(record_hdr_t) + hdr->topic_len + hdr->payload_len);
+}
+
+static uint32_t _record_crc(const record_hdr_t *hdr, const uint8_t *body)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&hdr->payload_len, 4);
+    return esp_rom_crc32_le(crc, body, hdr->topic_len + hdr->payload_len);
+}
+
+static esp_err_t _open_sector(uint32_t sector, uint32_t seq)
+{
+    esp_err_t err = esp_partition_erase_range(s_part, _sector_addr(sector), OFFLINE_LOG_SECTOR_SIZE);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "扇区 %lu 擦除失败: %s", (unsigned long)sector, esp_err_to_name(err));
+        return err;
+    }
+    s_stats.erases++;
+
+    sector_hdr_t hdr = {
+        .magic = SECTOR_MAGIC,
+        .seq = seq,
+        .state = 0xFFFFFFFF,
+        .reserved = 0xFFFFFFFF,
+    };
+    return esp_partition_write(s_part, _sector_addr(sector), &hdr, sizeof(hdr));
+}
+
+// 写缓冲区落盘（调用者持有锁）
+static esp_err_t _flush_locked(void)
+{
+    if (s_wbuf_len == 0) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = esp_partition_write(s_part, _sector_addr(s_wr_sector) + s_wbuf_off, s_wbuf, s_wbuf_len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "写入失败: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_stats.flushes++;
+    s_stats.bytes_written += s_wbuf_len;
+    s_wbuf_off += s_wbuf_len;
+    s_wbuf_len = 0;
+    s_wbuf_first_us = 0;
+    return ESP_OK;
+}
+
+// 统计扇区中未回放的记录数（from 之后）
+static uint32_t _count_live(uint32_t sector, size_t from, size_t end)
+{
+    uint32_t count = 0;
+    size_t off = from;
+    record_hdr_t hdr;
+
+    while (off + sizeof(hdr) <= end) {
+        if (esp_partition_read(s_part, _sector_addr(sector) + off, &hdr, sizeof(hdr)) != ESP_OK ||
+            hdr.magic != RECORD_MAGIC || off + _record_size(&hdr) > OFFLINE_LOG_SECTOR_SIZE) {
+            break;
+        }
+        if (hdr.state == STATE_LIVE) {
+            count++;
+        }
+        off += _record_size(&hdr);
+    }
+    return count;
+}
+
+// 回放位置移到下一个扇区，并把当前扇区标记为已回放
+static void _leave_rd_sector(void)
+{
+    uint32_t done = 0;
+    esp_partition_write(s_part, _sector_addr(s_rd_sector) + offsetof(sector_hdr_t, state), &done, sizeof(done));
+    s_rd_sector = (s_rd_sector + 1) % s_sectors;
+    s_rd_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+}
+
+// 切换到下一个写扇区，日志已满时覆盖最旧的扇区（调用者持有锁）
+static esp_err_t _advance_wr_sector(void)
+{
+    esp_err_t err = _flush_locked();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    uint32_t next = (s_wr_sector + 1) % s_sectors;
+    if (next == s_rd_sector) {
+        uint32_t lost = _count_live(s_rd_sector, s_rd_off, OFFLINE_LOG_SECTOR_SIZE);
+        s_stats.dropped += lost;
+        s_stats.pending -= lost;
+        s_rd_sector = (s_rd_sector + 1) % s_sectors;
+        s_rd_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+        ESP_LOGD(TAG, "日志已满，覆盖最旧扇区（丢弃 %lu 条）", (unsigned long)lost);
+    }
+
+    err = _open_sector(next, s_wr_seq + 1);
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_wr_sector = next;
+    s_wr_seq++;
+    s_wbuf_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+    return ESP_OK;
+}
+
+// 读取下一条已落盘且未回放的记录（调用者持有锁），成功时 hdr/addr 有效、主题与负载位于 s_rbuf
+static esp_err_t _read_next(record_hdr_t *hdr, size_t *addr)
+{
+    while (1) {
+        if (s_rd_sector == s_wr_sector && s_rd_off >= s_wbuf_off) {
+            // 追上写入位置：写缓冲区中的记录等攒满或超时后再回放，不为回放单独写 Flash
+            return ESP_ERR_NOT_FOUND;
+        }
+
+        size_t base = _sector_addr(s_rd_sector);
+        if (s_rd_off + sizeof(*hdr) > OFFLINE_LOG_SECTOR_SIZE ||
+            esp_partition_read(s_part, base + s_rd_off, hdr, sizeof(*hdr)) != ESP_OK ||
+            hdr->magic != RECORD_MAGIC) {
+            // 扇区结束（写满或遇到擦除区域/损坏数据）
+            if (s_rd_sector == s_wr_sector) {
+                return ESP_ERR_NOT_FOUND;
+            }
+            _leave_rd_sector();
+            continue;
+        }
+
+        size_t size = _record_size(hdr);
+        if (s_rd_off + size > OFFLINE_LOG_SECTOR_SIZE) {
+            s_stats.corrupt++;
+            if (s_rd_sector == s_wr_sector) {
+                return ESP_ERR_NOT_FOUND;
+            }
+            _leave_rd_sector();
+            continue;
+        }
+        if (hdr->state != STATE_LIVE) {
+            s_rd_off += size;
+            continue;
+        }
+
+        size_t body = hdr->topic_len + hdr->payload_len;
+        if (esp_partition_read(s_part, base + s_rd_off + sizeof(*hdr), s_rbuf, body) != ESP_OK ||
+            _record_crc(hdr, s_rbuf) != hdr->crc) {
+            s_stats.corrupt++;
+            s_stats.pending--;
+            s_rd_off += size;
+            continue;
+        }
+
+        *addr = base + s_rd_off;
+        return ESP_OK;
+    }
+}
+
+// 把一条已编码的记录追加到写缓冲区，攒够一批再写 Flash（调用者持有锁）
+static esp_err_t _write_record_locked(const uint8_t *rec)
+{
+    size_t size = _record_size((const record_hdr_t *)rec);
+    esp_err_t err = ESP_OK;
+    if (s_wbuf_off + s_wbuf_len + size > OFFLINE_LOG_SECTOR_SIZE) {
+        err = _advance_wr_sector();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    memcpy(s_wbuf + s_wbuf_len, rec, size);
+    if (s_wbuf_len == 0) {
+        s_wbuf_first_us = esp_timer_get_time();
+    }
+    s_wbuf_len += size;
+    s_stats.appended++;
+    s_stats.pending++;
+
+    // 攒够一批再写，减少 Flash 写操作次数
+    if (s_wbuf_len >= OFFLINE_LOG_WRITE_BUF) {
+        err = _flush_locked();
+    }
+    return err;
+}
+
+// 取出队列中全部待写入的记录（调用者持有锁）
+static void _drain_stage_locked(void)
+{
+    uint8_t *rec;
+    while (xQueueReceive(s_stage, &rec, 0) == pdTRUE) {
+        if (_write_record_locked(rec) != ESP_OK) {
+            s_stats.dropped++;
+        }
+        free(rec);
+    }
+}
+
+// 扫描分区，恢复读写位置
+static esp_err_t _mount(void)
+{
+    uint32_t head = UINT32_MAX;
+    uint32_t head_seq = 0;
+    sector_hdr_t hdr;
+
+    for (uint32_t i = 0; i < s_sectors; i++) {
+        if (esp_partition_read(s_part, _sector_addr(i), &hdr, sizeof(hdr)) == ESP_OK &&
+            hdr.magic == SECTOR_MAGIC && (head == UINT32_MAX || hdr.seq > head_seq)) {
+            head = i;
+            head_seq = hdr.seq;
+        }
+    }
+
+    if (head == UINT32_MAX) {
+        ESP_LOGI(TAG, "空分区，初始化日志");
+        s_wr_sector = 0;
+        s_wr_seq = 1;
+        s_rd_sector = 0;
+        s_rd_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+        s_wbuf_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+        return _open_sector(0, s_wr_seq);
+    }
+
+    // 从最新扇区向前找连续的序号，第一个含未回放记录的扇区即回放起点
+    uint32_t oldest = head;
+    uint32_t expect = head_seq;
+    for (uint32_t n = 1; n < s_sectors; n++) {
+        uint32_t prev = (head + s_sectors - n) % s_sectors;
+        if (esp_partition_read(s_part, _sector_addr(prev), &hdr, sizeof(hdr)) != ESP_OK ||
+            hdr.magic != SECTOR_MAGIC || hdr.seq != expect - 1) {
+            break;
+        }
+        oldest = prev;
+        expect--;
+    }
+
+    s_rd_sector = head;
+    for (uint32_t s = oldest; s != head; s = (s + 1) % s_sectors) {
+        esp_partition_read(s_part, _sector_addr(s), &hdr, sizeof(hdr));
+        if (hdr.state != 0) {
+            s_rd_sector = s;
+            break;
+        }
+    }
+    s_rd_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+
+    // 在最新扇区中找到写入位置，写了一半的记录（CRC 错误）之后不能继续追加
+    s_wr_sector = head;
+    s_wr_seq = head_seq;
+    size_t off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+    bool torn = false;
+    record_hdr_t rec;
+    while (off + sizeof(rec) <= OFFLINE_LOG_SECTOR_SIZE) {
+        esp_partition_read(s_part, _sector_addr(head) + off, &rec, sizeof(rec));
+        if (rec.magic == 0xFFFF) {
+            break;
+        }
+        size_t size = _record_size(&rec);
+        size_t body = rec.topic_len + rec.payload_len;
+        if (rec.magic != RECORD_MAGIC || off + size > OFFLINE_LOG_SECTOR_SIZE ||
+            esp_partition_read(s_part, _sector_addr(head) + off + sizeof(rec), s_rbuf, body) != ESP_OK ||
+            _record_crc(&rec, s_rbuf) != rec.crc) {
+            torn = true;
+            break;
+        }
+        off += size;
+    }
+    s_wbuf_off = off;
+
+    // 统计未回放记录（含写了一半的记录，回放时校验失败再扣除）
+    s_stats.pending = 0;
+    for (uint32_t s = s_rd_sector;; s = (s + 1) % s_sectors) {
+        s_stats.pending += _count_live(s, OFFLINE_LOG_SECTOR_HDR_SIZE, OFFLINE_LOG_SECTOR_SIZE);
+        if (s == head) {
+            break;
+        }
+    }
+
+    if (torn) {
+        ESP_LOGW(TAG, "扇区 %lu 末尾有未写完的记录，从下一扇区继续", (unsigned long)head);
+        s_wbuf_off = OFFLINE_LOG_SECTOR_SIZE;
+        return _advance_wr_sector();
+    }
+    return ESP_OK;
+}
+
+// 日志任务：写入转存的记录（擦除/写 Flash 只在这里发生），并按速率上限回放
+static void _log_task(void *arg)
+{
+    (void)arg;
+    char topic[MQTT_APP_TOPIC_MAX_LEN];
+    const TickType_t period = pdMS_TO_TICKS(1000 / OFFLINE_LOG_REPLAY_PER_SEC);
+    TickType_t last = xTaskGetTickCount();
+
+    while (1) {
+        // 等待下一个回放时刻期间处理新转存的记录
+        TickType_t elapsed = xTaskGetTickCount() - last;
+        uint8_t *rec;
+        if (elapsed < period && xQueueReceive(s_stage, &rec, period - elapsed) == pdTRUE) {
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            if (_write_record_locked(rec) != ESP_OK) {
+                s_stats.dropped++;
+            }
+            free(rec);
+            _drain_stage_locked();
+            xSemaphoreGive(s_lock);
+            continue;
+        }
+        last = xTaskGetTickCount();
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (s_wbuf_len > 0 && esp_timer_get_time() - s_wbuf_first_us >= OFFLINE_LOG_FLUSH_MS * 1000LL) {
+            _flush_locked();
+        }
+        bool idle = (s_stats.pending == 0);
+        xSemaphoreGive(s_lock);
+
+        if (idle || !s_replay_enabled || !mqtt_app_is_connected()) {
+            continue;
+        }
+
+        // 实时数据优先：发件箱有积压时暂停回放
+        mqtt_outbox_stats_t ob;
+        mqtt_app_get_outbox_stats(&ob);
+        if (ob.queued > OFFLINE_LOG_REPLAY_MAX_BACKLOG) {
+            continue;
+        }
+
+        record_hdr_t hdr;
+        size_t addr = 0;
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        esp_err_t err = _read_next(&hdr, &addr);
+        uint32_t rd_sector = s_rd_sector;
+        size_t rd_off = s_rd_off;
+        xSemaphoreGive(s_lock);
+        if (err != ESP_OK) {
+            continue;
+        }
+
+        memcpy(topic, s_rbuf, hdr.topic_len);
+        topic[hdr.topic_len] = '\0';
+        if (mqtt_app_publish(topic, s_rbuf + hdr.topic_len, hdr.payload_len, hdr.qos) != ESP_OK) {
+            continue;
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        // 发送期间该扇区可能已被覆盖
+        if (s_rd_sector == rd_sector && s_rd_off == rd_off) {
+            uint16_t done = STATE_DONE;
+            esp_partition_write(s_part, addr + offsetof(record_hdr_t, state), &done, sizeof(done));
+            s_rd_off += _record_size(&hdr);
+            s_stats.pending--;
+            s_stats.replayed++;
+        }
+        xSemaphoreGive(s_lock);
+    }
+}
+
+esp_err_t offline_log_init(void)
+{
+    if (s_part != NULL) {
+        return ESP_OK;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           OFFLINE_LOG_PARTITION);
+    if (part == NULL) {
+        ESP_LOGE(TAG, "未找到分区: %s", OFFLINE_LOG_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_sectors = part->size / OFFLINE_LOG_SECTOR_SIZE;
+    if (s_sectors < 3) {
+        ESP_LOGE(TAG, "分区过小，至少需要 3 个扇区");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    s_stage = xQueueCreate(OFFLINE_LOG_STAGE_QUEUE_LEN, sizeof(uint8_t *));
+    s_wbuf = malloc(OFFLINE_LOG_SECTOR_SIZE);
+    s_rbuf = malloc(MAX_RECORD_SIZE);
+    if (s_lock == NULL || s_stage == NULL || s_wbuf == NULL || s_rbuf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_part = part;
+    s_stats.sectors = s_sectors;
+    esp_err_t err = _mount();
+    if (err != ESP_OK) {
+        s_part = NULL;
+        return err;
+    }
+
+    if (xTaskCreate(_log_task, "offline_log", OFFLINE_LOG_TASK_STACK, NULL,
+                    OFFLINE_LOG_TASK_PRIORITY, NULL) != pdPASS) {
+        s_part = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "日志已挂载: %lu 个扇区, 待回放 %lu 条", (unsigned long)s_sectors,
+             (unsigned long)s_stats.pending);
+    return ESP_OK;
+}
+
+esp_err_t offline_log_append(const char *topic, const uint8_t *data, size_t len, int qos)
+{
+    if (topic == NULL || (data == NULL && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_part == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 先按实际长度检查，再截断为头部字段
+    size_t topic_len = strlen(topic);
+    if (topic_len == 0 || topic_len >= MQTT_APP_TOPIC_MAX_LEN || len > MAX_RECORD_SIZE ||
+        REC_ALIGN(sizeof(record_hdr_t) + topic_len + len) > MAX_RECORD_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    record_hdr_t hdr = {
+        .magic = RECORD_MAGIC,
+        .state = STATE_LIVE,
+        .payload_len = (uint16_t)len,
+        .topic_len = (uint8_t)topic_len,
+        .qos = (uint8_t)qos,
+    };
+    size_t size = _record_size(&hdr);
+
+    // 在调用者上下文中只编码并入队，不碰 Flash（发件箱持锁调用，不能被擦除阻塞）
+    uint8_t *p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (p == NULL) {
+        p = malloc(size);
+    }
+    if (p == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(p + sizeof(hdr), topic, topic_len);
+    memcpy(p + sizeof(hdr) + topic_len, data, len);
+    memset(p + sizeof(hdr) + topic_len + len, 0xFF, size - sizeof(hdr) - topic_len - len);
+    hdr.crc = _record_crc(&hdr, p + sizeof(hdr));
+    memcpy(p, &hdr, sizeof(hdr));
+
+    if (xQueueSend(s_stage, &p, 0) != pdTRUE) {
+        free(p);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t offline_log_flush(void)
+{
+    if (s_part == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    _drain_stage_locked();
+    esp_err_t err = _flush_locked();
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+void offline_log_set_replay(bool enable)
+{
+    s_replay_enabled = enable;
+}
+
+esp_err_t offline_log_clear(void)
+{
+    if (s_part == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    uint8_t *rec;
+    while (xQueueReceive(s_stage, &rec, 0) == pdTRUE) {
+        free(rec);
+    }
+    esp_err_t err = esp_partition_erase_range(s_part, 0, _sector_addr(s_sectors));
+    if (err == ESP_OK) {
+        s_wbuf_len = 0;
+        s_stats.pending = 0;
+        s_wr_sector = 0;
+        s_wr_seq++;
+        s_rd_sector = 0;
+        s_rd_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+        s_wbuf_off = OFFLINE_LOG_SECTOR_HDR_SIZE;
+        err = _open_sector(0, s_wr_seq);
+    }
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+void offline_log_get_stats(offline_log_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_lock == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    stats->sectors_used = (s_wr_sector + s_sectors - s_rd_sector) % s_sectors + 1;
+    xSemaphoreGive(s_lock);
+}
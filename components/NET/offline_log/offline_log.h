@@ -0,0 +1,61 @@
+#ifndef __OFFLINE_LOG_H__
+#define __OFFLINE_LOG_H__
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 离线日志统计
+ */
+typedef struct {
+    uint32_t pending;           // 尚未回放的记录数
+    uint32_t appended;          // 累计写入记录数
+    uint32_t replayed;          // 累计回放成功记录数
+    uint32_t dropped;           // 日志写满时被覆盖或写入 Flash 失败的记录数
+    uint32_t corrupt;           // CRC 校验失败被跳过的记录数
+    uint32_t flushes;           // Flash 写入次数（批量）
+    uint32_t erases;            // 扇区擦除次数
+    uint64_t bytes_written;     // 写入 Flash 的字节数
+    uint32_t sectors;           // 分区扇区数
+    uint32_t sectors_used;      // 含未回放记录的扇区数
+} offline_log_stats_t;
+
+/**
+ * @brief 挂载日志分区并启动日志任务（写入与回放）
+ *
+ * 扫描扇区恢复写入位置与回放位置，掉电时写了一半的记录通过 CRC 识别并跳过。
+ */
+esp_err_t offline_log_init(void);
+
+/**
+ * @brief 追加一条消息（签名与 mqtt_outbox_spill_fn_t 一致，可直接作为发件箱溢出回调）
+ *
+ * 记录在调用者上下文中编码后放入待写入队列即返回，不访问 Flash；日志任务把记录
+ * 攒入 RAM 写缓冲区，攒满或超时后整批写入 Flash。队列满时返回 ESP_ERR_NO_MEM。
+ * 日志写满时覆盖最旧的扇区（扇区按顺序轮转使用，磨损均匀）。
+ */
+esp_err_t offline_log_append(const char *topic, const uint8_t *data, size_t len, int qos);
+
+/**
+ * @brief 立即把待写入队列与写缓冲区写入 Flash
+ */
+esp_err_t offline_log_flush(void);
+
+/**
+ * @brief 暂停/恢复回放（如图像流传输期间）
+ */
+void offline_log_set_replay(bool enable);
+
+/**
+ * @brief 丢弃全部记录并擦除分区
+ */
+esp_err_t offline_log_clear(void);
+
+/**
+ * @brief 获取统计
+ */
+void offline_log_get_stats(offline_log_stats_t *stats);
+
+#endif /* __OFFLINE_LOG_H__ */
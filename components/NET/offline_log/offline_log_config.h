@@ -0,0 +1,22 @@
+#ifndef __OFFLINE_LOG_CONFIG_H__
+#define __OFFLINE_LOG_CONFIG_H__
+
+/* ================= Partition Config ================= */
+#define OFFLINE_LOG_PARTITION           "tlog"          // 分区名（见 partitions-16MiB.csv）
+#define OFFLINE_LOG_SECTOR_SIZE         4096            // 擦除单位
+#define OFFLINE_LOG_SECTOR_HDR_SIZE     16              // 扇区头大小（记录从其后开始）
+
+/* ================= Write Batching ================= */
+#define OFFLINE_LOG_WRITE_BUF           2048            // RAM 中攒够该字节数后一次写入 Flash
+#define OFFLINE_LOG_FLUSH_MS            1000            // 缓冲区中最旧数据的最长停留时间
+
+/* ================= Staging ================= */
+#define OFFLINE_LOG_STAGE_QUEUE_LEN     16              // 待写入记录队列长度（append 只入队，由日志任务写 Flash）
+
+/* ================= Replay Config ================= */
+#define OFFLINE_LOG_REPLAY_PER_SEC      20              // 回放速率上限（条/秒），避免挤占实时流量
+#define OFFLINE_LOG_REPLAY_MAX_BACKLOG  4               // 发件箱排队超过该值时暂停回放
+#define OFFLINE_LOG_TASK_STACK          (4 * 1024)      // 日志任务栈大小（写入与回放）
+#define OFFLINE_LOG_TASK_PRIORITY       3               // 日志任务优先级（低于发件箱任务）
+
+#endif /* __OFFLINE_LOG_CONFIG_H__ */
@@ -15,6 +15,20 @@
 #define WIFI_STA_PASS          "lrt13729011089"
 #define WIFI_STA_AUTHMODE      WIFI_AUTH_WPA2_PSK
 
+/* ================= Fast Connect Config ================ */
+#define WIFI_FAST_CONNECT               1           // 用 NVS 缓存的 BSSID/信道直连，跳过扫描
+#define WIFI_FAST_CONNECT_TIMEOUT_MS    3000        // 快速连接在此时间内未获取 IP 则回退全信道扫描
+
+#define WIFI_IP_MODE_DHCP      0    // DHCP 获取
+#define WIFI_IP_MODE_CACHED    1    // 快速连接时沿用上次 DHCP 租约（需在路由器上为本机保留地址），回退扫描时改用 DHCP
+#define WIFI_IP_MODE_STATIC    2    // 固定 IP
+
+#define WIFI_STA_IP_MODE       WIFI_IP_MODE_DHCP
+#define WIFI_STA_STATIC_IP     "192.168.5.60"
+#define WIFI_STA_STATIC_GW     "192.168.5.1"
+#define WIFI_STA_STATIC_MASK   "255.255.255.0"
+#define WIFI_STA_STATIC_DNS    "192.168.5.1"
+
 /* ==================== AP Config ===================== */
 #define WIFI_AP_SSID           "ESP32S3_AP"
 #define WIFI_AP_PASS           "12345678"
@@ -26,5 +40,31 @@
 #define WIFI_RECONNECT_MAX_ATTEMPTS     5           // 最大重连次数
 #define WIFI_RECONNECT_BASE_DELAY_MS    1000        // 基础延迟 1 秒
 #define WIFI_RECONNECT_MAX_DELAY_MS     30000       // 最大延迟 30 秒
+#define WIFI_STATE_MAX_CALLBACKS        4           // 连接状态回调数量
+
+/* ================ Link Monitor Config =============== */
+#define WIFI_LINK_SAMPLE_MS             1000        // 采样周期
+#define WIFI_LINK_RSSI_GOOD             (-65)       // 平均 RSSI 不低于此值为 GOOD
+#define WIFI_LINK_RSSI_FAIR             (-75)       // 平均 RSSI 不低于此值为 FAIR，否则 POOR
+#define WIFI_LINK_RSSI_HYST             3           // 升级时需超过门限的余量（dB）
+#define WIFI_LINK_RETRY_FAIR_PCT        5           // 周期内发送失败率达到此值时最高为 FAIR
+#define WIFI_LINK_RETRY_POOR_PCT        20          // 周期内发送失败率达到此值时为 POOR
+#define WIFI_LINK_RETRY_MIN_TX          5           // 周期内发送次数少于此值时不按失败率评估
+#define WIFI_LINK_UPGRADE_SAMPLES       3           // 连续满足条件的采样数才升级（降级立即生效）
+#define WIFI_LINK_MAX_SUBSCRIBERS       4           // 链路质量订阅者数量
+
+/* ================ Power Save Config ================= */
+#define WIFI_PS_AUTO                    1           // 按业务类型自动切换省电档位
+#define WIFI_PS_LISTEN_INTERVAL         3           // MAX_MODEM 下每隔多少个信标周期醒来接收（关联时生效）
+#define WIFI_PS_HOLD_MS                 3000        // 流/交互业务最后一次活动后保持低延迟档位的时间
+#define WIFI_PS_TELEMETRY_PROFILE       WIFI_PS_PROFILE_MAX_MODEM   // 空闲与周期遥测
+#define WIFI_PS_INTERACTIVE_PROFILE     WIFI_PS_PROFILE_MIN_MODEM   // 命令/控制
+#define WIFI_PS_STREAM_PROFILE          WIFI_PS_PROFILE_NONE        // 图像/音频流
+// 各档位估算平均电流（CPU 160 MHz 空闲、未开启 light sleep；按实测修改）
+#define WIFI_PS_CURRENT_NONE_MA         100         // 射频常开接收
+#define WIFI_PS_CURRENT_MIN_MODEM_MA    30          // 每个 DTIM 醒来
+#define WIFI_PS_CURRENT_MAX_MODEM_MA    20          // 每 WIFI_PS_LISTEN_INTERVAL 个信标醒来
+#define WIFI_PS_PING_INTERVAL_MS        500         // 延迟测量的 ping 间隔（大于休眠周期，使每次都从休眠中唤醒）
+#define WIFI_PS_SETTLE_MS               300         // 切换档位后等待生效的时间
 
 #endif /* __WIFI_CONFIG_H__ */
@@ -0,0 +1,54 @@
+#include "wifi_fast_cache.h"
+#include "nvs_storage.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include <string.h>
+
+static const char *TAG = "wifi_fast_cache";
+
+#define WIFI_FAST_NAMESPACE     "wifi_fast"
+#define CACHE_KEY               "cache"
+#define CACHE_VERSION           1
+
+esp_err_t wifi_fast_cache_load(wifi_fast_cache_t *cache)
+{
+    if (cache == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t len = sizeof(*cache);
+    esp_err_t err = nvs_storage_read_blob(WIFI_FAST_NAMESPACE, CACHE_KEY, cache, &len);
+    if (err != ESP_OK || len != sizeof(*cache) || cache->version != CACHE_VERSION || cache->channel == 0) {
+        memset(cache, 0, sizeof(*cache));
+        return ESP_ERR_NOT_FOUND;
+    }
+    cache->ssid[sizeof(cache->ssid) - 1] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t wifi_fast_cache_save(const wifi_fast_cache_t *cache)
+{
+    if (cache == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    wifi_fast_cache_t entry = *cache;
+    entry.version = CACHE_VERSION;
+    memset(entry.reserved, 0, sizeof(entry.reserved));
+
+    wifi_fast_cache_t stored;
+    if (wifi_fast_cache_load(&stored) == ESP_OK && memcmp(&stored, &entry, sizeof(entry)) == 0) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = nvs_storage_write_blob(WIFI_FAST_NAMESPACE, CACHE_KEY, &entry, sizeof(entry));
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "快速连接缓存已更新 (信道 %u)", entry.channel);
+    }
+    return err;
+}
+
+esp_err_t wifi_fast_cache_erase(void)
+{
+    return nvs_storage_delete_namespace(WIFI_FAST_NAMESPACE);
+}
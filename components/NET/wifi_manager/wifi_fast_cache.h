@@ -0,0 +1,39 @@
+#ifndef __WIFI_FAST_CACHE_H__
+#define __WIFI_FAST_CACHE_H__
+
+#include "esp_err.h"
+#include <stdint.h>
+
+/**
+ * @brief 快速连接缓存：上次成功连接的 AP 与 IP 租约（地址均为网络字节序）
+ */
+typedef struct {
+    uint8_t version;            // 结构版本（不匹配时视为无缓存）
+    uint8_t channel;            // AP 主信道
+    uint8_t bssid[6];           // AP MAC
+    char ssid[33];              // 对应的 SSID（凭证变化后缓存失效）
+    uint8_t reserved[3];
+    uint32_t ip;
+    uint32_t netmask;
+    uint32_t gw;
+    uint32_t dns;
+} wifi_fast_cache_t;
+
+/**
+ * @brief 从 NVS 读取缓存
+ *
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 无有效缓存
+ */
+esp_err_t wifi_fast_cache_load(wifi_fast_cache_t *cache);
+
+/**
+ * @brief 写入缓存（内容与 NVS 中一致时不写，避免每次连接都擦写 Flash）
+ */
+esp_err_t wifi_fast_cache_save(const wifi_fast_cache_t *cache);
+
+/**
+ * @brief 删除缓存（下次连接走全信道扫描）
+ */
+esp_err_t wifi_fast_cache_erase(void);
+
+#endif /* __WIFI_FAST_CACHE_H__ */
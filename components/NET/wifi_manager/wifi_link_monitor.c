@@ -0,0 +1,341 @@
+#include "wifi_link_monitor.h"
+#include "wifi_config.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include <string.h>
+
+static const char *TAG = "wifi_link";
+
+/*
+ * 等级由两个信号取较差者：
+ *   - RSSI 滑动平均（α = 1/4），升级需超过门限 WIFI_LINK_RSSI_HYST dB
+ *   - 应用层上报的发送失败率（公开的 esp_wifi 接口不提供逐帧 MAC 重传计数，
+ *     以发布失败近似反映重传/拥塞）
+ * 周期内出现信标超时时最高为 POOR。降级立即通知，升级需连续
+ * WIFI_LINK_UPGRADE_SAMPLES 次采样满足，避免在门限附近反复切换。
+ *
+ * 连接/断开事件与订阅时的首次回调都经 xTimerPendFunctionCall 转到定时器任务处理，
+ * 等级状态只在定时器任务中修改，回调也只在该任务中串行执行。
+ */
+
+typedef struct {
+    wifi_link_cb_t cb;
+    void *user_ctx;
+} link_subscriber_t;
+
+static portMUX_TYPE s_link_mux = portMUX_INITIALIZER_UNLOCKED;
+static TimerHandle_t s_sample_timer = NULL;
+static link_subscriber_t s_subscribers[WIFI_LINK_MAX_SUBSCRIBERS];
+static wifi_link_stats_t s_stats = { .quality = WIFI_LINK_DOWN };
+static bool s_connected = false;
+static int32_t s_rssi_avg_x4 = 0;          // 滑动平均 ×4，保留小数精度
+static uint8_t s_upgrade_count = 0;
+static int64_t s_window_start_us = 0;
+
+/* 当前周期累计（由上报函数在任意任务中更新） */
+static uint32_t s_win_tx_bytes = 0;
+static uint32_t s_win_rx_bytes = 0;
+static uint32_t s_win_tx = 0;
+static uint32_t s_win_tx_fail = 0;
+static uint32_t s_win_beacon_timeouts = 0;
+
+static void _notify(wifi_link_quality_t quality)
+{
+    wifi_link_stats_t snapshot;
+    link_subscriber_t subs[WIFI_LINK_MAX_SUBSCRIBERS];
+
+    taskENTER_CRITICAL(&s_link_mux);
+    snapshot = s_stats;
+    memcpy(subs, s_subscribers, sizeof(subs));
+    taskEXIT_CRITICAL(&s_link_mux);
+
+    for (int i = 0; i < WIFI_LINK_MAX_SUBSCRIBERS; i++) {
+        if (subs[i].cb) {
+            subs[i].cb(quality, &snapshot, subs[i].user_ctx);
+        }
+    }
+}
+
+static wifi_link_quality_t _rssi_quality(int rssi, wifi_link_quality_t current)
+{
+    // 向上越过门限需要额外余量
+    int good = WIFI_LINK_RSSI_GOOD + (current < WIFI_LINK_GOOD ? WIFI_LINK_RSSI_HYST : 0);
+    int fair = WIFI_LINK_RSSI_FAIR + (current < WIFI_LINK_FAIR ? WIFI_LINK_RSSI_HYST : 0);
+
+    if (rssi >= good) {
+        return WIFI_LINK_GOOD;
+    }
+    if (rssi >= fair) {
+        return WIFI_LINK_FAIR;
+    }
+    return WIFI_LINK_POOR;
+}
+
+static void _set_quality(wifi_link_quality_t quality)
+{
+    taskENTER_CRITICAL(&s_link_mux);
+    s_stats.quality = quality;
+    s_stats.quality_changes++;
+    taskEXIT_CRITICAL(&s_link_mux);
+
+    ESP_LOGI(TAG, "链路质量 -> %d (RSSI 平均 %d dBm, 失败率 %lu%%)",
+             quality, s_stats.rssi_avg, (unsigned long)s_stats.tx_fail_pct);
+    _notify(quality);
+}
+
+static void _sample_timer_callback(TimerHandle_t xTimer)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed_us = now - s_window_start_us;
+    uint32_t tx_bytes, rx_bytes, tx, tx_fail, beacon_timeouts;
+
+    taskENTER_CRITICAL(&s_link_mux);
+    tx_bytes = s_win_tx_bytes;
+    rx_bytes = s_win_rx_bytes;
+    tx = s_win_tx;
+    tx_fail = s_win_tx_fail;
+    beacon_timeouts = s_win_beacon_timeouts;
+    s_win_tx_bytes = s_win_rx_bytes = s_win_tx = s_win_tx_fail = s_win_beacon_timeouts = 0;
+    taskEXIT_CRITICAL(&s_link_mux);
+    s_window_start_us = now;
+
+    if (elapsed_us <= 0) {
+        elapsed_us = 1;
+    }
+    uint32_t tx_bps = (uint32_t)((uint64_t)tx_bytes * 1000000 / elapsed_us);
+    uint32_t rx_bps = (uint32_t)((uint64_t)rx_bytes * 1000000 / elapsed_us);
+    uint32_t fail_pct = tx ? tx_fail * 100 / tx : 0;
+
+    if (!s_connected) {
+        taskENTER_CRITICAL(&s_link_mux);
+        s_stats.tx_bps = tx_bps;
+        s_stats.rx_bps = rx_bps;
+        taskEXIT_CRITICAL(&s_link_mux);
+        return;
+    }
+
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+        return;     // 断开事件随后到达
+    }
+
+    if (s_rssi_avg_x4 == 0) {
+        s_rssi_avg_x4 = ap.rssi * 4;
+    } else {
+        s_rssi_avg_x4 += ap.rssi - s_rssi_avg_x4 / 4;
+    }
+    int rssi_avg = s_rssi_avg_x4 / 4;
+
+    wifi_link_quality_t current = s_stats.quality;
+    wifi_link_quality_t target = _rssi_quality(rssi_avg, current);
+
+    if (tx >= WIFI_LINK_RETRY_MIN_TX) {
+        if (fail_pct >= WIFI_LINK_RETRY_POOR_PCT) {
+            target = WIFI_LINK_POOR;
+        } else if (fail_pct >= WIFI_LINK_RETRY_FAIR_PCT && target > WIFI_LINK_FAIR) {
+            target = WIFI_LINK_FAIR;
+        }
+    }
+    if (beacon_timeouts > 0) {
+        target = WIFI_LINK_POOR;
+    }
+
+    taskENTER_CRITICAL(&s_link_mux);
+    s_stats.rssi = ap.rssi;
+    s_stats.rssi_avg = rssi_avg;
+    if (ap.rssi < s_stats.rssi_min) {
+        s_stats.rssi_min = ap.rssi;
+    }
+    s_stats.tx_bps = tx_bps;
+    s_stats.rx_bps = rx_bps;
+    s_stats.tx_fail_pct = fail_pct;
+    taskEXIT_CRITICAL(&s_link_mux);
+
+    if (target < current) {
+        s_upgrade_count = 0;
+        _set_quality(target);
+    } else if (target > current) {
+        if (++s_upgrade_count >= WIFI_LINK_UPGRADE_SAMPLES) {
+            s_upgrade_count = 0;
+            _set_quality(target);
+        }
+    } else {
+        s_upgrade_count = 0;
+    }
+}
+
+// 连接状态变化（在定时器任务中执行）
+static void _apply_link_event(void *param, uint32_t event_id)
+{
+    switch (event_id) {
+        case WIFI_EVENT_STA_CONNECTED:
+            s_connected = true;
+            s_rssi_avg_x4 = 0;
+            s_upgrade_count = 0;
+            taskENTER_CRITICAL(&s_link_mux);
+            s_stats.rssi_min = 0;
+            taskEXIT_CRITICAL(&s_link_mux);
+            // 以 FAIR 起步，由采样结果升降
+            _set_quality(WIFI_LINK_FAIR);
+            break;
+
+        case WIFI_EVENT_STA_DISCONNECTED:
+            if (!s_connected) {
+                break;      // 重连失败不重复计数
+            }
+            s_connected = false;
+            taskENTER_CRITICAL(&s_link_mux);
+            s_stats.disconnects++;
+            taskEXIT_CRITICAL(&s_link_mux);
+            _set_quality(WIFI_LINK_DOWN);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void _link_event_handler(void *arg, esp_event_base_t event_base,
+                                int32_t event_id, void *event_data)
+{
+    switch (event_id) {
+        case WIFI_EVENT_STA_CONNECTED:
+        case WIFI_EVENT_STA_DISCONNECTED:
+            if (xTimerPendFunctionCall(_apply_link_event, NULL, (uint32_t)event_id, portMAX_DELAY) != pdPASS) {
+                ESP_LOGE(TAG, "定时器命令队列已满，丢弃事件 %ld", (long)event_id);
+            }
+            break;
+
+        case WIFI_EVENT_STA_BEACON_TIMEOUT:
+            taskENTER_CRITICAL(&s_link_mux);
+            s_stats.beacon_timeouts++;
+            s_win_beacon_timeouts++;
+            taskEXIT_CRITICAL(&s_link_mux);
+            ESP_LOGW(TAG, "信标超时");
+            break;
+
+        default:
+            break;
+    }
+}
+
+esp_err_t wifi_link_monitor_start(void)
+{
+    if (s_sample_timer) {
+        return ESP_OK;
+    }
+
+    s_sample_timer = xTimerCreate("wifi_link", pdMS_TO_TICKS(WIFI_LINK_SAMPLE_MS), pdTRUE,
+                                  NULL, _sample_timer_callback);
+    if (!s_sample_timer) {
+        ESP_LOGE(TAG, "创建采样定时器失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &_link_event_handler, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "注册事件失败: %s", esp_err_to_name(ret));
+        xTimerDelete(s_sample_timer, 0);
+        s_sample_timer = NULL;
+        return ret;
+    }
+
+    // 启动时已连接（监测晚于连接启动）
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+        s_connected = true;
+        s_rssi_avg_x4 = ap.rssi * 4;
+        s_stats.rssi = s_stats.rssi_min = s_stats.rssi_avg = ap.rssi;
+        s_stats.quality = _rssi_quality(ap.rssi, WIFI_LINK_GOOD);
+    }
+
+    s_window_start_us = esp_timer_get_time();
+    xTimerStart(s_sample_timer, 0);
+    ESP_LOGI(TAG, "链路监测已启动 (周期 %d ms)", WIFI_LINK_SAMPLE_MS);
+    return ESP_OK;
+}
+
+// 订阅后的首次回调（在定时器任务中执行，与等级变化通知串行）
+static void _deliver_initial(void *param, uint32_t slot)
+{
+    wifi_link_stats_t snapshot;
+    link_subscriber_t sub;
+
+    taskENTER_CRITICAL(&s_link_mux);
+    snapshot = s_stats;
+    sub = s_subscribers[slot];
+    taskEXIT_CRITICAL(&s_link_mux);
+
+    if (sub.cb) {
+        sub.cb(snapshot.quality, &snapshot, sub.user_ctx);
+    }
+}
+
+esp_err_t wifi_link_subscribe(wifi_link_cb_t cb, void *user_ctx)
+{
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int slot = -1;
+
+    taskENTER_CRITICAL(&s_link_mux);
+    for (int i = 0; i < WIFI_LINK_MAX_SUBSCRIBERS; i++) {
+        if (!s_subscribers[i].cb) {
+            s_subscribers[i].cb = cb;
+            s_subscribers[i].user_ctx = user_ctx;
+            slot = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_link_mux);
+
+    if (slot < 0) {
+        ESP_LOGE(TAG, "订阅者已满");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTimerPendFunctionCall(_deliver_initial, NULL, (uint32_t)slot, portMAX_DELAY) != pdPASS) {
+        taskENTER_CRITICAL(&s_link_mux);
+        s_subscribers[slot].cb = NULL;
+        taskEXIT_CRITICAL(&s_link_mux);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void wifi_link_report_tx(size_t bytes, bool ok)
+{
+    taskENTER_CRITICAL(&s_link_mux);
+    s_win_tx++;
+    if (ok) {
+        s_win_tx_bytes += bytes;
+    } else {
+        s_win_tx_fail++;
+        s_stats.tx_fails++;
+    }
+    taskEXIT_CRITICAL(&s_link_mux);
+}
+
+void wifi_link_report_rx(size_t bytes)
+{
+    taskENTER_CRITICAL(&s_link_mux);
+    s_win_rx_bytes += bytes;
+    taskEXIT_CRITICAL(&s_link_mux);
+}
+
+void wifi_link_get_stats(wifi_link_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_link_mux);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_link_mux);
+}
@@ -0,0 +1,66 @@
+#ifndef __WIFI_LINK_MONITOR_H__
+#define __WIFI_LINK_MONITOR_H__
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief 链路质量等级
+ */
+typedef enum {
+    WIFI_LINK_DOWN = 0,         // 未连接
+    WIFI_LINK_POOR,             // 信号弱或发送失败率高：减少流量
+    WIFI_LINK_FAIR,             // 可用但余量不足
+    WIFI_LINK_GOOD,             // 良好
+} wifi_link_quality_t;
+
+/**
+ * @brief 链路统计（也用于仪表盘与 MQTT 指标）
+ */
+typedef struct {
+    wifi_link_quality_t quality;
+    int8_t rssi;                // 最近一次采样（dBm）
+    int8_t rssi_avg;            // 滑动平均
+    int8_t rssi_min;            // 本次连接期间最低
+    uint32_t tx_bps;            // 最近周期发送吞吐（应用层上报的负载字节）
+    uint32_t rx_bps;            // 最近周期接收吞吐
+    uint32_t tx_fail_pct;       // 最近周期发送失败率
+    uint32_t tx_fails;          // 累计发送失败
+    uint32_t beacon_timeouts;   // 累计信标超时
+    uint32_t disconnects;       // 累计断开
+    uint32_t quality_changes;   // 累计等级变化
+} wifi_link_stats_t;
+
+/**
+ * @brief 链路质量变化回调（所有回调都在 FreeRTOS 定时器任务中串行执行，不可阻塞）
+ */
+typedef void (*wifi_link_cb_t)(wifi_link_quality_t quality, const wifi_link_stats_t *stats, void *user_ctx);
+
+/**
+ * @brief 启动链路监测（STA 模式，须在 wifi_start 之后调用）
+ */
+esp_err_t wifi_link_monitor_start(void);
+
+/**
+ * @brief 订阅链路质量变化（订阅后在定时器任务中以当前等级回调一次）
+ */
+esp_err_t wifi_link_subscribe(wifi_link_cb_t cb, void *user_ctx);
+
+/**
+ * @brief 上报一次发送结果（用于吞吐与失败率估计，可在任意任务中调用）
+ */
+void wifi_link_report_tx(size_t bytes, bool ok);
+
+/**
+ * @brief 上报接收字节数
+ */
+void wifi_link_report_rx(size_t bytes);
+
+/**
+ * @brief 获取链路统计
+ */
+void wifi_link_get_stats(wifi_link_stats_t *stats);
+
+#endif /* __WIFI_LINK_MONITOR_H__ */
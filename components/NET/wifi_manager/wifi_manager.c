@@ -1,12 +1,17 @@
 #include "wifi_manager.h"
 #include "wifi_credentials.h"
+#include "wifi_fast_cache.h"
+#include "wifi_power.h"
 #include "nvs_storage.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_wifi.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/timers.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include <string.h>
 
 static const char *TAG = "wifi_app";
@@ -15,12 +20,163 @@ static bool s_inited = false;
 static esp_netif_t *s_wifi_netif = NULL;
 static wifi_state_t s_wifi_state = WIFI_STATE_DISCONNECTED;  // wifi连接状态
 
+// 就绪通知：等待者阻塞在事件组上，回调在状态变化时同步调用
+// s_state_lock 串行化状态变化与回调注册：注册时的首次回调与后续通知不会交错或乱序
+// （递归锁：回调中可以调用 wifi_connect 等会改变状态的接口）
+#define WIFI_CONNECTED_BIT  (1 << 0)
+#define WIFI_FAILED_BIT     (1 << 1)
+
+typedef struct {
+    wifi_state_cb_t cb;
+    void *user_ctx;
+} wifi_state_listener_t;
+
+static EventGroupHandle_t s_wifi_events = NULL;
+static SemaphoreHandle_t s_state_lock = NULL;
+static wifi_state_listener_t s_state_listeners[WIFI_STATE_MAX_CALLBACKS];
+
+// 更新状态、事件组并通知回调
+static void _set_state(wifi_state_t state)
+{
+    xSemaphoreTakeRecursive(s_state_lock, portMAX_DELAY);
+    if (state == s_wifi_state) {
+        xSemaphoreGiveRecursive(s_state_lock);
+        return;
+    }
+    s_wifi_state = state;
+
+    if (s_wifi_events != NULL) {
+        EventBits_t bits = (state == WIFI_STATE_CONNECTED) ? WIFI_CONNECTED_BIT :
+                           (state == WIFI_STATE_FAILED) ? WIFI_FAILED_BIT : 0;
+        xEventGroupClearBits(s_wifi_events, (WIFI_CONNECTED_BIT | WIFI_FAILED_BIT) & ~bits);
+        if (bits) {
+            xEventGroupSetBits(s_wifi_events, bits);
+        }
+    }
+
+    for (int i = 0; i < WIFI_STATE_MAX_CALLBACKS; i++) {
+        if (s_state_listeners[i].cb != NULL) {
+            s_state_listeners[i].cb(state, s_state_listeners[i].user_ctx);
+        }
+    }
+    xSemaphoreGiveRecursive(s_state_lock);
+}
+
 #if (WIFI_APP_MODE == WIFI_APP_MODE_STA)
 // 重连（仅 STA 模式）
 static uint8_t s_reconnect_attempts = 0;                     // 重连次数
 static TimerHandle_t s_reconnect_timer = NULL;               // 重连定时器句柄
 static bool s_auto_reconnect = true;                         // 是否自动重连标志
 
+// 快速连接：用缓存的 BSSID/信道跳过扫描，未及时获取 IP 则回退全信道扫描
+static wifi_config_t s_sta_config;                           // 当前 STA 配置（回退时修改后重新下发）
+static wifi_fast_cache_t s_fast_cache;                       // 本次连接写回 NVS 的缓存
+static bool s_fast_config = false;                           // 当前配置指定了 BSSID/信道
+static bool s_fast_pending = false;                          // 快速连接进行中（尚未获取 IP）
+static bool s_cached_ip = false;                             // 正在使用缓存的 IP（DHCP 已停止）
+static TimerHandle_t s_fast_timer = NULL;                    // 快速连接超时定时器
+static int64_t s_connect_start_us = 0;                       // 本次连接发起时间
+static wifi_connect_stats_t s_connect_stats = {0};
+
+// 发起连接并记录起始时间
+static void _sta_connect(void)
+{
+    s_connect_start_us = esp_timer_get_time();
+    esp_wifi_connect();
+}
+
+// 停止 DHCP 并设置固定地址（固定 IP 或缓存的租约）
+static void _apply_static_ip(uint32_t ip, uint32_t netmask, uint32_t gw, uint32_t dns)
+{
+    esp_netif_dhcpc_stop(s_wifi_netif);
+
+    esp_netif_ip_info_t ip_info = {
+        .ip.addr = ip,
+        .netmask.addr = netmask,
+        .gw.addr = gw,
+    };
+    ESP_ERROR_CHECK(esp_netif_set_ip_info(s_wifi_netif, &ip_info));
+
+    if (dns != 0) {
+        esp_netif_dns_info_t dns_info = {
+            .ip.u_addr.ip4.addr = dns,
+            .ip.type = ESP_IPADDR_TYPE_V4,
+        };
+        esp_netif_set_dns_info(s_wifi_netif, ESP_NETIF_DNS_MAIN, &dns_info);
+    }
+}
+
+// 恢复全信道扫描（缓存的租约不再可信，改回 DHCP）
+static void _use_full_scan(void)
+{
+    if (s_fast_config) {
+        s_sta_config.sta.bssid_set = false;
+        s_sta_config.sta.channel = 0;
+        s_sta_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        s_sta_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+        esp_wifi_set_config(WIFI_IF_STA, &s_sta_config);
+        s_fast_config = false;
+    }
+    if (s_cached_ip) {
+        esp_netif_dhcpc_start(s_wifi_netif);
+        s_cached_ip = false;
+    }
+}
+
+// 超时：主动断开，由断开事件执行回退
+static void _fast_timer_callback(TimerHandle_t xTimer)
+{
+    (void)xTimer;
+
+    if (s_fast_pending) {
+        ESP_LOGW(TAG, "快速连接 %d ms 内未获取 IP", WIFI_FAST_CONNECT_TIMEOUT_MS);
+        esp_wifi_disconnect();
+    }
+}
+
+static void _fast_connect_fallback(void)
+{
+    s_fast_pending = false;
+    s_connect_stats.fast_fallbacks++;
+    ESP_LOGW(TAG, "快速连接失败，回退全信道扫描");
+    _use_full_scan();
+    _sta_connect();
+}
+
+// 获取 IP：记录耗时并更新快速连接缓存
+static void _on_sta_got_ip(const ip_event_got_ip_t *event)
+{
+    int64_t now = esp_timer_get_time();
+    bool fast = s_fast_pending;
+    s_fast_pending = false;
+    if (s_fast_timer != NULL) {
+        xTimerStop(s_fast_timer, 0);
+    }
+
+    s_connect_stats.connects++;
+    s_connect_stats.fast_connects += fast ? 1 : 0;
+    s_connect_stats.last_ip_ms = (uint32_t)((now - s_connect_start_us) / 1000);
+    if (s_connect_stats.boot_to_ip_ms == 0) {
+        s_connect_stats.boot_to_ip_ms = (uint32_t)(now / 1000);
+    }
+    ESP_LOGI(TAG, "获取 IP 耗时 %lu ms (%s%s), 上电后 %lu ms", s_connect_stats.last_ip_ms,
+             fast ? "快速连接" : "全扫描", s_cached_ip ? ", 缓存 IP" : "", s_connect_stats.boot_to_ip_ms);
+
+#if WIFI_FAST_CONNECT
+    // 关联时已记录 SSID/BSSID/信道，这里补上租约
+    s_fast_cache.ip = event->ip_info.ip.addr;
+    s_fast_cache.netmask = event->ip_info.netmask.addr;
+    s_fast_cache.gw = event->ip_info.gw.addr;
+    esp_netif_dns_info_t dns_info;
+    if (esp_netif_get_dns_info(s_wifi_netif, ESP_NETIF_DNS_MAIN, &dns_info) == ESP_OK) {
+        s_fast_cache.dns = dns_info.ip.u_addr.ip4.addr;
+    }
+    if (s_fast_cache.channel != 0) {
+        wifi_fast_cache_save(&s_fast_cache);
+    }
+#endif
+}
+
 static void _reconnect_timer_callback(TimerHandle_t xTimer)
 {
     (void)xTimer;
@@ -28,10 +184,10 @@ static void _reconnect_timer_callback(TimerHandle_t xTimer)
     if (s_reconnect_attempts < WIFI_RECONNECT_MAX_ATTEMPTS) {
         s_reconnect_attempts++;
         ESP_LOGI(TAG, "重连 %d/%d", s_reconnect_attempts, WIFI_RECONNECT_MAX_ATTEMPTS);
-        esp_wifi_connect();
+        _sta_connect();
     } else {
         ESP_LOGE(TAG, "重连失败，已达最大次数");
-        s_wifi_state = WIFI_STATE_FAILED;
+        _set_state(WIFI_STATE_FAILED);
         if (s_reconnect_timer != NULL) {
             xTimerDelete(s_reconnect_timer, 0);
             s_reconnect_timer = NULL;
@@ -84,12 +240,38 @@ static void _wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t
     if (event_base == WIFI_EVENT) {
         if (event_id == WIFI_EVENT_STA_START) {
             ESP_LOGI(TAG, "STA 启动");
-            s_wifi_state = WIFI_STATE_CONNECTING;
+            _set_state(WIFI_STATE_CONNECTING);
             _reset_reconnect_state();
-            esp_wifi_connect();
+            _sta_connect();
+            if (s_fast_pending && s_fast_timer != NULL) {
+                xTimerStart(s_fast_timer, 0);
+            }
+        } else if (event_id == WIFI_EVENT_STA_CONNECTED) {
+            wifi_event_sta_connected_t *event = (wifi_event_sta_connected_t *)event_data;
+            s_connect_stats.last_assoc_ms = (uint32_t)((esp_timer_get_time() - s_connect_start_us) / 1000);
+            ESP_LOGI(TAG, "已关联 (信道 %u), 耗时 %lu ms", event->channel, s_connect_stats.last_assoc_ms);
+            memset(&s_fast_cache, 0, sizeof(s_fast_cache));
+            memcpy(s_fast_cache.ssid, s_sta_config.sta.ssid, sizeof(s_sta_config.sta.ssid));
+            memcpy(s_fast_cache.bssid, event->bssid, sizeof(s_fast_cache.bssid));
+            s_fast_cache.channel = event->channel;
         } else if (event_id == WIFI_EVENT_STA_DISCONNECTED) {
             ESP_LOGW(TAG, "连接断开");
-            s_wifi_state = WIFI_STATE_DISCONNECTED;
+            _set_state(WIFI_STATE_DISCONNECTED);
+
+            // 快速连接未成功：立即全信道扫描，不计入重连次数
+            if (s_fast_pending) {
+                if (s_fast_timer != NULL) {
+                    xTimerStop(s_fast_timer, 0);
+                }
+                if (s_auto_reconnect) {
+                    _fast_connect_fallback();
+                    return;
+                }
+                s_fast_pending = false;
+            }
+
+            // 已连接后断开：AP 可能已切换信道，之后的重连走全扫描
+            _use_full_scan();
             
             // 只有在允许自动重连时才启动重连定时器
             if (s_auto_reconnect && s_reconnect_attempts < WIFI_RECONNECT_MAX_ATTEMPTS) {
@@ -98,22 +280,23 @@ static void _wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t
                 ESP_LOGI(TAG, "自动重连已禁用");
             } else {
                 ESP_LOGE(TAG, "重连失败，已达最大次数");
-                s_wifi_state = WIFI_STATE_FAILED;
+                _set_state(WIFI_STATE_FAILED);
             }
         }
     } else if (event_base == IP_EVENT) {
         if (event_id == IP_EVENT_STA_GOT_IP) {
             ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
             ESP_LOGI(TAG, "连接成功，IP: " IPSTR, IP2STR(&event->ip_info.ip));
-            s_wifi_state = WIFI_STATE_CONNECTED;
+            _set_state(WIFI_STATE_CONNECTED);
             _reset_reconnect_state();
+            _on_sta_got_ip(event);
         }
     }
 #elif (WIFI_APP_MODE == WIFI_APP_MODE_AP)
     if (event_base == WIFI_EVENT) {
         if (event_id == WIFI_EVENT_AP_START) {
             ESP_LOGI(TAG, "AP 启动");
-            s_wifi_state = WIFI_STATE_CONNECTED;
+            _set_state(WIFI_STATE_CONNECTED);
 
             if (s_wifi_netif != NULL) {
                 esp_netif_ip_info_t ip_info;
@@ -123,7 +306,7 @@ static void _wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t
             }
         } else if (event_id == WIFI_EVENT_AP_STOP) {
             ESP_LOGI(TAG, "AP 停止");
-            s_wifi_state = WIFI_STATE_DISCONNECTED;
+            _set_state(WIFI_STATE_DISCONNECTED);
         }
     } else if (event_base == IP_EVENT) {
         if (event_id == IP_EVENT_AP_STAIPASSIGNED) {
@@ -142,6 +325,12 @@ static esp_err_t _wifi_init(void)
 
     ESP_ERROR_CHECK(nvs_storage_init());
 
+    s_wifi_events = xEventGroupCreate();
+    s_state_lock = xSemaphoreCreateRecursiveMutex();
+    if (s_wifi_events == NULL || s_state_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
     // 初始化网络接口层（esp_netif）
     esp_err_t err = esp_netif_init();
     if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
@@ -176,6 +365,12 @@ static esp_err_t _wifi_init(void)
     // 注册 IP 事件处理函数（处理获取 IP 等）
 #if (WIFI_APP_MODE == WIFI_APP_MODE_STA)
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, _wifi_event_handler, NULL));
+
+    s_fast_timer = xTimerCreate("wifi_fast", pdMS_TO_TICKS(WIFI_FAST_CONNECT_TIMEOUT_MS), pdFALSE, NULL,
+                                _fast_timer_callback);
+    if (s_fast_timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
 #elif (WIFI_APP_MODE == WIFI_APP_MODE_AP)
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_AP_STAIPASSIGNED, _wifi_event_handler, NULL));
 #endif
@@ -204,6 +399,37 @@ static esp_err_t _wifi_connect_sta(const char *ssid, const char *pass)
     wifi_config.sta.threshold.authmode = WIFI_STA_AUTHMODE;
     wifi_config.sta.pmf_cfg.capable = true;
     wifi_config.sta.pmf_cfg.required = false;
+    wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    wifi_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    wifi_config.sta.listen_interval = WIFI_PS_LISTEN_INTERVAL;
+
+#if (WIFI_STA_IP_MODE == WIFI_IP_MODE_STATIC)
+    _apply_static_ip(esp_ip4addr_aton(WIFI_STA_STATIC_IP), esp_ip4addr_aton(WIFI_STA_STATIC_MASK),
+                     esp_ip4addr_aton(WIFI_STA_STATIC_GW), esp_ip4addr_aton(WIFI_STA_STATIC_DNS));
+#endif
+
+#if WIFI_FAST_CONNECT
+    // 缓存与当前 SSID 一致时直连上次的 AP，只在其信道上探测
+    wifi_fast_cache_t cache;
+    if (wifi_fast_cache_load(&cache) == ESP_OK && strcmp(cache.ssid, ssid) == 0) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = cache.channel;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+        s_fast_config = true;
+        s_fast_pending = true;
+#if (WIFI_STA_IP_MODE == WIFI_IP_MODE_CACHED)
+        if (cache.ip != 0) {
+            _apply_static_ip(cache.ip, cache.netmask, cache.gw, cache.dns);
+            s_cached_ip = true;
+        }
+#endif
+        ESP_LOGI(TAG, "快速连接: 信道 %u, BSSID %02x:%02x:%02x:%02x:%02x:%02x%s", cache.channel,
+                 cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3], cache.bssid[4], cache.bssid[5],
+                 s_cached_ip ? ", 沿用缓存 IP" : "");
+    }
+#endif
+    s_sta_config = wifi_config;
 
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
@@ -212,7 +438,8 @@ static esp_err_t _wifi_connect_sta(const char *ssid, const char *pass)
         return err;
     }
 
-    return ESP_OK;
+    // 省电档位由 wifi_power 按业务类型管理
+    return wifi_power_init();
 }
 #elif (WIFI_APP_MODE == WIFI_APP_MODE_AP)
 static esp_err_t _wifi_start_ap(const char *ssid, const char *password)
@@ -320,6 +547,10 @@ esp_err_t wifi_connect(void)
     // 需要重新连接时，启用自动重连
     s_auto_reconnect = true;
     _reset_reconnect_state();
+    if (s_wifi_state != WIFI_STATE_CONNECTED) {
+        _set_state(WIFI_STATE_CONNECTING);      // 清除失败标志，等待者继续等待本次连接
+    }
+    s_connect_start_us = esp_timer_get_time();
     return esp_wifi_connect();
 }
 #endif
@@ -328,3 +559,58 @@ wifi_state_t wifi_get_state(void)
 {
     return s_wifi_state;
 }
+
+esp_err_t wifi_wait_connected(TickType_t timeout)
+{
+    if (s_wifi_events == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(s_wifi_events, WIFI_CONNECTED_BIT | WIFI_FAILED_BIT,
+                                           pdFALSE, pdFALSE, timeout);
+    if (bits & WIFI_CONNECTED_BIT) {
+        return ESP_OK;
+    }
+    return (bits & WIFI_FAILED_BIT) ? ESP_FAIL : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t wifi_register_state_cb(wifi_state_cb_t cb, void *user_ctx)
+{
+    if (cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_state_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    xSemaphoreTakeRecursive(s_state_lock, portMAX_DELAY);
+    for (int i = 0; i < WIFI_STATE_MAX_CALLBACKS; i++) {
+        if (s_state_listeners[i].cb == NULL) {
+            s_state_listeners[i].user_ctx = user_ctx;
+            s_state_listeners[i].cb = cb;
+            // 持锁以当前状态回调一次：注册晚于连接也不会错过，且不会与状态变化通知交错
+            cb(s_wifi_state, user_ctx);
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGiveRecursive(s_state_lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "状态回调已满");
+    }
+    return ret;
+}
+
+void wifi_get_connect_stats(wifi_connect_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+#if (WIFI_APP_MODE == WIFI_APP_MODE_STA)
+    *stats = s_connect_stats;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
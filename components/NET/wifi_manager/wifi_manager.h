@@ -3,6 +3,7 @@
 
 #include "esp_err.h"
 #include "wifi_config.h"
+#include "freertos/FreeRTOS.h"
 
 /**
  * @brief WiFi 连接状态枚举
@@ -14,6 +15,23 @@ typedef enum {
     WIFI_STATE_FAILED = 3,          // 连接失败（达到最大重连次数）
 } wifi_state_t;
 
+/**
+ * @brief 连接状态回调（在 WiFi 事件任务或定时器任务中执行，不可阻塞）
+ */
+typedef void (*wifi_state_cb_t)(wifi_state_t state, void *user_ctx);
+
+/**
+ * @brief STA 连接耗时统计
+ */
+typedef struct {
+    uint32_t connects;          // 获取 IP 的次数
+    uint32_t fast_connects;     // 其中经快速连接（跳过扫描）的次数
+    uint32_t fast_fallbacks;    // 快速连接失败、回退全信道扫描的次数
+    uint32_t last_assoc_ms;     // 最近一次：发起连接到关联成功
+    uint32_t last_ip_ms;        // 最近一次：发起连接到获取 IP
+    uint32_t boot_to_ip_ms;     // 上电到首次获取 IP
+} wifi_connect_stats_t;
+
 /**
  * @brief 启动 WiFi（STA 或 AP 模式，由 wifi_config.h 配置）
  */
@@ -36,4 +54,24 @@ esp_err_t wifi_connect(void);
  */
 wifi_state_t wifi_get_state(void);
 
+/**
+ * @brief 阻塞等待连接就绪（STA: 获取 IP，AP: 热点启动）
+ *
+ * @param timeout 等待时间（tick），portMAX_DELAY 表示一直等待
+ * @return ESP_OK 已就绪，ESP_FAIL 重连已达最大次数，ESP_ERR_TIMEOUT 超时，ESP_ERR_INVALID_STATE 未调用 wifi_start
+ */
+esp_err_t wifi_wait_connected(TickType_t timeout);
+
+/**
+ * @brief 注册连接状态回调（须在 wifi_start 之后调用）
+ *
+ * 注册时在调用者任务中以当前状态回调一次；首次回调与状态变化通知串行执行。
+ */
+esp_err_t wifi_register_state_cb(wifi_state_cb_t cb, void *user_ctx);
+
+/**
+ * @brief 获取 STA 连接耗时统计
+ */
+void wifi_get_connect_stats(wifi_connect_stats_t *stats);
+
 #endif
@@ -0,0 +1,355 @@
+#include "wifi_power.h"
+#include "wifi_config.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "ping/ping_sock.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include <string.h>
+
+static const char *TAG = "wifi_power";
+
+/*
+ * 档位 = 近 WIFI_PS_HOLD_MS 内有活动的业务类型中要求最低延迟的那个。
+ * 需要更低延迟时在 wifi_power_notify 中立即切换（首个分片仍要承受一次休眠延迟），
+ * 回落由周期定时器完成，避免突发流量间隙里反复切换。
+ * MAX_MODEM 的监听间隔写在关联配置里，只在该档位下生效。
+ */
+
+static const wifi_ps_type_t s_ps_type[WIFI_PS_PROFILE_COUNT] = {
+    WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM,
+};
+static const uint32_t s_profile_ma[WIFI_PS_PROFILE_COUNT] = {
+    WIFI_PS_CURRENT_NONE_MA, WIFI_PS_CURRENT_MIN_MODEM_MA, WIFI_PS_CURRENT_MAX_MODEM_MA,
+};
+static const char *const s_profile_name[WIFI_PS_PROFILE_COUNT] = {
+    "NONE", "MIN_MODEM", "MAX_MODEM",
+};
+static const wifi_ps_profile_t s_class_profile[WIFI_TRAFFIC_COUNT] = {
+    WIFI_PS_TELEMETRY_PROFILE, WIFI_PS_INTERACTIVE_PROFILE, WIFI_PS_STREAM_PROFILE,
+};
+
+static bool s_inited = false;
+static SemaphoreHandle_t s_lock = NULL;                  // 串行化档位切换
+static portMUX_TYPE s_power_mux = portMUX_INITIALIZER_UNLOCKED;
+static TimerHandle_t s_hold_timer = NULL;
+static wifi_ps_profile_t s_profile = WIFI_PS_TELEMETRY_PROFILE;
+static bool s_forced = false;
+static int64_t s_last_active_us[WIFI_TRAFFIC_COUNT];
+static int64_t s_profile_since_us = 0;
+static wifi_power_stats_t s_stats = {0};
+
+// 切换档位（调用者持有 s_lock）
+static esp_err_t _apply_profile(wifi_ps_profile_t profile)
+{
+    if (profile == s_profile) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = esp_wifi_set_ps(s_ps_type[profile]);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "设置省电档位 %s 失败: %s", s_profile_name[profile], esp_err_to_name(err));
+        return err;
+    }
+
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_power_mux);
+    s_stats.profiles[s_profile].time_ms += (uint32_t)((now - s_profile_since_us) / 1000);
+    s_profile_since_us = now;
+    s_profile = profile;
+    s_stats.switches++;
+    taskEXIT_CRITICAL(&s_power_mux);
+
+    ESP_LOGD(TAG, "省电档位 -> %s", s_profile_name[profile]);
+    return ESP_OK;
+}
+
+#if WIFI_PS_AUTO
+// 按各业务最近的活动计算应处的档位
+static wifi_ps_profile_t _wanted_profile(int64_t now)
+{
+    wifi_ps_profile_t wanted = s_class_profile[WIFI_TRAFFIC_TELEMETRY];
+
+    taskENTER_CRITICAL(&s_power_mux);
+    for (int c = 0; c < WIFI_TRAFFIC_COUNT; c++) {
+        if (s_last_active_us[c] != 0 && now - s_last_active_us[c] < (int64_t)WIFI_PS_HOLD_MS * 1000 &&
+            s_class_profile[c] < wanted) {
+            wanted = s_class_profile[c];
+        }
+    }
+    taskEXIT_CRITICAL(&s_power_mux);
+    return wanted;
+}
+
+// 周期检查：业务空闲后回落到更省电的档位
+static void _hold_timer_callback(TimerHandle_t xTimer)
+{
+    (void)xTimer;
+
+    // 切换进行中时跳过本轮，不阻塞定时器任务
+    if (xSemaphoreTake(s_lock, 0) != pdTRUE) {
+        return;
+    }
+    if (!s_forced) {
+        wifi_ps_profile_t wanted = _wanted_profile(esp_timer_get_time());
+        if (wanted > s_profile) {
+            _apply_profile(wanted);
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
+#endif
+
+esp_err_t wifi_power_init(void)
+{
+    if (s_inited) {
+        return ESP_OK;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+#if WIFI_PS_AUTO
+    s_hold_timer = xTimerCreate("wifi_ps", pdMS_TO_TICKS(WIFI_PS_HOLD_MS / 2), pdTRUE, NULL,
+                                _hold_timer_callback);
+    if (s_hold_timer == NULL) {
+        vSemaphoreDelete(s_lock);
+        s_lock = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+    esp_err_t err = esp_wifi_set_ps(s_ps_type[s_profile]);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "设置省电档位失败: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    for (int p = 0; p < WIFI_PS_PROFILE_COUNT; p++) {
+        s_stats.profiles[p].est_ma = s_profile_ma[p];
+    }
+    s_profile_since_us = esp_timer_get_time();
+    if (s_hold_timer != NULL) {
+        xTimerStart(s_hold_timer, 0);
+    }
+
+    s_inited = true;
+    ESP_LOGI(TAG, "省电管理已启动: %s, 监听间隔 %d%s", s_profile_name[s_profile], WIFI_PS_LISTEN_INTERVAL,
+             WIFI_PS_AUTO ? ", 自动切换" : "");
+    return ESP_OK;
+}
+
+void wifi_power_notify(wifi_traffic_class_t cls)
+{
+    if (!s_inited || cls >= WIFI_TRAFFIC_COUNT) {
+        return;
+    }
+
+    wifi_ps_profile_t wanted = s_class_profile[cls];
+    bool escalate;
+
+    taskENTER_CRITICAL(&s_power_mux);
+    s_last_active_us[cls] = esp_timer_get_time();
+    escalate = WIFI_PS_AUTO && !s_forced && wanted < s_profile;
+    taskEXIT_CRITICAL(&s_power_mux);
+
+    if (escalate) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (!s_forced && wanted < s_profile) {
+            _apply_profile(wanted);
+        }
+        xSemaphoreGive(s_lock);
+    }
+}
+
+esp_err_t wifi_power_force(wifi_ps_profile_t profile)
+{
+    if (profile >= WIFI_PS_PROFILE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_forced = true;
+    esp_err_t err = _apply_profile(profile);
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+void wifi_power_release(void)
+{
+    if (!s_inited) {
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_forced = false;
+#if WIFI_PS_AUTO
+    _apply_profile(_wanted_profile(esp_timer_get_time()));
+#else
+    _apply_profile(WIFI_PS_TELEMETRY_PROFILE);
+#endif
+    xSemaphoreGive(s_lock);
+}
+
+typedef struct {
+    SemaphoreHandle_t done;
+    uint32_t rtt_sum_ms;
+    uint32_t rtt_max_ms;
+    uint32_t replies;
+    uint32_t lost;
+} ping_result_t;
+
+static void _on_ping_success(esp_ping_handle_t hdl, void *args)
+{
+    ping_result_t *res = (ping_result_t *)args;
+    uint32_t elapsed_ms = 0;
+
+    esp_ping_get_profile(hdl, ESP_PING_PROF_TIMEGAP, &elapsed_ms, sizeof(elapsed_ms));
+    res->rtt_sum_ms += elapsed_ms;
+    if (elapsed_ms > res->rtt_max_ms) {
+        res->rtt_max_ms = elapsed_ms;
+    }
+    res->replies++;
+}
+
+static void _on_ping_timeout(esp_ping_handle_t hdl, void *args)
+{
+    (void)hdl;
+    ((ping_result_t *)args)->lost++;
+}
+
+static void _on_ping_end(esp_ping_handle_t hdl, void *args)
+{
+    (void)hdl;
+    xSemaphoreGive(((ping_result_t *)args)->done);
+}
+
+// 在当前档位下 ping 网关
+static esp_err_t _ping_gateway(uint32_t gw, uint32_t count, ping_result_t *res)
+{
+    esp_ping_config_t config = ESP_PING_DEFAULT_CONFIG();
+    ip_addr_t target = IPADDR4_INIT(gw);
+    config.target_addr = target;
+    config.count = count;
+    config.interval_ms = WIFI_PS_PING_INTERVAL_MS;
+
+    esp_ping_callbacks_t cbs = {
+        .cb_args = res,
+        .on_ping_success = _on_ping_success,
+        .on_ping_timeout = _on_ping_timeout,
+        .on_ping_end = _on_ping_end,
+    };
+
+    esp_ping_handle_t ping;
+    esp_err_t err = esp_ping_new_session(&config, &cbs, &ping);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = esp_ping_start(ping);
+    if (err == ESP_OK) {
+        TickType_t wait = pdMS_TO_TICKS(count * (config.interval_ms + config.timeout_ms) + 1000);
+        if (xSemaphoreTake(res->done, wait) != pdTRUE) {
+            err = ESP_ERR_TIMEOUT;
+        }
+    }
+    esp_ping_delete_session(ping);
+    return err;
+}
+
+esp_err_t wifi_power_measure_latency(uint32_t count)
+{
+    if (count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_netif_ip_info_t ip_info;
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (netif == NULL || esp_netif_get_ip_info(netif, &ip_info) != ESP_OK || ip_info.gw.addr == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+    if (done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    bool was_forced = s_forced;
+    wifi_ps_profile_t prev = s_profile;
+    uint32_t base_rtt_ms = 0;
+    esp_err_t err = ESP_OK;
+
+    for (int p = 0; p < WIFI_PS_PROFILE_COUNT && err == ESP_OK; p++) {
+        err = wifi_power_force((wifi_ps_profile_t)p);
+        if (err != ESP_OK) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(WIFI_PS_SETTLE_MS));
+
+        ping_result_t res = { .done = done };
+        err = _ping_gateway(ip_info.gw.addr, count, &res);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "ping 网关失败: %s", esp_err_to_name(err));
+            break;
+        }
+
+        uint32_t avg_ms = res.replies ? res.rtt_sum_ms / res.replies : 0;
+        taskENTER_CRITICAL(&s_power_mux);
+        s_stats.profiles[p].rtt_avg_ms = avg_ms;
+        s_stats.profiles[p].rtt_max_ms = res.rtt_max_ms;
+        s_stats.profiles[p].rtt_lost = res.lost;
+        taskEXIT_CRITICAL(&s_power_mux);
+
+        if (p == WIFI_PS_PROFILE_NONE) {
+            base_rtt_ms = avg_ms;
+        }
+        ESP_LOGI(TAG, "%-9s: RTT 平均 %lu ms (增加 %ld ms), 最大 %lu ms, 丢失 %lu/%lu, 估算 %lu mA",
+                 s_profile_name[p], avg_ms, (long)avg_ms - (long)base_rtt_ms, res.rtt_max_ms,
+                 res.lost, count, s_profile_ma[p]);
+    }
+
+    vSemaphoreDelete(done);
+    if (was_forced) {
+        wifi_power_force(prev);
+    } else {
+        wifi_power_release();
+    }
+    return err;
+}
+
+void wifi_power_get_stats(wifi_power_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_power_mux);
+    *stats = s_stats;
+    stats->profile = s_profile;
+    stats->forced = s_forced;
+    if (s_inited) {
+        stats->profiles[s_profile].time_ms += (uint32_t)((now - s_profile_since_us) / 1000);
+    }
+    taskEXIT_CRITICAL(&s_power_mux);
+
+    uint64_t total_ms = 0;
+    uint64_t weighted = 0;
+    for (int p = 0; p < WIFI_PS_PROFILE_COUNT; p++) {
+        total_ms += stats->profiles[p].time_ms;
+        weighted += (uint64_t)stats->profiles[p].time_ms * stats->profiles[p].est_ma;
+    }
+    stats->est_avg_ma = total_ms ? (uint32_t)(weighted / total_ms) : s_profile_ma[s_profile];
+}
@@ -0,0 +1,79 @@
+#ifndef __WIFI_POWER_H__
+#define __WIFI_POWER_H__
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 省电档位（数值越小越省延迟、越费电）
+ */
+typedef enum {
+    WIFI_PS_PROFILE_NONE = 0,       // 不休眠：延迟最低
+    WIFI_PS_PROFILE_MIN_MODEM,      // 每个 DTIM 醒来
+    WIFI_PS_PROFILE_MAX_MODEM,      // 每 WIFI_PS_LISTEN_INTERVAL 个信标醒来：最省电
+    WIFI_PS_PROFILE_COUNT,
+} wifi_ps_profile_t;
+
+/**
+ * @brief 业务类型（各自对应的档位见 wifi_config.h）
+ */
+typedef enum {
+    WIFI_TRAFFIC_TELEMETRY = 0,     // 空闲与周期遥测
+    WIFI_TRAFFIC_INTERACTIVE,       // 命令/控制
+    WIFI_TRAFFIC_STREAM,            // 图像/音频流
+    WIFI_TRAFFIC_COUNT,
+} wifi_traffic_class_t;
+
+/**
+ * @brief 单个档位的统计
+ */
+typedef struct {
+    uint32_t time_ms;               // 累计处于该档位的时间
+    uint32_t est_ma;                // 估算平均电流（配置值）
+    uint32_t rtt_avg_ms;            // 实测到网关的往返延迟（wifi_power_measure_latency）
+    uint32_t rtt_max_ms;
+    uint32_t rtt_lost;              // 测量中丢失的 ping 数
+} wifi_ps_profile_stats_t;
+
+typedef struct {
+    wifi_ps_profile_t profile;      // 当前档位
+    bool forced;                    // 是否被 wifi_power_force 固定
+    uint32_t switches;              // 档位切换次数
+    uint32_t est_avg_ma;            // 按各档位时间加权的估算平均电流
+    wifi_ps_profile_stats_t profiles[WIFI_PS_PROFILE_COUNT];
+} wifi_power_stats_t;
+
+/**
+ * @brief 初始化省电管理并进入遥测档位（STA 启动后由 wifi_manager 调用）
+ */
+esp_err_t wifi_power_init(void);
+
+/**
+ * @brief 报告业务活动：需要更低延迟时立即切换，空闲 WIFI_PS_HOLD_MS 后回落
+ */
+void wifi_power_notify(wifi_traffic_class_t cls);
+
+/**
+ * @brief 固定档位（关闭自动切换），直到 wifi_power_release
+ */
+esp_err_t wifi_power_force(wifi_ps_profile_t profile);
+
+/**
+ * @brief 恢复自动切换
+ */
+void wifi_power_release(void);
+
+/**
+ * @brief 依次在各档位下 ping 网关，测量增加的延迟（阻塞，需已获取 IP）
+ *
+ * @param count 每个档位的 ping 次数
+ */
+esp_err_t wifi_power_measure_latency(uint32_t count);
+
+/**
+ * @brief 获取统计（累计时间计到调用时刻）
+ */
+void wifi_power_get_stats(wifi_power_stats_t *stats);
+
+#endif /* __WIFI_POWER_H__ */
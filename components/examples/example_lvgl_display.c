@@ -1,12 +1,15 @@
 #include "examples.h"
 #include "lvgl_port.h"
 #include "lvgl_demo_ui.h"
+#include "disp_profiler.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 static const char *TAG = "example_lvgl";
 
+#define EXAMPLE_LVGL_PROFILER_OVERLAY   0   // 1：显示帧耗时浮层
+
 void example_lvgl_display(void)
 {
     ESP_LOGI(TAG, "=== LVGL 显示测试 ===");
@@ -27,6 +30,9 @@ void example_lvgl_display(void)
     // 创建 Demo UI（需要加锁）
     if (lvgl_port_lock_mutex(1000)) {
         lvgl_demo_ui(disp);
+#if EXAMPLE_LVGL_PROFILER_OVERLAY
+        disp_profiler_show_overlay(true);
+#endif
         lvgl_port_unlock_mutex();
     } else {
         ESP_LOGE(TAG, "无法获取 LVGL 互斥锁");
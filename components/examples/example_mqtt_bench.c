@@ -0,0 +1,199 @@
+#include "examples.h"
+#include "mqtt_app.h"
+#include "mqtt_app_config.h"
+#include "mqtt_loopback.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "example_mqtt_bench";
+
+/* 负载配置：需要在 mqtt_app_config.h 中将 MQTT_APP_LOOPBACK 设为 1 */
+#define BENCH_IMG_FPS           10                          // 图像帧率（0 表示不发送图像）
+#define BENCH_IMG_X             0                           // 图像区域（小区域可测精灵级局部更新）
+#define BENCH_IMG_Y             0
+#define BENCH_IMG_W             MQTT_APP_IMG_WIDTH
+#define BENCH_IMG_H             MQTT_APP_IMG_HEIGHT
+#define BENCH_IMG_SIZE          (MQTT_APP_IMG_HDR_LEN + BENCH_IMG_W * BENCH_IMG_H * MQTT_APP_IMG_PIXEL_SIZE)
+#define BENCH_SENSOR_HZ         500                         // 传感器消息速率
+#define BENCH_SENSOR_LEN        256                         // 传感器消息大小
+#define BENCH_SENSOR_QOS        1
+#define BENCH_SENSOR_TOPIC      "bench/sensor/imu"
+#define BENCH_SENSOR_FILTER     "bench/sensor/#"
+#ifndef BENCH_DURATION_S                                    // 主机构建（tools/host_bench）可在编译时缩短
+#define BENCH_DURATION_S        30                          // 测试时长
+#endif
+#define BENCH_TICK_MS           10                          // 发送节拍
+
+static volatile uint32_t s_sensor_rx = 0;
+static volatile uint32_t s_sensor_bad = 0;
+static volatile uint32_t s_frames_rx = 0;
+
+static esp_err_t _sensor_handler(const char *topic, const uint8_t *data, size_t len, void *user_ctx)
+{
+    (void)topic;
+    (void)data;
+    (void)user_ctx;
+    if (len != BENCH_SENSOR_LEN) {
+        s_sensor_bad++;
+    }
+    s_sensor_rx++;
+    return ESP_OK;
+}
+
+// 只计数，测量的是接收与重组本身的开销
+static esp_err_t _image_handler(const uint8_t *data, size_t len, const mqtt_app_img_rect_t *rect)
+{
+    (void)data;
+    (void)len;
+    (void)rect;
+    s_frames_rx++;
+    return ESP_OK;
+}
+
+static void _log_heap(const char *label)
+{
+    ESP_LOGI(TAG, "%s: 内部 RAM 空闲 %u (最低 %u), PSRAM 空闲 %u (最低 %u)", label,
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+}
+
+// 负载生成任务：按节拍发送传感器消息（经发件箱）与图像（直接发布）
+static void _load_task(void *arg)
+{
+    (void)arg;
+    uint8_t sensor[BENCH_SENSOR_LEN];
+    uint8_t *image = heap_caps_malloc(BENCH_IMG_SIZE, MALLOC_CAP_SPIRAM);
+    if (image == NULL) {
+        ESP_LOGE(TAG, "图像缓冲区分配失败");
+        vTaskDelete(NULL);
+        return;
+    }
+    // 图像头（格式见 mqtt_app.h）
+    const uint16_t rect[4] = {BENCH_IMG_X, BENCH_IMG_Y, BENCH_IMG_W, BENCH_IMG_H};
+    image[0] = MQTT_APP_IMG_MAGIC0;
+    image[1] = MQTT_APP_IMG_MAGIC1;
+    image[2] = MQTT_APP_IMG_FMT_RGB565;
+    image[3] = 0;
+    for (int i = 0; i < 4; i++) {
+        image[4 + i * 2] = rect[i] & 0xFF;
+        image[5 + i * 2] = rect[i] >> 8;
+    }
+
+    // 渐变测试图（RGB565），压缩率接近真实界面截图而非纯色
+    uint16_t *px = (uint16_t *)(image + MQTT_APP_IMG_HDR_LEN);
+    for (int y = 0; y < BENCH_IMG_H; y++) {
+        for (int x = 0; x < BENCH_IMG_W; x++) {
+            px[y * BENCH_IMG_W + x] = (uint16_t)(((x >> 3) << 11) | ((y >> 2) << 5) | (((x + y) >> 4) & 0x1F));
+        }
+    }
+
+    uint32_t sensor_sent = 0;
+    uint32_t sensor_fail = 0;
+    uint32_t img_sent = 0;
+    uint32_t img_fail = 0;
+    int64_t start_us = esp_timer_get_time();
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (esp_timer_get_time() - start_us < BENCH_DURATION_S * 1000000LL) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(BENCH_TICK_MS));
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+        // 按经过时间补齐应发数量，节拍抖动不影响平均速率
+        uint32_t sensor_due = (uint32_t)(elapsed_us * BENCH_SENSOR_HZ / 1000000);
+        while (sensor_sent + sensor_fail < sensor_due) {
+            memcpy(sensor, &sensor_sent, sizeof(sensor_sent));
+            if (mqtt_app_enqueue(BENCH_SENSOR_TOPIC, sensor, sizeof(sensor), BENCH_SENSOR_QOS) == ESP_OK) {
+                sensor_sent++;
+            } else {
+                sensor_fail++;
+            }
+        }
+
+        uint32_t img_due = (uint32_t)(elapsed_us * BENCH_IMG_FPS / 1000000);
+        while (img_sent + img_fail < img_due) {
+            if (mqtt_app_publish(MQTT_APP_TOPIC_IMAGE, image, BENCH_IMG_SIZE, 0) == ESP_OK) {
+                img_sent++;
+            } else {
+                img_fail++;
+            }
+        }
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(500));     // 等待队列中的消息投递完
+    ESP_LOGI(TAG, "发送完成: 传感器 %lu (失败 %lu), 图像 %lu (失败 %lu)",
+             sensor_sent, sensor_fail, img_sent, img_fail);
+    free(image);
+    vTaskDelete(NULL);
+}
+
+void example_mqtt_bench(void)
+{
+    ESP_LOGI(TAG, "=== MQTT 回环压测 ===");
+#if !MQTT_APP_LOOPBACK
+    ESP_LOGE(TAG, "请先在 mqtt_app_config.h 中将 MQTT_APP_LOOPBACK 设为 1");
+    return;
+#endif
+
+    _log_heap("启动前");
+    ESP_ERROR_CHECK(mqtt_app_init());
+    ESP_ERROR_CHECK(mqtt_app_register_data_handler(_image_handler));
+    ESP_ERROR_CHECK(mqtt_app_route_message(BENCH_SENSOR_FILTER, BENCH_SENSOR_QOS, BENCH_SENSOR_LEN,
+                                           _sensor_handler, NULL));
+
+#if MQTT_APP_IMG_COMPRESSED
+    // 图像主题按压缩格式收发，接收端边收边解压
+    ESP_ERROR_CHECK(mqtt_app_set_compression(MQTT_APP_TOPIC_IMAGE, true));
+#endif
+
+    ESP_ERROR_CHECK(mqtt_app_wait_connected(portMAX_DELAY));
+
+    ESP_LOGI(TAG, "负载: 图像 %d fps x %u 字节, 传感器 %d Hz x %d 字节 (QoS %d), 持续 %d 秒",
+             BENCH_IMG_FPS, (unsigned)BENCH_IMG_SIZE, BENCH_SENSOR_HZ, BENCH_SENSOR_LEN,
+             BENCH_SENSOR_QOS, BENCH_DURATION_S);
+    xTaskCreate(_load_task, "bench_load", 4096, NULL, 4, NULL);
+
+    // 每秒输出吞吐、重组延迟与内存占用
+    uint32_t last_sensor = 0;
+    uint32_t last_frames = 0;
+    uint64_t last_bytes = 0;
+    for (int sec = 1; sec <= BENCH_DURATION_S + 1; sec++) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+
+        mqtt_loopback_stats_t lb;
+        mqtt_app_img_stats_t img;
+        mqtt_outbox_stats_t ob;
+        mqtt_loopback_get_stats(&lb);
+        mqtt_app_get_img_stats(&img);
+        mqtt_app_get_outbox_stats(&ob);
+
+        uint32_t sensor = s_sensor_rx;
+        uint32_t frames = s_frames_rx;
+        ESP_LOGI(TAG, "[%2d s] 传感器 %lu msg/s, 图像 %lu fps, 投递 %lu KB/s, 帧延迟 %lu/%lu ms (平均/最近), "
+                 "丢帧 %lu, 发件箱峰值 %lu 字节, 代理队列峰值 %lu",
+                 sec, sensor - last_sensor, frames - last_frames,
+                 (uint32_t)((lb.bytes - last_bytes) / 1024), img.avg_latency_us / 1000,
+                 img.last_latency_us / 1000, img.dropped + img.partial, ob.high_water_bytes,
+                 lb.queue_high_water);
+        last_sensor = sensor;
+        last_frames = frames;
+        last_bytes = lb.bytes;
+    }
+
+    ESP_LOGI(TAG, "接收合计: 传感器 %lu (长度错误 %lu), 图像 %lu", s_sensor_rx, s_sensor_bad, s_frames_rx);
+
+    // 同一主题上的统计包含发送（压缩）与接收（解压）两个方向
+    mqtt_compress_stats_t cs;
+    if (mqtt_app_get_compress_stats(MQTT_APP_TOPIC_IMAGE, &cs) == ESP_OK && cs.messages > 0) {
+        ESP_LOGI(TAG, "图像压缩: %lu 条 (压缩 %lu), 压缩率 %lu%%, 平均耗时 %lu us/条",
+                 cs.messages, cs.compressed, (uint32_t)(cs.wire_bytes * 100 / cs.raw_bytes),
+                 (uint32_t)(cs.cpu_us / cs.messages));
+    }
+    _log_heap("结束");
+}
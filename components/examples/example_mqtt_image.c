@@ -1,5 +1,6 @@
 #include "examples.h"
 #include "wifi_manager.h"
+#include "wifi_power.h"
 #include "mqtt_app.h"
 #include "mqtt_app_config.h"
 #include "st7789_lcd.h"
@@ -7,26 +8,63 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 static const char *TAG = "example_mqtt_image";
 
-// MQTT 图像数据处理回调 - 将接收到的图像数据直接绘制到 ST7789
-static esp_err_t mqtt_app_image_handler(const uint8_t *data, size_t len)
+#define IMG_STRIPE_QUEUE_LEN    (MQTT_APP_FRAME_SLOTS * (MQTT_APP_IMG_HEIGHT / MQTT_APP_IMG_STRIPE_LINES + 1))  // 可容纳全部槽位的条带
+#define IMG_DRAW_TASK_STACK     (3 * 1024)
+#define IMG_DRAW_TASK_PRIORITY  6
+#define IMG_PS_MEASURE_LATENCY  0       // 1：启动后测量各省电档位的延迟（会临时切换省电档位，仅调试时开启）
+#define IMG_PS_MEASURE_COUNT    5       // 每个档位 ping 网关的次数
+
+typedef struct {
+    const uint8_t *data;        // NULL 表示本帧中止
+    mqtt_app_img_rect_t rect;   // 条带在屏幕上的区域
+    bool last;
+} img_stripe_t;
+
+static QueueHandle_t s_stripe_queue = NULL;
+
+// MQTT 条带回调 - 在 MQTT 任务中执行，只负责入队
+static esp_err_t mqtt_app_stripe_handler(const uint8_t *data, const mqtt_app_img_rect_t *rect, bool last)
 {
-    if (data == NULL || len == 0) {
-        ESP_LOGW(TAG, "接收到空图像数据");
-        return ESP_ERR_INVALID_ARG;
+    img_stripe_t stripe = {
+        .data = data,
+        .rect = *rect,
+        .last = last,
+    };
+
+    if (xQueueSend(s_stripe_queue, &stripe, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "条带队列已满");
+        return ESP_ERR_NO_MEM;
     }
-    
-    ESP_LOGI(TAG, "接收到完整图像帧，开始绘制...");
-    
-    // 绘制 240x240 的 RGB565 图像到 ST7789
-    st7789_lcd_draw_bitmap(0, 0, 240, 240, (void *)data);
-    
-    ESP_LOGI(TAG, "图像绘制完成");
     return ESP_OK;
 }
 
+// 绘制任务 - 条带到达即提交 DMA 到对应窗口，与后续分片的接收重叠
+static void img_draw_task(void *arg)
+{
+    img_stripe_t stripe;
+
+    while (1) {
+        if (xQueueReceive(s_stripe_queue, &stripe, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        if (stripe.data != NULL) {
+            const mqtt_app_img_rect_t *r = &stripe.rect;
+            st7789_lcd_draw_bitmap(r->x, r->y, r->x + r->w, r->y + r->h, (void *)stripe.data);
+        }
+
+        // 帧屏障：最后一个条带的 DMA 完成后才允许覆写重组缓冲区
+        if (stripe.last) {
+            st7789_lcd_wait_trans_done();
+            mqtt_app_frame_release();
+        }
+    }
+}
+
 void example_mqtt_image(void)
 {
     ESP_LOGI(TAG, "=== MQTT 图像接收测试 ===");
@@ -46,9 +84,10 @@ void example_mqtt_image(void)
     ESP_LOGI(TAG, "连接 WiFi...");
     ESP_ERROR_CHECK(wifi_start());
     
-    // 4. 等待 WiFi 连接
-    while (wifi_get_state() != WIFI_STATE_CONNECTED) {
-        vTaskDelay(pdMS_TO_TICKS(100));
+    // 4. 等待 WiFi 连接（获取 IP 时立即返回）
+    if (wifi_wait_connected(portMAX_DELAY) != ESP_OK) {
+        ESP_LOGE(TAG, "WiFi 连接失败");
+        return;
     }
     
     // WiFi 连接成功（黄色）
@@ -59,19 +98,31 @@ void example_mqtt_image(void)
     // 5. 初始化 MQTT
     ESP_LOGI(TAG, "初始化 MQTT...");
     ESP_ERROR_CHECK(mqtt_app_init());
+    mqtt_app_report_to_wifi();      // 收发流量计入链路监测，图像/命令触发省电档位切换
     
-    // 注册图像数据处理回调
-    ESP_ERROR_CHECK(mqtt_app_register_data_handler(mqtt_app_image_handler));
+    // 创建绘制任务并注册条带回调
+    s_stripe_queue = xQueueCreate(IMG_STRIPE_QUEUE_LEN, sizeof(img_stripe_t));
+    if (s_stripe_queue == NULL) {
+        ESP_LOGE(TAG, "条带队列创建失败");
+        return;
+    }
+    xTaskCreate(img_draw_task, "img_draw", IMG_DRAW_TASK_STACK, NULL, IMG_DRAW_TASK_PRIORITY, NULL);
+    // 条带模式下槽位由绘制任务释放，只能丢弃新消息
+    mqtt_app_set_drop_policy(MQTT_APP_DROP_NEWEST);
+    ESP_ERROR_CHECK(mqtt_app_register_stripe_handler(mqtt_app_stripe_handler));
     
     // 6. 等待 MQTT 连接
-    while (!mqtt_app_is_connected()) {
-        vTaskDelay(pdMS_TO_TICKS(500));
-    }
+    ESP_ERROR_CHECK(mqtt_app_wait_connected(portMAX_DELAY));
     
     // MQTT 连接成功（绿色）
     ws2812_led_set_color(0, 30, 0);  // 绿色
     ESP_LOGI(TAG, "MQTT 已连接");
     ESP_LOGI(TAG, "LED: 绿色（MQTT 已连接）");
+
+#if IMG_PS_MEASURE_LATENCY
+    // 各省电档位增加的延迟；之后按业务自动切换（收到图像时关闭省电）
+    wifi_power_measure_latency(IMG_PS_MEASURE_COUNT);
+#endif
     
     ESP_LOGI(TAG, "等待接收图像数据...");
 }
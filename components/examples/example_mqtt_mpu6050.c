@@ -1,57 +1,302 @@
 #include "examples.h"
 #include "wifi_manager.h"
+#include "wifi_link_monitor.h"
+#include "wifi_power.h"
 #include "mqtt_app.h"
 #include "mqtt_app_config.h"
 #include "mpu6050.h"
+#include "mpu6050_backend.h"
+#include "mpu6050_telemetry.h"
+#include "mpu6050_fifo.h"
+#include "mpu6050_fusion.h"
+#include "mpu6050_calib.h"
+#include "nvs_storage.h"
+#include "offline_log.h"
+#include "imu_features.h"
 #include "ws2812_led.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include <string.h>
 #include <stdio.h>
 
 static const char *TAG = "mqtt_mpu6050";
 
-// MPU6050 数据发布任务
+// 发布方式：原始数据二进制批量 / 仅振动特征
+#define MPU6050_PUBLISH_RAW_BATCH   0
+#define MPU6050_PUBLISH_FEATURES    1
+#define MPU6050_PUBLISH_MODE        MPU6050_PUBLISH_RAW_BATCH
+
+#if MPU6050_PUBLISH_MODE == MPU6050_PUBLISH_FEATURES
+#define MPU6050_SAMPLE_RATE_HZ      1000    // FIFO 输出数据率（振动分析需要更高采样率）
+#define MPU6050_FEATURE_WINDOW      1024    // 特征窗口（约 1 秒）
+// 最高频带上沿为奈奎斯特频率 500Hz，任何档位的 DLPF 都会衰减 150~500Hz 频带，故关闭 DLPF
+// （加速度计带宽 260Hz，陀螺仪内部 8kHz 采样，FIFO 分频按 8kHz 计算）
+#define MPU6050_SAMPLE_DLPF         MPU6050_DLPF_260HZ
+#else
+#define MPU6050_SAMPLE_RATE_HZ      100     // FIFO 输出数据率
+#define MPU6050_SAMPLE_DLPF         MPU6050_DLPF_42HZ   // 低于奈奎斯特频率 50Hz，抑制混叠
+#endif
+// 数据来源：真实传感器 / 合成数据（无硬件时测试整条链路）
+#define MPU6050_SOURCE_HW           0
+#define MPU6050_SOURCE_SYNTHETIC    1
+#define MPU6050_SOURCE              MPU6050_SOURCE_HW
+
+#define MPU6050_READ_CHUNK          32      // 每次从环形缓冲区取出的样本数
+#define MPU6050_BATCH_SAMPLES       100     // 每批样本数（约 1 秒发布一次）
+#define MPU6050_BATCH_RATE_BPS      (8 * 1024)  // 批量数据限速：重连后补发积压时不挤占其他流量
+#define MPU6050_BATCH_BURST         (4 * 1024)
+#define MPU6050_POOR_COALESCE_MS    5000    // 链路差时合并批次：更少、更大的消息，减少报文开销与重传
+#define MPU6050_POOR_COALESCE_BATCHES 5
+#define MPU6050_LINK_METRICS_SEC    10      // 链路指标发布周期
+
+static volatile wifi_link_quality_t s_link_quality = WIFI_LINK_GOOD;
+
+// 链路质量变化（在链路监测的定时器任务中执行，只记录，调整在发布任务中进行）
+static void _on_link_quality(wifi_link_quality_t quality, const wifi_link_stats_t *stats, void *user_ctx)
+{
+    s_link_quality = quality;
+}
+
+// 发布链路指标（上位机仪表盘订阅此主题）
+static void _publish_link_metrics(void)
+{
+    wifi_link_stats_t link;
+    wifi_link_get_stats(&link);
+    wifi_power_stats_t power;
+    wifi_power_get_stats(&power);
+
+    char payload[256];
+    int len = snprintf(payload, sizeof(payload),
+                       "{\"q\":%d,\"rssi\":%d,\"rssi_avg\":%d,\"rssi_min\":%d,\"tx_bps\":%lu,\"rx_bps\":%lu,"
+                       "\"fail_pct\":%lu,\"tx_fails\":%lu,\"bcn_to\":%lu,\"disc\":%lu,\"ps\":%d,\"ma\":%lu}",
+                       link.quality, link.rssi, link.rssi_avg, link.rssi_min,
+                       link.tx_bps, link.rx_bps, link.tx_fail_pct, link.tx_fails,
+                       link.beacon_timeouts, link.disconnects, power.profile, power.est_avg_ma);
+    if (len >= (int)sizeof(payload)) {
+        return;
+    }
+    if (mqtt_app_enqueue(MQTT_APP_TOPIC_LINK, payload, len, 0) != ESP_OK) {
+        ESP_LOGW(TAG, "链路指标入队失败");
+    }
+}
+
+#if MPU6050_PUBLISH_MODE == MPU6050_PUBLISH_FEATURES
+static int16_t s_raw_ch[6][MPU6050_READ_CHUNK];
+static float s_data_ch[6][MPU6050_READ_CHUNK];
+
+// 每个窗口只发布特征（约 400 字节/秒，原始数据约 14 KB/秒）
+static void _on_features(const imu_features_result_t *res, void *user_ctx)
+{
+    char payload[512];
+    int len = snprintf(payload, sizeof(payload), "{\"ts\":%llu,\"n\":%u",
+                       (unsigned long long)res->start_ts_us, res->window_size);
+
+    static const char axis_name[IMU_FEATURES_AXES] = {'x', 'y', 'z'};
+    for (int a = 0; a < IMU_FEATURES_AXES && len < (int)sizeof(payload); a++) {
+        const imu_features_axis_t *f = &res->axis[a];
+        len += snprintf(payload + len, sizeof(payload) - len,
+                        ",\"%c\":{\"rms\":%.4f,\"peak\":%.4f,\"crest\":%.2f,\"f0\":%.1f,\"bands\":[",
+                        axis_name[a], f->rms, f->peak, f->crest, f->dominant_hz);
+        for (int b = 0; b < res->num_bands && len < (int)sizeof(payload); b++) {
+            len += snprintf(payload + len, sizeof(payload) - len, "%s%.5f", b ? "," : "", f->band_energy[b]);
+        }
+        if (len < (int)sizeof(payload)) {
+            len += snprintf(payload + len, sizeof(payload) - len, "]}");
+        }
+    }
+    if (len < (int)sizeof(payload)) {
+        len += snprintf(payload + len, sizeof(payload) - len, "}");
+    }
+    if (len >= (int)sizeof(payload)) {
+        ESP_LOGW(TAG, "特征消息过长，已丢弃");
+        return;
+    }
+
+    // 经发件箱发布，断线期间缓存
+    if (mqtt_app_enqueue(MQTT_APP_TOPIC_MPU6050_FEATURES, payload, len, 0) != ESP_OK) {
+        ESP_LOGW(TAG, "特征消息入队失败");
+    }
+}
+#else
+static uint8_t s_batch_buf[MPU6050_TELEMETRY_BUF_SIZE(MPU6050_BATCH_SAMPLES)];
+
+// 发送当前批次并开始新批次
+static void _flush_batch(mpu6050_telemetry_t *batch)
+{
+    size_t len = mpu6050_telemetry_finish(batch);
+    if (len == 0) {
+        return;
+    }
+
+    // 经发件箱发布：断线期间缓存在 PSRAM，重连后补发
+    esp_err_t err = mqtt_app_enqueue(MQTT_APP_TOPIC_MPU6050_BATCH, batch->buf, len, 0);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "批次入队失败 (%s)，丢弃 %u 个样本", esp_err_to_name(err), batch->count);
+    } else {
+        ESP_LOGD(TAG, "批次已入队: %u 个样本, %u 字节", batch->count, (unsigned)len);
+    }
+    mpu6050_telemetry_reset(batch);
+}
+
+// 按链路质量调整批量数据：POOR 时合并多个批次（帧头自带样本数，拼接后仍可逐帧解析）
+static void _adapt_to_link(wifi_link_quality_t quality)
+{
+    esp_err_t err;
+    if (quality == WIFI_LINK_POOR) {
+        err = mqtt_app_set_coalesce(MQTT_APP_TOPIC_MPU6050_BATCH, MQTT_OUTBOX_COALESCE_CONCAT,
+                                    MPU6050_POOR_COALESCE_MS,
+                                    MPU6050_POOR_COALESCE_BATCHES * sizeof(s_batch_buf), -1);
+    } else {
+        err = mqtt_app_set_coalesce(MQTT_APP_TOPIC_MPU6050_BATCH, MQTT_OUTBOX_COALESCE_NONE, 0, 0, -1);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "调整批次合并失败: %s", esp_err_to_name(err));
+    } else {
+        ESP_LOGI(TAG, "链路质量 %d，批次合并%s", quality, quality == WIFI_LINK_POOR ? "开启" : "关闭");
+    }
+}
+
+static void _add_to_batch(mpu6050_telemetry_t *batch, const mpu6050_sample_t *sample)
+{
+    esp_err_t err = mpu6050_telemetry_add(batch, &sample->raw, sample->ts_us);
+    if (err == ESP_ERR_NO_MEM || err == ESP_ERR_INVALID_STATE) {
+        // 批次已满或采样间隔过长，先发送再放入新批次
+        _flush_batch(batch);
+        err = mpu6050_telemetry_add(batch, &sample->raw, sample->ts_us);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "样本编码失败: %s", esp_err_to_name(err));
+    }
+
+    if (batch->count >= MPU6050_BATCH_SAMPLES) {
+        _flush_batch(batch);
+    }
+}
+#endif
+
+// MQTT 连接状态指示：绿色已连接，黄色断线重连中（数据在发件箱中缓存）
+static void _on_mqtt_conn(bool connected, void *user_ctx)
+{
+    if (connected) {
+        ws2812_led_set_color(0, 30, 0);
+    } else {
+        ws2812_led_set_color(30, 30, 0);
+    }
+}
+
+// MPU6050 数据发布任务（FIFO 采集，按 MPU6050_PUBLISH_MODE 发布）
 static void mpu6050_mqtt_task(void *arg)
 {
-    mpu6050_raw_data_t raw_data;
-    mpu6050_data_t converted_data;
-    char mqtt_payload[256];
-    
+    mpu6050_sample_t samples[MPU6050_READ_CHUNK];
+    mpu6050_fusion_t fusion;
+    uint64_t prev_ts_us = 0;
+    int64_t fusion_us = 0;
+    uint32_t fusion_cnt = 0;
+    uint32_t status_cnt = 0;
+#if MPU6050_PUBLISH_MODE == MPU6050_PUBLISH_RAW_BATCH
+    wifi_link_quality_t applied_quality = WIFI_LINK_GOOD;
+#endif
+
+    ESP_ERROR_CHECK(mpu6050_fusion_init(&fusion, MPU6050_FUSION_MAHONY, MPU6050_SAMPLE_RATE_HZ));
+    mpu6050_fusion_set_sensitivity(&fusion, mpu6050_get_accel_sensitivity(), mpu6050_get_gyro_sensitivity());
+
+#if MPU6050_PUBLISH_MODE == MPU6050_PUBLISH_FEATURES
+    mpu6050_raw_soa_t raw_soa = {
+        s_raw_ch[0], s_raw_ch[1], s_raw_ch[2], s_raw_ch[3], s_raw_ch[4], s_raw_ch[5],
+    };
+    mpu6050_data_soa_t data_soa = {
+        s_data_ch[0], s_data_ch[1], s_data_ch[2], s_data_ch[3], s_data_ch[4], s_data_ch[5],
+    };
+    imu_features_config_t feat_cfg = {
+        .window_size = MPU6050_FEATURE_WINDOW,
+        .sample_rate_hz = MPU6050_SAMPLE_RATE_HZ,
+        .num_bands = 4,
+        .band_edges_hz = {2, 10, 50, 150, 500},
+    };
+    imu_features_handle_t features;
+    ESP_ERROR_CHECK(imu_features_create(&feat_cfg, _on_features, NULL, &features));
+#else
+    mpu6050_telemetry_t batch;
+    ESP_ERROR_CHECK(mpu6050_telemetry_init(&batch, s_batch_buf, sizeof(s_batch_buf),
+                                           mpu6050_get_accel_sensitivity(),
+                                           mpu6050_get_gyro_sensitivity()));
+#endif
+
     ESP_LOGI(TAG, "MPU6050 数据发布任务已启动");
-    
+
     while (1) {
-        // 读取 MPU6050 原始数据
-        if (mpu6050_read_raw_data(&raw_data) == ESP_OK) {
-            // 转换为物理单位
-            if (mpu6050_convert_data(&raw_data, &converted_data) == ESP_OK) {
-                // 检查 MQTT 是否已连接
-                if (mqtt_app_is_connected()) {
-                    // 构造 JSON 格式的 MQTT 消息
-                    snprintf(mqtt_payload, sizeof(mqtt_payload),
-                            "{\"gyro\":{\"x\":%.2f,\"y\":%.2f,\"z\":%.2f},"
-                            "\"accel\":{\"x\":%.2f,\"y\":%.2f,\"z\":%.2f}}",
-                            converted_data.gyro_x, converted_data.gyro_y, converted_data.gyro_z,
-                            converted_data.accel_x, converted_data.accel_y, converted_data.accel_z);
-                    
-                    // 发布到 MQTT 主题
-                    int ret = mqtt_app_publish(MQTT_APP_TOPIC_MPU6050, mqtt_payload, strlen(mqtt_payload), 0);
-                    if (ret < 0) {
-                        ESP_LOGW(TAG, "MQTT 发送失败");
-                    } else {
-                        ESP_LOGI(TAG, "已发布: %s", mqtt_payload);
-                    }
-                } else {
-                    ESP_LOGW(TAG, "MQTT 未连接，跳过发送");
-                }
+        size_t n = mpu6050_fifo_read(samples, MPU6050_READ_CHUNK, pdMS_TO_TICKS(1000));
+        if (n == 0) {
+            ESP_LOGW(TAG, "1 秒内无新样本");
+            continue;
+        }
+
+#if MPU6050_PUBLISH_MODE == MPU6050_PUBLISH_FEATURES
+        mpu6050_raw_to_soa(&samples[0].raw, sizeof(samples[0]), n, &raw_soa);
+        mpu6050_convert_batch(&raw_soa, &data_soa, n);
+        imu_features_push(features, data_soa.accel_x, data_soa.accel_y, data_soa.accel_z, n, samples[0].ts_us);
+#endif
+
+        for (size_t i = 0; i < n; i++) {
+            // 姿态解算（按实际时间戳计算 dt）
+            float dt = prev_ts_us ? (samples[i].ts_us - prev_ts_us) * 1e-6f : 0.0f;
+            prev_ts_us = samples[i].ts_us;
+            int64_t t0 = esp_timer_get_time();
+            mpu6050_fusion_update_raw(&fusion, &samples[i].raw, dt);
+            fusion_us += esp_timer_get_time() - t0;
+            fusion_cnt++;
+
+#if MPU6050_PUBLISH_MODE == MPU6050_PUBLISH_RAW_BATCH
+            _add_to_batch(&batch, &samples[i]);
+#endif
+        }
+
+        // 每秒输出一次状态
+        if (fusion_cnt >= MPU6050_SAMPLE_RATE_HZ) {
+            mpu6050_fifo_stats_t stats;
+            mpu6050_fifo_get_stats(&stats);
+            ESP_LOGD(TAG, "采样率 %.1f Hz, FIFO 溢出 %lu, 缓冲区覆盖 %lu",
+                     stats.effective_hz, stats.hw_overflows, stats.ring_overruns);
+
+            mqtt_outbox_stats_t ob;
+            mqtt_app_get_outbox_stats(&ob);
+            ESP_LOGD(TAG, "发件箱: 排队 %lu (%lu 字节), 已发送 %lu, 丢弃 %lu, 最大延迟 %lu ms",
+                     ob.queued, ob.queued_bytes, ob.sent, ob.dropped, ob.max_delay_ms);
+            ESP_LOGD(TAG, "排队延迟(平均/最大 ms): 控制 %lu/%lu, 普通 %lu/%lu, 批量 %lu/%lu",
+                     ob.classes[MQTT_OUTBOX_PRIO_CONTROL].avg_delay_ms, ob.classes[MQTT_OUTBOX_PRIO_CONTROL].max_delay_ms,
+                     ob.classes[MQTT_OUTBOX_PRIO_NORMAL].avg_delay_ms, ob.classes[MQTT_OUTBOX_PRIO_NORMAL].max_delay_ms,
+                     ob.classes[MQTT_OUTBOX_PRIO_BULK].avg_delay_ms, ob.classes[MQTT_OUTBOX_PRIO_BULK].max_delay_ms);
+
+            offline_log_stats_t ol;
+            offline_log_get_stats(&ol);
+            ESP_LOGD(TAG, "离线日志: 待回放 %lu, 已回放 %lu, 覆盖 %lu, 扇区 %lu/%lu",
+                     ol.pending, ol.replayed, ol.dropped, ol.sectors_used, ol.sectors);
+
+            // 后台校准完成后零偏会更新
+            mpu6050_gyro_bias_t bias;
+            mpu6050_get_gyro_bias(&bias);
+            mpu6050_fusion_set_gyro_bias(&fusion, &bias);
+
+            mpu6050_euler_t euler;
+            mpu6050_fusion_get_euler(&fusion, &euler);
+            ESP_LOGI(TAG, "姿态 roll %.1f pitch %.1f yaw %.1f, 解算 %.2f us/次",
+                     euler.roll, euler.pitch, euler.yaw, (float)fusion_us / fusion_cnt);
+            fusion_us = 0;
+            fusion_cnt = 0;
+
+#if MPU6050_PUBLISH_MODE == MPU6050_PUBLISH_RAW_BATCH
+            // 断开期间保持原设置，发件箱照常缓存
+            wifi_link_quality_t quality = s_link_quality;
+            if (quality != WIFI_LINK_DOWN && (quality == WIFI_LINK_POOR) != (applied_quality == WIFI_LINK_POOR)) {
+                _adapt_to_link(quality);
+                applied_quality = quality;
+            }
+#endif
+            if (++status_cnt % MPU6050_LINK_METRICS_SEC == 0) {
+                _publish_link_metrics();
             }
-        } else {
-            ESP_LOGE(TAG, "MPU6050 读取失败");
         }
-        
-        // 每 0.5 秒发送一次
-        vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
 
@@ -64,41 +309,82 @@ void example_wifi_mqtt(void)
     ws2812_led_set_color(30, 0, 0);  // 红色
     ESP_LOGI(TAG, "LED: 红色（启动中）");
     
-    // 1. 初始化 MPU6050
+    // 1. 初始化 MPU6050（先初始化 NVS，以便加载已保存的校准参数）
     ESP_LOGI(TAG, "初始化 MPU6050...");
+    ESP_ERROR_CHECK(nvs_storage_init());
+#if MPU6050_SOURCE == MPU6050_SOURCE_SYNTHETIC
+    mpu6050_backend_t *backend = NULL;
+    ESP_ERROR_CHECK(mpu6050_backend_synthetic_create(NULL, &backend));
+    ESP_ERROR_CHECK(mpu6050_set_backend(backend));
+#endif
     ESP_ERROR_CHECK(mpu6050_init());
+    mpu6050_fifo_config_t fifo_cfg = MPU6050_FIFO_DEFAULT_CONFIG();
+    fifo_cfg.odr_hz = MPU6050_SAMPLE_RATE_HZ;
+    fifo_cfg.dlpf = MPU6050_SAMPLE_DLPF;
+#if MPU6050_SOURCE == MPU6050_SOURCE_SYNTHETIC
+    fifo_cfg.int_gpio = -1;     // 模拟设备没有 INT 引脚，轮询读取
+#endif
+    ESP_ERROR_CHECK(mpu6050_fifo_start(&fifo_cfg));
+
+    mpu6050_calib_t calib;
+    mpu6050_get_calibration(&calib);
+    if (!(calib.flags & MPU6050_CALIB_GYRO_VALID)) {
+        // 首次启动：在采集流上后台校准，请保持设备静止
+        ESP_ERROR_CHECK(mpu6050_calib_start_gyro());
+    }
     ESP_LOGI(TAG, "MPU6050 初始化完成");
     
     // 2. 启动 WiFi
     ESP_LOGI(TAG, "连接 WiFi...");
     ESP_ERROR_CHECK(wifi_start());
     
-    // 3. 等待 WiFi 连接
-    while (wifi_get_state() != WIFI_STATE_CONNECTED) {
-        vTaskDelay(pdMS_TO_TICKS(500));
+    // 3. 等待 WiFi 连接（获取 IP 时立即返回）
+    if (wifi_wait_connected(portMAX_DELAY) != ESP_OK) {
+        ESP_LOGE(TAG, "WiFi 连接失败");
+        return;
     }
     
     // WiFi 连接成功（黄色）
     ws2812_led_set_color(30, 30, 0);  // 黄色
     ESP_LOGI(TAG, "WiFi 已连接");
     ESP_LOGI(TAG, "LED: 黄色（WiFi 已连接）");
+
+    // 链路监测：质量变化时调整批量数据，指标定期发布
+    ESP_ERROR_CHECK(wifi_link_monitor_start());
+    ESP_ERROR_CHECK(wifi_link_subscribe(_on_link_quality, NULL));
     
     // 4. 初始化 MQTT
     ESP_LOGI(TAG, "初始化 MQTT...");
     ESP_ERROR_CHECK(mqtt_app_init());
+    mqtt_app_report_to_wifi();      // 收发流量计入链路监测，图像/命令触发省电档位切换
+
+    // 原始批量数据走批量类并限速，振动特征（小消息）越过排队中的批量数据
+    mqtt_app_set_topic_class(MQTT_APP_TOPIC_MPU6050_BATCH, MQTT_OUTBOX_PRIO_BULK,
+                             MPU6050_BATCH_RATE_BPS, MPU6050_BATCH_BURST);
+    mqtt_app_set_topic_class(MQTT_APP_TOPIC_MPU6050_FEATURES, MQTT_OUTBOX_PRIO_CONTROL, 0, 0);
+
+    // 发件箱写满时转存到 Flash，重连后由离线日志按限速回放
+    if (offline_log_init() == ESP_OK) {
+        mqtt_app_set_outbox_spill(offline_log_append);
+    } else {
+        ESP_LOGW(TAG, "离线日志不可用，发件箱写满时将丢弃最旧数据");
+    }
     
     // 5. 等待 MQTT 连接
-    while (!mqtt_app_is_connected()) {
-        vTaskDelay(pdMS_TO_TICKS(500));
-    }
+    ESP_ERROR_CHECK(mqtt_app_wait_connected(portMAX_DELAY));
     
-    // MQTT 连接成功（绿色）
-    ws2812_led_set_color(0, 30, 0);  // 绿色
+    // MQTT 连接成功（绿色），之后由回调随连接状态切换
+    ESP_ERROR_CHECK(mqtt_app_register_conn_cb(_on_mqtt_conn, NULL));
     ESP_LOGI(TAG, "MQTT 已连接");
     ESP_LOGI(TAG, "LED: 绿色（MQTT 已连接）");
     
     // 6. 创建 MPU6050 数据发布任务
-    xTaskCreate(mpu6050_mqtt_task, "mpu_mqtt", 4096, NULL, 5, NULL);
+    xTaskCreate(mpu6050_mqtt_task, "mpu_mqtt", 6144, NULL, 5, NULL);
     ESP_LOGI(TAG, "MPU6050 数据发布任务已创建");
-    ESP_LOGI(TAG, "开始每 0.5 秒发布传感器数据到 MQTT...");
+    ESP_LOGI(TAG, "开始以 %d Hz 采样，发布到 %s...", MPU6050_SAMPLE_RATE_HZ,
+#if MPU6050_PUBLISH_MODE == MPU6050_PUBLISH_FEATURES
+             MQTT_APP_TOPIC_MPU6050_FEATURES);
+#else
+             MQTT_APP_TOPIC_MPU6050_BATCH);
+#endif
 }
@@ -29,6 +29,10 @@ void examples_run_demo(void)
     ESP_LOGI(TAG, "启动示例 6：MQTT 图像接收测试");
     example_mqtt_image();
     
+#elif SELECTED_EXAMPLE == EXAMPLE_MQTT_BENCH
+    ESP_LOGI(TAG, "启动示例 7：MQTT 回环压测");
+    example_mqtt_bench();
+    
 #else
     ESP_LOGE(TAG, "错误：未选择有效的示例！");
     ESP_LOGE(TAG, "请在 examples.h 中设置 SELECTED_EXAMPLE 宏");
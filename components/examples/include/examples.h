@@ -8,6 +8,7 @@
 #define EXAMPLE_SPEECH_RECOGNITION  3
 #define EXAMPLE_MQTT_MPU6050        4
 #define EXAMPLE_MQTT_IMAGE          5
+#define EXAMPLE_MQTT_BENCH          6
 
 // 选择要运行的示例
 #define SELECTED_EXAMPLE  EXAMPLE_SPEECH_RECOGNITION
@@ -19,5 +20,6 @@ void example_led_effects(void);
 void example_speech_recognition(void);
 void example_wifi_mqtt(void);
 void example_mqtt_image(void);
+void example_mqtt_bench(void);
 
 #endif
@@ -0,0 +1,432 @@
+/*
+ * 负载压缩测试：mqtt_compress 打包 → 分片流式解压的往返一致性
+ *
+ *   - 语料覆盖可压缩文本、不可压缩随机数据、全零（长匹配）、短周期图案（偏移小于匹配长度的
+ *     重叠复制）、长字面量（多字节长度扩展）、低于压缩阈值的短消息与空消息；
+ *   - 每条打包结果先用一次性参考解码器按 LZ4 块格式规范严格检查（最后 5 字节为字面量、
+ *     最后一个匹配在结尾 12 字节之前），再按整段、逐字节、随机分片三种方式流式解压；
+ *   - 由 lz4 命令行工具（v1.9.4）生成的块作为互通向量；
+ *   - 截断、目标缓冲区不足、损坏的偏移/方法/魔数、多余字节等错误路径，以及按主题统计。
+ *
+ * 用法：compress_test
+ */
+#include "mqtt_compress.h"
+#include "mqtt_app_config.h"
+#include "host_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_TOPIC             "test/lz4"
+#define BENCH_TOPIC_OFF         "test/plain"
+#define BENCH_MAX_RAW           (64 * 1024)
+#define BENCH_RANDOM_SPLITS     20          // 每条消息的随机分片方案数
+#define BENCH_ROUNDS            200         // 吞吐测量轮数
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...)                                                    \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  失败 %s:%d: %s  ", __FILE__, __LINE__, #cond);       \
+            printf(__VA_ARGS__);                                            \
+            printf("\n");                                                   \
+            s_failures++;                                                   \
+        }                                                                   \
+    } while (0)
+
+static uint32_t s_rng = 20240601;
+
+static uint32_t _rand(void)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+// lz4 -9 --no-frame-crc -BD -B4 压缩 _interop_text() 得到的帧中取出的块
+static const uint8_t s_interop_block[] = {
+    0xe1, 0x7b, 0x22, 0x74, 0x73, 0x22, 0x3a, 0x31, 0x30, 0x30, 0x30, 0x2c, 0x22, 0x61, 0x78, 0x0a,
+    0x00, 0xf1, 0x0f, 0x2c, 0x22, 0x61, 0x79, 0x22, 0x3a, 0x2d, 0x31, 0x32, 0x2c, 0x22, 0x61, 0x7a,
+    0x22, 0x3a, 0x31, 0x36, 0x33, 0x38, 0x34, 0x2c, 0x22, 0x67, 0x78, 0x22, 0x3a, 0x33, 0x2c, 0x22,
+    0x67, 0x1b, 0x00, 0x94, 0x2c, 0x22, 0x67, 0x7a, 0x22, 0x3a, 0x30, 0x7d, 0x0a, 0x3f, 0x00, 0x15,
+    0x31, 0x3f, 0x00, 0x1f, 0x31, 0x3f, 0x00, 0x21, 0x15, 0x32, 0x3f, 0x00, 0x1f, 0x32, 0x3f, 0x00,
+    0x21, 0x1f, 0x33, 0xbd, 0x00, 0x2b, 0x1f, 0x34, 0xbd, 0x00, 0x2b, 0x1f, 0x35, 0xbd, 0x00, 0x2b,
+    0x1f, 0x36, 0xbd, 0x00, 0x2b, 0x1f, 0x37, 0xbd, 0x00, 0x2b, 0x1f, 0x38, 0xbd, 0x00, 0x2b, 0x1f,
+    0x39, 0xbd, 0x00, 0x2a, 0x2f, 0x31, 0x30, 0xbd, 0x00, 0x2a, 0x2f, 0x31, 0x31, 0xbd, 0x00, 0x1e,
+    0x50, 0x22, 0x3a, 0x30, 0x7d, 0x0a,
+};
+
+static size_t _interop_text(char *buf, size_t cap)
+{
+    size_t len = 0;
+    for (int i = 0; i < 12; i++) {
+        len += snprintf(buf + len, cap - len, "{\"ts\":%d,\"ax\":%d,\"ay\":-12,\"az\":16384,\"gx\":3,\"gy\":-1,\"gz\":0}\n",
+                        1000 + i * 10, 100 + i % 3);
+    }
+    return len;
+}
+
+// 类似 NDJSON 遥测的可压缩文本
+static size_t _gen_text(uint8_t *buf, size_t len)
+{
+    size_t n = 0;
+    for (uint32_t i = 0; n < len; i++) {
+        char line[96];
+        int l = snprintf(line, sizeof(line), "{\"ts\":%u,\"t\":%d.%02d,\"rh\":%u,\"ok\":true}\n", 1700000000u + i,
+                         20 + (int)(_rand() % 5), (int)(_rand() % 100), 40 + _rand() % 20);
+        for (int k = 0; k < l && n < len; k++) {
+            buf[n++] = (uint8_t)line[k];
+        }
+    }
+    return len;
+}
+
+/*
+ * 一次性参考解码器：按 LZ4 块格式规范逐项检查，不与被测的流式解码器共享代码
+ * 返回解出的字节数，格式错误返回 -1
+ */
+static long _ref_decode(const uint8_t *src, size_t len, uint8_t *dst, size_t cap)
+{
+    const uint8_t *ip = src, *iend = src + len;
+    size_t out = 0;
+    size_t last_match_start = 0;
+    bool any_match = false;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                lit += b;
+            } while (b == 255);
+        }
+        if ((size_t)(iend - ip) < lit || cap - out < lit) {
+            return -1;
+        }
+        memcpy(dst + out, ip, lit);
+        ip += lit;
+        out += lit;
+        if (ip == iend) {
+            // 最后一个序列：至少 5 字节字面量（整块短于 13 字节时除外），最后一个匹配在结尾 12 字节之前
+            if (any_match && (lit < 5 || out - last_match_start < 12)) {
+                return -1;
+            }
+            return (long)out;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        size_t off = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t ml = (token & 0x0F) + 4;
+        if ((token & 0x0F) == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                ml += b;
+            } while (b == 255);
+        }
+        if (off == 0 || off > out || cap - out < ml) {
+            return -1;
+        }
+        last_match_start = out;
+        any_match = true;
+        for (size_t i = 0; i < ml; i++) {
+            dst[out + i] = dst[out + i - off];
+        }
+        out += ml;
+    }
+    return -1;
+}
+
+// 按固定分片长度流式解压并与原文比较；frag 为 0 时每片随机 1 ~ 97 字节
+static bool _stream(const uint8_t *wire, size_t wire_len, const uint8_t *raw, size_t raw_len, size_t frag,
+                    uint8_t *dst)
+{
+    // 清掉上一次的结果，避免错误的匹配复制恰好读到正确的旧数据
+    memset(dst, 0xEE, raw_len);
+    mqtt_decomp_t d;
+    mqtt_decomp_begin(&d, dst, BENCH_MAX_RAW);
+    size_t pos = 0;
+    while (pos < wire_len) {
+        size_t n = frag ? frag : (size_t)(1 + _rand() % 97);
+        if (n > wire_len - pos) {
+            n = wire_len - pos;
+        }
+        if (mqtt_decomp_feed(&d, wire + pos, n) != ESP_OK) {
+            return false;
+        }
+        pos += n;
+        // 头部喂完后原始长度可用
+        if (pos >= MQTT_COMPRESS_HDR_LEN && d.raw_len != raw_len) {
+            return false;
+        }
+    }
+    return mqtt_decomp_finish(&d) && d.out == raw_len && d.wire_len == wire_len && memcmp(dst, raw, raw_len) == 0;
+}
+
+typedef struct {
+    uint32_t messages;
+    uint32_t compressed;
+    uint64_t raw_bytes;
+    uint64_t wire_bytes;
+} totals_t;
+
+static void _round_trip(const char *name, const uint8_t *raw, size_t len, bool expect_lz4, totals_t *tot)
+{
+    uint8_t *wire = NULL;
+    size_t wire_len = 0;
+    esp_err_t err = mqtt_compress_pack(BENCH_TOPIC, raw, len, &wire, &wire_len);
+    CHECK(err == ESP_OK, "%s: pack %s", name, esp_err_to_name(err));
+    if (err != ESP_OK) {
+        return;
+    }
+
+    uint8_t method = wire[0] & 0x0F;
+    size_t peek_len = 0;
+    CHECK((wire[0] & 0xF0) == MQTT_COMPRESS_MAGIC, "%s: 魔数 0x%02x", name, wire[0]);
+    CHECK(mqtt_compress_peek(wire, wire_len, &peek_len) == ESP_OK && peek_len == len, "%s: 头部长度 %zu", name,
+          peek_len);
+    CHECK(method == (expect_lz4 ? MQTT_COMPRESS_LZ4 : MQTT_COMPRESS_RAW), "%s: 方法 %u", name, method);
+    CHECK(wire_len <= len + MQTT_COMPRESS_HDR_LEN, "%s: 输出 %zu 大于原始长度", name, wire_len);
+
+    uint8_t *dst = malloc(BENCH_MAX_RAW);
+    if (method == MQTT_COMPRESS_LZ4) {
+        long n = _ref_decode(wire + MQTT_COMPRESS_HDR_LEN, wire_len - MQTT_COMPRESS_HDR_LEN, dst, BENCH_MAX_RAW);
+        CHECK(n == (long)len && memcmp(dst, raw, len) == 0, "%s: 参考解码器结果 %ld", name, n);
+    }
+
+    CHECK(_stream(wire, wire_len, raw, len, wire_len, dst), "%s: 整段解压", name);
+    CHECK(_stream(wire, wire_len, raw, len, 1, dst), "%s: 逐字节解压", name);
+    bool ok = true;
+    for (int i = 0; i < BENCH_RANDOM_SPLITS; i++) {
+        ok &= _stream(wire, wire_len, raw, len, 0, dst);
+    }
+    CHECK(ok, "%s: 随机分片解压", name);
+
+    printf("  %-10s %6zu → %6zu 字节（%5.1f%%）%s\n", name, len, wire_len, len ? 100.0 * wire_len / len : 0.0,
+           method == MQTT_COMPRESS_LZ4 ? "LZ4" : "原样");
+    tot->messages++;
+    tot->compressed += method == MQTT_COMPRESS_LZ4;
+    tot->raw_bytes += len;
+    tot->wire_bytes += wire_len;
+    free(dst);
+    free(wire);
+}
+
+static void _test_round_trip(void)
+{
+    printf("往返一致性\n");
+    uint8_t *raw = malloc(BENCH_MAX_RAW);
+    totals_t tot = {0};
+
+    _round_trip("文本", raw, _gen_text(raw, 4096), true, &tot);
+
+    for (size_t i = 0; i < 2048; i++) {
+        raw[i] = (uint8_t)_rand();
+    }
+    _round_trip("随机", raw, 2048, false, &tot);
+
+    memset(raw, 0, BENCH_MAX_RAW);
+    _round_trip("全零", raw, BENCH_MAX_RAW, true, &tot);
+
+    // 周期 3、5、7 的图案：匹配偏移小于匹配长度，源与目标重叠
+    for (size_t i = 0; i < 8192; i++) {
+        raw[i] = (uint8_t)(i < 3000 ? "xyz"[i % 3] : i < 6000 ? 'A' + i % 5 : '0' + i % 7);
+    }
+    _round_trip("短周期", raw, 8192, true, &tot);
+
+    // 600 字节随机字面量（长度扩展 2 字节以上）后接重复段
+    for (size_t i = 0; i < 600; i++) {
+        raw[i] = (uint8_t)_rand();
+    }
+    memcpy(raw + 600, raw, 600);
+    _round_trip("长字面量", raw, 1200, true, &tot);
+
+    // 短于压缩阈值、刚到阈值、空消息
+    _gen_text(raw, MQTT_APP_COMPRESS_MIN_LEN);
+    _round_trip("短消息", raw, MQTT_APP_COMPRESS_MIN_LEN - 1, false, &tot);
+    memset(raw, 'a', MQTT_APP_COMPRESS_MIN_LEN);
+    _round_trip("阈值", raw, MQTT_APP_COMPRESS_MIN_LEN, true, &tot);
+    _round_trip("空", raw, 0, false, &tot);
+
+    // 多种长度，覆盖结尾字面量与最后匹配位置的边界
+    bool ok = true;
+    int before = s_failures;
+    for (size_t len = MQTT_APP_COMPRESS_MIN_LEN; len < MQTT_APP_COMPRESS_MIN_LEN + 40; len++) {
+        for (size_t i = 0; i < len; i++) {
+            raw[i] = (uint8_t)("abcabcabd"[i % 9]);
+        }
+        uint8_t *wire;
+        size_t wire_len;
+        uint8_t dst[256];
+        ok &= mqtt_compress_pack(BENCH_TOPIC, raw, len, &wire, &wire_len) == ESP_OK;
+        ok &= _ref_decode(wire + MQTT_COMPRESS_HDR_LEN, wire_len - MQTT_COMPRESS_HDR_LEN, dst, sizeof(dst)) ==
+              (long)len;
+        ok &= _stream(wire, wire_len, raw, len, 3, dst);
+        tot.messages++;
+        tot.compressed += (wire[0] & 0x0F) == MQTT_COMPRESS_LZ4;
+        tot.raw_bytes += len;
+        tot.wire_bytes += wire_len;
+        free(wire);
+    }
+    CHECK(ok && s_failures == before, "长度边界");
+
+    // 统计与逐条累加一致
+    mqtt_compress_stats_t st;
+    CHECK(mqtt_compress_get_stats(BENCH_TOPIC, &st) == ESP_OK, "统计");
+    CHECK(st.messages == tot.messages && st.compressed == tot.compressed && st.raw_bytes == tot.raw_bytes &&
+          st.wire_bytes == tot.wire_bytes,
+          "统计 %u/%u 条 %llu/%llu 字节，期望 %u/%u 条 %llu/%llu 字节", st.messages, st.compressed,
+          (unsigned long long)st.raw_bytes, (unsigned long long)st.wire_bytes, tot.messages, tot.compressed,
+          (unsigned long long)tot.raw_bytes, (unsigned long long)tot.wire_bytes);
+    free(raw);
+}
+
+static void _test_interop(void)
+{
+    printf("lz4 工具互通\n");
+    char text[1024];
+    size_t len = _interop_text(text, sizeof(text));
+
+    uint8_t wire[MQTT_COMPRESS_HDR_LEN + sizeof(s_interop_block)];
+    wire[0] = MQTT_COMPRESS_MAGIC | MQTT_COMPRESS_LZ4;
+    wire[1] = (uint8_t)len;
+    wire[2] = (uint8_t)(len >> 8);
+    wire[3] = (uint8_t)(len >> 16);
+    memcpy(wire + MQTT_COMPRESS_HDR_LEN, s_interop_block, sizeof(s_interop_block));
+
+    uint8_t dst[1024];
+    CHECK(_ref_decode(s_interop_block, sizeof(s_interop_block), dst, sizeof(dst)) == (long)len &&
+          memcmp(dst, text, len) == 0, "参考解码器");
+    CHECK(_stream(wire, sizeof(wire), (const uint8_t *)text, len, sizeof(wire), dst), "整段解压");
+    CHECK(_stream(wire, sizeof(wire), (const uint8_t *)text, len, 1, dst), "逐字节解压");
+    CHECK(_stream(wire, sizeof(wire), (const uint8_t *)text, len, 0, dst), "随机分片解压");
+}
+
+static void _test_errors(void)
+{
+    printf("错误路径\n");
+    uint8_t raw[2048];
+    _gen_text(raw, sizeof(raw));
+    uint8_t *wire;
+    size_t wire_len;
+    CHECK(mqtt_compress_pack(BENCH_TOPIC_OFF, raw, sizeof(raw), &wire, &wire_len) == ESP_ERR_NOT_FOUND,
+          "未开启压缩的主题");
+    CHECK(mqtt_compress_pack(BENCH_TOPIC, raw, sizeof(raw), &wire, &wire_len) == ESP_OK, "pack");
+
+    uint8_t dst[sizeof(raw)];
+    mqtt_decomp_t d;
+
+    // 截断：少喂最后一个字节
+    mqtt_decomp_begin(&d, dst, sizeof(dst));
+    CHECK(mqtt_decomp_feed(&d, wire, wire_len - 1) == ESP_OK && !mqtt_decomp_finish(&d), "截断的负载不应完成");
+
+    // 完整块之后又出现一个带字面量的序列头：输出已满但块未正常结束
+    uint8_t extra = 0x10;
+    mqtt_decomp_begin(&d, dst, sizeof(dst));
+    CHECK(mqtt_decomp_feed(&d, wire, wire_len) == ESP_OK && mqtt_decomp_finish(&d), "完整负载");
+    CHECK(mqtt_decomp_feed(&d, &extra, 1) == ESP_OK && !mqtt_decomp_finish(&d), "多余序列头不应完成");
+
+    // 目标缓冲区小于声明长度
+    mqtt_decomp_begin(&d, dst, sizeof(raw) - 1);
+    CHECK(mqtt_decomp_feed(&d, wire, wire_len) == ESP_ERR_INVALID_SIZE, "缓冲区不足");
+
+    // 未知方法与魔数
+    uint8_t *bad = malloc(wire_len + 1);
+    memcpy(bad, wire, wire_len);
+    bad[0] = MQTT_COMPRESS_MAGIC | 2;
+    mqtt_decomp_begin(&d, dst, sizeof(dst));
+    CHECK(mqtt_decomp_feed(&d, bad, wire_len) == ESP_ERR_INVALID_RESPONSE, "未知方法");
+    bad[0] = 0x7B;
+    mqtt_decomp_begin(&d, dst, sizeof(dst));
+    CHECK(mqtt_decomp_feed(&d, bad, wire_len) == ESP_ERR_INVALID_RESPONSE, "魔数");
+    size_t peek;
+    CHECK(mqtt_compress_peek(bad, wire_len, &peek) == ESP_ERR_INVALID_RESPONSE, "peek 魔数");
+
+    // 第一个序列的偏移改为 0（超出已输出范围）
+    memcpy(bad, wire, wire_len);
+    uint8_t *blk = bad + MQTT_COMPRESS_HDR_LEN;
+    size_t lit = blk[0] >> 4;
+    size_t p = 1;
+    if (lit == 15) {
+        while (blk[p] == 255) {
+            lit += blk[p++];
+        }
+        lit += blk[p++];
+    }
+    p += lit;
+    blk[p] = 0;
+    blk[p + 1] = 0;
+    mqtt_decomp_begin(&d, dst, sizeof(dst));
+    CHECK(mqtt_decomp_feed(&d, bad, wire_len) == ESP_ERR_INVALID_RESPONSE, "偏移为 0");
+
+    // 原样负载后多出字节
+    free(wire);
+    CHECK(mqtt_compress_pack(BENCH_TOPIC, raw, 16, &wire, &wire_len) == ESP_OK && (wire[0] & 0x0F) == 0, "pack 原样");
+    memcpy(bad, wire, wire_len);
+    bad[wire_len] = 0;
+    mqtt_decomp_begin(&d, dst, sizeof(dst));
+    CHECK(mqtt_decomp_feed(&d, bad, wire_len + 1) == ESP_ERR_INVALID_SIZE, "多余字节");
+    free(bad);
+    free(wire);
+}
+
+static void _bench(void)
+{
+    const size_t len = 16 * 1024;
+    uint8_t *raw = malloc(len);
+    uint8_t *dst = malloc(len);
+    _gen_text(raw, len);
+
+    uint8_t *wire = NULL;
+    size_t wire_len = 0;
+    uint64_t t0 = host_bench_now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        free(wire);
+        mqtt_compress_pack(BENCH_TOPIC, raw, len, &wire, &wire_len);
+    }
+    uint64_t pack_ns = host_bench_now_ns() - t0;
+
+    mqtt_decomp_t d;
+    t0 = host_bench_now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        mqtt_decomp_begin(&d, dst, len);
+        // 按 MQTT 分片的典型大小喂入
+        for (size_t pos = 0; pos < wire_len; pos += 1024) {
+            mqtt_decomp_feed(&d, wire + pos, wire_len - pos < 1024 ? wire_len - pos : 1024);
+        }
+    }
+    uint64_t unpack_ns = host_bench_now_ns() - t0;
+    CHECK(mqtt_decomp_finish(&d) && memcmp(dst, raw, len) == 0, "吞吐测量结果");
+
+    double mib = (double)len * BENCH_ROUNDS / (1024.0 * 1024.0);
+    printf("吞吐: %zu 字节文本 → %zu 字节  压缩 %.0f MiB/s  解压 %.0f MiB/s（1 KB 分片）\n", len, wire_len,
+           mib / (pack_ns * 1e-9), mib / (unpack_ns * 1e-9));
+    free(wire);
+    free(raw);
+    free(dst);
+}
+
+int main(void)
+{
+    ESP_ERROR_CHECK(mqtt_compress_init());
+    ESP_ERROR_CHECK(mqtt_compress_set_topic(BENCH_TOPIC, true));
+
+    _test_round_trip();
+    _test_interop();
+    _test_errors();
+    _bench();
+
+    printf("一致性: %s\n", s_failures == 0 ? "通过" : "失败");
+    return s_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+/*
+ * 振动特征测试：imu_features 在合成信号上的时域特征、主频，以及频带能量与参考 DFT 的一致性。
+ *
+ * 参考值按定义直接计算（O(N²) 双精度 DFT，窗函数与归一化独立实现），不经过 shim/esp_dsp_host.c，
+ * 因此同时验证 FFT 替身与 imu_features 的加窗、归一化和频点分带。信号为整周期音调、非整周期
+ * 音调与白噪声的组合，频带覆盖 0 ~ fs/2 时各频带能量之和应在 RMS² 的 1% 以内。
+ *
+ * 分批 push 的窗口切分与时间戳也一并检查；耗时使用主机 FFT 替身，仅供参考。
+ *
+ * 用法：features_test [窗口长度]
+ */
+#include "imu_features.h"
+#include "esp_dsp.h"
+#include "host_bench.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_WINDOW    512
+#define BENCH_RATE_HZ           1000.0f
+#define BENCH_WINDOWS           256
+#define BENCH_REF_WINDOWS       4           // 与参考 DFT 逐项比对的窗口数（O(N²)）
+#define BENCH_CHUNK             100         // 每次 push 的样本数，故意不整除窗口长度
+#define BENCH_TS0_US            5000000ULL
+#define BENCH_GRAVITY           9.81f
+#define BENCH_BAND_TOL          1e-3        // 频带能量与参考 DFT 的相对误差（相对 RMS²）
+#define BENCH_SUM_TOL           0.01        // 频带能量之和与 RMS² 的相对误差（确定性信号逐窗口，噪声取多窗口平均）
+#define BENCH_NOISE_WIN_TOL(n)  (3.0 / sqrt((double)(n)))    // 噪声单窗口的估计波动上限（约 ±1/√N 量级）
+
+static const float s_edges[] = {0.0f, 20.0f, 60.0f, 100.0f, 150.0f, 250.0f, 400.0f, 500.0f};
+#define BENCH_BANDS             (sizeof(s_edges) / sizeof(s_edges[0]) - 1)
+
+typedef struct {
+    imu_features_result_t results[BENCH_WINDOWS];
+    int count;
+} bench_ctx_t;
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...)                                                    \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  失败 %s:%d: %s  ", __FILE__, __LINE__, #cond);       \
+            printf(__VA_ARGS__);                                            \
+            printf("\n");                                                   \
+            s_failures++;                                                   \
+        }                                                                   \
+    } while (0)
+
+static uint32_t s_rng = 12345;
+
+static float _noise(void)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return (float)(s_rng >> 8) / (float)(1u << 24) - 0.5f;
+}
+
+/*
+ * 合成信号（按全局样本序号生成，各窗口连续）
+ *   X: 重力 + 1.0 × 125 Hz（整周期）
+ *   Y: 0.5 × 31.25 Hz + 0.2 × 312.5 Hz（整周期）
+ *   Z: 重力 + 0.4 × 77.7 Hz（非整周期，有泄漏）+ 白噪声
+ */
+static void _generate(float *x, float *y, float *z, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        double t = i / (double)BENCH_RATE_HZ;
+        x[i] = BENCH_GRAVITY + (float)sin(2.0 * M_PI * 125.0 * t);
+        y[i] = 0.5f * (float)sin(2.0 * M_PI * 31.25 * t) + 0.2f * (float)sin(2.0 * M_PI * 312.5 * t + 0.3);
+        z[i] = BENCH_GRAVITY + 0.4f * (float)sin(2.0 * M_PI * 77.7 * t) + 0.6f * _noise();
+    }
+}
+
+// 参考实现：去均值、对称 Hann 窗、双精度 DFT，单边谱按窗函数实际功率增益归一化
+static void _reference(const float *x, size_t n, double *rms, double *band, double *dominant_hz)
+{
+    double mean = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        mean += x[i];
+    }
+    mean /= n;
+
+    double sum_sq = 0.0, w_sq = 0.0;
+    double *v = malloc(n * sizeof(double));
+    for (size_t i = 0; i < n; i++) {
+        double w = 0.5 * (1.0 - cos(2.0 * M_PI * i / (n - 1)));
+        double d = x[i] - mean;
+        w_sq += w * w;
+        sum_sq += d * d;
+        v[i] = d * w;
+    }
+    *rms = sqrt(sum_sq / n);
+
+    memset(band, 0, BENCH_BANDS * sizeof(double));
+    double best = 0.0;
+    size_t best_k = 0;
+    for (size_t k = 1; k < n / 2; k++) {
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double a = -2.0 * M_PI * (double)((k * i) % n) / n;
+            re += v[i] * cos(a);
+            im += v[i] * sin(a);
+        }
+        double p = 2.0 * (re * re + im * im) / (n * w_sq);
+        if (p > best) {
+            best = p;
+            best_k = k;
+        }
+        double f = k * (double)BENCH_RATE_HZ / n;
+        for (size_t b = 0; b < BENCH_BANDS; b++) {
+            if (f >= s_edges[b] && f < s_edges[b + 1]) {
+                band[b] += p;
+                break;
+            }
+        }
+    }
+    *dominant_hz = best_k * (double)BENCH_RATE_HZ / n;
+    free(v);
+}
+
+static void _on_window(const imu_features_result_t *result, void *user_ctx)
+{
+    bench_ctx_t *ctx = user_ctx;
+    if (ctx->count < BENCH_WINDOWS) {
+        ctx->results[ctx->count] = *result;
+    }
+    ctx->count++;
+}
+
+// 返回该窗口的 频带能量和 / RMS²
+static double _check_axis(int w, const char *name, const imu_features_axis_t *got, const float *x, size_t n,
+                          float expect_rms, float expect_peak, float expect_hz, double sum_tol)
+{
+    double rms, band[BENCH_BANDS], dominant_hz;
+    _reference(x, n, &rms, band, &dominant_hz);
+    double rms_sq = rms * rms;
+
+    CHECK(fabs(got->rms - rms) <= 1e-4 * rms, "窗口 %d %s: rms %.6f 参考 %.6f", w, name, got->rms, rms);
+    CHECK(fabsf(got->crest - got->peak / got->rms) <= 1e-4f, "窗口 %d %s: crest %.4f", w, name, got->crest);
+    CHECK(got->dominant_hz == (float)dominant_hz, "窗口 %d %s: 主频 %.2f 参考 %.2f", w, name, got->dominant_hz,
+          dominant_hz);
+    if (expect_rms > 0.0f) {
+        CHECK(fabsf(got->rms - expect_rms) <= 0.01f * expect_rms, "窗口 %d %s: rms %.4f 理论 %.4f", w, name,
+              got->rms, expect_rms);
+    }
+    if (expect_peak > 0.0f) {
+        CHECK(fabsf(got->peak - expect_peak) <= 0.01f * expect_peak, "窗口 %d %s: peak %.4f 理论 %.4f", w, name,
+              got->peak, expect_peak);
+    }
+    if (expect_hz > 0.0f) {
+        CHECK(got->dominant_hz == expect_hz, "窗口 %d %s: 主频 %.2f 理论 %.2f", w, name, got->dominant_hz, expect_hz);
+    }
+
+    double sum = 0.0, max_err = 0.0;
+    for (size_t b = 0; b < BENCH_BANDS; b++) {
+        double err = fabs(got->band_energy[b] - band[b]) / rms_sq;
+        max_err = err > max_err ? err : max_err;
+        sum += got->band_energy[b];
+    }
+    CHECK(max_err <= BENCH_BAND_TOL, "窗口 %d %s: 频带能量最大相对误差 %.2e", w, name, max_err);
+    CHECK(fabs(sum - rms_sq) <= sum_tol * rms_sq, "窗口 %d %s: 频带能量和 %.6f RMS² %.6f", w, name, sum, rms_sq);
+
+    if (w == 0) {
+        printf("  %s: rms %.4f  peak %.4f  crest %.3f  主频 %6.2f Hz  频带和/RMS² %.4f  与参考最大误差 %.1e\n", name,
+               got->rms, got->peak, got->crest, got->dominant_hz, sum / rms_sq, max_err);
+    }
+    return sum / rms_sq;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long n = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_WINDOW;
+
+    imu_features_config_t cfg = {
+        .window_size = (uint16_t)n,
+        .sample_rate_hz = BENCH_RATE_HZ,
+        .num_bands = BENCH_BANDS,
+    };
+    memcpy(cfg.band_edges_hz, s_edges, sizeof(s_edges));
+
+    bench_ctx_t ctx = {0};
+    imu_features_handle_t h;
+    esp_err_t err = imu_features_create(&cfg, _on_window, &ctx, &h);
+    if (err != ESP_OK) {
+        fprintf(stderr, "imu_features_create 失败: %s（窗口长度需为 64 ~ %d 的 2 的幂）\n", esp_err_to_name(err),
+                CONFIG_DSP_MAX_FFT_SIZE);
+        return 2;
+    }
+
+    // 非法配置：频带边界不递增
+    imu_features_config_t bad = cfg;
+    imu_features_handle_t h_bad;
+    bad.band_edges_hz[2] = bad.band_edges_hz[1];
+    CHECK(imu_features_create(&bad, NULL, NULL, &h_bad) == ESP_ERR_INVALID_ARG, "非递增频带边界未被拒绝");
+
+    size_t total = n * BENCH_WINDOWS + n / 2;      // 末尾半个窗口不应触发回调
+    float *x = malloc(total * sizeof(float));
+    float *y = malloc(total * sizeof(float));
+    float *z = malloc(total * sizeof(float));
+    _generate(x, y, z, total);
+
+    const uint32_t period_us = (uint32_t)(1000000.0f / BENCH_RATE_HZ);
+    uint64_t elapsed_ns = 0;
+    for (size_t done = 0; done < total; done += BENCH_CHUNK) {
+        size_t chunk = total - done < BENCH_CHUNK ? total - done : BENCH_CHUNK;
+        uint64_t t0 = host_bench_now_ns();
+        CHECK(imu_features_push(h, x + done, y + done, z + done, chunk, BENCH_TS0_US + done * period_us) == ESP_OK,
+              "push 失败");
+        elapsed_ns += host_bench_now_ns() - t0;
+    }
+
+    printf("窗口 %lu 点 @ %.0f Hz，%u 个频带，分 %u 样本一批输入\n", n, BENCH_RATE_HZ, (unsigned)BENCH_BANDS,
+           BENCH_CHUNK);
+    CHECK(ctx.count == BENCH_WINDOWS, "回调 %d 次", ctx.count);
+
+    double noise_ratio = 0.0, noise_min = 1e9, noise_max = 0.0;
+    for (int w = 0; w < ctx.count && w < BENCH_WINDOWS; w++) {
+        const imu_features_result_t *r = &ctx.results[w];
+        size_t off = (size_t)w * n;
+        CHECK(r->start_ts_us == BENCH_TS0_US + off * period_us, "窗口 %d 时间戳 %llu", w,
+              (unsigned long long)r->start_ts_us);
+        CHECK(r->window_size == n && r->num_bands == BENCH_BANDS, "窗口 %d 头部", w);
+
+        if (w >= BENCH_REF_WINDOWS) {
+            double sum = 0.0;
+            for (size_t b = 0; b < BENCH_BANDS; b++) {
+                sum += r->axis[2].band_energy[b];
+            }
+            double ratio = sum / ((double)r->axis[2].rms * r->axis[2].rms);
+            noise_ratio += ratio;
+            noise_min = ratio < noise_min ? ratio : noise_min;
+            noise_max = ratio > noise_max ? ratio : noise_max;
+            continue;
+        }
+
+        // 31.25/125/312.5 Hz 在 n ≥ 64 时都落在频点上；峰值只对 X 轴单音调有解析值
+        _check_axis(w, "X", &r->axis[0], x + off, n, (float)M_SQRT1_2, 1.0f, 125.0f, BENCH_SUM_TOL);
+        _check_axis(w, "Y", &r->axis[1], y + off, n, sqrtf(0.5f * 0.25f + 0.5f * 0.04f), 0.0f, 31.25f,
+                    BENCH_SUM_TOL);
+        // 宽带噪声经 Hann 窗加权后单窗口的能量估计有随机波动，逐窗口只做宽松检查
+        double ratio = _check_axis(w, "Z", &r->axis[2], z + off, n, 0.0f, 0.0f, 0.0f, BENCH_NOISE_WIN_TOL(n));
+        noise_ratio += ratio;
+        noise_min = ratio < noise_min ? ratio : noise_min;
+        noise_max = ratio > noise_max ? ratio : noise_max;
+    }
+    noise_ratio /= BENCH_WINDOWS;
+    printf("  Z 频带和/RMS²: %d 窗口平均 %.4f（单窗口 %.3f ~ %.3f）\n", BENCH_WINDOWS, noise_ratio, noise_min,
+           noise_max);
+    CHECK(fabs(noise_ratio - 1.0) <= BENCH_SUM_TOL, "Z 多窗口平均 %.4f", noise_ratio);
+
+    printf("耗时: %.1f us/窗口（三轴，主机 FFT 替身）\n", elapsed_ns * 1e-3 / BENCH_WINDOWS);
+    printf("一致性: %s\n", s_failures == 0 ? "通过" : "失败");
+
+    imu_features_delete(h);
+    free(x);
+    free(y);
+    free(z);
+    return s_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#ifndef __HOST_BENCH_H__
+#define __HOST_BENCH_H__
+
+#include <stdint.h>
+#include <time.h>
+
+// 单调时钟（纳秒），用于主机基准计时
+static inline uint64_t host_bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#endif /* __HOST_BENCH_H__ */
@@ -0,0 +1,107 @@
+/*
+ * 离线日志写入基准：在 RAM 模拟的 NOR Flash 分区（shim/esp_partition_host.c）上运行
+ * offline_log，统计批量写入次数、擦除次数、每次写入的字节数与写入吞吐。
+ *
+ * MQTT 始终视为断开，日志任务只写入不回放。队列满（ESP_ERR_NO_MEM）时短暂等待后重试，
+ * 与发件箱溢出时的调用方式相同。
+ *
+ * 用法：offline_log_bench [记录数] [负载字节数]
+ */
+#include "offline_log.h"
+#include "offline_log_config.h"
+#include "mqtt_app.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_RECORDS   20000
+#define BENCH_DEFAULT_PAYLOAD   200
+#define BENCH_PARTITION_SIZE    (1024 * 1024)       // 与 partitions-16MiB.csv 中 tlog 分区相同
+#define BENCH_TOPIC             "esp32s3/mpu6050/batch"
+
+// offline_log.c 的外部依赖：始终断开，不触发回放
+bool mqtt_app_is_connected(void)
+{
+    return false;
+}
+
+esp_err_t mqtt_app_publish(const char *topic, const void *data, size_t len, int qos)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+void mqtt_app_get_outbox_stats(mqtt_outbox_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+int main(int argc, char **argv)
+{
+    size_t records = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_RECORDS;
+    size_t payload = argc > 2 ? strtoul(argv[2], NULL, 10) : BENCH_DEFAULT_PAYLOAD;
+
+    ESP_ERROR_CHECK(esp_partition_host_create(OFFLINE_LOG_PARTITION, BENCH_PARTITION_SIZE));
+    ESP_ERROR_CHECK(offline_log_init());
+
+    uint8_t *data = malloc(payload);
+    if (data == NULL) {
+        perror("malloc");
+        return 1;
+    }
+    for (size_t i = 0; i < payload; i++) {
+        data[i] = (uint8_t)i;
+    }
+
+    // 挂载时的扫描读不计入
+    esp_partition_host_stats_t ps0;
+    esp_partition_host_get_stats(&ps0);
+
+    uint64_t retries = 0, append_ns = 0, append_max_ns = 0;
+    uint64_t start = host_bench_now_ns();
+    for (size_t i = 0; i < records; i++) {
+        esp_err_t err;
+        for (;;) {
+            uint64_t t0 = host_bench_now_ns();
+            err = offline_log_append(BENCH_TOPIC, data, payload, 1);
+            uint64_t dt = host_bench_now_ns() - t0;
+            append_ns += dt;
+            append_max_ns = dt > append_max_ns ? dt : append_max_ns;
+            if (err != ESP_ERR_NO_MEM) {
+                break;
+            }
+            retries++;
+            vTaskDelay(1);
+        }
+        ESP_ERROR_CHECK(err);
+    }
+    ESP_ERROR_CHECK(offline_log_flush());
+    double elapsed_s = (host_bench_now_ns() - start) * 1e-9;
+
+    offline_log_stats_t st;
+    offline_log_get_stats(&st);
+    esp_partition_host_stats_t ps;
+    esp_partition_host_get_stats(&ps);
+    uint32_t writes = ps.writes - ps0.writes;
+    uint64_t bytes = ps.bytes_written - ps0.bytes_written;
+
+    printf("%zu 条 × %zu 字节负载，分区 %u KiB（%u 扇区）\n", records, payload,
+           BENCH_PARTITION_SIZE / 1024, st.sectors);
+    printf("offline_log: 写入 %u 条  批量写 %u 次（平均 %.0f 字节）  擦除 %u 次  覆盖丢弃 %u 条  未回放 %u 条\n",
+           st.appended, st.flushes, (double)st.bytes_written / st.flushes, st.erases, st.dropped, st.pending);
+    printf("Flash 模拟:  write %u 次（含扇区头/状态）  平均 %.0f 字节/次  erase %u 次  %.1f 条/擦除  NOR 违例 %u\n",
+           writes, (double)bytes / writes, ps.erases, (double)st.appended / ps.erases, ps.nor_violations);
+    // 墙钟时间含队列满时的 vTaskDelay(1)，主机上是吞吐上限的主要来源
+    printf("吞吐:        %.3f s  %.0f 条/s  %.2f MiB/s\n", elapsed_s, records / elapsed_s,
+           bytes / elapsed_s / (1024.0 * 1024.0));
+    printf("append:      平均 %.0f ns  最大 %.1f us  队列满重试 %llu 次\n", (double)append_ns / (records + retries),
+           append_max_ns * 1e-3, (unsigned long long)retries);
+
+    bool ok = st.appended == records && st.pending + st.dropped == records && ps.nor_violations == 0;
+    printf("一致性: %s\n", ok ? "通过" : "失败");
+    free(data);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,405 @@
+/*
+ * 发件箱测试：mqtt_outbox 在模拟发送函数与虚拟时钟下的调度行为
+ *
+ *   - 优先级类：断线期间交错入队，重连后按 控制 → 普通 → 批量 发送，类内保持顺序；
+ *   - QoS 窗口：非控制类最多占用 INFLIGHT - INFLIGHT_RESERVE，余下留给控制类；
+ *   - 令牌桶：突发量、按虚拟时间补充、超过突发量的单条消息透支，限速类不阻塞其他类；
+ *   - 溢出与重连：缓冲区满时最旧的消息按顺序转存，发送失败重试、断线重连后从断点继续，
+ *     转存与发送的序号首尾相接，无重复无遗漏；
+ *   - 确认先于发送返回：PUBLISHED 在 s_send 返回前到达时不占用 QoS 窗口。
+ *
+ * esp_timer_get_time 由本程序提供（-DHOST_MOCK_CLOCK=1），只在测试推进时前进；发送任务的
+ * 超时仍是真实时间，推进时钟后用 mqtt_outbox_on_published(0) 唤醒发送任务。
+ *
+ * 用法：outbox_test
+ */
+#include "mqtt_outbox.h"
+#include "mqtt_app_config.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_LOG_MAX           512
+#define BENCH_PAYLOAD_MAX       1024
+#define BENCH_WAIT_MS           3000        // 等待发送的真实时间上限
+#define BENCH_SETTLE_MS         50          // 确认不再发送的观察时间
+#define BENCH_CLOCK_START_US    1000000LL
+
+#define TOPIC_CTRL              "test/ctrl"
+#define TOPIC_NORM              "test/norm"
+#define TOPIC_BULK              "test/bulk"
+#define TOPIC_RATE              "test/rate"
+
+#define BENCH_RATE_BPS          1000
+#define BENCH_BURST             500
+
+typedef struct {
+    char topic[MQTT_APP_TOPIC_MAX_LEN];
+    uint32_t seq;
+    size_t len;
+    int qos;
+    int msg_id;
+} sent_t;
+
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sent_t s_log[BENCH_LOG_MAX];
+static int s_log_count = 0;
+static int s_acked = 0;                 // s_log 中已确认到的位置
+static int s_next_msg_id = 0;
+static int s_fail_sends = 0;            // 接下来发送失败的次数
+static bool s_ack_in_send = false;      // 在发送函数返回前确认（模拟 PUBLISHED 先到）
+static uint32_t s_spilled[BENCH_LOG_MAX];
+static int s_spill_count = 0;
+static int64_t s_now_us = BENCH_CLOCK_START_US;
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...)                                                    \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  失败 %s:%d: %s  ", __FILE__, __LINE__, #cond);       \
+            printf(__VA_ARGS__);                                            \
+            printf("\n");                                                   \
+            s_failures++;                                                   \
+        }                                                                   \
+    } while (0)
+
+int64_t esp_timer_get_time(void)
+{
+    return __atomic_load_n(&s_now_us, __ATOMIC_SEQ_CST);
+}
+
+// 推进虚拟时钟并唤醒发送任务（msg_id 0 不对应任何消息）
+static void _advance_ms(int64_t ms)
+{
+    __atomic_add_fetch(&s_now_us, ms * 1000, __ATOMIC_SEQ_CST);
+    mqtt_outbox_on_published(0);
+}
+
+static int _mock_send(const char *topic, const uint8_t *data, size_t len, int qos, void *ctx)
+{
+    (void)ctx;
+    pthread_mutex_lock(&s_mutex);
+    if (s_fail_sends > 0) {
+        s_fail_sends--;
+        pthread_mutex_unlock(&s_mutex);
+        return -1;
+    }
+    int msg_id = qos > 0 ? ++s_next_msg_id : 0;
+    if (s_log_count < BENCH_LOG_MAX) {
+        sent_t *e = &s_log[s_log_count];
+        strlcpy(e->topic, topic, sizeof(e->topic));
+        memcpy(&e->seq, data, sizeof(e->seq));
+        e->len = len;
+        e->qos = qos;
+        e->msg_id = msg_id;
+    }
+    s_log_count++;
+    bool ack_now = s_ack_in_send && msg_id > 0;
+    if (ack_now) {
+        s_acked = s_log_count;
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    if (ack_now) {
+        mqtt_outbox_on_published(msg_id);
+    }
+    return msg_id;
+}
+
+static esp_err_t _mock_spill(const char *topic, const uint8_t *data, size_t len, int qos)
+{
+    (void)topic;
+    (void)len;
+    (void)qos;
+    // 在发件箱锁内调用，入队的测试线程此时持有该锁，无需另加锁
+    if (s_spill_count < BENCH_LOG_MAX) {
+        memcpy(&s_spilled[s_spill_count], data, sizeof(uint32_t));
+    }
+    s_spill_count++;
+    return ESP_OK;
+}
+
+static void _enqueue(const char *topic, uint32_t seq, size_t len, int qos)
+{
+    uint8_t buf[BENCH_PAYLOAD_MAX];
+    memset(buf, 0xA5, len);
+    memcpy(buf, &seq, sizeof(seq));
+    esp_err_t err = mqtt_outbox_enqueue(topic, buf, len, qos);
+    CHECK(err == ESP_OK, "入队 %s #%u: %s", topic, seq, esp_err_to_name(err));
+}
+
+static int _sent(void)
+{
+    pthread_mutex_lock(&s_mutex);
+    int n = s_log_count;
+    pthread_mutex_unlock(&s_mutex);
+    return n;
+}
+
+static bool _wait_sent(int n)
+{
+    for (int i = 0; i < BENCH_WAIT_MS; i++) {
+        if (_sent() >= n) {
+            return true;
+        }
+        vTaskDelay(1);
+    }
+    return false;
+}
+
+// 观察一段时间，返回期间结束时的发送数（用于确认没有多发）
+static int _settle(void)
+{
+    vTaskDelay(pdMS_TO_TICKS(BENCH_SETTLE_MS));
+    return _sent();
+}
+
+// 确认所有已发送的 QoS1/2 消息
+static void _ack_all(void)
+{
+    pthread_mutex_lock(&s_mutex);
+    int end = s_log_count;
+    pthread_mutex_unlock(&s_mutex);
+    for (; s_acked < end; s_acked++) {
+        if (s_log[s_acked].msg_id > 0) {
+            mqtt_outbox_on_published(s_log[s_acked].msg_id);
+        }
+    }
+}
+
+// 检查 s_log[from, from + n) 为同一主题、序号从 first 连续递增
+static bool _expect_run(int from, int n, const char *topic, uint32_t first)
+{
+    for (int i = 0; i < n; i++) {
+        const sent_t *e = &s_log[from + i];
+        if (strcmp(e->topic, topic) != 0 || e->seq != first + i) {
+            printf("  第 %d 条: 期望 %s #%u，实际 %s #%u\n", from + i, topic, first + i, e->topic, e->seq);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void _test_class_order(void)
+{
+    printf("优先级类顺序\n");
+    mqtt_outbox_on_disconnected();
+    int base = _sent();
+
+    // 断线期间交错入队：批量、普通、控制各 10 条
+    static const char *topics[] = {TOPIC_BULK, TOPIC_NORM, TOPIC_CTRL};
+    for (uint32_t i = 0; i < 30; i++) {
+        _enqueue(topics[i % 3], 100 + i / 3, 32, 0);
+    }
+    CHECK(_settle() == base, "断线时不应发送");
+
+    mqtt_outbox_on_connected();
+    CHECK(_wait_sent(base + 30), "已发送 %d/30", _sent() - base);
+    CHECK(_settle() == base + 30, "多发 %d 条", _sent() - base - 30);
+    CHECK(_expect_run(base, 10, TOPIC_CTRL, 100), "控制类应最先发送");
+    CHECK(_expect_run(base + 10, 10, TOPIC_NORM, 100), "普通类其次");
+    CHECK(_expect_run(base + 20, 10, TOPIC_BULK, 100), "批量类最后");
+}
+
+static void _test_qos_window(void)
+{
+    printf("QoS 窗口预留\n");
+    const int normal_limit = MQTT_APP_OUTBOX_INFLIGHT - MQTT_APP_OUTBOX_INFLIGHT_RESERVE;
+    mqtt_outbox_on_disconnected();
+    _ack_all();
+    int base = _sent();
+
+    for (uint32_t i = 0; i < 10; i++) {
+        _enqueue(TOPIC_NORM, 200 + i, 64, 1);
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+        _enqueue(TOPIC_CTRL, 200 + i, 64, 1);
+    }
+    mqtt_outbox_on_connected();
+
+    // 控制类 3 条 + 普通类补足到非控制类上限
+    CHECK(_wait_sent(base + normal_limit), "已发送 %d", _sent() - base);
+    CHECK(_settle() == base + normal_limit, "未确认时应停在 %d 条，实际 %d", normal_limit, _sent() - base);
+    CHECK(_expect_run(base, 3, TOPIC_CTRL, 200), "控制类先发");
+    CHECK(_expect_run(base + 3, normal_limit - 3, TOPIC_NORM, 200), "普通类按序");
+
+    // 普通类被窗口卡住时，控制类仍可使用预留部分
+    _enqueue(TOPIC_CTRL, 203, 64, 1);
+    CHECK(_wait_sent(base + normal_limit + 1), "控制类未使用预留窗口");
+    CHECK(_expect_run(base + normal_limit, 1, TOPIC_CTRL, 203), "预留窗口应给控制类");
+    mqtt_outbox_stats_t st;
+    mqtt_outbox_get_stats(&st);
+    CHECK(st.inflight == (uint32_t)normal_limit + 1, "inflight %u", st.inflight);
+
+    // 逐步确认，普通类剩余消息按序发出
+    const int total = 14;
+    for (int i = 0; i < BENCH_WAIT_MS && _sent() < base + total; i++) {
+        _ack_all();
+        vTaskDelay(1);
+    }
+    CHECK(_settle() == base + total, "已发送 %d/%d", _sent() - base, total);
+    CHECK(_expect_run(base + normal_limit + 1, total - normal_limit - 1, TOPIC_NORM, 200 + normal_limit - 3),
+          "确认后普通类继续按序发送");
+    _ack_all();
+    vTaskDelay(pdMS_TO_TICKS(BENCH_SETTLE_MS));
+    mqtt_outbox_get_stats(&st);
+    CHECK(st.inflight == 0, "全部确认后 inflight %u", st.inflight);
+}
+
+static void _test_token_bucket(void)
+{
+    printf("令牌桶限速（%d B/s，突发 %d 字节）\n", BENCH_RATE_BPS, BENCH_BURST);
+    CHECK(mqtt_outbox_set_topic_class(TOPIC_RATE, MQTT_OUTBOX_PRIO_NORMAL, BENCH_RATE_BPS, BENCH_BURST) == ESP_OK,
+          "设置限速");
+    int base = _sent();
+
+    // 突发量内的 5 条立即发送，之后虚拟时间不动就不再发送
+    for (uint32_t i = 0; i < 10; i++) {
+        _enqueue(TOPIC_RATE, 300 + i, 100, 0);
+    }
+    CHECK(_wait_sent(base + 5), "突发已发送 %d", _sent() - base);
+    CHECK(_settle() == base + 5, "突发后应停止，实际 %d", _sent() - base);
+
+    // 限速的普通类不阻塞批量类
+    _enqueue(TOPIC_BULK, 300, 100, 0);
+    CHECK(_wait_sent(base + 6), "批量类被限速类阻塞");
+    CHECK(_expect_run(base + 5, 1, TOPIC_BULK, 300), "批量类应越过限速中的普通类");
+
+    // 100 ms 补充 100 字节（1 条），再 250 ms 补充 250 字节（2 条，余 50）
+    _advance_ms(100);
+    CHECK(_wait_sent(base + 7) && _settle() == base + 7, "100 ms 后应再发 1 条，实际共 %d", _sent() - base);
+    _advance_ms(250);
+    CHECK(_wait_sent(base + 9) && _settle() == base + 9, "250 ms 后应再发 2 条，实际共 %d", _sent() - base);
+    _advance_ms(1000);
+    CHECK(_wait_sent(base + 11) && _settle() == base + 11, "剩余 2 条，实际共 %d", _sent() - base);
+    CHECK(_expect_run(base, 5, TOPIC_RATE, 300) && _expect_run(base + 6, 5, TOPIC_RATE, 305), "限速类按序");
+
+    // 超过突发量的单条消息在桶满时发出并透支，下一条需等令牌回到 100 字节
+    _advance_ms(1000);
+    _enqueue(TOPIC_RATE, 310, 800, 0);
+    CHECK(_wait_sent(base + 12), "桶满时超长消息未发出");
+    _enqueue(TOPIC_RATE, 311, 100, 0);
+    _advance_ms(300);
+    CHECK(_settle() == base + 12, "透支 300 字节时 300 ms 后仍应等待");
+    _advance_ms(100);
+    CHECK(_wait_sent(base + 13), "透支恢复后未发送");
+    CHECK(_expect_run(base + 11, 2, TOPIC_RATE, 310), "透支后顺序");
+
+    mqtt_outbox_set_topic_class(TOPIC_RATE, MQTT_OUTBOX_PRIO_NORMAL, 0, 0);
+}
+
+static void _test_overflow_reconnect(void)
+{
+    printf("溢出转存与断线重连\n");
+    const uint32_t count = 100;
+    const uint32_t first = 1000;
+    mqtt_outbox_on_disconnected();
+    _ack_all();
+    mqtt_outbox_set_spill_handler(_mock_spill);
+    mqtt_outbox_stats_t st0, st;
+    mqtt_outbox_get_stats(&st0);
+    int base = _sent();
+
+    // 批量类缓冲区约可容纳 60 条 1000 字节消息，其余最旧的转存
+    for (uint32_t i = 0; i < count; i++) {
+        _enqueue(TOPIC_BULK, first + i, 1000, 1);
+    }
+    mqtt_outbox_get_stats(&st);
+    int spilled = s_spill_count;
+    CHECK(spilled > 0 && st.spilled - st0.spilled == (uint32_t)spilled, "转存 %d 条，统计 %u", spilled,
+          st.spilled - st0.spilled);
+    CHECK(st.dropped == st0.dropped, "不应丢弃");
+    CHECK(st.classes[MQTT_OUTBOX_PRIO_BULK].queued == count - spilled, "排队 %u",
+          st.classes[MQTT_OUTBOX_PRIO_BULK].queued);
+    bool spill_order = true;
+    for (int i = 0; i < spilled && i < BENCH_LOG_MAX; i++) {
+        spill_order &= s_spilled[i] == first + i;
+    }
+    CHECK(spill_order, "转存应为最旧的消息且按序");
+
+    // 重连后第一次发送失败，重试后发满窗口
+    const int limit = MQTT_APP_OUTBOX_INFLIGHT - MQTT_APP_OUTBOX_INFLIGHT_RESERVE;
+    pthread_mutex_lock(&s_mutex);
+    s_fail_sends = 1;
+    pthread_mutex_unlock(&s_mutex);
+    mqtt_outbox_on_connected();
+    CHECK(_wait_sent(base + limit), "重连后已发送 %d", _sent() - base);
+    CHECK(_settle() == base + limit, "窗口满后应停止，实际 %d", _sent() - base);
+
+    // 未确认时断线：客户端负责重发已发出的消息，发件箱从断点继续
+    mqtt_outbox_on_disconnected();
+    mqtt_outbox_on_connected();
+    CHECK(_wait_sent(base + 2 * limit), "第二次重连后已发送 %d", _sent() - base);
+
+    const int remaining = (int)count - spilled;
+    for (int i = 0; i < BENCH_WAIT_MS && _sent() < base + remaining; i++) {
+        _ack_all();
+        vTaskDelay(1);
+    }
+    CHECK(_settle() == base + remaining, "已发送 %d/%d", _sent() - base, remaining);
+    CHECK(_expect_run(base, remaining, TOPIC_BULK, first + spilled), "转存与发送序号应首尾相接");
+    _ack_all();
+
+    mqtt_outbox_get_stats(&st);
+    CHECK(st.send_failures - st0.send_failures == 1, "发送失败 %u 次", st.send_failures - st0.send_failures);
+    CHECK(st.queued == 0, "仍有 %u 条排队", st.queued);
+    mqtt_outbox_set_spill_handler(NULL);
+}
+
+static void _test_early_ack(void)
+{
+    printf("确认先于发送返回\n");
+    const int count = 4 * MQTT_APP_OUTBOX_INFLIGHT;
+    mqtt_outbox_on_disconnected();
+    _ack_all();
+    int base = _sent();
+
+    for (int i = 0; i < count; i++) {
+        _enqueue(TOPIC_NORM, 2000 + i, 64, 1);
+    }
+    pthread_mutex_lock(&s_mutex);
+    s_ack_in_send = true;
+    pthread_mutex_unlock(&s_mutex);
+    mqtt_outbox_on_connected();
+
+    // 不再另行确认：窗口若泄漏，发送会停在非控制类上限
+    CHECK(_wait_sent(base + count), "已发送 %d/%d", _sent() - base, count);
+    CHECK(_expect_run(base, count, TOPIC_NORM, 2000), "顺序");
+    mqtt_outbox_stats_t st;
+    mqtt_outbox_get_stats(&st);
+    CHECK(st.inflight == 0, "inflight %u", st.inflight);
+
+    pthread_mutex_lock(&s_mutex);
+    s_ack_in_send = false;
+    pthread_mutex_unlock(&s_mutex);
+}
+
+int main(void)
+{
+    ESP_ERROR_CHECK(mqtt_outbox_init(_mock_send, NULL));
+    ESP_ERROR_CHECK(mqtt_outbox_set_topic_class(TOPIC_CTRL, MQTT_OUTBOX_PRIO_CONTROL, 0, 0));
+    ESP_ERROR_CHECK(mqtt_outbox_set_topic_class(TOPIC_BULK, MQTT_OUTBOX_PRIO_BULK, 0, 0));
+
+    _test_class_order();
+    _test_qos_window();
+    _test_token_bucket();
+    _test_overflow_reconnect();
+    _test_early_ack();
+
+    mqtt_outbox_stats_t st;
+    mqtt_outbox_get_stats(&st);
+    static const char *names[] = {"控制", "普通", "批量"};
+    printf("发件箱: 入队 %u  发送 %u  转存 %u  丢弃 %u  发送失败 %u  峰值 %.1f KB\n", st.enqueued, st.sent,
+           st.spilled, st.dropped, st.send_failures, st.high_water_bytes / 1024.0);
+    for (int i = 0; i < MQTT_OUTBOX_PRIO_MAX; i++) {
+        printf("  %s: 发送 %u  平均延迟 %u ms  最大 %u ms（虚拟时间）\n", names[i], st.classes[i].sent,
+               st.classes[i].avg_delay_ms, st.classes[i].max_delay_ms);
+    }
+    printf("一致性: %s\n", s_failures == 0 ? "通过" : "失败");
+    return s_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#ifndef __HOST_SHIM_ESP_DSP_H__
+#define __HOST_SHIM_ESP_DSP_H__
+
+// 主机构建用：esp-dsp 中 imu_features 用到的 FFT 与窗函数，由 esp_dsp_host.c 以可移植 C 实现。
+// 与 esp-dsp 相同：dsps_fft2r_fc32 输入为自然顺序的交错复数，输出为位反转顺序，需再调用 dsps_bit_rev_fc32。
+
+#include "esp_err.h"
+
+#ifndef CONFIG_DSP_MAX_FFT_SIZE
+#define CONFIG_DSP_MAX_FFT_SIZE     4096
+#endif
+
+esp_err_t dsps_fft2r_init_fc32(float *fft_table_buff, int table_size);
+void dsps_fft2r_deinit_fc32(void);
+esp_err_t dsps_fft2r_fc32(float *data, int N);
+esp_err_t dsps_bit_rev_fc32(float *data, int N);
+void dsps_wind_hann_f32(float *window, int len);
+
+#endif /* __HOST_SHIM_ESP_DSP_H__ */
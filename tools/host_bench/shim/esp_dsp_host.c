@@ -0,0 +1,104 @@
+// 主机构建用：基 2 复数 FFT（频域抽取，输出位反转）与 Hann 窗
+
+#include "esp_dsp.h"
+#include <math.h>
+#include <stdlib.h>
+
+static float *s_w = NULL;       // 旋转因子 exp(-j2πk/N)，k < N/2，交错复数
+static int s_size = 0;
+
+static int _is_pow2(int n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+esp_err_t dsps_fft2r_init_fc32(float *fft_table_buff, int table_size)
+{
+    (void)fft_table_buff;
+    if (!_is_pow2(table_size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 与 esp-dsp 一致：已初始化时直接返回
+    if (s_w != NULL) {
+        return ESP_OK;
+    }
+    s_w = malloc(table_size * sizeof(float));
+    if (s_w == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int k = 0; k < table_size / 2; k++) {
+        double a = -2.0 * M_PI * k / table_size;
+        s_w[k * 2] = (float)cos(a);
+        s_w[k * 2 + 1] = (float)sin(a);
+    }
+    s_size = table_size;
+    return ESP_OK;
+}
+
+void dsps_fft2r_deinit_fc32(void)
+{
+    free(s_w);
+    s_w = NULL;
+    s_size = 0;
+}
+
+esp_err_t dsps_fft2r_fc32(float *data, int N)
+{
+    if (s_w == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!_is_pow2(N) || N > s_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int len = N; len >= 2; len >>= 1) {
+        int half = len / 2;
+        int stride = s_size / len;
+        for (int k = 0; k < half; k++) {
+            float wr = s_w[k * stride * 2];
+            float wi = s_w[k * stride * 2 + 1];
+            for (int a = k; a < N; a += len) {
+                int b = a + half;
+                float ur = data[a * 2], ui = data[a * 2 + 1];
+                float vr = data[b * 2], vi = data[b * 2 + 1];
+                data[a * 2] = ur + vr;
+                data[a * 2 + 1] = ui + vi;
+                float tr = ur - vr, ti = ui - vi;
+                data[b * 2] = tr * wr - ti * wi;
+                data[b * 2 + 1] = tr * wi + ti * wr;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t dsps_bit_rev_fc32(float *data, int N)
+{
+    if (!_is_pow2(N)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 1, j = 0; i < N; i++) {
+        int bit = N >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float re = data[i * 2], im = data[i * 2 + 1];
+            data[i * 2] = data[j * 2];
+            data[i * 2 + 1] = data[j * 2 + 1];
+            data[j * 2] = re;
+            data[j * 2 + 1] = im;
+        }
+    }
+    return ESP_OK;
+}
+
+// 与 esp-dsp 相同的对称 Hann 窗：w[i] = 0.5 (1 - cos(2πi / (len - 1)))
+void dsps_wind_hann_f32(float *window, int len)
+{
+    float inv_size = 1.0f / (float)(len - 1);
+    for (int i = 0; i < len; i++) {
+        window[i] = 0.5f * (1.0f - cosf(i * 2.0f * (float)M_PI * inv_size));
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef __HOST_SHIM_ESP_EVENT_H__
+#define __HOST_SHIM_ESP_EVENT_H__
+
+// 主机构建用：事件回调类型（主机上没有默认事件循环，事件由调用方直接回调）
+
+#include <stdint.h>
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *handler_arg, esp_event_base_t base, int32_t event_id, void *event_data);
+
+#define ESP_EVENT_ANY_ID    -1
+
+#endif /* __HOST_SHIM_ESP_EVENT_H__ */
@@ -0,0 +1,57 @@
+#ifndef __HOST_SHIM_ESP_HEAP_CAPS_H__
+#define __HOST_SHIM_ESP_HEAP_CAPS_H__
+
+// 主机构建用：所有内存能力都落到 libc 堆
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_DEFAULT          (1 << 0)
+#define MALLOC_CAP_INTERNAL         (1 << 1)
+#define MALLOC_CAP_SPIRAM           (1 << 2)
+#define MALLOC_CAP_DMA              (1 << 3)
+#define MALLOC_CAP_8BIT             (1 << 4)
+
+static inline void *heap_caps_malloc(size_t size, unsigned caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void *heap_caps_calloc(size_t n, size_t size, unsigned caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+static inline void *heap_caps_aligned_alloc(size_t alignment, size_t size, unsigned caps)
+{
+    (void)caps;
+    // aligned_alloc 要求 size 为 alignment 的整数倍
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static inline void *heap_caps_realloc(void *ptr, size_t size, unsigned caps)
+{
+    (void)caps;
+    return realloc(ptr, size);
+}
+
+static inline void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+// 主机上不按能力统计堆，空闲量返回 0
+static inline size_t heap_caps_get_free_size(unsigned caps)
+{
+    (void)caps;
+    return 0;
+}
+
+static inline size_t heap_caps_get_minimum_free_size(unsigned caps)
+{
+    (void)caps;
+    return 0;
+}
+
+#endif /* __HOST_SHIM_ESP_HEAP_CAPS_H__ */
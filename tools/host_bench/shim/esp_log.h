@@ -0,0 +1,14 @@
+#ifndef __HOST_SHIM_ESP_LOG_H__
+#define __HOST_SHIM_ESP_LOG_H__
+
+// 主机构建用：E/W/I 输出到 stderr，D/V 丢弃（不干扰基准结果的 stdout）
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...)     fprintf(stderr, "E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)     fprintf(stderr, "W (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)     fprintf(stderr, "I (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...)     do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, fmt, ...)     do { (void)(tag); } while (0)
+
+#endif /* __HOST_SHIM_ESP_LOG_H__ */
@@ -0,0 +1,52 @@
+#ifndef __HOST_SHIM_ESP_PARTITION_H__
+#define __HOST_SHIM_ESP_PARTITION_H__
+
+// 主机构建用：RAM 中的 NOR Flash 分区（擦除置 1，写入只能把 1 变成 0），由 esp_partition_host.c 实现
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    uint32_t erase_size;
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label);
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size);
+
+/**
+ * @brief 模拟分区的操作计数（主机专用）
+ */
+typedef struct {
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t erases;            // 按扇区计
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint32_t nor_violations;    // 试图把 0 写成 1 的次数（真实 Flash 上会静默失败）
+} esp_partition_host_stats_t;
+
+/**
+ * @brief 创建模拟分区（在 esp_partition_find_first 之前调用，内容为全 0xFF）
+ */
+esp_err_t esp_partition_host_create(const char *label, uint32_t size);
+void esp_partition_host_get_stats(esp_partition_host_stats_t *stats);
+
+#endif /* __HOST_SHIM_ESP_PARTITION_H__ */
@@ -0,0 +1,86 @@
+// 主机构建用：单个 RAM 分区的 NOR Flash 模拟
+
+#include "esp_partition.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_SECTOR_SIZE    4096
+
+static esp_partition_t s_part;
+static uint8_t *s_mem = NULL;
+static esp_partition_host_stats_t s_stats;
+
+esp_err_t esp_partition_host_create(const char *label, uint32_t size)
+{
+    if (size == 0 || size % HOST_SECTOR_SIZE != 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    free(s_mem);
+    s_mem = malloc(size);
+    if (s_mem == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(s_mem, 0xFF, size);
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    s_part.type = ESP_PARTITION_TYPE_DATA;
+    s_part.subtype = ESP_PARTITION_SUBTYPE_ANY;
+    s_part.size = size;
+    s_part.erase_size = HOST_SECTOR_SIZE;
+    strncpy(s_part.label, label, sizeof(s_part.label) - 1);
+    return ESP_OK;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    (void)subtype;
+    if (s_mem == NULL || type != s_part.type || (label != NULL && strcmp(label, s_part.label) != 0)) {
+        return NULL;
+    }
+    return &s_part;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size)
+{
+    if (part != &s_part || offset + size > s_part.size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, s_mem + offset, size);
+    s_stats.reads++;
+    s_stats.bytes_read += size;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size)
+{
+    if (part != &s_part || offset + size > s_part.size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t *p = src;
+    for (size_t i = 0; i < size; i++) {
+        if (p[i] & ~s_mem[offset + i]) {
+            s_stats.nor_violations++;
+        }
+        s_mem[offset + i] &= p[i];
+    }
+    s_stats.writes++;
+    s_stats.bytes_written += size;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size)
+{
+    if (part != &s_part || offset % HOST_SECTOR_SIZE != 0 || size % HOST_SECTOR_SIZE != 0 ||
+        offset + size > s_part.size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(s_mem + offset, 0xFF, size);
+    s_stats.erases += size / HOST_SECTOR_SIZE;
+    return ESP_OK;
+}
+
+void esp_partition_host_get_stats(esp_partition_host_stats_t *stats)
+{
+    *stats = s_stats;
+}
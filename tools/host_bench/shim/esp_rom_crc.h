@@ -0,0 +1,19 @@
+#ifndef __HOST_SHIM_ESP_ROM_CRC_H__
+#define __HOST_SHIM_ESP_ROM_CRC_H__
+
+#include <stdint.h>
+
+// 主机构建用：与 ROM 中 crc32_le 相同（多项式 0xEDB88320，输入输出取反，与 zlib crc32 一致）
+static inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+#endif /* __HOST_SHIM_ESP_ROM_CRC_H__ */
@@ -0,0 +1,20 @@
+#ifndef __HOST_SHIM_ESP_TIMER_H__
+#define __HOST_SHIM_ESP_TIMER_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#if HOST_MOCK_CLOCK
+// 虚拟时钟：由测试程序实现（FreeRTOS shim 的延时与超时仍使用真实时间）
+int64_t esp_timer_get_time(void);
+#else
+// 主机构建用：单调时钟（微秒）
+static inline int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+#endif
+
+#endif /* __HOST_SHIM_ESP_TIMER_H__ */
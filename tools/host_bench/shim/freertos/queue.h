@@ -0,0 +1,16 @@
+#ifndef __HOST_SHIM_FREERTOS_QUEUE_H__
+#define __HOST_SHIM_FREERTOS_QUEUE_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t q);
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t timeout);
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t timeout);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q);
+
+#define xQueueSendToBack(q, item, timeout)  xQueueSend(q, item, timeout)
+
+#endif /* __HOST_SHIM_FREERTOS_QUEUE_H__ */
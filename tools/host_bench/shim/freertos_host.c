@@ -0,0 +1,445 @@
+// 主机构建用：FreeRTOS 任务、队列与信号量的 pthread 实现
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct host_task {
+    TaskFunction_t fn;
+    void *arg;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t notify;            // 任务通知计数
+};
+
+struct host_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t buf[];
+};
+
+struct host_sem {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    UBaseType_t max;
+    UBaseType_t count;
+    bool recursive;
+    pthread_t owner;            // 递归互斥量的持有者
+    UBaseType_t depth;          // 递归获取层数
+};
+
+struct host_event_group {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+static uint64_t _now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 超时换算为 pthread_cond_timedwait 使用的绝对时间（CLOCK_REALTIME）
+static struct timespec _deadline(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return ts;
+}
+
+// 在 mutex 已加锁时等待 cond 直到 ready() 为真，超时返回 false
+static bool _wait(pthread_cond_t *cond, pthread_mutex_t *mutex, TickType_t timeout,
+                  bool (*ready)(void *), void *obj)
+{
+    struct timespec dl = _deadline(timeout == portMAX_DELAY ? 0 : timeout);
+    while (!ready(obj)) {
+        if (timeout == 0) {
+            return false;
+        }
+        if (timeout == portMAX_DELAY) {
+            pthread_cond_wait(cond, mutex);
+        } else if (pthread_cond_timedwait(cond, mutex, &dl) == ETIMEDOUT) {
+            return ready(obj);
+        }
+    }
+    return true;
+}
+
+/* ================= Task ================= */
+
+static uint64_t s_start_ms;
+static __thread struct host_task *s_current;    // 当前线程对应的任务（主线程首次使用时创建）
+
+static struct host_task *_task_new(TaskFunction_t fn, void *arg)
+{
+    struct host_task *t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&t->mutex, NULL);
+    pthread_cond_init(&t->cond, NULL);
+    t->fn = fn;
+    t->arg = arg;
+    return t;
+}
+
+static void *_task_entry(void *p)
+{
+    struct host_task *t = p;
+    s_current = t;
+    t->fn(t->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t prio, TaskHandle_t *handle)
+{
+    (void)name;
+    (void)stack;
+    (void)prio;
+    struct host_task *t = _task_new(fn, arg);
+    if (t == NULL) {
+        return pdFAIL;
+    }
+
+    pthread_t th;
+    if (pthread_create(&th, NULL, _task_entry, t) != 0) {
+        free(t);
+        return pdFAIL;
+    }
+    pthread_detach(th);
+    if (handle != NULL) {
+        *handle = t;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec = ticks / 1000,
+        .tv_nsec = (long)(ticks % 1000) * 1000000,
+    };
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    if (s_start_ms == 0) {
+        s_start_ms = _now_ms();
+    }
+    return (TickType_t)(_now_ms() - s_start_ms);
+}
+
+void vTaskDelayUntil(TickType_t *prev_wake, TickType_t period)
+{
+    TickType_t wake = *prev_wake + period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(wake - now) > 0) {
+        vTaskDelay(wake - now);
+    }
+    *prev_wake = wake;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (s_current == NULL) {
+        s_current = _task_new(NULL, NULL);
+    }
+    return s_current;
+}
+
+static bool _task_notified(void *p)
+{
+    return ((struct host_task *)p)->notify > 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->mutex);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->mutex);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout)
+{
+    struct host_task *t = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&t->mutex);
+    _wait(&t->cond, &t->mutex, timeout, _task_notified, t);
+    uint32_t n = t->notify;
+    if (n > 0) {
+        t->notify = clear_on_exit ? 0 : n - 1;
+    }
+    pthread_mutex_unlock(&t->mutex);
+    return n;
+}
+
+/* ================= Queue ================= */
+
+static bool _queue_has_item(void *p)
+{
+    return ((struct host_queue *)p)->count > 0;
+}
+
+static bool _queue_has_space(void *p)
+{
+    struct host_queue *q = p;
+    return q->count < q->length;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *q = calloc(1, sizeof(*q) + (size_t)length * item_size);
+    if (q == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&q->mutex, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    pthread_mutex_destroy(&q->mutex);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t timeout)
+{
+    pthread_mutex_lock(&q->mutex);
+    if (!_wait(&q->not_full, &q->mutex, timeout, _queue_has_space, q)) {
+        pthread_mutex_unlock(&q->mutex);
+        return pdFALSE;
+    }
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(q->buf + (size_t)tail * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->mutex);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t timeout)
+{
+    pthread_mutex_lock(&q->mutex);
+    if (!_wait(&q->not_empty, &q->mutex, timeout, _queue_has_item, q)) {
+        pthread_mutex_unlock(&q->mutex);
+        return pdFALSE;
+    }
+    memcpy(item, q->buf + (size_t)q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->mutex);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->mutex);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->mutex);
+    return n;
+}
+
+/* ================= Semaphore ================= */
+
+static bool _sem_available(void *p)
+{
+    return ((struct host_sem *)p)->count > 0;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    struct host_sem *s = calloc(1, sizeof(*s));
+    if (s == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->max = max;
+    s->count = initial;
+    return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t timeout)
+{
+    pthread_mutex_lock(&s->mutex);
+    if (!_wait(&s->cond, &s->mutex, timeout, _sem_available, s)) {
+        pthread_mutex_unlock(&s->mutex);
+        return pdFALSE;
+    }
+    s->count--;
+    pthread_mutex_unlock(&s->mutex);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    pthread_mutex_lock(&s->mutex);
+    BaseType_t ok = s->count < s->max;
+    if (ok) {
+        s->count++;
+        pthread_cond_signal(&s->cond);
+    }
+    pthread_mutex_unlock(&s->mutex);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    SemaphoreHandle_t s = xSemaphoreCreateCounting(1, 1);
+    if (s != NULL) {
+        s->recursive = true;
+    }
+    return s;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t timeout)
+{
+    pthread_mutex_lock(&s->mutex);
+    if (s->depth > 0 && pthread_equal(s->owner, pthread_self())) {
+        s->depth++;
+        pthread_mutex_unlock(&s->mutex);
+        return pdTRUE;
+    }
+    if (!_wait(&s->cond, &s->mutex, timeout, _sem_available, s)) {
+        pthread_mutex_unlock(&s->mutex);
+        return pdFALSE;
+    }
+    s->count--;
+    s->owner = pthread_self();
+    s->depth = 1;
+    pthread_mutex_unlock(&s->mutex);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s)
+{
+    pthread_mutex_lock(&s->mutex);
+    if (s->depth == 0 || !pthread_equal(s->owner, pthread_self())) {
+        pthread_mutex_unlock(&s->mutex);
+        return pdFALSE;
+    }
+    if (--s->depth == 0) {
+        s->count++;
+        pthread_cond_signal(&s->cond);
+    }
+    pthread_mutex_unlock(&s->mutex);
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+    pthread_mutex_destroy(&s->mutex);
+    pthread_cond_destroy(&s->cond);
+    free(s);
+}
+
+/* ================= Event Group ================= */
+
+struct event_wait {
+    EventGroupHandle_t group;
+    EventBits_t bits;
+    bool all;
+};
+
+static bool _bits_ready(void *p)
+{
+    struct event_wait *w = p;
+    EventBits_t hit = w->group->bits & w->bits;
+    return w->all ? hit == w->bits : hit != 0;
+}
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct host_event_group *g = calloc(1, sizeof(*g));
+    if (g == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&g->mutex, NULL);
+    pthread_cond_init(&g->cond, NULL);
+    return g;
+}
+
+void vEventGroupDelete(EventGroupHandle_t g)
+{
+    pthread_mutex_destroy(&g->mutex);
+    pthread_cond_destroy(&g->cond);
+    free(g);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    pthread_mutex_lock(&g->mutex);
+    g->bits |= bits;
+    EventBits_t v = g->bits;
+    pthread_cond_broadcast(&g->cond);
+    pthread_mutex_unlock(&g->mutex);
+    return v;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    pthread_mutex_lock(&g->mutex);
+    EventBits_t v = g->bits;
+    g->bits &= ~bits;
+    pthread_mutex_unlock(&g->mutex);
+    return v;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t g)
+{
+    pthread_mutex_lock(&g->mutex);
+    EventBits_t v = g->bits;
+    pthread_mutex_unlock(&g->mutex);
+    return v;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_all, TickType_t timeout)
+{
+    struct event_wait w = {g, bits, wait_all};
+    pthread_mutex_lock(&g->mutex);
+    bool ok = _wait(&g->cond, &g->mutex, timeout, _bits_ready, &w);
+    EventBits_t v = g->bits;
+    if (ok && clear_on_exit) {
+        g->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&g->mutex);
+    return v;
+}
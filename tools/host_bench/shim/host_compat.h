@@ -0,0 +1,21 @@
+#ifndef __HOST_SHIM_HOST_COMPAT_H__
+#define __HOST_SHIM_HOST_COMPAT_H__
+
+// 主机构建用：newlib 提供而旧版 glibc 缺少的函数（由 Makefile 以 -include 引入）
+
+#include <string.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+static inline size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+#endif /* __HOST_SHIM_HOST_COMPAT_H__ */
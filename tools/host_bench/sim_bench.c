@@ -0,0 +1,119 @@
+/*
+ * 模拟设备吞吐基准：在主机上用虚拟时钟驱动 mpu6050_sim，按 FIFO 采集任务的方式
+ * 读取 FIFO_COUNT / FIFO_R_W 并解析样本，统计每个样本的耗时。
+ *
+ * 用法：sim_bench [样本数] [回放文件]
+ *   不指定回放文件时，先生成一段 1kHz、10 秒的 CSV 供回放设备循环播放。
+ */
+#include "mpu6050_sim.h"
+#include "mpu6050_config.h"
+#include "host_bench.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_DEFAULT_SAMPLES   2000000
+#define BENCH_STEP_US           10000       // 每次读取间隔 10ms（8kHz 下 80 个样本，不溢出）
+#define BENCH_REPLAY_RATE_HZ    1000
+#define BENCH_REPLAY_SECONDS    10
+
+typedef struct {
+    uint64_t samples;
+    uint64_t overflows;
+    int64_t checksum;           // 防止编译器省略解析
+} bench_result_t;
+
+// 与 mpu6050_fifo_start 相同的寄存器序列：唤醒、关闭 DLPF（8kHz）、复位并开启 FIFO
+static void _configure(mpu6050_sim_t *sim)
+{
+    mpu6050_sim_power_on(sim, 0);
+    ESP_ERROR_CHECK(mpu6050_sim_write_reg(sim, 0, MPU6050_REG_PWR_MGMT_1, MPU6050_PWR_MGMT_1_WAKEUP));
+    ESP_ERROR_CHECK(mpu6050_sim_write_reg(sim, 0, MPU6050_REG_CONFIG, MPU6050_DLPF_260HZ));
+    ESP_ERROR_CHECK(mpu6050_sim_write_reg(sim, 0, MPU6050_REG_SMPLRT_DIV, 0));
+    ESP_ERROR_CHECK(mpu6050_sim_write_reg(sim, 0, MPU6050_REG_USER_CTRL, MPU6050_USER_CTRL_FIFO_RESET));
+    ESP_ERROR_CHECK(mpu6050_sim_write_reg(sim, 0, MPU6050_REG_USER_CTRL, MPU6050_USER_CTRL_FIFO_EN));
+    ESP_ERROR_CHECK(mpu6050_sim_write_reg(sim, 0, MPU6050_REG_FIFO_EN, MPU6050_FIFO_EN_ACCEL_GYRO));
+}
+
+static void _drain(mpu6050_sim_t *sim, int64_t now, bench_result_t *res)
+{
+    uint8_t status;
+    mpu6050_sim_read_regs(sim, now, MPU6050_REG_INT_STATUS, &status, 1);
+    if (status & MPU6050_INT_FIFO_OFLOW) {
+        res->overflows++;
+    }
+
+    uint8_t cnt[2];
+    mpu6050_sim_read_regs(sim, now, MPU6050_REG_FIFO_COUNT_H, cnt, 2);
+    size_t avail = ((size_t)cnt[0] << 8 | cnt[1]) / MPU6050_FIFO_SAMPLE_BYTES * MPU6050_FIFO_SAMPLE_BYTES;
+
+    uint8_t buf[MPU6050_FIFO_HW_SIZE];
+    while (avail > 0) {
+        size_t n = avail < MPU6050_FIFO_BURST_BYTES ? avail : MPU6050_FIFO_BURST_BYTES;
+        mpu6050_sim_read_regs(sim, now, MPU6050_REG_FIFO_R_W, buf, n);
+        for (size_t off = 0; off < n; off += MPU6050_FIFO_SAMPLE_BYTES) {
+            for (int i = 0; i < 6; i++) {
+                res->checksum += (int16_t)((buf[off + i * 2] << 8) | buf[off + i * 2 + 1]);
+            }
+            res->samples++;
+        }
+        avail -= n;
+    }
+}
+
+static void _run(const char *label, mpu6050_sim_t *sim, uint64_t target)
+{
+    bench_result_t res = {0};
+    _configure(sim);
+
+    int64_t t = 0;
+    uint64_t start = host_bench_now_ns();
+    while (res.samples < target) {
+        t += BENCH_STEP_US;
+        _drain(sim, t, &res);
+    }
+    double elapsed_s = (host_bench_now_ns() - start) * 1e-9;
+
+    // 8kHz 下虚拟时间 t 内应产生 t × 8000 / 1e6 个样本（±1）
+    uint64_t expect = (uint64_t)t * 8000 / 1000000;
+    printf("%-10s %9" PRIu64 " 样本 (期望 %9" PRIu64 ", 溢出 %" PRIu64 ")  %.3f s  %6.1f ns/样本  %6.2f M样本/s  [校验 %" PRId64 "]\n",
+           label, res.samples, expect, res.overflows, elapsed_s, elapsed_s * 1e9 / res.samples,
+           res.samples / elapsed_s * 1e-6, res.checksum);
+}
+
+// 生成回放文件：30° 倾斜 + 0.5Hz 摆动，±2g / ±250°/s 量程的原始值
+static const char *_write_replay_file(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        perror(path);
+        exit(1);
+    }
+    fprintf(fp, "# t_us,ax,ay,az,gx,gy,gz\n");
+    for (int i = 0; i < BENCH_REPLAY_RATE_HZ * BENCH_REPLAY_SECONDS; i++) {
+        double t = (double)i / BENCH_REPLAY_RATE_HZ;
+        double tilt = 30.0 * M_PI / 180.0;
+        fprintf(fp, "%llu,%d,%d,%d,%d,%d,%d\n", (unsigned long long)(t * 1e6),
+                0, (int)lround(sin(tilt) * MPU6050_ACCEL_SENS_2G), (int)lround(cos(tilt) * MPU6050_ACCEL_SENS_2G),
+                (int)lround(20.0 * sin(2 * M_PI * 0.5 * t) * MPU6050_GYRO_SENS_250), 0, 0);
+    }
+    fclose(fp);
+    return path;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t target = argc > 1 ? strtoull(argv[1], NULL, 10) : BENCH_DEFAULT_SAMPLES;
+    const char *replay = argc > 2 ? argv[2] : _write_replay_file("build/sim_bench_replay.csv");
+
+    mpu6050_sim_t *sim = NULL;
+    ESP_ERROR_CHECK(mpu6050_sim_create_synthetic(NULL, &sim));
+    _run("synthetic", sim, target);
+    mpu6050_sim_delete(sim);
+
+    ESP_ERROR_CHECK(mpu6050_sim_create_replay(replay, true, &sim));
+    _run("replay", sim, target);
+    mpu6050_sim_delete(sim);
+    return 0;
+}
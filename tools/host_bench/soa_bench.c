@@ -0,0 +1,124 @@
+/*
+ * 原始值换算基准：逐样本 mpu6050_convert_data 与 SoA 批量 mpu6050_convert_batch
+ * 的每样本耗时，并检查两者输出逐位一致。
+ *
+ * 用法：soa_bench [每批样本数] [重复次数]
+ */
+#include "mpu6050.h"
+#include "mpu6050_calib.h"
+#include "mpu6050_backend.h"
+#include "host_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_SAMPLES   1000
+#define BENCH_DEFAULT_ROUNDS    20000
+
+// mpu6050.c 的外部依赖：换算接口不需要设备，初始化路径不会被调用
+esp_err_t mpu6050_calib_load(void)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+const mpu6050_backend_t *mpu6050_backend_i2c(void)
+{
+    return NULL;
+}
+
+typedef struct {
+    int16_t *ch[6];
+} raw_channels_t;
+
+typedef struct {
+    float *ch[6];
+} data_channels_t;
+
+static void *_alloc(size_t size)
+{
+    void *p = aligned_alloc(64, (size + 63) & ~(size_t)63);
+    if (p == NULL) {
+        perror("aligned_alloc");
+        exit(1);
+    }
+    return p;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_SAMPLES;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : BENCH_DEFAULT_ROUNDS;
+
+    // 非零零偏与比例，确保系数中的 b 项参与运算
+    mpu6050_calib_t calib = {
+        .flags = MPU6050_CALIB_GYRO_VALID | MPU6050_CALIB_ACCEL_VALID,
+        .gyro_bias_dps = {0.5f, -0.3f, 0.2f},
+        .accel_offset_g = {0.01f, -0.02f, 0.03f},
+        .accel_scale = {1.01f, 0.99f, 1.002f},
+    };
+    mpu6050_set_calibration(&calib);
+
+    mpu6050_raw_data_t *aos = _alloc(n * sizeof(*aos));
+    mpu6050_data_t *aos_out = _alloc(n * sizeof(*aos_out));
+    raw_channels_t raw;
+    data_channels_t out;
+    for (int c = 0; c < 6; c++) {
+        raw.ch[c] = _alloc(n * sizeof(int16_t));
+        out.ch[c] = _alloc(n * sizeof(float));
+    }
+    mpu6050_raw_soa_t raw_soa = {raw.ch[0], raw.ch[1], raw.ch[2], raw.ch[3], raw.ch[4], raw.ch[5]};
+    mpu6050_data_soa_t data_soa = {out.ch[0], out.ch[1], out.ch[2], out.ch[3], out.ch[4], out.ch[5]};
+
+    uint32_t x = 1;
+    for (size_t i = 0; i < n; i++) {
+        int16_t *v = &aos[i].accel_x;
+        for (int c = 0; c < 6; c++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            v[c] = (int16_t)x;
+        }
+    }
+
+    // 逐样本接口
+    uint64_t t0 = host_bench_now_ns();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < n; i++) {
+            mpu6050_convert_data(&aos[i], &aos_out[i]);
+        }
+    }
+    double per_sample = (double)(host_bench_now_ns() - t0) / ((double)rounds * n);
+
+    // 批量接口（输入已是 SoA）
+    mpu6050_raw_to_soa(aos, sizeof(*aos), n, &raw_soa);
+    t0 = host_bench_now_ns();
+    for (size_t r = 0; r < rounds; r++) {
+        mpu6050_convert_batch(&raw_soa, &data_soa, n);
+    }
+    double batch = (double)(host_bench_now_ns() - t0) / ((double)rounds * n);
+
+    // 批量接口（含从 FIFO 样本数组拆分为 SoA）
+    t0 = host_bench_now_ns();
+    for (size_t r = 0; r < rounds; r++) {
+        mpu6050_raw_to_soa(aos, sizeof(*aos), n, &raw_soa);
+        mpu6050_convert_batch(&raw_soa, &data_soa, n);
+    }
+    double batch_split = (double)(host_bench_now_ns() - t0) / ((double)rounds * n);
+
+    size_t mismatch = 0;
+    for (size_t i = 0; i < n; i++) {
+        const float *v = &aos_out[i].accel_x;
+        for (int c = 0; c < 6; c++) {
+            if (memcmp(&v[c], &out.ch[c][i], sizeof(float)) != 0) {
+                mismatch++;
+            }
+        }
+    }
+
+    printf("%zu 样本 × %zu 轮\n", n, rounds);
+    printf("逐样本 mpu6050_convert_data   %6.2f ns/样本\n", per_sample);
+    printf("批量 mpu6050_convert_batch    %6.2f ns/样本 (%.2fx)\n", batch, per_sample / batch);
+    printf("拆分 + 批量                   %6.2f ns/样本 (%.2fx)\n", batch_split, per_sample / batch_split);
+    printf("输出逐位比较: %s (%zu 处不一致)\n", mismatch ? "不一致" : "一致", mismatch);
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * 批量遥测格式测试：mpu6050_telemetry 编码 → 解析 → 逐样本读取的往返一致性，
+ * 以及间隔超出 u16（ESP_ERR_INVALID_STATE）、缓冲区满（ESP_ERR_NO_MEM）、
+ * 截断/损坏批次等错误路径；最后给出编码与解码吞吐。
+ *
+ * 用法：telemetry_test [批次样本数]
+ */
+#include "mpu6050_telemetry.h"
+#include "host_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_SAMPLES   500
+#define BENCH_ACCEL_LSB         16384.0f    // ±2g
+#define BENCH_GYRO_LSB          131.0f      // ±250°/s
+#define BENCH_BASE_TS_US        1234567890123ULL
+#define BENCH_ROUNDS            2000
+
+static int s_failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  失败 %s:%d: %s\n", __FILE__, __LINE__, #cond);       \
+            s_failures++;                                                   \
+        }                                                                   \
+    } while (0)
+
+// 可复现的测试样本：包含 int16 的两端值
+static void _make_sample(uint32_t i, mpu6050_raw_data_t *raw)
+{
+    uint32_t h = i * 2654435761u;
+    raw->accel_x = (int16_t)h;
+    raw->accel_y = (int16_t)(h >> 16);
+    raw->accel_z = (i % 7 == 0) ? INT16_MIN : (int16_t)(16384 - (int16_t)(i & 0xFF));
+    raw->gyro_x = (i % 11 == 0) ? INT16_MAX : (int16_t)(h >> 8);
+    raw->gyro_y = (int16_t)-(int32_t)i;
+    raw->gyro_z = 0;
+}
+
+// 间隔覆盖 0、常规采样周期与 u16 上限
+static uint16_t _make_dt(uint32_t i)
+{
+    switch (i % 5) {
+    case 0:
+        return 1000;
+    case 1:
+        return 0;
+    case 2:
+        return UINT16_MAX;
+    default:
+        return (uint16_t)(997 + i % 13);
+    }
+}
+
+static bool _raw_equal(const mpu6050_raw_data_t *a, const mpu6050_raw_data_t *b)
+{
+    return a->accel_x == b->accel_x && a->accel_y == b->accel_y && a->accel_z == b->accel_z &&
+           a->gyro_x == b->gyro_x && a->gyro_y == b->gyro_y && a->gyro_z == b->gyro_z;
+}
+
+static size_t _encode(mpu6050_telemetry_t *t, uint16_t samples)
+{
+    mpu6050_telemetry_reset(t);
+    uint64_t ts = BENCH_BASE_TS_US;
+    for (uint32_t i = 0; i < samples; i++) {
+        mpu6050_raw_data_t raw;
+        _make_sample(i, &raw);
+        if (i > 0) {
+            ts += _make_dt(i);
+        }
+        if (mpu6050_telemetry_add(t, &raw, ts) != ESP_OK) {
+            return 0;
+        }
+    }
+    return mpu6050_telemetry_finish(t);
+}
+
+static void _test_round_trip(uint16_t samples)
+{
+    printf("往返一致性（%u 个样本）\n", samples);
+    size_t cap = MPU6050_TELEMETRY_BUF_SIZE(samples);
+    uint8_t *buf = malloc(cap);
+    mpu6050_telemetry_t t;
+    CHECK(mpu6050_telemetry_init(&t, buf, cap, BENCH_ACCEL_LSB, BENCH_GYRO_LSB) == ESP_OK);
+
+    size_t len = _encode(&t, samples);
+    CHECK(len == cap);
+
+    mpu6050_telemetry_header_t hdr;
+    CHECK(mpu6050_telemetry_parse_header(buf, len, &hdr) == ESP_OK);
+    CHECK(hdr.version == MPU6050_TELEMETRY_VERSION);
+    CHECK(hdr.count == samples);
+    CHECK(hdr.base_ts_us == BENCH_BASE_TS_US);
+    CHECK(hdr.accel_lsb_per_g == BENCH_ACCEL_LSB);
+    CHECK(hdr.gyro_lsb_per_dps == BENCH_GYRO_LSB);
+
+    uint32_t mismatches = 0;
+    uint64_t ts = BENCH_BASE_TS_US;
+    for (uint16_t i = 0; i < samples; i++) {
+        mpu6050_raw_data_t expect, got;
+        uint64_t got_ts = 0;
+        _make_sample(i, &expect);
+        if (i > 0) {
+            ts += _make_dt(i);
+        }
+        if (mpu6050_telemetry_get_sample(buf, len, i, &got, &got_ts) != ESP_OK ||
+            !_raw_equal(&expect, &got) || got_ts != ts) {
+            mismatches++;
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // 越界样本、截断批次、损坏的魔数与版本
+    mpu6050_raw_data_t raw;
+    CHECK(mpu6050_telemetry_get_sample(buf, len, samples, &raw, NULL) == ESP_ERR_INVALID_ARG);
+    CHECK(mpu6050_telemetry_parse_header(buf, len - 1, &hdr) == ESP_ERR_INVALID_SIZE);
+    CHECK(mpu6050_telemetry_parse_header(buf, MPU6050_TELEMETRY_HEADER_SIZE - 1, &hdr) == ESP_ERR_INVALID_ARG);
+    buf[2] = MPU6050_TELEMETRY_VERSION + 1;
+    CHECK(mpu6050_telemetry_parse_header(buf, len, &hdr) == ESP_ERR_INVALID_VERSION);
+    buf[0] ^= 0xFF;
+    CHECK(mpu6050_telemetry_parse_header(buf, len, &hdr) == ESP_ERR_INVALID_RESPONSE);
+
+    // reset 后头部灵敏度保留，无样本时 finish 返回 0
+    mpu6050_telemetry_init(&t, buf, cap, BENCH_ACCEL_LSB, BENCH_GYRO_LSB);
+    mpu6050_telemetry_reset(&t);
+    CHECK(mpu6050_telemetry_finish(&t) == 0);
+    free(buf);
+}
+
+static void _test_dt_overflow(void)
+{
+    printf("间隔溢出\n");
+    uint8_t buf[MPU6050_TELEMETRY_BUF_SIZE(8)];
+    mpu6050_telemetry_t t;
+    mpu6050_raw_data_t raw;
+    _make_sample(1, &raw);
+    CHECK(mpu6050_telemetry_init(&t, buf, sizeof(buf), BENCH_ACCEL_LSB, BENCH_GYRO_LSB) == ESP_OK);
+
+    uint64_t ts = BENCH_BASE_TS_US;
+    CHECK(mpu6050_telemetry_add(&t, &raw, ts) == ESP_OK);
+    CHECK(mpu6050_telemetry_add(&t, &raw, ts + UINT16_MAX) == ESP_OK);
+    ts += UINT16_MAX;
+
+    // 间隔 65536 us 与时间回退都应拒绝，且不改变已编码内容
+    size_t len_before = t.len;
+    CHECK(mpu6050_telemetry_add(&t, &raw, ts + UINT16_MAX + 1) == ESP_ERR_INVALID_STATE);
+    CHECK(mpu6050_telemetry_add(&t, &raw, ts - 1) == ESP_ERR_INVALID_STATE);
+    CHECK(t.len == len_before && t.count == 2);
+
+    // 调用方发送当前批次后，新批次以该样本为基准
+    CHECK(mpu6050_telemetry_finish(&t) == MPU6050_TELEMETRY_BUF_SIZE(2));
+    mpu6050_telemetry_reset(&t);
+    CHECK(mpu6050_telemetry_add(&t, &raw, ts + UINT16_MAX + 1) == ESP_OK);
+    size_t len = mpu6050_telemetry_finish(&t);
+    mpu6050_telemetry_header_t hdr;
+    CHECK(mpu6050_telemetry_parse_header(buf, len, &hdr) == ESP_OK);
+    CHECK(hdr.count == 1 && hdr.base_ts_us == ts + UINT16_MAX + 1);
+}
+
+static void _test_full_buffer(void)
+{
+    printf("缓冲区满\n");
+    enum { CAP_SAMPLES = 4 };
+    // 多出的字节不足一个样本，不能被写入
+    uint8_t buf[MPU6050_TELEMETRY_BUF_SIZE(CAP_SAMPLES) + MPU6050_TELEMETRY_SAMPLE_SIZE - 1];
+    mpu6050_telemetry_t t;
+    mpu6050_raw_data_t raw;
+    CHECK(mpu6050_telemetry_init(&t, buf, MPU6050_TELEMETRY_BUF_SIZE(1) - 1, 1.0f, 1.0f) == ESP_ERR_INVALID_ARG);
+    CHECK(mpu6050_telemetry_init(&t, buf, sizeof(buf), BENCH_ACCEL_LSB, BENCH_GYRO_LSB) == ESP_OK);
+
+    uint64_t ts = BENCH_BASE_TS_US;
+    for (uint32_t i = 0; i < CAP_SAMPLES; i++, ts += 1000) {
+        _make_sample(i, &raw);
+        CHECK(mpu6050_telemetry_add(&t, &raw, ts) == ESP_OK);
+    }
+    _make_sample(CAP_SAMPLES, &raw);
+    CHECK(mpu6050_telemetry_add(&t, &raw, ts) == ESP_ERR_NO_MEM);
+    CHECK(t.count == CAP_SAMPLES);
+
+    size_t len = mpu6050_telemetry_finish(&t);
+    CHECK(len == MPU6050_TELEMETRY_BUF_SIZE(CAP_SAMPLES));
+    mpu6050_raw_data_t got;
+    _make_sample(CAP_SAMPLES - 1, &raw);
+    CHECK(mpu6050_telemetry_get_sample(buf, len, CAP_SAMPLES - 1, &got, NULL) == ESP_OK);
+    CHECK(_raw_equal(&raw, &got));
+}
+
+static void _bench(uint16_t samples)
+{
+    size_t cap = MPU6050_TELEMETRY_BUF_SIZE(samples);
+    uint8_t *buf = malloc(cap);
+    mpu6050_telemetry_t t;
+    mpu6050_telemetry_init(&t, buf, cap, BENCH_ACCEL_LSB, BENCH_GYRO_LSB);
+
+    uint64_t t0 = host_bench_now_ns();
+    size_t len = 0;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        len = _encode(&t, samples);
+    }
+    uint64_t enc_ns = host_bench_now_ns() - t0;
+
+    // 不取时间戳：逐个取时间戳为 O(n²)，接收端应自行累加 dt
+    volatile int32_t sink = 0;
+    t0 = host_bench_now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (uint16_t i = 0; i < samples; i++) {
+            mpu6050_raw_data_t raw;
+            mpu6050_telemetry_get_sample(buf, len, i, &raw, NULL);
+            sink += raw.accel_x;
+        }
+    }
+    uint64_t dec_ns = host_bench_now_ns() - t0;
+    (void)sink;
+
+    double n = (double)BENCH_ROUNDS * samples;
+    printf("吞吐: 批次 %zu 字节（%.2f 字节/样本）  编码 %.1f ns/样本  解码 %.1f ns/样本\n", len,
+           (double)len / samples, enc_ns / n, dec_ns / n);
+    free(buf);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long samples = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_SAMPLES;
+    if (samples < 2 || samples > UINT16_MAX) {
+        fprintf(stderr, "批次样本数需在 2..%u 之间\n", UINT16_MAX);
+        return 2;
+    }
+
+    _test_round_trip((uint16_t)samples);
+    _test_dt_overflow();
+    _test_full_buffer();
+    _bench((uint16_t)samples);
+
+    printf("一致性: %s\n", s_failures == 0 ? "通过" : "失败");
+    return s_failures == 0 ? 0 : 1;
+}